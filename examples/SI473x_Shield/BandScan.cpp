@@ -0,0 +1,124 @@
+/*
+  Band scan engine for the SI473X.
+
+  A channel goes through:
+
+    SCAN_TUNE   startTune() sent, isTuneComplete() polled. Then getStatus(1, 0) acknowledges the tune
+                and returns RSSI, SNR and the valid flag measured by the device.
+    SCAN_DWELL  only for candidates (valid, or RSSI SCAN_CANDIDATE_DB over the noise floor):
+                SCAN_DWELL_SAMPLES readings of getCurrentReceivedSignalQuality() SCAN_SAMPLE_TIME apart.
+                The AGC and the SNR estimate of the device need that time on a real signal.
+
+  The noise floor follows the RSSI of the channels that were not candidates.
+*/
+#include "BandScan.h"
+
+BandScan::BandScan(SI4735 &rx) : rx(rx)
+{
+}
+
+/**
+ * Starts a sweep of the band. The step is raised until the band fits SCAN_MAX_CHANNELS.
+ */
+bool BandScan::start(uint16_t minimumFreq, uint16_t maximumFreq, uint16_t step)
+{
+  if (maximumFreq < minimumFreq || step == 0)
+    return false;
+  while ((uint32_t)(maximumFreq - minimumFreq) / step + 1 > SCAN_MAX_CHANNELS)
+    step++;
+  this->minimumFreq = minimumFreq;
+  this->maximumFreq = maximumFreq;
+  this->step = step;
+  channels = (maximumFreq - minimumFreq) / step + 1;
+  memset(map, 0, channels * sizeof(ScanChannel));
+  position = stations = candidates = 0;
+  noiseFloor = 0xFF;
+  scanTime = 0;
+  scanStart = millis();
+  tuneNext();
+  return true;
+}
+
+void BandScan::stop()
+{
+  if (state == SCAN_TUNE)
+    rx.getStatus(1, 0); // clears STCINT of the tune in flight, the device is left on that channel
+  state = SCAN_IDLE;
+}
+
+void BandScan::tuneNext()
+{
+  rx.startTune(getFrequency(position));
+  lastAction = millis();
+  state = SCAN_TUNE;
+}
+
+void BandScan::record()
+{
+  ScanChannel *ch = &map[position];
+  ch->refined.rssi = min(rssiSum / samples, 127);
+  ch->refined.snr = min(snrMax, (uint8_t)127);
+  ch->refined.valid = valid;
+  ch->refined.scanned = 1;
+  if (valid)
+    stations++;
+  if (++position < channels) {
+    tuneNext();
+  } else {
+    scanTime = millis() - scanStart;
+    state = SCAN_IDLE;
+  }
+}
+
+/**
+ * Advances the scan, one device command per call at most (plus the tune of the next channel).
+ */
+bool BandScan::service()
+{
+  if (state == SCAN_TUNE) {
+    if (!rx.isTuneComplete()) {
+      if (millis() - lastAction < SCAN_TUNE_TIMEOUT)
+        return false;
+      // never completed, leave it unscanned
+      rx.getStatus(1, 0);
+      if (++position < channels) {
+        tuneNext();
+      } else {
+        scanTime = millis() - scanStart;
+        state = SCAN_IDLE;
+      }
+      return true;
+    }
+    rx.getStatus(1, 0);
+    uint8_t rssi = rx.getReceivedSignalStrengthIndicator();
+    rssiSum = rssi;
+    snrMax = rx.getStatusSNR();
+    valid = rx.getStatusValid();
+    samples = 1;
+    if (noiseFloor == 0xFF)
+      noiseFloor = rssi;
+    if (valid || rssi >= noiseFloor + SCAN_CANDIDATE_DB) {
+      candidates++;
+      lastAction = millis();
+      state = SCAN_DWELL;
+      return false;
+    }
+    noiseFloor = (noiseFloor * 7 + rssi + 4) / 8;
+    record();
+    return true;
+  }
+
+  if (state == SCAN_DWELL) {
+    if (millis() - lastAction < SCAN_SAMPLE_TIME)
+      return false;
+    rx.getCurrentReceivedSignalQuality();
+    rssiSum += rx.getCurrentRSSI();
+    snrMax = max(snrMax, rx.getCurrentSNR());
+    lastAction = millis();
+    if (++samples <= SCAN_DWELL_SAMPLES)
+      return false;
+    record();
+    return true;
+  }
+  return false;
+}
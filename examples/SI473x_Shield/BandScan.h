@@ -0,0 +1,83 @@
+// Band scan engine for the SI473X, records RSSI / SNR of every channel of a band.
+#include "Arduino.h"
+#include <SI4735.h>
+
+#ifndef band_scan_h
+#define band_scan_h
+
+#define SCAN_MAX_CHANNELS   6000  // 2 bytes each, ALL band (150 kHz to 30 MHz) at 5 kHz
+#define SCAN_TUNE_TIMEOUT    250  // ms, the channel is skipped if the tune does not complete
+#define SCAN_CANDIDATE_DB      6  // RSSI over the noise floor that makes a channel worth a longer look
+#define SCAN_DWELL_SAMPLES     4  // RSQ samples of a candidate channel
+#define SCAN_SAMPLE_TIME      10  // ms between them
+
+/**
+ * One channel of the occupancy map
+ */
+typedef union
+{
+  struct
+  {
+    uint16_t rssi : 7;    // dBuV, average of the samples
+    uint16_t snr : 7;     // dB, best sample
+    uint16_t valid : 1;   // station by the seek criteria of the device (SNR / RSSI thresholds)
+    uint16_t scanned : 1;
+  } refined;
+  uint16_t raw;
+} ScanChannel;
+
+/**
+ * Sweeps a band without blocking: service() is called from loop() and only talks to the device
+ * when it has something to do. The tune is started with startTune() and polled with
+ * isTuneComplete(), so a channel takes the tune time of the device and not a fixed delay.
+ * The tune status gives RSSI / SNR at once, only channels above the noise floor (or valid ones)
+ * stay for SCAN_DWELL_SAMPLES more RSQ readings. Empty channels cost one tune each.
+ */
+class BandScan
+{
+  public:
+    BandScan(SI4735 &rx);
+    // Sweeps minimumFreq to maximumFreq in the current mode of the device, the audio should be muted
+    bool start(uint16_t minimumFreq, uint16_t maximumFreq, uint16_t step);
+    void stop();
+    // Returns true when a channel was added to the map
+    bool service();
+    bool isRunning() { return state != SCAN_IDLE; }
+
+    uint16_t getChannels() { return channels; }
+    uint16_t getPosition() { return position; }  // channels done
+    uint16_t getFrequency(uint16_t idx) { return minimumFreq + idx * step; }
+    ScanChannel getChannel(uint16_t idx) { return map[idx]; }
+    uint16_t getMinimumFrequency() { return minimumFreq; }
+    uint16_t getMaximumFrequency() { return maximumFreq; }
+    uint16_t getStations() { return stations; }
+    uint16_t getCandidates() { return candidates; }
+    uint32_t getScanTime() { return scanTime; }   // ms, of the whole band once complete
+    bool isComplete() { return channels && position == channels && state == SCAN_IDLE; }
+
+  private:
+    enum { SCAN_IDLE = 0, SCAN_TUNE, SCAN_DWELL };
+
+    void tuneNext();
+    void record();
+
+    SI4735 &rx;
+    uint8_t state = SCAN_IDLE;
+    uint16_t minimumFreq = 0;
+    uint16_t maximumFreq = 0;
+    uint16_t step = 1;
+    uint16_t channels = 0;
+    uint16_t position = 0;
+    uint16_t stations = 0;
+    uint16_t candidates = 0;
+    uint8_t noiseFloor = 0;
+    uint8_t samples = 0;
+    uint16_t rssiSum = 0;
+    uint8_t snrMax = 0;
+    bool valid = false;
+    uint32_t scanStart = 0;
+    uint32_t scanTime = 0;
+    uint32_t lastAction = 0;
+    ScanChannel map[SCAN_MAX_CHANNELS];
+};
+#endif
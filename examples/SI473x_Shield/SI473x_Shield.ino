@@ -5,7 +5,9 @@
   regular  comercial  stations.
 
   Features:   AM; SSB; LW/MW/SW; external mute circuit control; AGC; Attenuation gain control;
-              SSB filter; CW; AM filter; 1, 5, 10, 50 and 500kHz step on AM and 10Hhz sep on SSB
+              SSB filter; CW; AM filter; 1, 5, 10, 50 and 500kHz step on AM and 10Hhz sep on SSB;
+              band scan with a spectrum of the whole band (menu "Scan")
+              FM RDS: station name on the display; text, RT+, clock time and group statistics on Serial
 
   Lilygo T-Display S3
   
@@ -66,10 +68,11 @@
 #include <Battery18650Stats.h> // https://github.com/danilopinotti/Battery18650Stats
 #include <OneButton.h>  // https://github.com/mathertel/OneButton
 
+#include "BandScan.h"
 #include "Rotary.h"
-#include "patch_init.h" // SSB patch for whole SSBRX initialization string
+#include <patch_ssb_compressed.h> // SSB patch for whole SSBRX initialization string, without the 0x15/0x16 command bytes
 
-const uint16_t size_content = sizeof ssb_patch_content; // see patch_init.h
+const si4735_compressed_patch ssbPatch = {ssb_patch_content, sizeof ssb_patch_content, cmd_0x15, sizeof cmd_0x15};
 
 #define FM_BAND_TYPE 0
 #define MW_BAND_TYPE 1
@@ -105,6 +108,8 @@ const uint16_t size_content = sizeof ssb_patch_content; // see patch_init.h
 #define DEFAULT_VOLUME          35  // change it for your favorite sound volume
 #define STRENGTH_CHECK_TIME   1500
 #define RDS_CHECK_TIME          90
+#define RDS_REPORT_TIME      10000  // RDS group statistics on Serial
+#define SCAN_DRAW_TIME         100  // spectrum refresh while scanning
 
 #define FM  0
 #define LSB 1
@@ -125,6 +130,7 @@ const uint16_t size_content = sizeof ssb_patch_content; // see patch_init.h
 #define SEEKDOWN     8
 #define BAND         9
 #define MUTE        10
+#define SCAN        11
 
 #define TFT_MENU_BACK TFT_BLACK  // 0x01E9
 #define TFT_MENU_HIGHLIGHT_BACK TFT_BLUE
@@ -169,6 +175,7 @@ long elapsedButton = millis();
 
 long lastStrengthCheck = millis();
 long lastRDSCheck = millis();
+long lastRDSReport = millis();
 
 long elapsedClick = millis();
 long elapsedCommand = millis();
@@ -179,7 +186,7 @@ const uint8_t currentBFOStep = 10;
 
 char sAgc[15];
 
-const char *menu[] = {"Volume", "Step", "Mode", "BFO", "BW", "AGC/Att", "SoftMute", "Seek Up", "Seek Dn", "Band", "Mute"};
+const char *menu[] = {"Volume", "Step", "Mode", "BFO", "BW", "AGC/Att", "SoftMute", "Seek Up", "Seek Dn", "Band", "Mute", "Scan"};
 int8_t menuIdx = VOLUME;
 const int lastMenu = (sizeof menu / sizeof(char *)) - 1;
 int8_t currentMenuCmd = -1;
@@ -298,12 +305,12 @@ Band band[] = {
 
 const int lastBand = (sizeof band / sizeof(Band)) - 1;
 int bandIdx = 0;
+uint32_t bandScanTime[lastBand + 1]; // ms, last complete scan of each band
 int tabStep[] = {1, 5, 10, 50, 100, 500, 1000};
 const int lastStep = (sizeof tabStep / sizeof(int)) - 1;
 
-char *rdsMsg;
-char *stationName;
-char *rdsTime;
+RdsDecoder rds;
+rds_stat lastRdsStat;
 char bufferStationName[50];
 char bufferRdsMsg[100];
 char bufferRdsTime[32];
@@ -330,12 +337,18 @@ TFT_eSprite spr = TFT_eSprite(&tft);
 
 SI4735 rx;
 
+BandScan scan(rx);
+bool scanView = false; // spectrum instead of the tuning scale
+long lastScanDraw = millis();
+
 void setup()
 {
 
   pinMode(PIN_POWER_ON, OUTPUT);
   digitalWrite(PIN_POWER_ON, HIGH);
 
+  Serial.begin(115200);
+
   // Encoder pins
   pinMode(ENCODER_PUSH_BUTTON, INPUT_PULLUP);
   
@@ -767,10 +780,13 @@ void useBand()
 }
 
 
+// The patch is uploaded at 400kHz only when the device lost it (power down when going to AM or FM)
 void loadSSB() {
-  rx.setI2CFastModeCustom(400000); // You can try rx.setI2CFastModeCustom(700000); or greater value
-  rx.loadPatch(ssb_patch_content, size_content, bandwidthSSB[bwIdxSSB].idx);
-  rx.setI2CFastModeCustom(100000);
+  bool upload = !rx.isPatchLoaded(&ssbPatch);
+  if (!rx.loadPatch(&ssbPatch, bandwidthSSB[bwIdxSSB].idx))
+    Serial.println("SSB patch refused by the device");
+  else if (upload)
+    Serial.printf("SSB patch loaded in %u ms\n", rx.getPatchLoadTime() / 1000);
   ssbLoaded = true; 
 }
 
@@ -902,11 +918,12 @@ void doMode(int8_t v)
       if (currentMode == AM)
       {
         // If you were in AM mode, it is necessary to load SSB patch (avery time)
-
-        spr.fillSmoothRoundRect(80,40,160,40,4,TFT_WHITE);
-        spr.fillSmoothRoundRect(81,41,158,38,4,TFT_MENU_BACK);
-        spr.drawString("Loading SSB",160,62,4);
-        spr.pushSprite(0,0);
+        if (!rx.isPatchLoaded(&ssbPatch)) {
+          spr.fillSmoothRoundRect(80,40,160,40,4,TFT_WHITE);
+          spr.fillSmoothRoundRect(81,41,158,38,4,TFT_MENU_BACK);
+          spr.drawString("Loading SSB",160,62,4);
+          spr.pushSprite(0,0);
+        }
         
         loadSSB();
         ssbLoaded = true;
@@ -923,11 +940,12 @@ void doMode(int8_t v)
       if (currentMode == AM)
       {
         // If you were in AM mode, it is necessary to load SSB patch (avery time)
-
-        spr.fillSmoothRoundRect(80,40,160,40,4,TFT_WHITE);
-        spr.fillSmoothRoundRect(81,41,158,38,4,TFT_MENU_BACK);
-        spr.drawString("Loading SSB",160,62,4);
-        spr.pushSprite(0,0);
+        if (!rx.isPatchLoaded(&ssbPatch)) {
+          spr.fillSmoothRoundRect(80,40,160,40,4,TFT_WHITE);
+          spr.fillSmoothRoundRect(81,41,158,38,4,TFT_MENU_BACK);
+          spr.drawString("Loading SSB",160,62,4);
+          spr.pushSprite(0,0);
+        }
         
         loadSSB();
         ssbLoaded = true;
@@ -984,6 +1002,48 @@ void doSeek()
   
 }
 
+/**
+ * Scans the whole current band in the current mode. The spectrum replaces the tuning scale.
+ */
+void startScan()
+{
+  uint16_t step;
+  if (currentMode == FM)
+    step = tabFmStep[currentStepIdx];
+  else
+    step = max(tabAmStep[currentStepIdx], 5); // finer than the AM channel spacing only costs time
+
+  rx.setAudioMute(true);
+  cleanBfoRdsInfo();
+  scanView = true;
+  scan.start(band[bandIdx].minimumFreq, band[bandIdx].maximumFreq, step);
+  drawSprite();
+  lastScanDraw = millis();
+}
+
+/**
+ * Goes back to the frequency before the scan, after a complete or a stopped scan
+ */
+void endScan()
+{
+  scan.stop();
+  rx.setFrequency(currentFrequency);
+  rx.setAudioMute(muted);
+  if (scan.isComplete())
+  {
+    bandScanTime[bandIdx] = scan.getScanTime();
+    Serial.printf("Scan %s: %u channels in %u ms (%u us/ch), %u looked at longer, %u stations\n", band[bandIdx].bandName,
+                  scan.getChannels(), scan.getScanTime(), scan.getScanTime() * 1000 / scan.getChannels(), scan.getCandidates(),
+                  scan.getStations());
+    Serial.print("Scan time per band:");
+    for (int i = 0; i <= lastBand; i++)
+      if (bandScanTime[i])
+        Serial.printf(" %s %u ms", band[i].bandName, bandScanTime[i]);
+    Serial.println();
+  }
+  drawSprite();
+}
+
 /**
  * Sets the Soft Mute Parameter
  */
@@ -1072,6 +1132,9 @@ void doCurrentMenuCmd() {
       else rx.setAudioMute(muted);
       drawSprite();  
       break;
+    case SCAN:
+      startScan();
+      break;
     default:
       showStatus();
       break;
@@ -1208,6 +1271,84 @@ void drawMenu() {
   }
 }
 
+/**
+ * Tuning scale around the current frequency
+ */
+void drawScale()
+{
+  spr.fillTriangle(156,112,160,122,164,112,TFT_RED);
+  spr.drawLine(160,114,160,170,TFT_RED);
+
+  int temp=(currentFrequency/10.00)-20;
+  uint16_t lineColor;
+  for(int i=0;i<40;i++)
+  {
+    if (i==20) lineColor=TFT_RED;
+    else lineColor=0xC638;
+    if (!(temp<band[bandIdx].minimumFreq/10.00 or temp>band[bandIdx].maximumFreq/10.00)) {
+      if((temp%10)==0){
+        spr.drawLine(i*8,170,i*8,140,lineColor);
+        spr.drawLine((i*8)+1,170,(i*8)+1,140,lineColor);
+        if (currentMode == FM) spr.drawFloat(temp/10.0,1,i*8,130,2);
+        else if (temp >= 100) spr.drawFloat(temp/100.0,3,i*8,130,2);
+               else spr.drawNumber(temp*10,i*8,130,2);
+      } else if((temp%5)==0 && (temp%10)!=0) {
+        spr.drawLine(i*8,170,i*8,150,lineColor);
+        spr.drawLine((i*8)+1,170,(i*8)+1,150,lineColor);
+        // spr.drawFloat(temp/10.0,1,i*8,144);        
+      } else {
+        spr.drawLine(i*8,170,i*8,160,lineColor);
+      }
+    }
+  
+   temp=temp+1;
+  }
+}
+
+/**
+ * Occupancy map of the last scan of the band over the tuning scale area, one column per 320th of the band.
+ * Green: valid station, grey: signal only.
+ */
+void drawSpectrum()
+{
+  uint16_t channels = scan.getChannels();
+  for (int x = 0; x < 320; x++) {
+    uint16_t first = (uint32_t)x * channels / 320;
+    uint16_t last = max((uint32_t)(x + 1) * channels / 320, (uint32_t)first + 1);
+    uint8_t rssi = 0;
+    bool scanned = false, valid = false;
+    for (uint16_t i = first; i < last && i < channels; i++) {
+      ScanChannel ch = scan.getChannel(i);
+      if (!ch.refined.scanned) continue;
+      scanned = true;
+      rssi = max(rssi, (uint8_t)ch.refined.rssi);
+      valid |= ch.refined.valid;
+    }
+    if (!scanned) continue;
+    int h = min(2 + rssi * 38 / 64, 40);
+    spr.drawFastVLine(x, 170 - h, h, valid ? 0x3526 : 0xC638);
+  }
+
+  // scan position, then the frequency to go back to
+  int x;
+  if (scan.isRunning()) x = (uint32_t)scan.getPosition() * 320 / channels;
+  else x = (uint32_t)(currentFrequency - scan.getMinimumFrequency()) * 320 / (scan.getMaximumFrequency() - scan.getMinimumFrequency() + 1);
+  spr.drawLine(x,128,x,170,TFT_RED);
+
+  spr.setTextDatum(ML_DATUM);
+  if (currentMode == FM) spr.drawFloat(scan.getMinimumFrequency()/100.0,1,2,120,2);
+  else spr.drawNumber(scan.getMinimumFrequency(),2,120,2);
+  spr.setTextDatum(MR_DATUM);
+  if (currentMode == FM) spr.drawFloat(scan.getMaximumFrequency()/100.0,1,318,120,2);
+  else spr.drawNumber(scan.getMaximumFrequency(),318,120,2);
+  spr.setTextDatum(MC_DATUM);
+  char text[32];
+  if (scan.isRunning()) sprintf(text, "Scanning %u%%", (uint32_t)scan.getPosition() * 100 / channels);
+  else if (scan.isComplete()) sprintf(text, "%u ch %u.%u s, %u st", channels, scan.getScanTime() / 1000, scan.getScanTime() / 100 % 10, scan.getStations());
+  else strcpy(text, "Scan stopped");
+  spr.drawString(text,160,120,2);
+}
+
 void drawSprite()
 {
   
@@ -1294,33 +1435,8 @@ void drawSprite()
       spr.fillRect(244+(i*4),80-(i*1),2,4+(i*1),TFT_RED);
   
   
-  spr.fillTriangle(156,112,160,122,164,112,TFT_RED);
-  spr.drawLine(160,114,160,170,TFT_RED);
-
-  int temp=(currentFrequency/10.00)-20;
-  uint16_t lineColor;
-  for(int i=0;i<40;i++)
-  {
-    if (i==20) lineColor=TFT_RED;
-    else lineColor=0xC638;
-    if (!(temp<band[bandIdx].minimumFreq/10.00 or temp>band[bandIdx].maximumFreq/10.00)) {
-      if((temp%10)==0){
-        spr.drawLine(i*8,170,i*8,140,lineColor);
-        spr.drawLine((i*8)+1,170,(i*8)+1,140,lineColor);
-        if (currentMode == FM) spr.drawFloat(temp/10.0,1,i*8,130,2);
-        else if (temp >= 100) spr.drawFloat(temp/100.0,3,i*8,130,2);
-               else spr.drawNumber(temp*10,i*8,130,2);
-      } else if((temp%5)==0 && (temp%10)!=0) {
-        spr.drawLine(i*8,170,i*8,150,lineColor);
-        spr.drawLine((i*8)+1,170,(i*8)+1,150,lineColor);
-        // spr.drawFloat(temp/10.0,1,i*8,144);        
-      } else {
-        spr.drawLine(i*8,170,i*8,160,lineColor);
-      }
-    }
-  
-   temp=temp+1;
-  }
+  if (scanView) drawSpectrum();
+  else drawScale();
 
   if (currentMode == FM) {
     spr.fillSmoothRoundRect(240,20,76,22,4,TFT_WHITE);
@@ -1352,42 +1468,64 @@ void cleanBfoRdsInfo()
 
 void showRDSMsg()
 {
-  rdsMsg[35] = bufferRdsMsg[35] = '\0';
-  if (strcmp(bufferRdsMsg, rdsMsg) == 0)
+  char title[65], artist[65];
+
+  if (strcmp(bufferRdsMsg, rds.getRT()) == 0)
     return;
+  strcpy(bufferRdsMsg, rds.getRT());
+  Serial.printf("RDS text: %s\n", bufferRdsMsg);
+  if (rds.getRtPlusText(RDS_RTPLUS_TITLE, title, sizeof(title)) && rds.getRtPlusText(RDS_RTPLUS_ARTIST, artist, sizeof(artist)))
+    Serial.printf("RDS now playing: %s - %s\n", artist, title);
 }
 
 void showRDSStation()
 {
-  if (strcmp(bufferStationName, stationName) == 0 ) return;
+  if (strcmp(bufferStationName, rds.getPS()) == 0 ) return;
   cleanBfoRdsInfo();
-  strcpy(bufferStationName, stationName);
+  strcpy(bufferStationName, rds.getPS());
   drawSprite();
 }
 
 void showRDSTime()
 {
+  uint16_t year;
+  uint8_t month, day, hour, minute;
+  int8_t offset;
 
-  if (strcmp(bufferRdsTime, rdsTime) == 0)
+  if (!rds.getTime(&year, &month, &day, &hour, &minute, &offset))
     return;
+  sprintf(bufferRdsTime, "%04u-%02u-%02u %02u:%02u UTC%c%u:%02u", year, month, day, hour, minute, offset < 0 ? '-' : '+',
+          abs(offset) / 2, (abs(offset) & 1) * 30);
+  Serial.printf("RDS time: %s\n", bufferRdsTime);
 }
 
+// Every group waiting in the RDS FIFO goes through the decoder, the display only follows what changed
 void checkRDS()
 {
-  rx.getRdsStatus();
-  if (rx.getRdsReceived())
-  {
-    if (rx.getRdsSync() && rx.getRdsSyncFound())
-    {
-      rdsMsg = rx.getRdsText2A();
-      stationName = rx.getRdsText0A();
-      rdsTime = rx.getRdsTime();
-      // if ( rdsMsg != NULL )   showRDSMsg();
-      if (stationName != NULL)         
-          showRDSStation();
-      // if ( rdsTime != NULL ) showRDSTime();
-    }
-  }
+  if (rx.getRdsGroups(rds) == 0)
+    return;
+  uint8_t changes = rds.getChanges();
+  if (changes & RDS_CHANGED_PS)
+    showRDSStation();
+  if ((changes & (RDS_CHANGED_RT | RDS_CHANGED_RTPLUS)) && rds.isRTComplete())
+    showRDSMsg();
+  if (changes & RDS_CHANGED_CT)
+    showRDSTime();
+}
+
+void reportRDS()
+{
+  const rds_stat *s = rds.getStat();
+  uint32_t groups = s->groups - lastRdsStat.groups;
+  uint32_t period = millis() - lastRDSReport;
+
+  if (groups == 0 && s->dropped == lastRdsStat.dropped)
+    return;
+  Serial.printf("RDS %u.%u groups/s, dropped %u, lost %u, blocks ok %u corrected %u/%u bad %u\n",
+                groups * 1000 / period, (groups * 10000 / period) % 10, s->dropped - lastRdsStat.dropped, s->lost - lastRdsStat.lost,
+                s->blocks[0] - lastRdsStat.blocks[0], s->blocks[1] - lastRdsStat.blocks[1], s->blocks[2] - lastRdsStat.blocks[2],
+                s->blocks[3] - lastRdsStat.blocks[3]);
+  lastRdsStat = *s;
 }
 
 /***************************************************************************************
@@ -1467,9 +1605,32 @@ void loop()
 
   batteryMonitor(false);  // Battery check
 
+  if (scan.isRunning())
+  {
+    // any encoder move or click stops the scan
+    if (encoderCount != 0 || digitalRead(ENCODER_PUSH_BUTTON) == LOW)
+    {
+      endScan();
+      encoderCount = 0;
+      while (digitalRead(ENCODER_PUSH_BUTTON) == LOW)
+        delay(MIN_ELAPSED_TIME);
+      elapsedCommand = millis();
+    }
+    else if (scan.service() && !scan.isRunning())
+      endScan();
+    else if ((millis() - lastScanDraw) > SCAN_DRAW_TIME)
+    {
+      drawSprite();
+      lastScanDraw = millis();
+    }
+    delay(1);
+    return;
+  }
+
   // Check if the encoder has moved.
   if (encoderCount != 0)
   {
+    scanView = false;
     if (bfoOn & (currentMode == LSB || currentMode == USB))
     {
       currentBFO = (encoderCount == 1) ? (currentBFO + currentBFOStep) : (currentBFO - currentBFOStep);
@@ -1516,6 +1677,7 @@ void loop()
   {
     if (digitalRead(ENCODER_PUSH_BUTTON) == LOW)
     {
+       scanView = false;
        uint32_t timestamp = millis() + 3000;
         while (digitalRead(ENCODER_PUSH_BUTTON) == LOW ) { 
           if( millis() > timestamp){
@@ -1611,6 +1773,11 @@ void loop()
     lastRDSCheck = millis();
   }  
 
+  if ((millis() - lastRDSReport) > RDS_REPORT_TIME) {
+    if (currentMode == FM) reportRDS();
+    lastRDSReport = millis();
+  }
+
   // Show the current frequency only if it has changed
   if (itIsTimeToSave)
   {
@@ -0,0 +1,238 @@
+/*
+ * Decoder benchmark and conformance check for the MP3 / AAC / FLAC decoders of ESP32-audioI2S.
+ *
+ * Every *.mp3, *.aac (ADTS) and *.flac file in BENCH_DIR on the SD card is loaded into PSRAM and
+ * decoded without I2S output, so only decoder time is measured. For each file the sketch prints
+ * frames/s, realtime factor, decoder heap usage and the CRC32 of the produced PCM.
+ * If "<file>.crc" exists next to the audio file (8 hex digits), the CRC is checked against it,
+ * otherwise the computed value is printed so it can be saved as the reference.
+ *
+ * lib/ESP32-audioI2S/extras/DecoderBench builds the same loop on a Linux host, with a profile.
+ * The decoders are fixed point, both builds give the same CRCs.
+ */
+#include "Arduino.h"
+#include "FS.h"
+#include "SD_MMC.h"
+#include "pin_config.h"
+
+#include "mp3_decoder/mp3_decoder.h"
+#include "aac_decoder/aac_decoder.h"
+#include "flac_decoder/flac_decoder.h"
+
+#define BENCH_DIR "/bench"
+// Input handed to one decode call, at most what Audio buffers for a frame (m_frameSizeFLAC): the
+// FLAC decoder counts the bytes left in an int16_t
+#define BENCH_WINDOW (16 * 1024)
+
+enum bench_codec_t { BENCH_MP3, BENCH_AAC, BENCH_FLAC };
+
+typedef struct {
+  uint32_t frames;
+  uint32_t samples;       // PCM samples (all channels)
+  uint32_t errors;
+  uint32_t decode_us;
+  uint32_t sample_rate;
+  uint8_t channels;
+  uint32_t heap_used;     // bytes taken by the decoder buffers
+  uint32_t crc;
+} bench_result_t;
+
+static short pcm[2 * 8192]; // large enough for one FLAC block (MAX_BLOCKSIZE, stereo)
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *data++;
+    for (int k = 0; k < 8; k++)
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+// Skip the "fLaC" marker and metadata blocks, hand STREAMINFO to the decoder.
+static int flac_parse_header(uint8_t *data, size_t len) {
+  if (len < 42 || memcmp(data, "fLaC", 4) != 0) return -1;
+  size_t pos = 4;
+  bool last = false;
+  while (!last && pos + 4 <= len) {
+    last = data[pos] & 0x80;
+    uint8_t type = data[pos] & 0x7F;
+    uint32_t size = (data[pos + 1] << 16) | (data[pos + 2] << 8) | data[pos + 3];
+    uint8_t *b = &data[pos + 4];
+    if (type == 0 && size >= 18) { // STREAMINFO
+      uint32_t sampleRate = (b[10] << 12) | (b[11] << 4) | (b[12] >> 4);
+      uint8_t channels = ((b[12] >> 1) & 0x07) + 1;
+      uint8_t bps = (((b[12] & 0x01) << 4) | (b[13] >> 4)) + 1;
+      uint32_t totalSamples = (b[14] << 24) | (b[15] << 16) | (b[16] << 8) | b[17];
+      FLACSetRawBlockParams(channels, sampleRate, bps, totalSamples, len);
+    }
+    pos += 4 + size;
+  }
+  return pos <= len ? pos : -1;
+}
+
+static bool bench_run(bench_codec_t codec, uint8_t *data, size_t len, bench_result_t *r) {
+  memset(r, 0, sizeof(*r));
+
+  uint32_t heap_before = ESP.getFreeHeap();
+  bool ok = false;
+  if (codec == BENCH_MP3) ok = MP3Decoder_AllocateBuffers();
+  if (codec == BENCH_AAC) ok = AACDecoder_AllocateBuffers();
+  if (codec == BENCH_FLAC) ok = FLACDecoder_AllocateBuffers();
+  if (!ok) return false;
+  r->heap_used = heap_before - ESP.getFreeHeap();
+
+  size_t pos = 0;
+  if (codec == BENCH_FLAC) {
+    FLACDecoderReset();
+    int start = flac_parse_header(data, len);
+    if (start < 0) {
+      FLACDecoder_FreeBuffers();
+      return false;
+    }
+    pos = start;
+  }
+
+  bool synced = false;
+  while (pos < len) {
+    int avail = len - pos < BENCH_WINDOW ? len - pos : BENCH_WINDOW;
+    if (!synced) {
+      int next = -1;
+      if (codec == BENCH_MP3) next = MP3FindSyncWord(data + pos, avail);
+      if (codec == BENCH_AAC) next = AACFindSyncWord(data + pos, avail);
+      if (codec == BENCH_FLAC) next = FLACFindSyncWord(data + pos, avail);
+      if (next < 0) break;
+      pos += next;
+      avail -= next;
+      synced = true;
+    }
+
+    int bytesLeft = avail;
+    int ret = 0;
+    uint32_t t = micros();
+    if (codec == BENCH_MP3) ret = MP3Decode(data + pos, &bytesLeft, pcm, 0);
+    if (codec == BENCH_AAC) ret = AACDecode(data + pos, &bytesLeft, pcm);
+    if (codec == BENCH_FLAC) ret = FLACDecode(data + pos, &bytesLeft, pcm);
+    r->decode_us += micros() - t;
+
+    int used = avail - bytesLeft;
+    if (ret < 0) {
+      // MP3 needs a few frames of main data before the first output, that is not an error
+      if (!(codec == BENCH_MP3 && ret == ERR_MP3_MAINDATA_UNDERFLOW)) {
+        r->errors++;
+        synced = false;
+      }
+      pos += used ? used : 1;
+      continue;
+    }
+    pos += used;
+
+    int samples = 0;
+    if (codec == BENCH_MP3) samples = MP3GetOutputSamps();
+    if (codec == BENCH_AAC) samples = AACGetOutputSamps();
+    if (codec == BENCH_FLAC) samples = FLACGetOutputSamps();
+    // FLAC returns after the frame header, then once per part of the output, the last part ends a frame
+    if (codec != BENCH_FLAC || (ret == ERR_FLAC_NONE && samples > 0)) r->frames++;
+    if (samples > 0) {
+      r->samples += samples;
+      r->crc = crc32_update(r->crc, (const uint8_t *)pcm, samples * sizeof(short));
+    }
+    if (!used && !samples) pos++; // never stall on a frame that produces nothing
+  }
+
+  if (codec == BENCH_MP3) {
+    r->sample_rate = MP3GetSampRate();
+    r->channels = MP3GetChannels();
+    MP3Decoder_FreeBuffers();
+  }
+  if (codec == BENCH_AAC) {
+    r->sample_rate = AACGetSampRate();
+    r->channels = AACGetChannels();
+    AACDecoder_FreeBuffers();
+  }
+  if (codec == BENCH_FLAC) {
+    r->sample_rate = FLACGetSampRate();
+    r->channels = FLACGetChannels();
+    FLACDecoder_FreeBuffers();
+  }
+  return true;
+}
+
+static bool read_reference(const char *path, uint32_t *crc) {
+  String crc_path = String(path) + ".crc";
+  File f = SD_MMC.open(crc_path.c_str());
+  if (!f) return false;
+  String s = f.readStringUntil('\n');
+  f.close();
+  *crc = strtoul(s.c_str(), NULL, 16);
+  return true;
+}
+
+static void bench_file(File &file) {
+  const char *name = file.name();
+  bench_codec_t codec;
+  if (strstr(name, ".mp3")) codec = BENCH_MP3;
+  else if (strstr(name, ".aac")) codec = BENCH_AAC;
+  else if (strstr(name, ".flac")) codec = BENCH_FLAC;
+  else return;
+
+  size_t len = file.size();
+  uint8_t *data = (uint8_t *)ps_malloc(len);
+  if (!data) {
+    Serial.printf("%-24s skipped, %u bytes do not fit in PSRAM\n", name, len);
+    return;
+  }
+  file.read(data, len);
+
+  bench_result_t r;
+  if (!bench_run(codec, data, len, &r)) {
+    Serial.printf("%-24s decoder init failed\n", name);
+    free(data);
+    return;
+  }
+  free(data);
+
+  float seconds = r.decode_us / 1e6f;
+  float audio_seconds = (r.channels && r.sample_rate) ? (float)r.samples / r.channels / r.sample_rate : 0;
+  uint32_t ref;
+  const char *check = "NEW";
+  if (read_reference(file.path(), &ref)) check = (ref == r.crc) ? "OK" : "MISMATCH";
+
+  Serial.printf("%-24s %6u %8.1f %7.1fx %6u %3u %7u  %08X %s\n",
+                name, r.frames, seconds > 0 ? r.frames / seconds : 0,
+                seconds > 0 ? audio_seconds / seconds : 0,
+                r.heap_used / 1024, r.errors, r.decode_us / 1000, r.crc, check);
+}
+
+void setup() {
+  pinMode(PIN_POWER_ON, OUTPUT);
+  digitalWrite(PIN_POWER_ON, HIGH);
+  Serial.begin(115200);
+  delay(2000);
+
+  pinMode(PIN_SD_CS, OUTPUT);
+  digitalWrite(PIN_SD_CS, 1);
+  SD_MMC.setPins(PIN_SD_SCK, PIN_SD_MOSI, PIN_SD_MISO);
+  if (!SD_MMC.begin("/sdcard", true)) {
+    Serial.println("Card Mount Failed");
+    return;
+  }
+
+  File root = SD_MMC.open(BENCH_DIR);
+  if (!root || !root.isDirectory()) {
+    Serial.println("Put the test files into " BENCH_DIR " on the SD card");
+    return;
+  }
+
+  Serial.println("file                     frames  frame/s realtime heapKB err  dec(ms)  crc32");
+  File file = root.openNextFile();
+  while (file) {
+    if (!file.isDirectory()) bench_file(file);
+    file = root.openNextFile();
+  }
+  Serial.printf("min free heap during run: %u bytes\n", ESP.getMinFreeHeap());
+}
+
+void loop() {
+  delay(1000);
+}
@@ -25,7 +25,7 @@ void ADCSampler::processI2SData(uint8_t *i2sData, size_t bytesRead)
     uint16_t *rawSamples = (uint16_t *)i2sData;
     for (int i = 0; i < bytesRead / 2; i++)
     {
-        // addSample((2048 - (rawSamples[i] & 0xfff)) * 15);
-       addSample(rawSamples[i] & 0xfff);
+        // rawSamples[i] = (2048 - (rawSamples[i] & 0xfff)) * 15;
+        rawSamples[i] &= 0xfff;
     }
 }
@@ -0,0 +1,116 @@
+#ifndef __block_ring_buffer_h__
+#define __block_ring_buffer_h__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+
+/**
+ * Lock-free single-producer / single-consumer ring of fixed size blocks, e.g.
+ * I2S sample blocks (I2SSampler) or received radio packets (radio_pipe).
+ *
+ * The producer asks for the next free block, fills it in place (for example
+ * straight from i2s_read or the radio FIFO) and commits it. The consumer borrows the oldest
+ * committed block by pointer and releases it when done, so no data is copied
+ * by the ring itself. When the ring is full the producer keeps reusing the
+ * same free block and the lost block is counted as an overrun.
+ **/
+class BlockRingBuffer
+{
+private:
+    uint8_t *m_data = nullptr;
+    size_t m_blockSize = 0;
+    // number of blocks, power of two
+    uint32_t m_blockCount = 0;
+    // free running counters, only written by producer / consumer respectively
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+    std::atomic<uint32_t> m_committed{0};
+    std::atomic<uint32_t> m_overruns{0};
+
+public:
+    ~BlockRingBuffer()
+    {
+        free(m_data);
+    }
+
+    bool begin(size_t blockSize, uint32_t blockCount)
+    {
+        if (blockCount < 2 || (blockCount & (blockCount - 1)) != 0)
+        {
+            return false;
+        }
+        free(m_data);
+        m_data = (uint8_t *)malloc(blockSize * blockCount);
+        if (m_data == nullptr)
+        {
+            return false;
+        }
+        m_blockSize = blockSize;
+        m_blockCount = blockCount;
+        m_head = 0;
+        m_tail = 0;
+        m_committed = 0;
+        m_overruns = 0;
+        return true;
+    }
+
+    size_t getBlockSize()
+    {
+        return m_blockSize;
+    }
+
+    /* producer side */
+    uint8_t *writeBlock()
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        return &m_data[(head & (m_blockCount - 1)) * m_blockSize];
+    }
+    // returns false and counts an overrun if the consumer has not caught up,
+    // the same block is then handed out again by writeBlock()
+    bool commitWrite()
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        // keep one block free so writeBlock() never aliases a borrowed block
+        if (head - tail >= m_blockCount - 1)
+        {
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_head.store(head + 1, std::memory_order_release);
+        m_committed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /* consumer side */
+    const uint8_t *readBlock()
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &m_data[(tail & (m_blockCount - 1)) * m_blockSize];
+    }
+    void releaseRead()
+    {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    uint32_t available()
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+    }
+
+    /* statistics */
+    uint32_t getCommittedBlocks()
+    {
+        return m_committed.load(std::memory_order_relaxed);
+    }
+    uint32_t getOverruns()
+    {
+        return m_overruns.load(std::memory_order_relaxed);
+    }
+};
+
+#endif
@@ -1,69 +1,42 @@
-
 #include <Arduino.h>
 #include "I2SSampler.h"
 #include "driver/i2s.h"
 
-void I2SSampler::addSample(int16_t sample)
-{
-    // add the sample to the current audio buffer
-    m_currentAudioBuffer[m_audioBufferPos] = sample;
-    m_audioBufferPos++;
-    // have we filled the buffer with data?
-    if (m_audioBufferPos == m_bufferSizeInSamples)
-    {
-        // swap to the other buffer
-        std::swap(m_currentAudioBuffer, m_capturedAudioBuffer);
-        // reset the buffer position
-        m_audioBufferPos = 0;
-        // tell the writer task to save the data
-        xTaskNotify(m_writerTaskHandle, 1, eIncrement);
-    }
-}
-
 void i2sReaderTask(void *param)
 {
     I2SSampler *sampler = (I2SSampler *)param;
     while (true)
     {
-        // wait for some data to arrive on the queue
-        i2s_event_t evt;
-        if (xQueueReceive(sampler->m_i2sQueue, &evt, portMAX_DELAY) == pdPASS)
+        // read straight into the next free block of the ring
+        uint8_t *block = sampler->m_ring.writeBlock();
+        size_t bytesRead = 0;
+        i2s_read(sampler->getI2SPort(), block, sampler->m_bufferSizeInBytes, &bytesRead, portMAX_DELAY);
+        if (bytesRead != (size_t)sampler->m_bufferSizeInBytes)
+        {
+            continue;
+        }
+        // process the raw data in place, once per block
+        sampler->processI2SData(block, bytesRead);
+        // hand it over and tell the writer task there is data to consume
+        if (sampler->m_ring.commitWrite())
         {
-            if (evt.type == I2S_EVENT_RX_DONE)
-            {
-                size_t bytesRead = 0;
-                do
-                {
-                    // read data from the I2S peripheral
-                    uint8_t i2sData[1024];
-                    // read from i2s
-                    i2s_read(sampler->getI2SPort(), i2sData, 1024, &bytesRead, portMAX_DELAY);
-                    // process the raw data
-                    sampler->processI2SData(i2sData, bytesRead);
-                } while (bytesRead > 0);
-            }
+            xTaskNotify(sampler->m_writerTaskHandle, 1, eIncrement);
         }
     }
 }
 
-void I2SSampler::start(i2s_port_t i2sPort, i2s_config_t &i2sConfig, int32_t bufferSizeInBytes, TaskHandle_t writerTaskHandle)
+void I2SSampler::start(i2s_port_t i2sPort, i2s_config_t &i2sConfig, int32_t bufferSizeInBytes, TaskHandle_t writerTaskHandle, uint32_t blockCount)
 {
     m_i2sPort = i2sPort;
     m_writerTaskHandle = writerTaskHandle;
     m_bufferSizeInSamples = bufferSizeInBytes / sizeof(int16_t);
     m_bufferSizeInBytes = bufferSizeInBytes;
-    m_audioBuffer1 = (int16_t *)malloc(bufferSizeInBytes);
-    m_audioBuffer2 = (int16_t *)malloc(bufferSizeInBytes);
+    m_ring.begin(bufferSizeInBytes, blockCount);
 
-    m_currentAudioBuffer = m_audioBuffer1;
-    m_capturedAudioBuffer = m_audioBuffer2;
-
-    m_writerTaskHandle = writerTaskHandle;
     //install and start i2s driver
-    i2s_driver_install(m_i2sPort, &i2sConfig, 4, &m_i2sQueue);
+    i2s_driver_install(m_i2sPort, &i2sConfig, 0, NULL);
     // set up the I2S configuration from the subclass
     // configureI2S();
     // start a task to read samples from the ADC
-    TaskHandle_t readerTaskHandle;
-    xTaskCreatePinnedToCore(i2sReaderTask, "i2s Reader Task", 4096, this, 1, &readerTaskHandle, 0);
+    xTaskCreatePinnedToCore(i2sReaderTask, "i2s Reader Task", 4096, this, 1, &m_readerTaskHandle, 0);
 }
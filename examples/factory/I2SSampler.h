@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "driver/i2s.h"
+#include "BlockRingBuffer.h"
 
 /**
  * Base Class for both the ADC and I2S sampler
@@ -10,31 +11,22 @@
 class I2SSampler
 {
 private:
-    // double buffer so we can be capturing samples while sending data
-    int16_t *m_audioBuffer1;
-    int16_t *m_audioBuffer2;
-    // current position in the audio buffer
-    int32_t m_audioBufferPos = 0;
-    // current audio buffer
-    int16_t *m_currentAudioBuffer;
-    // buffer containing samples that have been captured already
-    int16_t *m_capturedAudioBuffer;
-    // size of the audio buffers in bytes
+    // ring of captured blocks, filled directly by i2s_read
+    BlockRingBuffer m_ring;
+    // size of the audio blocks in bytes
     int32_t m_bufferSizeInBytes;
-    // size of the audio buffer in samples
+    // size of the audio blocks in samples
     int32_t m_bufferSizeInSamples;
     // I2S reader task
     TaskHandle_t m_readerTaskHandle;
     // writer task
     TaskHandle_t m_writerTaskHandle;
-    // i2s reader queue
-    QueueHandle_t m_i2sQueue;
     // i2s port
     i2s_port_t m_i2sPort;
 
 protected:
-    void addSample(int16_t sample);
     virtual void configureI2S() = 0;
+    // convert one raw block into samples in place
     virtual void processI2SData(uint8_t *i2sData, size_t bytesRead) = 0;
     i2s_port_t getI2SPort()
     {
@@ -46,13 +38,32 @@ public:
     {
         return m_bufferSizeInBytes;
     };
-    int16_t *getCapturedAudioBuffer()
+    int32_t getBufferSizeInSamples()
     {
-        return m_capturedAudioBuffer;
+        return m_bufferSizeInSamples;
+    };
+    // borrow the oldest captured block, nullptr if none is pending
+    const int16_t *getCapturedAudioBuffer()
+    {
+        return (const int16_t *)m_ring.readBlock();
+    }
+    // give the borrowed block back to the reader
+    void releaseCapturedAudioBuffer()
+    {
+        m_ring.releaseRead();
+    }
+    uint32_t getCapturedBlocks()
+    {
+        return m_ring.getCommittedBlocks();
+    }
+    // blocks dropped because the consumer did not keep up
+    uint32_t getOverruns()
+    {
+        return m_ring.getOverruns();
     }
-    void start(i2s_port_t i2sPort, i2s_config_t &i2sConfig, int32_t bufferSizeInSamples, TaskHandle_t writerTaskHandle);
+    void start(i2s_port_t i2sPort, i2s_config_t &i2sConfig, int32_t bufferSizeInBytes, TaskHandle_t writerTaskHandle, uint32_t blockCount = 4);
 
     friend void i2sReaderTask(void *param);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,50 +1,84 @@
 #include "MyFFT.h"
-#include "arduinoFFT.h"
 #include "ADCSampler.h"
+#include "RealFFT.h"
 
-double     vReal[ADC_SAMPLE_COUNT]; // 实部
-double     vImag[ADC_SAMPLE_COUNT]; // 虚部
+#if FFT_USE_Q15
+int16_t    g_fftData[FFT_MAX_SAMPLE_COUNT];      // 加窗后的一帧, 原地变换为频谱
+int16_t    g_fftWindow[FFT_MAX_SAMPLE_COUNT];    // 窗函数 Q15
+#else
+float      g_fftData[FFT_MAX_SAMPLE_COUNT];      // 加窗后的一帧, 原地变换为频谱
+float      g_fftWindow[FFT_MAX_SAMPLE_COUNT];    // 窗函数
+#endif
+uint16_t   g_fftAmplitude[FFT_MAX_SAMPLE_COUNT]; // 幅值
+int16_t    g_fftHistory[FFT_MAX_SAMPLE_COUNT];   // 最近 N 个采样, 环形
 
-arduinoFFT FFT = arduinoFFT(vReal, vImag, ADC_SAMPLE_COUNT, ADC_SAMPLE_RATE);
+RealFFT    g_realFFT;
 ADCSampler g_adcSampler(ADC_UNIT_1, ADC_CHANNEL_NUM);
 
-bool       g_fftDataIsOk = false;
+volatile bool g_fftDataIsOk = false;
 bool       g_fftIsInstalled = false;
+SemaphoreHandle_t g_fftFrameSem = NULL;
 
-uint16_t   _FFT_GetAmplitude(int i)
+// 当前帧配置, 只在写任务中修改
+static uint16_t     s_fftSize = 0;
+static uint16_t     s_fftHop = 0;
+static float        s_fftWindowGain = 1.0f; // 窗函数相干增益补偿
+static uint16_t     s_histPos = 0;          // 下一个写入位置, 也是最早的采样
+static uint16_t     s_histFill = 0;
+static uint16_t     s_hopCount = 0;
+
+// 其他任务请求的新配置
+static portMUX_TYPE s_fftConfigMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_fftConfigPending = false;
+static uint16_t     s_newFftSize = ADC_SAMPLE_COUNT;
+static uint16_t     s_newFftHop = ADC_SAMPLE_COUNT / 2;
+static fft_window_t s_newFftWindow = FFT_WINDOW_HANN;
+
+static volatile uint32_t s_fftFrames = 0;
+static volatile uint32_t s_fftDroppedFrames = 0;
+
+void FFT_Calc()
 {
-    if (i == 0)
+    const uint16_t size = s_fftSize;
+
+    // 计算FFT, 实数输入只需要 N/2 点复数FFT
+#if FFT_USE_Q15
+    g_realFFT.forwardQ15(g_fftData);
+    g_realFFT.amplitudeQ15(g_fftData, g_fftAmplitude);
+    for (int i = 0; i < size / 2; i++)
     {
-        return (
-            uint16_t)((sqrt(sq(vReal[0]) + sq(vImag[0])) / ADC_SAMPLE_COUNT));
+        g_fftAmplitude[i] = (uint16_t)(g_fftAmplitude[i] * s_fftWindowGain);
     }
-    else
+#else
+    g_realFFT.forward(g_fftData);
+    g_realFFT.amplitude(g_fftData, g_fftData);
+    for (int i = 0; i < size / 2; i++)
     {
-        return (uint16_t)(sqrt(sq(vReal[i]) + sq(vImag[i])) * 2 /
-                          ADC_SAMPLE_COUNT);
+        g_fftAmplitude[i] = (uint16_t)(g_fftData[i] * s_fftWindowGain);
     }
-}
-
-void FFT_Calc()
-{
-    // 计算FFT
-    FFT.Windowing(FFT_WIN_TYP_RECTANGLE, FFT_FORWARD);
-    FFT.Compute(FFT_FORWARD);
+#endif
 
     // 因为具有对称性,只计算一半
-    vReal[0] = _FFT_GetAmplitude(0);
-    for (int i = 1; i < ADC_SAMPLE_COUNT / 2; i++)
+    for (int i = 1; i < size / 2; i++)
     {
-        vReal[i] = vReal[ADC_SAMPLE_COUNT - i] = _FFT_GetAmplitude(i);
+        g_fftAmplitude[size - i] = g_fftAmplitude[i];
     }
+    g_fftAmplitude[size / 2] = 0;
 }
 
-uint16_t FFT_GetAmplitude(int i) { return vReal[i]; }
-
+uint16_t FFT_GetAmplitude(int i) { return i < s_fftSize ? g_fftAmplitude[i] : 0; }
 
 //将ADC_SAMPLE_COUNT和ADC_SAMPLE_RATE改成一样数值,好查看数据
 void     FFT_Test()
 {
+    RealFFT fft;
+    float  *data = (float *)malloc(ADC_SAMPLE_COUNT * sizeof(float));
+    if (data == NULL || !fft.begin(ADC_SAMPLE_COUNT))
+    {
+        free(data);
+        return;
+    }
+
     // 构造测试信号
     for (int i = 0; i < ADC_SAMPLE_COUNT; i++)
     {
@@ -52,34 +86,124 @@ void     FFT_Test()
         double f2 = fn(1024, 50, 0, i);   //50Hz,幅值1024,相位0度
         double f3 = fn(3096, 100, 30, i); //100Hz,幅值3096,相位30度
 
-        vReal[i] = f1 + f2 + f3;
-        vImag[i] = 0;
+        data[i] = f1 + f2 + f3;
     }
 
-    // 计算FFT
-    FFT.Windowing(FFT_WIN_TYP_RECTANGLE, FFT_FORWARD);
-    FFT.Compute(FFT_FORWARD);
-
-    // 计算幅值
-    vReal[0] = sqrt(sq(vReal[0]) + sq(vImag[0])) / ADC_SAMPLE_COUNT;
-    for (int i = 1; i < ADC_SAMPLE_COUNT / 2;
-         i++) //因为数据具有对称性,所以计算一般就可以了
-    {
-        vReal[i] = sqrt(sq(vReal[i]) + sq(vImag[i])) * 2 / ADC_SAMPLE_COUNT;
-    }
+    // 计算FFT和幅值
+    fft.forward(data);
+    fft.amplitude(data, data);
 
     int idx = 0;
-    for (int i = 0; i < (ADC_SAMPLE_COUNT) >> 4; i++)
+    for (int i = 0; i < (ADC_SAMPLE_COUNT / 2) >> 4; i++)
     {
         for (int j = 0; j < 1 << 4; j++)
         {
-            Serial.printf("(%dHz)%.0f  ", IDX_TO_FREQ(idx), vReal[idx]);
+            Serial.printf("(%dHz)%.0f  ", IDX_TO_FREQ(idx), data[idx]);
             idx++;
         }
         Serial.println("");
     }
     Serial.println("");
     Serial.println("");
+    free(data);
+}
+
+static void FFT_ApplyConfig(uint16_t size, uint16_t hop, fft_window_t window)
+{
+    g_realFFT.begin(size);
+
+    // 窗函数表只在配置改变时生成一次
+    float sum = 0;
+    for (int i = 0; i < size; i++)
+    {
+        float x = PI2 * i / size;
+        float w;
+        switch (window)
+        {
+        case FFT_WINDOW_HANN:
+            w = 0.5f - 0.5f * cosf(x);
+            break;
+        case FFT_WINDOW_HAMMING:
+            w = 0.54f - 0.46f * cosf(x);
+            break;
+        case FFT_WINDOW_BLACKMAN:
+            w = 0.42f - 0.5f * cosf(x) + 0.08f * cosf(2 * x);
+            break;
+        default:
+            w = 1.0f;
+            break;
+        }
+        sum += w;
+#if FFT_USE_Q15
+        g_fftWindow[i] = (int16_t)(w >= 1.0f ? 32767 : w * 32768);
+#else
+        g_fftWindow[i] = w;
+#endif
+    }
+    s_fftWindowGain = size / sum;
+
+    s_fftSize = size;
+    s_fftHop = hop;
+    s_histPos = 0;
+    s_histFill = 0;
+    s_hopCount = 0;
+}
+
+// 把最近 N 个采样加窗后复制到 g_fftData, 交给 FFT_Calc
+static void FFT_EmitFrame()
+{
+    const uint16_t mask = s_fftSize - 1;
+
+    s_fftFrames++;
+    if (g_fftDataIsOk)
+    {
+        // 上一帧还没被取走, 丢弃这一帧, 采样仍保留在历史中
+        s_fftDroppedFrames++;
+        return;
+    }
+    for (int i = 0; i < s_fftSize; i++)
+    {
+#if FFT_USE_Q15
+        g_fftData[i] = (int16_t)((g_fftHistory[(s_histPos + i) & mask] * g_fftWindow[i]) >> 15);
+#else
+        g_fftData[i] = g_fftHistory[(s_histPos + i) & mask] * g_fftWindow[i];
+#endif
+    }
+    g_fftDataIsOk = true; // 数据准备完毕
+    xSemaphoreGive(g_fftFrameSem);
+}
+
+static void FFT_PushSamples(const int16_t *pData, int count)
+{
+    const uint16_t mask = s_fftSize - 1;
+
+    while (count > 0)
+    {
+        // 一次处理到下一个 hop 边界
+        int chunk = s_fftHop - s_hopCount;
+        if (chunk > count)
+        {
+            chunk = count;
+        }
+        for (int i = 0; i < chunk; i++)
+        {
+            g_fftHistory[s_histPos] = pData[i] - 2048; //构造上下一半
+            s_histPos = (s_histPos + 1) & mask;
+        }
+        pData += chunk;
+        count -= chunk;
+        s_hopCount += chunk;
+        s_histFill = (s_histFill + chunk > s_fftSize) ? s_fftSize : s_histFill + chunk;
+
+        if (s_hopCount == s_fftHop)
+        {
+            s_hopCount = 0;
+            if (s_histFill == s_fftSize)
+            {
+                FFT_EmitFrame();
+            }
+        }
+    }
 }
 
 void FFT_adcWriterTask(void *param)
@@ -88,27 +212,70 @@ void FFT_adcWriterTask(void *param)
     const TickType_t xMaxBlockTime = pdMS_TO_TICKS(100);
     while (true)
     {
+        // 配置只在没有待处理帧时切换, 避免 FFT_Calc 使用到一半的表
+        if (s_fftConfigPending && g_fftDataIsOk == false)
+        {
+            taskENTER_CRITICAL(&s_fftConfigMux);
+            uint16_t     size = s_newFftSize;
+            uint16_t     hop = s_newFftHop;
+            fft_window_t window = s_newFftWindow;
+            s_fftConfigPending = false;
+            taskEXIT_CRITICAL(&s_fftConfigMux);
+            FFT_ApplyConfig(size, hop, window);
+        }
+
         // wait for some samples to save
         uint32_t ulNotificationValue = ulTaskNotifyTake(pdTRUE, xMaxBlockTime);
         if (ulNotificationValue > 0)
         {
-            if (g_fftDataIsOk == false)
+            // 每个采样都进入历史, 按 hop 产生重叠的帧
+            const int16_t *pData;
+            while ((pData = sampler->getCapturedAudioBuffer()) != NULL)
             {
-                int16_t *pData = sampler->getCapturedAudioBuffer();
-                //Serial.println(millis());
-                //Serial.println(*pData);
-
-                for (int i = 0; i < ADC_SAMPLE_COUNT; i++, pData++)
-                {
-                    vReal[i] = *pData - 2048; //构造上下一半
-                    vImag[i] = 0;
-                }
-                g_fftDataIsOk = true; // 数据准备完毕
+                FFT_PushSamples(pData, sampler->getBufferSizeInSamples());
+                sampler->releaseCapturedAudioBuffer();
             }
         }
     }
 }
 
+bool FFT_SetFrameConfig(uint16_t fftSize, uint16_t hopSize, fft_window_t window)
+{
+    if (fftSize < 4 || fftSize > FFT_MAX_SAMPLE_COUNT || (fftSize & (fftSize - 1)) != 0)
+    {
+        return false;
+    }
+    if (hopSize == 0 || hopSize > fftSize)
+    {
+        return false;
+    }
+    taskENTER_CRITICAL(&s_fftConfigMux);
+    s_newFftSize = fftSize;
+    s_newFftHop = hopSize;
+    s_newFftWindow = window;
+    s_fftConfigPending = true;
+    taskEXIT_CRITICAL(&s_fftConfigMux);
+    return true;
+}
+
+uint16_t FFT_GetSize() { return s_fftSize; }
+
+bool FFT_WaitData(TickType_t xTicksToWait)
+{
+    if (g_fftFrameSem == NULL)
+    {
+        return false;
+    }
+    xSemaphoreTake(g_fftFrameSem, xTicksToWait);
+    return g_fftDataIsOk;
+}
+
+uint32_t FFT_GetFrameCount() { return s_fftFrames; }
+
+uint32_t FFT_GetDroppedFrames() { return s_fftDroppedFrames; }
+
+uint32_t FFT_GetLostBlocks() { return g_adcSampler.getOverruns(); }
+
 void FFT_Install()
 {
     g_fftDataIsOk = false;
@@ -116,6 +283,8 @@ void FFT_Install()
     if (g_fftIsInstalled == true) return;
 
     g_fftIsInstalled = true;
+    g_fftFrameSem = xSemaphoreCreateBinary();
+    FFT_ApplyConfig(s_newFftSize, s_newFftHop, s_newFftWindow);
 
     i2s_config_t adcI2SConfig = {
         .mode =
@@ -142,8 +311,9 @@ void FFT_Install()
                             1);
     g_adcSampler.start(I2S_NUM_0,
                        adcI2SConfig,
-                       ADC_SAMPLE_COUNT * 2,
-                       adcWriterTaskHandle);
+                       FFT_BLOCK_SAMPLE_COUNT * 2,
+                       adcWriterTaskHandle,
+                       8);
 }
 
 bool FFT_GetDataFlag() { return g_fftDataIsOk; }
@@ -18,6 +18,9 @@
 #define ADC_SAMPLE_COUNT 	(512)			//N 采样个数 必须2的N次方
 #define ADC_SAMPLE_RATE 	(16*1000) 		//Fs 采样频率
 #define ADC_CHANNEL_NUM     ADC1_CHANNEL_6 //只能是ADC1
+#define FFT_USE_Q15         0              //1: 定点Q15, 0: float32
+#define FFT_MAX_SAMPLE_COUNT (2048)        //运行时可配置的最大FFT点数
+#define FFT_BLOCK_SAMPLE_COUNT (128)       //I2S每次读取的采样个数, 决定帧间隔的精度
 
 #define PI2 6.28318530717959
 #define _FREQ_TO_IDX(freq) ((freq)*ADC_SAMPLE_COUNT/ADC_SAMPLE_RATE)
@@ -25,7 +28,21 @@
 #define IDX_TO_FREQ(idx)  ((idx)*ADC_SAMPLE_RATE/ADC_SAMPLE_COUNT)
 #define fn(a,f,p,i) (a) * cos(PI2 * (f) * ((double)(i)/ADC_SAMPLE_RATE) + (p) * PI2 / 360) 
 
+typedef enum {
+    FFT_WINDOW_RECTANGLE,
+    FFT_WINDOW_HANN,
+    FFT_WINDOW_HAMMING,
+    FFT_WINDOW_BLACKMAN,
+} fft_window_t;
+
 void FFT_Install();
+// 流式STFT: 每 hopSize 个新采样输出一帧 fftSize 点的频谱, 默认 512 点 Hann 窗 50% 重叠
+bool FFT_SetFrameConfig(uint16_t fftSize, uint16_t hopSize, fft_window_t window);
+uint16_t FFT_GetSize();
+bool FFT_WaitData(TickType_t xTicksToWait);
+uint32_t FFT_GetFrameCount();
+uint32_t FFT_GetDroppedFrames();
+uint32_t FFT_GetLostBlocks();
 void FFT_Calc();
 uint16_t FFT_GetAmplitude(int i);
 bool FFT_GetDataFlag();
@@ -0,0 +1,246 @@
+#include <math.h>
+#include <stdlib.h>
+#include "RealFFT.h"
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+RealFFT::~RealFFT()
+{
+    end();
+}
+
+bool RealFFT::begin(uint16_t samples)
+{
+    end();
+    // must be a power of two so that the N/2 complex FFT is radix-2
+    if (samples < 4 || (samples & (samples - 1)) != 0)
+    {
+        return false;
+    }
+    uint16_t half = samples / 2;
+
+    m_cos = (float *)malloc(half * sizeof(float));
+    m_sin = (float *)malloc(half * sizeof(float));
+    m_cosQ15 = (int16_t *)malloc(half * sizeof(int16_t));
+    m_sinQ15 = (int16_t *)malloc(half * sizeof(int16_t));
+    m_bitReverse = (uint16_t *)malloc(half * sizeof(uint16_t));
+    if (!m_cos || !m_sin || !m_cosQ15 || !m_sinQ15 || !m_bitReverse)
+    {
+        end();
+        return false;
+    }
+
+    for (uint16_t k = 0; k < half; k++)
+    {
+        double phase = 2.0 * PI * k / samples;
+        m_cos[k] = (float)cos(phase);
+        m_sin[k] = (float)sin(phase);
+        // 1.0 does not fit in Q15, saturate it to 32767
+        long c = lround(cos(phase) * 32768.0);
+        long s = lround(sin(phase) * 32768.0);
+        m_cosQ15[k] = (int16_t)(c > 32767 ? 32767 : c);
+        m_sinQ15[k] = (int16_t)(s > 32767 ? 32767 : s);
+    }
+
+    uint16_t bits = 0;
+    while ((1u << bits) < half)
+    {
+        bits++;
+    }
+    for (uint16_t i = 0; i < half; i++)
+    {
+        uint16_t r = 0;
+        for (uint16_t b = 0; b < bits; b++)
+        {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitReverse[i] = r;
+    }
+
+    m_samples = samples;
+    return true;
+}
+
+void RealFFT::end()
+{
+    free(m_cos);
+    free(m_sin);
+    free(m_cosQ15);
+    free(m_sinQ15);
+    free(m_bitReverse);
+    m_cos = m_sin = nullptr;
+    m_cosQ15 = m_sinQ15 = nullptr;
+    m_bitReverse = nullptr;
+    m_samples = 0;
+}
+
+void RealFFT::forward(float *data)
+{
+    const uint16_t half = m_samples / 2;
+
+    // reorder the packed complex sequence z[k] = x[2k] + j*x[2k+1]
+    for (uint16_t i = 0; i < half; i++)
+    {
+        uint16_t r = m_bitReverse[i];
+        if (r > i)
+        {
+            float tr = data[2 * i], ti = data[2 * i + 1];
+            data[2 * i] = data[2 * r];
+            data[2 * i + 1] = data[2 * r + 1];
+            data[2 * r] = tr;
+            data[2 * r + 1] = ti;
+        }
+    }
+
+    // radix-2 DIT butterflies, W_half^j = W_N^(2j) so the tables are shared
+    for (uint16_t size = 2; size <= half; size <<= 1)
+    {
+        const uint16_t span = size >> 1;
+        const uint16_t step = m_samples / size;
+        for (uint16_t j = 0; j < span; j++)
+        {
+            const float wr = m_cos[j * step];
+            const float wi = -m_sin[j * step];
+            for (uint16_t k = j; k < half; k += size)
+            {
+                float *a = &data[2 * k];
+                float *b = &data[2 * (k + span)];
+                float tr = wr * b[0] - wi * b[1];
+                float ti = wr * b[1] + wi * b[0];
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+
+    // split Z[k] into the real spectrum X[k] and X[N/2-k]
+    float z0r = data[0], z0i = data[1];
+    data[0] = z0r + z0i;
+    data[1] = z0r - z0i;
+    for (uint16_t k = 1; k <= half / 2; k++)
+    {
+        const uint16_t m = half - k;
+        float zr = data[2 * k], zi = data[2 * k + 1];
+        float yr = data[2 * m], yi = data[2 * m + 1];
+
+        // even part Fe = (Z[k] + conj(Z[M-k])) / 2, odd part Fo = (Z[k] - conj(Z[M-k])) / 2j
+        float er = 0.5f * (zr + yr);
+        float ei = 0.5f * (zi - yi);
+        float or_ = 0.5f * (zi + yi);
+        float oi = -0.5f * (zr - yr);
+
+        // B = W_N^k * Fo
+        float c = m_cos[k], s = m_sin[k];
+        float br = c * or_ + s * oi;
+        float bi = c * oi - s * or_;
+
+        data[2 * k] = er + br;
+        data[2 * k + 1] = ei + bi;
+        if (m != k)
+        {
+            // X[M-k] = conj(Fe - B)
+            data[2 * m] = er - br;
+            data[2 * m + 1] = bi - ei;
+        }
+    }
+}
+
+void RealFFT::forwardQ15(int16_t *data)
+{
+    const uint16_t half = m_samples / 2;
+
+    for (uint16_t i = 0; i < half; i++)
+    {
+        uint16_t r = m_bitReverse[i];
+        if (r > i)
+        {
+            int16_t tr = data[2 * i], ti = data[2 * i + 1];
+            data[2 * i] = data[2 * r];
+            data[2 * i + 1] = data[2 * r + 1];
+            data[2 * r] = tr;
+            data[2 * r + 1] = ti;
+        }
+    }
+
+    // same butterflies as forward(), every stage scaled by 1/2
+    for (uint16_t size = 2; size <= half; size <<= 1)
+    {
+        const uint16_t span = size >> 1;
+        const uint16_t step = m_samples / size;
+        for (uint16_t j = 0; j < span; j++)
+        {
+            const int32_t wr = m_cosQ15[j * step];
+            const int32_t wi = -m_sinQ15[j * step];
+            for (uint16_t k = j; k < half; k += size)
+            {
+                int16_t *a = &data[2 * k];
+                int16_t *b = &data[2 * (k + span)];
+                int32_t tr = (wr * b[0] - wi * b[1] + (1 << 14)) >> 15;
+                int32_t ti = (wr * b[1] + wi * b[0] + (1 << 14)) >> 15;
+                int32_t ar = a[0], ai = a[1];
+                a[0] = (int16_t)((ar + tr) >> 1);
+                a[1] = (int16_t)((ai + ti) >> 1);
+                b[0] = (int16_t)((ar - tr) >> 1);
+                b[1] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+
+    // split step, the 1/2 of Fe/Fo completes the 1/N scaling
+    int32_t z0r = data[0], z0i = data[1];
+    data[0] = (int16_t)((z0r + z0i) >> 1);
+    data[1] = (int16_t)((z0r - z0i) >> 1);
+    for (uint16_t k = 1; k <= half / 2; k++)
+    {
+        const uint16_t m = half - k;
+        int32_t zr = data[2 * k], zi = data[2 * k + 1];
+        int32_t yr = data[2 * m], yi = data[2 * m + 1];
+
+        int32_t er = (zr + yr) >> 1;
+        int32_t ei = (zi - yi) >> 1;
+        int32_t or_ = (zi + yi) >> 1;
+        int32_t oi = (yr - zr) >> 1;
+
+        int32_t c = m_cosQ15[k], s = m_sinQ15[k];
+        int32_t br = (c * or_ + s * oi + (1 << 14)) >> 15;
+        int32_t bi = (c * oi - s * or_ + (1 << 14)) >> 15;
+
+        data[2 * k] = (int16_t)((er + br) >> 1);
+        data[2 * k + 1] = (int16_t)((ei + bi) >> 1);
+        if (m != k)
+        {
+            data[2 * m] = (int16_t)((er - br) >> 1);
+            data[2 * m + 1] = (int16_t)((bi - ei) >> 1);
+        }
+    }
+}
+
+void RealFFT::amplitude(const float *spectrum, float *out)
+{
+    const uint16_t half = m_samples / 2;
+    const float scale = 2.0f / m_samples;
+
+    out[0] = fabsf(spectrum[0]) / m_samples;
+    for (uint16_t k = 1; k < half; k++)
+    {
+        float re = spectrum[2 * k], im = spectrum[2 * k + 1];
+        out[k] = sqrtf(re * re + im * im) * scale;
+    }
+}
+
+void RealFFT::amplitudeQ15(const int16_t *spectrum, uint16_t *out)
+{
+    const uint16_t half = m_samples / 2;
+
+    // the spectrum is already X[k] / N
+    out[0] = (uint16_t)abs(spectrum[0]);
+    for (uint16_t k = 1; k < half; k++)
+    {
+        int32_t re = spectrum[2 * k], im = spectrum[2 * k + 1];
+        out[k] = (uint16_t)(2.0f * sqrtf((float)(re * re + im * im)));
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef __real_fft_h__
+#define __real_fft_h__
+
+#include <stdint.h>
+
+/**
+ * Real-input FFT engine.
+ *
+ * An N-point real sequence is packed into an N/2-point complex sequence
+ * (even samples -> real part, odd samples -> imaginary part), transformed
+ * with a radix-2 complex FFT and then split back into the N/2+1 unique bins
+ * of the real spectrum. Twiddle factors and the bit-reverse permutation are
+ * computed once in begin(), so forward() only does butterflies.
+ *
+ * Both variants work in place on the caller's buffer and leave it packed as:
+ *   data[0]      = Re(X[0])    (DC)
+ *   data[1]      = Re(X[N/2])  (Nyquist)
+ *   data[2k]     = Re(X[k])    k = 1 .. N/2-1
+ *   data[2k + 1] = Im(X[k])
+ *
+ * The float32 variant returns the unscaled DFT. The Q15 variant halves the
+ * data at every stage to avoid overflow, so it returns X[k] / N.
+ **/
+class RealFFT
+{
+private:
+    // number of real samples (N)
+    uint16_t m_samples = 0;
+    // W_N^k = cos(2*pi*k/N) - j*sin(2*pi*k/N), k = 0 .. N/2-1
+    float *m_cos = nullptr;
+    float *m_sin = nullptr;
+    int16_t *m_cosQ15 = nullptr;
+    int16_t *m_sinQ15 = nullptr;
+    // bit-reverse permutation of the N/2-point complex FFT
+    uint16_t *m_bitReverse = nullptr;
+
+public:
+    ~RealFFT();
+
+    /**
+     * Build the tables for an N-point transform, N must be a power of two
+     * between 4 and 32768. Returns false on bad size or out of memory.
+     **/
+    bool begin(uint16_t samples);
+    void end();
+    uint16_t getSamples()
+    {
+        return m_samples;
+    }
+
+    void forward(float *data);
+    void forwardQ15(int16_t *data);
+
+    /**
+     * Convert a packed spectrum into N/2 amplitudes, scaled the same way the
+     * old arduinoFFT path did: |X[0]| / N for DC and 2 * |X[k]| / N otherwise.
+     * out may alias spectrum.
+     **/
+    void amplitude(const float *spectrum, float *out);
+    void amplitudeQ15(const int16_t *spectrum, uint16_t *out);
+};
+
+#endif
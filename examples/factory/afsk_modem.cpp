@@ -0,0 +1,121 @@
+#include "afsk_modem.h"
+#include "Arduino.h"
+
+static PCMLayer *modem_pcm = NULL;
+static PCMClient *modem_afsk = NULL;
+static AX25Client *modem_ax25 = NULL;
+static APRSClient *modem_aprs = NULL;
+static AFSKReceiver *modem_rx = NULL;
+static int16_t rx_block[RADIOLIB_PCM_BLOCK_SIZE];
+
+// rendered frame, mono
+static int16_t *tx_pcm = NULL;
+static size_t tx_size = 0;
+static size_t tx_len = 0;
+static volatile size_t tx_pos = 0;
+static bool tx_overflow = false;
+
+// PCMLayer output while a frame is rendered
+static void modem_sink(const int16_t *samples, size_t len) {
+  if (tx_len + len > tx_size) {
+    tx_overflow = true;
+    len = tx_size - tx_len;
+  }
+  memcpy(&tx_pcm[tx_len], samples, len * sizeof(int16_t));
+  tx_len += len;
+}
+
+static void modem_frame(const uint8_t *frame, size_t len) {
+  // destination and source, 6 shifted characters and the SSID each
+  char call[2][10];
+  for (uint8_t a = 0; a < 2; a++) {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < 6; i++) {
+      char c = frame[7 * a + i] >> 1;
+      if (c != ' ')
+        call[a][n++] = c;
+    }
+    uint8_t ssid = (frame[7 * a + 6] >> 1) & 0x0F;
+    if (ssid)
+      n += sprintf(&call[a][n], "-%u", ssid);
+    call[a][n] = 0;
+  }
+  // skip repeaters, control and PID
+  size_t pos = 14;
+  while (pos < len && !(frame[pos - 1] & 0x01))
+    pos += 7;
+  pos += 2;
+  if (pos > len)
+    pos = len;
+  Serial.printf("afsk %s>%s:%.*s\n", call[1], call[0], (int)(len - pos), &frame[pos]);
+}
+
+bool afsk_modem_begin(uint32_t sample_rate, const char *callsign, uint8_t ssid) {
+  if (modem_pcm == NULL) {
+    tx_size = sample_rate * AFSK_MODEM_TX_MS / 1000;
+    tx_pcm = (int16_t *)heap_caps_malloc(tx_size * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+    if (tx_pcm == NULL)
+      return false;
+    modem_pcm = new PCMLayer(sample_rate, modem_sink);
+    modem_afsk = new PCMClient(modem_pcm);
+    modem_ax25 = new AX25Client(modem_afsk);
+    modem_aprs = new APRSClient(modem_ax25);
+    modem_rx = new AFSKReceiver(sample_rate);
+  }
+  tx_len = tx_pos = 0;
+  int16_t state = modem_pcm->begin(AFSK_MODEM_AMPLITUDE);
+  state |= modem_ax25->begin(callsign, ssid);
+  state |= modem_aprs->begin('>');
+  state |= modem_rx->begin();
+  modem_rx->setFrameAction(modem_frame);
+  return state == RADIOLIB_ERR_NONE;
+}
+
+void afsk_modem_rx(const int16_t *samples, size_t frames) {
+  if (modem_rx == NULL)
+    return;
+  while (frames > 0) {
+    size_t n = frames < RADIOLIB_PCM_BLOCK_SIZE ? frames : RADIOLIB_PCM_BLOCK_SIZE;
+    for (size_t i = 0; i < n; i++)
+      rx_block[i] = samples[2 * i];
+    modem_rx->process(rx_block, n);
+    samples += 2 * n;
+    frames -= n;
+  }
+}
+
+int16_t afsk_modem_send_position(char *lat, char *lon, char *msg) {
+  if (modem_aprs == NULL)
+    return RADIOLIB_ERR_UNKNOWN;
+  if (afsk_modem_tx_busy())
+    return RADIOLIB_ERR_TX_TIMEOUT;
+  tx_len = tx_pos = 0;
+  tx_overflow = false;
+  int16_t state = modem_aprs->sendPosition((char *)"APRS", 0, lat, lon, msg);
+  // a little silence pushes the last bits out of the DMA buffers
+  modem_pcm->silence(50000);
+  modem_pcm->flush();
+  if (state == RADIOLIB_ERR_NONE && tx_overflow)
+    state = RADIOLIB_ERR_PACKET_TOO_LONG;
+  if (state != RADIOLIB_ERR_NONE)
+    tx_len = 0;
+  return state;
+}
+
+size_t afsk_modem_tx(int16_t *samples, size_t frames) {
+  size_t pos = tx_pos;
+  size_t n = tx_len - pos;
+  if (n > frames)
+    n = frames;
+  // mono to both speaker channels
+  for (size_t i = 0; i < n; i++)
+    samples[2 * i] = samples[2 * i + 1] = tx_pcm[pos + i];
+  tx_pos = pos + n;
+  return n;
+}
+
+bool afsk_modem_tx_busy(void) { return tx_pos < tx_len; }
+
+uint32_t afsk_modem_get_frames(void) { return modem_rx ? modem_rx->getFrames() : 0; }
+
+uint32_t afsk_modem_get_errors(void) { return modem_rx ? modem_rx->getErrors() : 0; }
@@ -0,0 +1,38 @@
+#pragma once
+#include <RadioLib.h>
+#include <stdint.h>
+
+/**
+ * Software AFSK modem on the audio codec.
+ *
+ * Transmit renders the RadioLib AX.25 / APRS encoders into PCM through
+ * PCMLayer, the same encoders that otherwise key a radio pin. Receive runs
+ * AFSKReceiver on one channel of the ES7210 stream, decoded frames are
+ * printed to Serial as SRC>DST:info.
+ *
+ * Both sides run in the calling task (mic_spk_task). Sending renders the
+ * whole frame into a PSRAM buffer at once, afsk_modem_tx() then hands it out
+ * block by block, so the loop that reads and demodulates the mic writes the
+ * beacon to the speaker in step with it and hears its own frame. Nothing is
+ * allocated after afsk_modem_begin().
+ */
+
+#define AFSK_MODEM_AMPLITUDE 8000 // speaker level, of 32767
+#define AFSK_MODEM_TX_MS     3000 // longest frame rendered, silence included
+
+bool afsk_modem_begin(uint32_t sample_rate, const char *callsign, uint8_t ssid);
+
+/* Interleaved stereo 16 bit samples as read from the ES7210, both mics hear the same */
+void afsk_modem_rx(const int16_t *samples, size_t frames);
+
+/* Queue an APRS position report, lat "DDMM.hhN", lon "DDDMM.hhE". Fails
+ * while the previous frame is still going out. */
+int16_t afsk_modem_send_position(char *lat, char *lon, char *msg);
+
+/* Next frames of the queued frame as interleaved stereo 16 bit samples for
+ * the speaker, returns how many were filled, 0 when nothing is queued */
+size_t afsk_modem_tx(int16_t *samples, size_t frames);
+bool afsk_modem_tx_busy(void);
+
+uint32_t afsk_modem_get_frames(void);
+uint32_t afsk_modem_get_errors(void);
@@ -135,6 +135,7 @@ static void play_event_cb(lv_event_t *e) {
   String path = play_music_path;
   Serial.println(path);
   xQueueSend(play_music_queue, &path, 0);
+  xEventGroupSetBits(global_event_group, WAV_WAKE);
 }
 
 static void drag_music_time_event_cb(lv_event_t *e) {
@@ -143,6 +144,7 @@ static void drag_music_time_event_cb(lv_event_t *e) {
   if (c == LV_EVENT_RELEASED) {
     uint32_t pos = lv_slider_get_value(instance);
     xQueueSend(play_time_queue, &pos, 0);
+    xEventGroupSetBits(global_event_group, WAV_WAKE);
   }
 }
 
@@ -1,6 +1,8 @@
 #include "app_nfc.h"
 #include "Arduino.h"
 #include "pin_config.h"
+#include "global_flags.h"
+#include "ui_msg.h"
 
 LV_IMG_DECLARE(img_card);
 
@@ -9,25 +11,17 @@ int nfc_init_succeed = 0;
 extern  void resume_nfcTaskHandler(void);
 
 lv_obj_t * nfc_message_label = NULL;
-static int new_data = 0;
-char set_text_nfc_data[200] = {0};
-void set_nfc_message_label(const char * txt, int cmd)
+// May be called from any task, the label is updated by ui_task through MSG_NFC_TEXT_ID
+void set_nfc_message_label(const char * txt)
 {
-    if(cmd && new_data)
-    {
-        new_data = 0;
-        if(nfc_message_label != NULL)
-            lv_label_set_text(nfc_message_label, set_text_nfc_data);
-    }
-    else if(cmd == 0)
-    {
-        memset(set_text_nfc_data, 0, 200);
-        if(txt != NULL)
-        {
-            memcpy(set_text_nfc_data, txt, 200);
-            new_data = 1;
-        }
-    }
+    ui_msg_post_text(MSG_NFC_TEXT_ID, txt);
+}
+
+static void nfc_message_msg_cb(lv_event_t *e)
+{
+    lv_obj_t *label = lv_event_get_target(e);
+    lv_msg_t *m = lv_event_get_msg(e);
+    lv_label_set_text(label, (const char *)lv_msg_get_payload(m));
 }
 
 void app_nfc_load(lv_obj_t *cont) {
@@ -83,8 +77,9 @@ void app_nfc_load(lv_obj_t *cont) {
     lv_obj_set_align(nfc_message_label, LV_ALIGN_CENTER);
     lv_obj_set_style_border_opa(nfc_message_label, 0, 0);
     lv_obj_clear_flag(nfc_message_label, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(nfc_message_label, nfc_message_msg_cb, LV_EVENT_MSG_RECEIVED, NULL);
+    lv_msg_subsribe_obj(MSG_NFC_TEXT_ID, nfc_message_label, NULL);
 
-    digitalWrite(NFC_CS, LOW);
     resume_nfcTaskHandler();
 }
 
@@ -98,7 +93,6 @@ extern void suspend_nfcTaskHandler(void);
 void app_nfc_exit(lv_obj_t *cont) 
 {
     suspend_nfcTaskHandler();
-    digitalWrite(NFC_CS, HIGH);
     nfc_message_label = NULL;
 }
 
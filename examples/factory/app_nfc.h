@@ -4,5 +4,5 @@
 #include "lvgl.h"
 
 extern app_t app_nfc;
-void set_nfc_message_label(const char * txt, int cmd);
+void set_nfc_message_label(const char * txt);
 
@@ -1,6 +1,8 @@
 #include "app_radio.h"
 #include "Arduino.h"
 #include "pin_config.h"
+#include "global_flags.h"
+#include "ui_msg.h"
 
 int radio_init_succeed = 0;
 
@@ -18,27 +20,17 @@ lv_timer_t *transmitTask;
 static lv_obj_t *radio_ta = NULL;
 
 
-char set_text_radio_data[250] = {0};
-static int new_data = 0;
-
+// May be called from any task, the label is updated by ui_task through MSG_RADIO_TEXT_ID
+void set_text_radio_ta(const char * txt)
+{
+    ui_msg_post_text(MSG_RADIO_TEXT_ID, txt);
+}
 
-void set_text_radio_ta(const char * txt, int cmd)
+static void radio_ta_msg_cb(lv_event_t *e)
 {
-    if(cmd && new_data)
-    {
-        new_data = 0;
-        if(radio_ta != NULL)
-            lv_label_set_text(radio_ta, (const char * )set_text_radio_data);
-    }
-    else if(cmd == 0)
-    {
-        memset(set_text_radio_data, 0, 250);
-        if(txt != NULL)
-        {
-            memcpy(set_text_radio_data, txt, 250);
-            new_data = 1;
-        }
-    }
+    lv_obj_t *label = lv_event_get_target(e);
+    lv_msg_t *m = lv_event_get_msg(e);
+    lv_label_set_text(label, (const char *)lv_msg_get_payload(m));
 }
 
 extern u32_t radio_task_delay_ms;
@@ -64,7 +56,6 @@ static void radio_tx_interval_cb(lv_event_t *e)
 }
 
 void app_radio_load(lv_obj_t *cont) {
-    digitalWrite(RADIO_CS_PIN, LOW);
     radioPingPong(cont);
     //lv_timer_resume(transmitTask);
 }
@@ -109,6 +100,8 @@ void radioPingPong(lv_obj_t *parent)
     //lv_textarea_set_cursor_click_pos(radio_ta, false);
     //lv_textarea_set_text_selection(radio_ta, false);
     lv_obj_add_style(radio_ta, &style, LV_PART_MAIN);
+    lv_obj_add_event_cb(radio_ta, radio_ta_msg_cb, LV_EVENT_MSG_RECEIVED, NULL);
+    lv_msg_subsribe_obj(MSG_RADIO_TEXT_ID, radio_ta, NULL);
     lv_obj_set_style_border_color(radio_ta, lv_color_hex(0xffffff), LV_PART_MAIN);
     //lv_obj_set_style_line_color(radio_ta, lv_color_hex(0x6a6c62), LV_PART_MAIN);
 
@@ -216,7 +209,6 @@ extern void suspend_radioTaskHandler(void);
 void app_radio_exit(lv_obj_t *cont) 
 {
     suspend_radioTaskHandler();
-    digitalWrite(RADIO_CS_PIN, HIGH);
 }
 
 app_t app_radio = {
@@ -1,7 +1,9 @@
 #include "app_wireless.h"
 #include "WiFi.h"
 #include "global_flags.h"
+#include "glyph_cache.h"
 #include "ui.h"
+#include "ui_msg.h"
 #include <NimBLEDevice.h>
 
 class ClientCallbacks : public NimBLEClientCallbacks {
@@ -149,7 +151,7 @@ void app_wireless_load(lv_obj_t *cont) {
   lv_obj_add_event_cb(ta2, ta_event_cb, LV_EVENT_ALL, wireless_param.kb);
 
   wireless_param.msg = lv_label_create(cont);
-  lv_obj_set_style_text_font(wireless_param.msg, &alibaba_font, 0);
+  lv_obj_set_style_text_font(wireless_param.msg, glyph_cache_font(&alibaba_font), 0);
   lv_obj_align(wireless_param.msg, LV_ALIGN_BOTTOM_LEFT, 0, 0);
   lv_label_set_long_mode(wireless_param.msg, LV_LABEL_LONG_SCROLL_CIRCULAR);
   lv_obj_set_width(wireless_param.msg, LV_PCT(80));
@@ -289,9 +291,9 @@ void notifyCB(NimBLERemoteCharacteristic *pRemoteCharacteristic, uint8_t *pData,
   /* To prevent the reset after the exit is still refreshed. */
   float fData = String(pData, length).toFloat();
   if (pRemoteCharacteristic->getUUID() == NimBLEUUID("2A6E")) {
-    lv_msg_send(MSG_BLE_SEND_DATA_1, &fData);
+    ui_msg_post(MSG_BLE_SEND_DATA_1, fData);
   } else if (pRemoteCharacteristic->getUUID() == NimBLEUUID("2A6F")) {
-    lv_msg_send(MSG_BLE_SEND_DATA_2, &fData);
+    ui_msg_post(MSG_BLE_SEND_DATA_2, fData);
   }
 }
 static void get_ble_name_event_cb(lv_event_t *e) {
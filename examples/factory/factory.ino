@@ -7,12 +7,22 @@
 #include "MyFFT.h"
 #include "SD_MMC.h"
 #include "SPIFFS.h"
+#include "afsk_modem.h"
 #include "driver/i2s.h"
 #include "es7210.h"
+#include "gif_cache.h"
 #include "global_flags.h"
+#include "glyph_cache.h"
+#include "img_pack.h"
+#include "nfc_reader.h"
 #include "pin_config.h"
+#include "radio_pipe.h"
+#include "refr_stat.h"
 #include "self_test.h"
+#include "spi_bus.h"
+#include "task_stat.h"
 #include "ui.h"
+#include "ui_msg.h"
 
 /* external library */
 #include "APA102.h"     // https://github.com/pololu/apa102-arduino
@@ -69,6 +79,9 @@ QueueHandle_t play_time_queue;
 static EventGroupHandle_t lv_input_event;
 
 static TaskHandle_t radioTaskHandler;
+static TaskHandle_t uiTaskHandler;
+// esp_timer time of the first interrupt since ui_task last woke up, 0 if none
+static volatile uint32_t ui_wake_isr_us = 0;
 static TaskHandle_t  nfcTaskHandler;
 static bool isCoderOnline = false;
 
@@ -76,20 +89,21 @@ u32_t radio_task_delay_ms = 200;
 
 // Flag to indicate transmission or reception state
 static bool transmitFlag = false;
-// Save transmission states between loops
-static int transmissionState = RADIOLIB_ERR_NONE;
-// Flag to indicate that a packet was sent or received
-static bool radioTransmitFlag = false;
 
 SPIClass radioBus =  SPIClass(HSPI);
 // ?If you use the CC1101 shield, the ES7210 decoding chip will not be used. This is a conflict.
-CC1101 radio = new Module(RADIO_CS_PIN, PIN_IIC_SDA, RADIOLIB_NC, PIN_IIC_SCL, radioBus);
+CC1101 radio = new SpiBusModule(RADIO_CS_PIN, PIN_IIC_SDA, RADIOLIB_NC, PIN_IIC_SCL, radioBus);
 Adafruit_PN532 nfc(NFC_CS, &radioBus);
+// radioBus devices, see spi_bus.h
+static int8_t spi_radio = -1;
+static int8_t spi_nfc = -1;
+// set by suspend_*TaskHandler(), the task parks itself where it holds no bus
+static volatile bool radio_task_pause = false;
+static volatile bool nfc_task_pause = false;
 
 extern int nfc_init_succeed;
 extern int radio_init_succeed;
 extern lv_timer_t *transmitTask;
-extern void lv_msg_send(uint32_t msg_id, const void * payload);
 
 
 void ui_task(void *param);
@@ -104,13 +118,40 @@ void timeavailable(struct timeval *t);
 void printLocalTime();
 void SD_init(void);
 
+#if LV_FLUSH_USE_DMA
+static volatile uint32_t lv_dma_start_us;
+
+// Called from the SPI interrupt when the strip starts going out, after the byte swap and
+// the address window, so "spi us" is the transfer alone
+static void IRAM_ATTR lv_disp_dma_start(void *arg)
+{
+    lv_dma_start_us = (uint32_t)esp_timer_get_time();
+}
+
+// Called from the SPI interrupt when the strip has been sent, the buffer can be rendered again
+static void IRAM_ATTR lv_disp_dma_done(void *arg)
+{
+    refr_stat_spi((uint32_t)esp_timer_get_time() - lv_dma_start_us);
+    lv_disp_flush_ready((lv_disp_drv_t *)arg);
+}
+#endif
+
 static void lv_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p)
 {
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
+    uint32_t start = (uint32_t)esp_timer_get_time();
+#if LV_FLUSH_USE_DMA
+    // Waits for the previous strip, so the other buffer is never overwritten while in flight.
+    // lv_disp_flush_ready() follows from lv_disp_dma_done().
+    tft.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)&color_p->full);
+#else
     tft.setAddrWindow(area->x1, area->y1, w, h);
     tft.pushColors((uint16_t *)&color_p->full, w * h);
+    refr_stat_spi((uint32_t)esp_timer_get_time() - start);
     lv_disp_flush_ready(disp);
+#endif
+    refr_stat_flush(w * h, (uint32_t)esp_timer_get_time() - start);
 }
 
 static void lv_encoder_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
@@ -142,8 +183,12 @@ void setup()
     pinMode(PIN_POWER_ON, OUTPUT);
     digitalWrite(PIN_POWER_ON, HIGH);
 
-    pinMode(RADIO_CS_PIN, OUTPUT);
-    digitalWrite(RADIO_CS_PIN, HIGH);
+    // all chip selects of radioBus high before anything talks on it
+    spi_bus_init(&radioBus);
+    spi_radio = spi_bus_add("radio", RADIO_CS_PIN, SPI_BUS_PRIO_HIGH, RADIOLIB_DEFAULT_SPI_SETTINGS);
+    spi_nfc = spi_bus_add("nfc", NFC_CS, SPI_BUS_PRIO_NORMAL, SPISettings(1000000, SPI_LSBFIRST, SPI_MODE0));
+    spi_bus_add("sd", PIN_SD_CS, SPI_BUS_PRIO_LOW, SPISettings(20000000, SPI_MSBFIRST, SPI_MODE0));
+    Adafruit_SPIDevice::setBusHooks(spi_bus_acquire_cs, spi_bus_release_cs);
 
     Serial.begin(115200);
     Serial.printf("psram size : %d kb\r\n", ESP.getPsramSize() / 1024);
@@ -197,10 +242,14 @@ void wav_task(void *param)
     audio->setVolume(21); // 0...21
     audio->connecttoFS(SPIFFS, "/ring_setup.mp3");
     Serial.println("play \"/ring_setup.mp3\"");
+    int8_t wav_stat = task_stat_register("wav_task");
     while (1) {
 
         EventBits_t bit = xEventGroupGetBits(global_event_group);
         if (bit) {
+            if (bit & WAV_WAKE) {
+                xEventGroupClearBits(global_event_group, WAV_WAKE);
+            }
             if (bit & RING_PAUSE) {
                 xEventGroupClearBits(global_event_group, RING_PAUSE);
                 is_pause = !is_pause;
@@ -233,25 +282,54 @@ void wav_task(void *param)
             audio->setAudioPlayPosition(time_pos);
         }
 
-        if (audio->isRunning() && Millis - millis() > 100) {
+        if (audio->isRunning() && millis() - Millis > 100) {
             music_time = audio->getAudioCurrentTime();
-            lv_msg_send(MSG_MUSIC_TIME_ID, &music_time);
+            ui_msg_post(MSG_MUSIC_TIME_ID, music_time);
 
             end_time = audio->getTotalPlayingTime();
-            lv_msg_send(MSG_MUSIC_TIME_END_ID, &end_time);
+            ui_msg_post(MSG_MUSIC_TIME_END_ID, end_time);
             Millis = millis();
         }
-        if (!is_pause)
+        if (!is_pause && audio->isRunning()) {
             audio->loop();
-        delay(1);
+            task_stat_sleep(wav_stat);
+            delay(1);
+        } else {
+            // Nothing to decode, sleep until the UI asks for something
+            task_stat_sleep(wav_stat);
+            xEventGroupWaitBits(global_event_group, RING_PAUSE | RING_STOP | WAV_RING_1 | WAV_WAKE, pdFALSE, pdFALSE, portMAX_DELAY);
+        }
+        task_stat_wake(wav_stat);
     }
 }
 
+// Encoder and button interrupts, ui_task sleeps until one of them (or a ui_msg post) arrives
+static void IRAM_ATTR ui_wake_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    if (ui_wake_isr_us == 0)
+        ui_wake_isr_us = (uint32_t)esp_timer_get_time();
+    vTaskNotifyGiveFromISR(uiTaskHandler, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void IRAM_ATTR encoder_isr(void)
+{
+    encoder.tick();
+    ui_wake_from_isr();
+}
+
+static void IRAM_ATTR button_isr(void)
+{
+    ui_wake_from_isr();
+}
+
 void ui_task(void *param)
 {
     static lv_disp_draw_buf_t draw_buf;
     static lv_color_t *buf1, *buf2;
 
+    uiTaskHandler = xTaskGetCurrentTaskHandle();
     tft.begin();
     tft.setRotation(3);
     tft.fillScreen(TFT_BLACK);
@@ -277,9 +355,20 @@ void ui_task(void *param)
     lv_input_event);
 
     lv_init();
-    buf1 = (lv_color_t *)ps_malloc(LV_BUF_SIZE * sizeof(lv_color_t));
+    img_pack_init();
+    // Mailboxes for the messages posted by the other tasks, see ui_msg.h
+    ui_msg_register(MSG_MUSIC_TIME_ID, sizeof(uint32_t));
+    ui_msg_register(MSG_MUSIC_TIME_END_ID, sizeof(uint32_t));
+    ui_msg_register(MSG_FFT_ID, SAMPLES * sizeof(uint16_t));
+    ui_msg_register(MSG_BLE_SEND_DATA_1, sizeof(float));
+    ui_msg_register(MSG_BLE_SEND_DATA_2, sizeof(float));
+    ui_msg_register(MSG_RADIO_TEXT_ID, MSG_TEXT_MAX_LEN);
+    ui_msg_register(MSG_NFC_TEXT_ID, MSG_TEXT_MAX_LEN);
+    ui_msg_set_consumer(uiTaskHandler);
+    // Two strips in internal RAM so the SPI DMA can read one while LVGL renders the other
+    buf1 = (lv_color_t *)heap_caps_malloc(LV_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
     assert(buf1);
-    buf2 = (lv_color_t *)ps_malloc(LV_BUF_SIZE * sizeof(lv_color_t));
+    buf2 = (lv_color_t *)heap_caps_malloc(LV_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
     assert(buf2);
     lv_disp_draw_buf_init(&draw_buf, buf1, buf2, LV_BUF_SIZE);
     /*Initialize the display*/
@@ -290,7 +379,19 @@ void ui_task(void *param)
     disp_drv.ver_res = LV_SCREEN_HEIGHT;
     disp_drv.flush_cb = lv_disp_flush;
     disp_drv.draw_buf = &draw_buf;
-    lv_disp_drv_register(&disp_drv);
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+    refr_stat_init(disp);
+    refr_stat_set_overlay(LV_REFR_STAT_OVERLAY);
+    refr_stat_set_serial(LV_REFR_STAT_SERIAL);
+
+#if LV_FLUSH_USE_DMA
+    // LVGL renders RGB565 little endian, pushImageDMA swaps it in place before sending
+    tft.setSwapBytes(true);
+    tft.initDMA();
+    tft.setDMACallback(lv_disp_dma_done, &disp_drv, lv_disp_dma_start);
+    // Keep CS asserted, the TFT is the only device on this SPI bus
+    tft.startWrite();
+#endif
 
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
@@ -339,23 +440,19 @@ void ui_task(void *param)
     },  
     LV_EVENT_CLICKED, NULL);
 
-    attachInterrupt( 
-        digitalPinToInterrupt(PIN_ENCODE_A), []() {
-        encoder.tick();
-    }, CHANGE);
-    attachInterrupt( 
-        digitalPinToInterrupt(PIN_ENCODE_B), []() {
-        encoder.tick();
-    }, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PIN_ENCODE_A), encoder_isr, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PIN_ENCODE_B), encoder_isr, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PIN_ENCODE_BTN), button_isr, CHANGE);
+
+    // The encoder is read on input events only, see the end of the loop
+    lv_timer_t *indev_timer = lv_encoder_indev->driver->read_timer;
+    uint32_t last_input = 0;
+    int8_t ui_stat = task_stat_register("ui_task");
+    task_stat_set_serial(TASK_STAT_SERIAL);
+    lv_timer_create([](lv_timer_t *t) { task_stat_report(); spi_bus_report(); radio_pipe_report(); nfc_reader_report(); img_pack_report(); gif_cache_report(); glyph_cache_report(); }, TASK_STAT_PERIOD_MS, NULL);
 
     while (1) {
-        delay(1);
         button.tick();
-        lv_timer_handler();
-        if (isCoderOnline) {
-            set_text_radio_ta(NULL, 1);
-            set_nfc_message_label(NULL, 1);
-        }
         RotaryEncoder::Direction dir = encoder.getDirection();
         if (dir != RotaryEncoder::Direction::NOROTATION) {
             if (dir != RotaryEncoder::Direction::CLOCKWISE) {
@@ -370,6 +467,20 @@ void ui_task(void *param)
         }
 
         EventBits_t bit = xEventGroupGetBits(lv_input_event);
+        if (bit & (LV_BUTTON | LV_ENCODER_CW | LV_ENCODER_CCW)) {
+            // let LVGL read the encoder in this round and for a while after, to see the release
+            last_input = millis();
+            lv_timer_resume(indev_timer);
+            lv_timer_ready(indev_timer);
+        } else if (millis() - last_input > UI_INDEV_ACTIVE_MS) {
+            lv_timer_pause(indev_timer);
+        }
+
+        ui_msg_dispatch();
+        uint32_t wait_ms = lv_timer_handler();
+
+        // the start buttons set these from their LVGL event callbacks
+        bit = xEventGroupGetBits(lv_input_event);
         if (bit & LV_SELF_TEST_START) {
             xEventGroupClearBits(lv_input_event, LV_SELF_TEST_START);
             uint16_t temp = 0x41;
@@ -382,6 +493,22 @@ void ui_task(void *param)
             xEventGroupClearBits(lv_input_event, LV_UI_DEMO_START);
             ui_init();
         }
+
+        // Sleep until the next LVGL timer is due or something wakes us up
+        if (wait_ms > UI_IDLE_MAX_MS)
+            wait_ms = UI_IDLE_MAX_MS;
+        // OneButton times clicks in tick(), keep ticking while a press is in progress
+        if (!button.isIdle() && wait_ms > UI_BUTTON_TICK_MS)
+            wait_ms = UI_BUTTON_TICK_MS;
+        task_stat_sleep(ui_stat);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+        task_stat_wake(ui_stat);
+
+        uint32_t isr_us = ui_wake_isr_us;
+        if (isr_us) {
+            ui_wake_isr_us = 0;
+            task_stat_latency(ui_stat, (uint32_t)esp_timer_get_time() - isr_us);
+        }
     }
 
     vTaskDelete(NULL);
@@ -424,42 +551,54 @@ rgb_color hsvToRgb(uint16_t h, uint8_t s, uint8_t v)
 // clang-format on
 
 
+// Suspending radio_task or nfc_task from outside could stop them in the middle of a bus
+// transaction (or queued for the bus) and block the other devices, they park themselves
+// at the top of their loop instead.
 void suspend_nfcTaskHandler(void)
 {
-    vTaskSuspend(nfcTaskHandler);
+    nfc_task_pause = true;
+    // it may sleep until the next card otherwise
+    if (nfcTaskHandler)
+        xTaskNotifyGive(nfcTaskHandler);
 }
 
 void resume_nfcTaskHandler(void)
 {
-    vTaskResume(nfcTaskHandler);
+    nfc_task_pause = false;
+    if (nfcTaskHandler)
+        vTaskResume(nfcTaskHandler);
 }
 
 void suspend_radioTaskHandler(void)
 {
-    vTaskSuspend(radioTaskHandler);
+    radio_task_pause = true;
 }
 
 void resume_radioTaskHandler(void)
 {
-    vTaskResume(radioTaskHandler);
+    radio_task_pause = false;
+    if (radioTaskHandler)
+        vTaskResume(radioTaskHandler);
 }
 
 // clang-format on
 void radio_task(void * param)
 {
-    digitalWrite(RADIO_CS_PIN, HIGH);
     Serial.print("==========radio_init sta===========\r\n");
     //radio_init();
     Serial.print("radio_init end\r\n");
 
     suspend_radioTaskHandler();
+    radio_pipe_set_consumer(xTaskGetCurrentTaskHandle());
 
     while(1)
     {
+        if (radio_task_pause)
+            vTaskSuspend(NULL);
+        // woken by the GDO0 interrupt, the timeout paces the Tx packets
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(radio_task_delay_ms));
         if(radio_init_succeed)
             radioTask(NULL);
-
-        delay(radio_task_delay_ms);
     }
 }
 
@@ -485,11 +624,6 @@ void uint8_to_hexstr(uint8_t *in_data,int len,char *out_data)
 
 void nfc_task(void *param)
 {
-    pinMode(PIN_SD_CS, OUTPUT);
-    digitalWrite(PIN_SD_CS, HIGH);
-
-    //pinMode(NFC_CS, OUTPUT);
-    digitalWrite(NFC_CS, LOW);
     nfc.begin();
     uint32_t versiondata = nfc.getFirmwareVersion();
     if (! versiondata) {
@@ -498,7 +632,12 @@ void nfc_task(void *param)
 
         //while (1); // halt
     }
-    else 
+    else if (!nfc_reader_begin(&nfc, NFC_IRQ_PIN))
+    {
+        Serial.println("PN532 configuration failed");
+        nfc_init_succeed = 0;
+    }
+    else
     {
         nfc_init_succeed = 1;
         // Got ok data, print it out!
@@ -509,7 +648,6 @@ void nfc_task(void *param)
     }
 
 
-    digitalWrite(NFC_CS, HIGH);
     suspend_nfcTaskHandler();
 
     uint32_t nfc_Success_count = 0;
@@ -522,126 +660,51 @@ void nfc_task(void *param)
         }
     }
 
+    bool reading = false;
     while(1)
     {
-        delay(100);
-        //Serial.println("delay(10)\n");
-        uint8_t success;
-        uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };  // Buffer to store the returned UID
-        uint8_t uidLength;                        // Length of the UID (4 or 7 bytes depending on ISO14443A card type)
-
-        // Wait for an ISO14443A type cards (Mifare, etc.).  When one is found
-        // 'uid' will be populated with the UID, and uidLength will indicate
-        // if the uid is 4 bytes (Mifare Classic) or 7 bytes (Mifare Ultralight)
-        Serial.println("readPassiveTargetID sta\n");
-        success = nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength);
-        Serial.printf("readPassiveTargetID end =%d=\n", success);
-        if (success) {
+        if (nfc_task_pause) {
+            // leaves the PN532 idle, no command half way when the bus is needed elsewhere
+            nfc_reader_stop();
+            reading = false;
+            vTaskSuspend(NULL);
+        }
+        if (!reading) {
+            nfc_reader_start();
+            reading = true;
+        }
+        // one frame at a time, the bus is free while the PN532 works or waits for a card
+        TickType_t wait = nfc_reader_service();
+
+        nfc_card_event_t card;
+        while (nfc_reader_get_event(&card, 0)) {
             char text_nfc_data[200] = {0};
             nfc_Success_count++;
-            // Display some basic information about the card
-            Serial.println("Found an ISO14443A card");
-            Serial.print("  UID Length: ");Serial.print(uidLength, DEC);Serial.println(" bytes");
+            Serial.printf("Found %s card, SAK %02X, %u bytes in %u exchanges, detect to dump %u us\n",
+                          nfc_card_type_name(card.type), card.sak, card.size, card.exchanges, card.latency_us);
             Serial.print("  UID Value: ");
-            nfc.PrintHex(uid, uidLength);
-            Serial.println("");
-
-            if (uidLength == 4)
-            {
-                // We probably have a Mifare Classic card ...
-                Serial.println("Seems to be a Mifare Classic card (4 byte UID)");
-
-                // Now we need to try to authenticate it for read/write access
-                // Try with the factory default KeyA: 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF
-                Serial.println("Trying to authenticate block 4 with default KEYA value");
-                uint8_t keya[6] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
-
-                // Start with block 4 (the first block of sector 1) since sector 0
-                // contains the manufacturer data and it's probably better just
-                // to leave it alone unless you know what you're doing
-                success = nfc.mifareclassic_AuthenticateBlock(uid, uidLength, 4, 0, keya);
-
-            if (success)
-            {
-                    Serial.println("Sector 1 (Blocks 4..7) has been authenticated");
-                    uint8_t data[16];
-
-                    // If you want to write something to block 4 to test with, uncomment
-                    // the following line and this text should be read back in a minute
-                    //memcpy(data, (const uint8_t[]){ 'a', 'd', 'a', 'f', 'r', 'u', 'i', 't', '.', 'c', 'o', 'm', 0, 0, 0, 0 }, sizeof data);
-                    // success = nfc.mifareclassic_WriteDataBlock (4, data);
-
-                    // Try to read the contents of block 4
-                    success = nfc.mifareclassic_ReadDataBlock(4, data);
-
-                if (success)
-                {
-                        // Data seems to have been read ... spit it out
-                        Serial.println("Reading Block 4:");
-                        nfc.PrintHexChar(data, 16);
-                        Serial.println("");
-
-                        //sprintf(text_radio_data, "Sector 1 (Blocks" );
-                        sprintf(text_nfc_data, "Success recognition count: %d\n", nfc_Success_count);
-                        sprintf(&text_nfc_data[strlen(text_nfc_data)], "Seems to be a Mifare Classic card (4 byte UID)\nUID Value: " );
-                        uint8_to_hexstr(uid, 4, &text_nfc_data[strlen(text_nfc_data)]);
-                        sprintf(&text_nfc_data[strlen(text_nfc_data)], "\nSector 1 (Blocks 4..7) has been authenticated" );
-
-                        set_nfc_message_label(text_nfc_data, 0);
-                        // Wait a bit before reading the card again
-                delay(1000);
-                }
-                else
-                {
-                Serial.println("Ooops ... unable to read the requested block.  Try another key?");
-                }
-            }
-            else
-            {
-                sprintf(text_nfc_data, "Success recognition count: %d\n", nfc_Success_count);
-                sprintf(&text_nfc_data[strlen(text_nfc_data)], "Seems to be a Mifare Ultralight tag (7 byte UID)\nUID Value: " );
-                uint8_to_hexstr(uid, 4, &text_nfc_data[strlen(text_nfc_data)]);
-                sprintf(&text_nfc_data[strlen(text_nfc_data)], "\nOoops ... authentication failed: Try another key?" );
-                set_nfc_message_label(text_nfc_data, 0);
-
-                Serial.println("Ooops ... authentication failed: Try another key?");
-            }
-            }
+            nfc.PrintHex(card.uid, card.uid_len);
 
-            if (uidLength == 7)
-            {
-                // We probably have a Mifare Ultralight card ...
-                Serial.println("Seems to be a Mifare Ultralight tag (7 byte UID)");
-
-                // Try to read the first general-purpose user page (#4)
-                Serial.println("Reading page 4");
-                uint8_t data[32];
-                success = nfc.mifareultralight_ReadPage (4, data);
-            if (success)
-            {
-                // Data seems to have been read ... spit it out
-                nfc.PrintHexChar(data, 4);
-                Serial.println("");
-                sprintf(text_nfc_data, "Success recognition count: %d\n", nfc_Success_count);
-                sprintf(&text_nfc_data[strlen(text_nfc_data)], "Seems to be a Mifare Ultralight tag (7 byte UID)\nUID Value: " );
-                uint8_to_hexstr(uid, 4, &text_nfc_data[strlen(text_nfc_data)]);
-                sprintf(&text_nfc_data[strlen(text_nfc_data)], "\nSector 1 (Blocks 4..7) has been authenticated" );
-                set_nfc_message_label(text_nfc_data, 0);
-                // Wait a bit before reading the card again
-                delay(1000);
-            }
-            else
-            {
-                sprintf(text_nfc_data, "Success recognition count: %d\n", nfc_Success_count);
-                sprintf(&text_nfc_data[strlen(text_nfc_data)], "Seems to be a Mifare Ultralight tag (7 byte UID)\nUID Value: " );
-                uint8_to_hexstr(uid, 4, &text_nfc_data[strlen(text_nfc_data)]);
-                sprintf(&text_nfc_data[strlen(text_nfc_data)], "\nOoops ... unable to read the requested page!?" );
-                set_nfc_message_label(text_nfc_data, 0);
-
-                Serial.println("Ooops ... unable to read the requested page!?");
+            sprintf(text_nfc_data, "Success recognition count: %d\n%s, UID: ", nfc_Success_count, nfc_card_type_name(card.type));
+            uint8_to_hexstr(card.uid, card.uid_len > 4 ? 4 : card.uid_len, &text_nfc_data[strlen(text_nfc_data)]);
+            if (card.size) {
+                sprintf(&text_nfc_data[strlen(text_nfc_data)], "\n%u bytes read in %u ms%s", card.size,
+                        (card.read_us + 500) / 1000, card.complete ? "" : ", some sectors locked");
             }
+            if (card.data_ok) {
+                Serial.println("First user data:");
+                nfc.PrintHexChar(card.data, 16);
+            } else if (card.type != NFC_CARD_OTHER) {
+                sprintf(&text_nfc_data[strlen(text_nfc_data)], "\nOoops ... unable to read the user data: Try another key?");
             }
+            // the whole card, from the dump cache
+            if (NFC_DUMP_SERIAL && card.size)
+                nfc_dump_print(card.uid, card.uid_len);
+            set_nfc_message_label(text_nfc_data);
         }
+
+        // woken early by the IRQ pin or by suspend_nfcTaskHandler()
+        ulTaskNotifyTake(pdTRUE, wait);
     }
 }
 
@@ -809,8 +872,6 @@ void mic_init(void)
 
 void SD_init(void)
 {
-    pinMode(PIN_SD_CS, OUTPUT);
-    digitalWrite(PIN_SD_CS, 1);
     SD_MMC.setPins(PIN_SD_SCK, PIN_SD_MOSI, PIN_SD_MISO);
     if (!SD_MMC.begin("/sdcard", true)) {
         Serial.println("Card Mount Failed");
@@ -862,13 +923,25 @@ void mic_spk_task(void *param)
     // FFT_Install();
     mic_init();
 
+    /* AFSK test: an APRS beacon from the speaker, the loop below decodes it from the mic */
+    if (afsk_modem_begin(SAMPLE_FREQ, "N0CALL", 0)) {
+        afsk_modem_send_position((char *)"0000.00N", (char *)"00000.00E", (char *)"T-Embed self test");
+    }
+
     while (1) {
         delay(5);
         // if (!wifi_init) {
         /* Microphone loopback test */
-        size_t bytes_read;
+        size_t bytes_read, bytes_written;
         i2s_read(I2S_NUM_0, &buffer, sizeof(buffer), &bytes_read, 15);
-        i2s_write(I2S_NUM_1, &buffer, sizeof(buffer), &bytes_read, 15);
+        size_t frames = bytes_read / (2 * sizeof(int16_t));
+        afsk_modem_rx((const int16_t *)buffer, frames);
+        // while the beacon goes out it replaces the loopback, one block per block read
+        if (afsk_modem_tx_busy()) {
+            frames = afsk_modem_tx((int16_t *)buffer, frames);
+            bytes_read = frames * 2 * sizeof(int16_t);
+        }
+        i2s_write(I2S_NUM_1, &buffer, bytes_read, &bytes_written, 15);
         // } else {
         //   delay(100);
         //   if (FFT_GetDataFlag()) {
@@ -897,8 +970,16 @@ void mic_fft_task(void *param)
     bool start_fft = false;
     FFT_Install();
     pinMode(PIN_ENCODE_BTN, INPUT);
+    int8_t fft_stat = task_stat_register("fft_task");
     while (1) {
-        delay(50);
+        task_stat_sleep(fft_stat);
+        // Frames arrive every hop (256 samples @ 16 kHz by default), wait for them instead of polling
+        if (start_fft) {
+            FFT_WaitData(pdMS_TO_TICKS(50));
+        } else {
+            xEventGroupWaitBits(global_event_group, FFT_READY, pdFALSE, pdFALSE, portMAX_DELAY);
+        }
+        task_stat_wake(fft_stat);
         EventBits_t bit = xEventGroupGetBits(global_event_group);
         /* Microphone test */
         if (bit & FFT_READY) {
@@ -921,7 +1002,8 @@ void mic_fft_task(void *param)
                     buffer[i] = FFT_GetAmplitude(i);
                 }
 
-                lv_msg_send(MSG_FFT_ID, buffer);
+                // copied into the mailbox, only the newest frame is drawn
+                ui_msg_post(MSG_FFT_ID, buffer, sizeof(buffer));
                 FFT_ClrDataFlag();
             }
         }
@@ -930,37 +1012,8 @@ void mic_fft_task(void *param)
 }
 
 
-// flag to indicate that a packet was received
-//volatile bool receivedFlag = false;
-// disable interrupt when it's not needed
-volatile bool enableInterrupt = true;
-// this function is called when a complete packet
-// is received by the module
-// IMPORTANT: this function MUST be 'void' type
-//            and MUST NOT have any arguments!
-void setFlag(void) {
-  // check if the interrupt is enabled
-  if(!enableInterrupt) {
-    return;
-  }
-
-    // we got a packet, set the flag
-    //receivedFlag = true;
-    radioTransmitFlag = true;
-}
-/*
-void setRadioFlag(void)
-{
-    radioTransmitFlag = true;
-}
-*/
 void radio_init(void)
 {
-    digitalWrite(PIN_SD_CS, HIGH);
-
-    pinMode(NFC_CS, OUTPUT);
-    digitalWrite(NFC_CS, HIGH);
-
     pinMode(RADIO_SW1_PIN, OUTPUT);
     pinMode(RADIO_SW0_PIN, OUTPUT);
     digitalWrite(RADIO_SW0_PIN, HIGH);
@@ -1020,13 +1073,14 @@ void radio_init(void)
         Serial.println(F("[CC1101] Selected sync word is invalid for this module!"));
         while (true);
     }
-    // set the function that will be called
-    // when new packet is received
-    radio.setGdo0Action(setFlag);
+    // packets are taken from the FIFO by the GDO0 interrupt, see radio_pipe.h
+    if (!radio_pipe_begin(&radio, spi_radio)) {
+        Serial.println(F("[CC1101] Packet pipe setup failed!"));
+    }
 
     // start listening for packets
     Serial.print(F("[CC1101] Starting to listen ... "));
-    state = radio.startReceive();
+    state = radio_pipe_start_rx();
     if (state == RADIOLIB_ERR_NONE) {
         Serial.println(F("success!"));
     } else {
@@ -1059,16 +1113,19 @@ void radio_power_cb(lv_event_t *e)
         Serial.println("invalid dBm params!");
         return;
     }
+    // one bus hold for the whole sequence, radio_task must not read the FIFO in between
+    if (!spi_bus_acquire(spi_radio)) {
+        Serial.println("radio bus not available!");
+        return;
+    }
     // set output power (accepted range is - 17 - 22 dBm)
     if (radio.setOutputPower(dBm[id]) == RADIOLIB_ERR_INVALID_OUTPUT_POWER) {
         Serial.println(F("Selected output power is invalid for this module!"));
     }
 
-    if (transmitFlag) {
-        radio.startTransmit("");
-    } else {
-        radio.startReceive();
-    }
+    // back to Rx, in Tx mode radio_task sends the next packet on time
+    radio_pipe_start_rx();
+    spi_bus_release(spi_radio);
 
     /*if (isRunning) {
         digitalWrite(RADIO_CS_PIN, LOW);
@@ -1122,73 +1179,40 @@ u_int32_t radio_tx_count = 0;
 u_int32_t radio_rx_count = 0;
 void radioTask(lv_timer_t *parent)
 {
-    char buf[256] = {0};
-
-    // check if the previous operation finished
-    if (radioTransmitFlag) {
-        // reset flag
-        radioTransmitFlag = false;
-        enableInterrupt = false;
-
-        if (transmitFlag) {
-            //TX
-            // the previous operation was transmission, listen for response
-            // print the result
-            if (transmissionState == RADIOLIB_ERR_NONE) {
-                // packet was successfully sent
-                Serial.println(F("transmission finished!"));
-                radio_tx_count++;
-            } else {
-                Serial.print(F("failed, code "));
-                Serial.println(transmissionState);
-            }
-
-            lv_snprintf(buf, 256, "[%u]:Tx %s", radio_tx_count, transmissionState == RADIOLIB_ERR_NONE ? "Successed" : "Failed");
-            set_text_radio_ta(buf, 0);
-            transmissionState = radio.startTransmit("Hello World!");
-        } else {
-            // RX
-            // the previous operation was reception
-            // print data and send another packet
-            String str;
-            int state = radio.readData(str);
-
-            if (state == RADIOLIB_ERR_NONE) {
-                radio_rx_count++;
-                // packet was successfully received
-                Serial.println(F("[SX1262] Received packet!"));
-
-                // print data of the packet
-                Serial.print(F("[SX1262] Data:\t\t"));
-                Serial.println(str);
-
-                // print RSSI (Received Signal Strength Indicator)
-                Serial.print(F("[SX1262] RSSI:\t\t"));
-                float rssi_t = radio.getRSSI();
-                Serial.print(rssi_t);
-                Serial.println(F(" dBm"));
-
-                /*Serial.print(F("[SX1262] SNR:\t\t"));
-                Serial.print(radio.getSNR());
-                Serial.println(F(" dB"));*/
-                /*char rssi_str[30] = {0};
-                float_to_str(rssi_t, 2, rssi_str);
-                Serial.printf("=float_to_str:%s=\n", rssi_str);*/
-
-                //lv_snprintf(buf, 256, "[%u]:Rx %s \nRSSI:%d.%d", radio_rx_count, str.c_str(), (int)rssi_t, (u16_t)((int)(rssi_t*100)%100));
-                lv_snprintf(buf, 256, "[%u]:Rx %s \n", radio_rx_count, str.c_str());
-                lv_snprintf(&buf[strlen(buf)], 256, "RSSI:%d.%d", (int)rssi_t, ((int)(rssi_t*100)%100)>0?((int)(rssi_t*100)%100):((int)(rssi_t*100)%100)*-1);
-                //lv_snprintf(&buf[strlen(buf)], 256, "RSSI:32.2356");
-                //Serial.printf("\n=====%s====\n", buf);
-                //lv_snprintf(buf, 256, "[%u]:Rx %s \nRSSI:%.2f", radio_rx_count, str.c_str(), radio.getRSSI());
-                //lv_snprintf(buf, 256, "[%d]:Rx %s \nRSSI:%s dBm", radio_rx_count, str.c_str(), rssi_str);
-                //sprintf(buf, "[%d]:Rx %s \nRSSI:%s dBm", radio_rx_count, str.c_str(), rssi_str);
-                set_text_radio_ta(buf, 0);
-            }
+    static uint32_t last_tx_ms = 0;
+    static uint32_t last_tx_count = 0;
+    char buf[128];
+    const radio_pkt_t *pkt;
+    radio_pipe_stat_t stat;
+
+    radio_pipe_service();
+
+    // only the newest packet is shown, the rest is counted
+    int shown = 0;
+    while ((pkt = radio_pipe_peek()) != NULL) {
+        radio_rx_count++;
+        int rssi = (int)(pkt->rssi * 10);
+        shown = lv_snprintf(buf, sizeof(buf), "[%u]:Rx %.*s \nRSSI:%s%d.%d LQI:%u", radio_rx_count, pkt->len,
+                            (const char *)pkt->data, rssi < 0 ? "-" : "", abs(rssi) / 10, abs(rssi) % 10, pkt->lqi);
+        radio_pipe_release();
+    }
+    if (shown)
+        set_text_radio_ta(buf);
 
-            radio.startReceive();
-        }
-        enableInterrupt = true;
+    if (!transmitFlag)
+        return;
+    radio_pipe_get_stat(&stat);
+    if (stat.tx_packets != last_tx_count) {
+        radio_tx_count += stat.tx_packets - last_tx_count;
+        last_tx_count = stat.tx_packets;
+        lv_snprintf(buf, sizeof(buf), "[%u]:Tx Successed", radio_tx_count);
+        set_text_radio_ta(buf);
+    }
+    if (!radio_pipe_tx_busy() && millis() - last_tx_ms >= radio_task_delay_ms) {
+        static const char hello[] = "Hello World!";
+        last_tx_ms = millis();
+        if (radio_pipe_send((const uint8_t *)hello, sizeof(hello) - 1) != RADIOLIB_ERR_NONE)
+            set_text_radio_ta("Tx Failed");
     }
 }
 
@@ -1201,27 +1225,25 @@ void radio_rxtx_cb(lv_event_t *e)
     Serial.printf("Option: %s id:%u\n", buf, id);
     switch (id) {
     case 0:
-        digitalWrite(RADIO_CS_PIN, LOW);
         //lv_timer_resume(transmitTask);
         // TX
         // send the first packet on this node
-        Serial.print(F("[Radio] Sending first packet ... "));
-        transmissionState = radio.startTransmit("Hello World!");
+        Serial.println(F("[Radio] Sending packets ... "));
         transmitFlag = true;
+        radio_pipe_start_rx();
         resume_radioTaskHandler();
         break;
     case 1:
-        digitalWrite(RADIO_CS_PIN, LOW);
         //lv_timer_resume(transmitTask);
         // RX
         Serial.print(F("[Radio] Starting to listen ... "));
-        if (radio.startReceive() == RADIOLIB_ERR_NONE) {
+        if (radio_pipe_start_rx() == RADIOLIB_ERR_NONE) {
             Serial.println(F("success!"));
         } else {
             Serial.println(F("failed "));
         }
         transmitFlag = false;
-        set_text_radio_ta("[RX]:Listening.", 0);
+        set_text_radio_ta("[RX]:Listening.");
         resume_radioTaskHandler();
         break;
     case 2:
@@ -1231,6 +1253,7 @@ void radio_rxtx_cb(lv_event_t *e)
             lv_timer_pause(transmitTask);
             radio.standby();
         }*/
+        radio_pipe_standby();
         suspend_radioTaskHandler();
         break;
     default:
@@ -1260,17 +1283,19 @@ void radio_bandwidth_cb(lv_event_t *e)
         radio.standby();
     }*/
 
-    radio.standby();
+    if (!spi_bus_acquire(spi_radio)) {
+        Serial.println("radio bus not available!");
+        return;
+    }
+    radio_pipe_standby();
     // set bandwidth
     if (radio.setRxBandwidth(bw[id]) == RADIOLIB_ERR_INVALID_BANDWIDTH) {
         Serial.println(F("Selected bandwidth is invalid for this module!"));
     }
 
-    if (transmitFlag) {
-        radio.startTransmit("");
-    } else {
-        radio.startReceive();
-    }
+    // back to Rx, in Tx mode radio_task sends the next packet on time
+    radio_pipe_start_rx();
+    spi_bus_release(spi_radio);
 
     /*if (isRunning) {
         digitalWrite(RADIO_CS_PIN, LOW);
@@ -1313,17 +1338,17 @@ void radio_freq_cb(lv_event_t *e)
          digitalWrite(RADIO_CS_PIN, HIGH);
          lv_timer_pause(transmitTask);
      }*/
-    digitalWrite(RADIO_CS_PIN, HIGH);
-
+    if (!spi_bus_acquire(spi_radio)) {
+        Serial.println("radio bus not available!");
+        return;
+    }
     if (radio.setFrequency(freq[id]) == RADIOLIB_ERR_INVALID_FREQUENCY) {
         Serial.println(F("Selected frequency is invalid for this module!"));
     }
 
-    if (transmitFlag) {
-        radio.startTransmit("");
-    } else {
-        radio.startReceive();
-    }
+    // back to Rx, in Tx mode radio_task sends the next packet on time
+    radio_pipe_start_rx();
+    spi_bus_release(spi_radio);
 
     /*if (isRunning) {
         digitalWrite(RADIO_CS_PIN, LOW);
@@ -0,0 +1,567 @@
+#include "gif_cache.h"
+#include "Arduino.h"
+#include "lz4_block.h"
+#include <atomic>
+#include <new>
+
+#define PX LV_IMG_PX_SIZE_ALPHA_BYTE // gifdec canvas: color + alpha
+#define SPAN_HEADER 6                // y, x, length, 16 bit each
+#define PALETTE_MAP 1024             // hash slots of the palette lookup, > 256
+
+// What the UI does with the next frame
+enum { GIF_FOLLOW = 0, GIF_REPLAY, GIF_DECODE, GIF_DONE };
+// Where the recorder task is
+enum { REC_RUNNING = 0, REC_LOOPED, REC_ENDED, REC_FAILED };
+
+typedef struct {
+  uint8_t *delta;  // LZ4 packed spans, PSRAM
+  uint32_t size;
+  uint32_t raw;    // spans unpacked
+  lv_area_t area;  // changed pixels in image coordinates, empty (x2 < x1) if none
+  uint32_t hash;   // canvas after the frame
+  uint16_t delay;  // ms to show the frame
+  bool indexed;    // span pixels are palette indices
+} gif_frame_t;
+
+typedef struct {
+  // UI
+  lv_obj_t *obj;
+  gd_GIF *gif;       // its canvas is shown, it decodes only if nothing is recorded
+  lv_img_dsc_t dsc;
+  lv_timer_t *timer;
+  uint32_t last_call;
+  uint16_t delay;
+  uint8_t mode;
+  uint16_t seq;      // frames shown in the order they were recorded
+  uint16_t pos;      // next frame of the loop when replaying
+  int32_t loops;     // gifdec loop_count when replaying started
+  uint16_t played;   // loops shown to the end
+  uint8_t *spans;    // unpacked spans
+  bool recording;    // the recorder task has not been joined yet
+  SemaphoreHandle_t done; // given by the recorder task when it ends
+
+  // Written by the recorder, read by the UI once 'ready' or 'state' say so
+  gif_frame_t *frames;
+  uint16_t loop_len; // frames of a loop, 0 before the first one ended
+  uint16_t wrap_len; // frames of the second loop recorded before it repeats the first one
+  int32_t rec_loops; // gifdec loop_count when the second loop repeated the first one
+  uint8_t palette[256 * PX]; // canvas pixels met in the spans, only added to
+  std::atomic<uint16_t> ready; // frames recorded
+  std::atomic<uint8_t> state;
+  std::atomic<bool> stop;
+
+  // Recorder only, until it is joined
+  gd_GIF *rec;
+  uint16_t count;    // frames recorded
+  uint32_t span_cap;
+  uint8_t *rec_spans;
+  uint8_t *shadow;   // canvas before the frame
+  uint8_t *packed;   // pack buffer
+  uint32_t *table;   // LZ4 hash table
+  uint16_t *map;     // pixel hash -> palette index + 1
+  uint8_t *indices;  // palette indices of a frame
+  uint32_t hash;     // of the canvas
+  uint16_t colors;
+} gif_player_t;
+
+typedef struct {
+  uint32_t recorded;  // recorder task: decode, diff and pack
+  uint32_t record_us;
+  uint32_t record_max_us;
+  uint32_t shown;     // UI: frames unpacked from the cache
+  uint32_t show_us;
+  uint32_t show_max_us;
+  uint32_t waits;     // UI timer calls that found the recorder behind
+  uint32_t decoded;   // UI: frames decoded like lv_gif, nothing recorded
+  uint32_t decode_us;
+  uint32_t decode_max_us;
+  uint32_t px_shown;  // image pixels of the frames shown
+  uint32_t px_redrawn;
+  uint32_t fallbacks;
+} gif_cache_stat_t;
+
+static gif_cache_stat_t stat;
+static gif_cache_stat_t stat_last;
+static uint32_t cache_bytes = 0, cache_raw = 0; // added by the recorder, taken off by the UI once it is joined
+
+static uint32_t now_us(void) { return (uint32_t)esp_timer_get_time(); }
+
+static void add_time(uint32_t *sum, uint32_t *max, uint32_t start) {
+  uint32_t t = now_us() - start;
+  *sum += t;
+  if (t > *max)
+    *max = t;
+}
+
+// The canvas hash is the sum of the pixel hashes, so a frame updates it with
+// its changed pixels only
+static uint32_t px_hash(uint32_t pos, const uint8_t *px) {
+  uint32_t h = 0;
+  memcpy(&h, px, PX);
+  h = (h ^ (pos * 0x9e3779b9u)) * 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  return h ^ (h >> 16);
+}
+
+static void free_recording(gif_player_t *p) {
+  if (p->rec)
+    gd_close_gif(p->rec);
+  heap_caps_free(p->rec_spans);
+  heap_caps_free(p->shadow);
+  heap_caps_free(p->packed);
+  heap_caps_free(p->table);
+  heap_caps_free(p->map);
+  heap_caps_free(p->indices);
+  p->rec = NULL;
+  p->rec_spans = p->shadow = p->packed = p->indices = NULL;
+  p->table = NULL;
+  p->map = NULL;
+}
+
+// Waits for the recorder task to end, it stops after the frame it is on
+static void join_recorder(gif_player_t *p) {
+  if (!p->recording)
+    return;
+  xSemaphoreTake(p->done, portMAX_DELAY);
+  p->recording = false;
+}
+
+static void free_frames(gif_player_t *p) {
+  if (p->frames == NULL)
+    return;
+  for (uint16_t i = 0; i < p->count; i++) {
+    heap_caps_free(p->frames[i].delta);
+    cache_bytes -= p->frames[i].size;
+    cache_raw -= p->frames[i].raw;
+  }
+  heap_caps_free(p->frames);
+  p->frames = NULL;
+  p->count = 0;
+}
+
+// Nothing (more) to play from the cache, decode every frame from now on. The
+// decoder of the shown canvas has not moved yet, the animation starts over.
+static void fall_back(gif_player_t *p) {
+  join_recorder(p);
+  free_recording(p);
+  free_frames(p);
+  heap_caps_free(p->spans);
+  p->spans = NULL;
+  p->mode = GIF_DECODE;
+  stat.fallbacks++;
+}
+
+static void show(gif_player_t *p, const lv_area_t *area) {
+  uint32_t w = p->gif->width, h = p->gif->height;
+  stat.px_shown += w * h;
+  lv_img_cache_invalidate_src(&p->dsc);
+  if (area == NULL || lv_img_get_zoom(p->obj) != LV_IMG_ZOOM_NONE || lv_img_get_angle(p->obj) != 0) {
+    stat.px_redrawn += w * h;
+    lv_obj_invalidate(p->obj);
+    return;
+  }
+  if (area->x2 < area->x1)
+    return; // nothing changed
+  stat.px_redrawn += lv_area_get_size(area);
+  lv_area_t a = *area;
+  lv_area_move(&a, p->obj->coords.x1, p->obj->coords.y1);
+  lv_obj_invalidate_area(p->obj, &a);
+}
+
+// The last frame stays on the canvas, the cache is of no use any more
+static void finish(gif_player_t *p) {
+  p->stop.store(true, std::memory_order_relaxed);
+  join_recorder(p);
+  free_recording(p);
+  free_frames(p);
+  heap_caps_free(p->spans);
+  p->spans = NULL;
+  p->mode = GIF_DONE;
+  lv_timer_pause(p->timer);
+  lv_event_send(p->obj, LV_EVENT_READY, NULL);
+}
+
+// Spans of the pixels that differ from the shadow canvas, the shadow and the
+// canvas hash are updated
+static uint32_t diff(gif_player_t *p, lv_area_t *area) {
+  uint32_t w = p->rec->width, h = p->rec->height, stride = w * PX;
+  const uint8_t *canvas = p->rec->canvas;
+  uint8_t *out = p->rec_spans;
+  area->x1 = w;
+  area->y1 = h;
+  area->x2 = -1;
+  area->y2 = -1;
+  for (uint32_t y = 0; y < h; y++) {
+    const uint8_t *row = canvas + y * stride;
+    uint8_t *old = p->shadow + y * stride;
+    if (memcmp(row, old, stride) == 0)
+      continue;
+    uint32_t x = 0;
+    while (x < w) {
+      if (memcmp(row + x * PX, old + x * PX, PX) == 0) {
+        x++;
+        continue;
+      }
+      uint32_t start = x, last = x;
+      for (; x < w && x - last <= GIF_CACHE_SPAN_GAP; x++) {
+        if (memcmp(row + x * PX, old + x * PX, PX) != 0) {
+          p->hash += px_hash(y * w + x, row + x * PX) - px_hash(y * w + x, old + x * PX);
+          last = x;
+        }
+      }
+      uint32_t len = last - start + 1;
+      uint16_t hdr[3] = {(uint16_t)y, (uint16_t)start, (uint16_t)len};
+      memcpy(out, hdr, SPAN_HEADER);
+      memcpy(out + SPAN_HEADER, row + start * PX, len * PX);
+      memcpy(old + start * PX, row + start * PX, len * PX);
+      out += SPAN_HEADER + len * PX;
+      if ((lv_coord_t)start < area->x1)
+        area->x1 = start;
+      if ((lv_coord_t)last > area->x2)
+        area->x2 = last;
+      if (area->y1 > (lv_coord_t)y)
+        area->y1 = y;
+      area->y2 = y;
+      x = last + 1;
+    }
+  }
+  return out - p->rec_spans;
+}
+
+// Palette index of a canvas pixel, added if new; -1 when the palette is full
+static int16_t color_index(gif_player_t *p, const uint8_t *px) {
+  uint32_t v = 0;
+  memcpy(&v, px, PX);
+  uint32_t slot = (v * 2654435761u) >> 22; // 10 bits, PALETTE_MAP slots
+  while (p->map[slot]) {
+    uint16_t i = p->map[slot] - 1;
+    if (memcmp(&p->palette[i * PX], px, PX) == 0)
+      return i;
+    slot = (slot + 1) & (PALETTE_MAP - 1);
+  }
+  if (p->colors == 256)
+    return -1;
+  memcpy(&p->palette[p->colors * PX], px, PX);
+  p->map[slot] = ++p->colors;
+  return p->colors - 1;
+}
+
+// Replaces the span pixels by palette indices, false if they do not fit the palette
+static bool index_spans(gif_player_t *p, uint32_t *len) {
+  const uint8_t *in = p->rec_spans, *end = p->rec_spans + *len;
+  uint8_t *idx = p->indices;
+  uint32_t last = 0xffffffff; // runs of one color are common
+  int16_t last_idx = 0;
+  while (in < end) {
+    uint16_t hdr[3];
+    memcpy(hdr, in, SPAN_HEADER);
+    in += SPAN_HEADER;
+    for (uint32_t i = 0; i < hdr[2]; i++, in += PX) {
+      uint32_t v = 0;
+      memcpy(&v, in, PX);
+      if (v != last) {
+        last_idx = color_index(p, in);
+        if (last_idx < 0)
+          return false;
+        last = v;
+      }
+      *idx++ = last_idx;
+    }
+  }
+  uint8_t *out = p->rec_spans;
+  idx = p->indices;
+  in = p->rec_spans;
+  while (in < end) {
+    uint16_t hdr[3];
+    memcpy(hdr, in, SPAN_HEADER);
+    memmove(out, in, SPAN_HEADER);
+    in += SPAN_HEADER + hdr[2] * PX;
+    out += SPAN_HEADER;
+    memcpy(out, idx, hdr[2]);
+    out += hdr[2];
+    idx += hdr[2];
+  }
+  *len = out - p->rec_spans;
+  return true;
+}
+
+static void apply(gif_player_t *p, uint32_t len, bool indexed) {
+  uint32_t stride = p->gif->width * PX;
+  const uint8_t *in = p->spans, *end = p->spans + len;
+  while (in < end) {
+    uint16_t hdr[3];
+    memcpy(hdr, in, SPAN_HEADER);
+    uint8_t *dst = p->gif->canvas + hdr[0] * stride + hdr[1] * PX;
+    in += SPAN_HEADER;
+    if (indexed) {
+      for (uint32_t i = 0; i < hdr[2]; i++, dst += PX)
+        memcpy(dst, &p->palette[*in++ * PX], PX);
+    } else {
+      memcpy(dst, in, hdr[2] * PX);
+      in += hdr[2] * PX;
+    }
+  }
+}
+
+// Decodes and records the next frame on the recorder task, REC_RUNNING while
+// the loop is not known yet
+static uint8_t record_frame(gif_player_t *p) {
+  gd_GIF *gif = p->rec;
+  uint32_t start = now_us();
+  uint32_t read_pos = gif->f_rw_p;
+  if (gd_get_frame(gif) <= 0)
+    return REC_ENDED;
+  bool wrapped = gif->f_rw_p < read_pos; // gifdec went back to the first frame
+  gd_render_frame(gif, gif->canvas);
+  if (wrapped) {
+    if (p->loop_len)
+      return REC_FAILED; // the second loop never repeated the first one
+    p->loop_len = p->count;
+  }
+  if (p->count == GIF_CACHE_MAX_FRAMES)
+    return REC_FAILED;
+  gif_frame_t *f = &p->frames[p->count];
+  uint32_t raw = diff(p, &f->area);
+  f->indexed = index_spans(p, &raw);
+  uint32_t size = lz4_block_pack(p->rec_spans, raw, p->packed, LZ4_BLOCK_BOUND(p->span_cap), p->table);
+  f->delta = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+  if (f->delta == NULL)
+    return REC_FAILED;
+  memcpy(f->delta, p->packed, size);
+  f->size = size;
+  f->raw = raw;
+  f->delay = gif->gce.delay * 10;
+  f->hash = p->hash;
+  cache_bytes += size;
+  cache_raw += raw;
+
+  uint8_t state = REC_RUNNING;
+  if (p->loop_len) {
+    uint16_t i = p->count - p->loop_len; // frame of the second loop
+    if (f->hash == p->frames[i].hash) {
+      // same canvas as in the first loop, the rest of the loop is known
+      p->wrap_len = i + 1;
+      p->rec_loops = gif->loop_count;
+      state = REC_LOOPED;
+    }
+  }
+  p->count++;
+  stat.recorded++;
+  add_time(&stat.record_us, &stat.record_max_us, start);
+  p->ready.store(p->count, std::memory_order_release);
+  return state;
+}
+
+static void record_task(void *param) {
+  gif_player_t *p = (gif_player_t *)param;
+  uint8_t state = REC_RUNNING;
+  while (state == REC_RUNNING && !p->stop.load(std::memory_order_relaxed))
+    state = record_frame(p);
+  free_recording(p);
+  p->state.store(state == REC_RUNNING ? REC_FAILED : state, std::memory_order_release);
+  xSemaphoreGive(p->done);
+  vTaskDelete(NULL);
+}
+
+// Unpacks a recorded frame into the shown canvas
+static void show_frame(gif_player_t *p, const gif_frame_t *f) {
+  uint32_t start = now_us();
+  if (!lz4_block_unpack(f->delta, f->size, p->spans, f->raw)) {
+    finish(p);
+    return;
+  }
+  apply(p, f->raw, f->indexed);
+  stat.shown++;
+  add_time(&stat.show_us, &stat.show_max_us, start);
+  p->delay = f->delay;
+  show(p, &f->area);
+}
+
+static void replay_frame(gif_player_t *p) {
+  if (p->pos == p->loop_len) {
+    // what gifdec does at the trailer
+    if (p->loops == 1 || p->loops < 0) {
+      finish(p);
+      return;
+    }
+    if (p->loops > 1)
+      p->loops--;
+    p->pos = 0;
+    p->played++;
+  }
+  const gif_frame_t *f = &p->frames[p->pos < p->wrap_len ? p->loop_len + p->pos : p->pos];
+  p->pos++;
+  show_frame(p, f);
+}
+
+// What lv_gif does
+static void decode_frame(gif_player_t *p) {
+  gd_GIF *gif = p->gif;
+  uint32_t start = now_us();
+  uint32_t read_pos = gif->f_rw_p;
+  if (gd_get_frame(gif) <= 0) {
+    finish(p);
+    return;
+  }
+  if (gif->f_rw_p < read_pos)
+    p->played++;
+  gd_render_frame(gif, gif->canvas);
+  stat.decoded++;
+  add_time(&stat.decode_us, &stat.decode_max_us, start);
+  p->delay = gif->gce.delay * 10;
+  show(p, NULL);
+}
+
+// The frames in the order they are recorded: the first loop and the start of
+// the second one, then replay takes over
+static void follow_frame(gif_player_t *p) {
+  uint8_t state = p->state.load(std::memory_order_acquire);
+  uint16_t ready = p->ready.load(std::memory_order_acquire);
+  if (state == REC_LOOPED && p->seq == p->loop_len + p->wrap_len) {
+    join_recorder(p);
+    p->pos = p->wrap_len;
+    p->loops = p->rec_loops;
+    p->mode = GIF_REPLAY;
+    replay_frame(p);
+    return;
+  }
+  if (p->seq == ready) {
+    if (state == REC_ENDED) {
+      finish(p);
+    } else if (state == REC_FAILED) {
+      fall_back(p);
+      decode_frame(p);
+    } else {
+      // the recorder is behind: keep the frame, look again at the next timer call
+      stat.waits++;
+      p->delay = 0;
+    }
+    return;
+  }
+  if (p->loop_len && p->seq == p->loop_len)
+    p->played++;
+  show_frame(p, &p->frames[p->seq++]);
+}
+
+static void next_frame(lv_timer_t *t) {
+  gif_player_t *p = (gif_player_t *)t->user_data;
+  if (lv_tick_elaps(p->last_call) < p->delay)
+    return;
+  p->last_call = lv_tick_get();
+  if (p->mode == GIF_FOLLOW)
+    follow_frame(p);
+  else if (p->mode == GIF_REPLAY)
+    replay_frame(p);
+  else if (p->mode == GIF_DECODE)
+    decode_frame(p);
+}
+
+static void delete_cb(lv_event_t *e) {
+  gif_player_t *p = (gif_player_t *)lv_event_get_user_data(e);
+  p->stop.store(true, std::memory_order_relaxed);
+  join_recorder(p);
+  lv_timer_del(p->timer);
+  lv_img_cache_invalidate_src(&p->dsc);
+  free_recording(p);
+  free_frames(p);
+  heap_caps_free(p->spans);
+  if (p->done)
+    vSemaphoreDelete(p->done);
+  gd_close_gif(p->gif);
+  heap_caps_free(p);
+}
+
+lv_obj_t *gif_cache_create(lv_obj_t *parent, const lv_img_dsc_t *src) {
+  lv_obj_t *obj = lv_img_create(parent);
+  void *mem = heap_caps_malloc(sizeof(gif_player_t), MALLOC_CAP_SPIRAM);
+  if (mem == NULL)
+    return obj;
+  gif_player_t *p = new (mem) gif_player_t();
+  p->gif = gd_open_gif_data(src->data);
+  if (p->gif == NULL) {
+    heap_caps_free(p);
+    return obj;
+  }
+  gd_GIF *gif = p->gif;
+  p->obj = obj;
+  lv_obj_set_user_data(obj, p);
+  p->dsc.header.always_zero = 0;
+  p->dsc.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+  p->dsc.header.w = gif->width;
+  p->dsc.header.h = gif->height;
+  p->dsc.data = gif->canvas;
+  p->dsc.data_size = gif->width * gif->height * PX;
+
+  // Worst case: every pixel changed, one span every GIF_CACHE_SPAN_GAP + 1 pixels
+  uint32_t canvas_size = gif->width * gif->height * PX;
+  p->span_cap = canvas_size + gif->height * SPAN_HEADER * (gif->width / (GIF_CACHE_SPAN_GAP + 1) + 1);
+  // The recorder decodes with its own gifdec, from the same start
+  p->rec = gd_open_gif_data(src->data);
+  p->frames = (gif_frame_t *)heap_caps_calloc(GIF_CACHE_MAX_FRAMES, sizeof(gif_frame_t), MALLOC_CAP_SPIRAM);
+  p->spans = (uint8_t *)heap_caps_malloc(p->span_cap, MALLOC_CAP_SPIRAM);
+  p->rec_spans = (uint8_t *)heap_caps_malloc(p->span_cap, MALLOC_CAP_SPIRAM);
+  p->shadow = (uint8_t *)heap_caps_malloc(canvas_size, MALLOC_CAP_SPIRAM);
+  p->packed = (uint8_t *)heap_caps_malloc(LZ4_BLOCK_BOUND(p->span_cap), MALLOC_CAP_SPIRAM);
+  p->table = (uint32_t *)heap_caps_malloc(LZ4_BLOCK_TABLE_SIZE, MALLOC_CAP_SPIRAM);
+  p->map = (uint16_t *)heap_caps_calloc(PALETTE_MAP, sizeof(uint16_t), MALLOC_CAP_SPIRAM);
+  p->indices = (uint8_t *)heap_caps_malloc(gif->width * gif->height, MALLOC_CAP_SPIRAM);
+  p->done = xSemaphoreCreateBinary();
+  if (p->rec && p->frames && p->spans && p->rec_spans && p->shadow && p->packed && p->table && p->map &&
+      p->indices && p->done) {
+    memcpy(p->shadow, p->rec->canvas, canvas_size);
+    for (uint32_t i = 0; i < gif->width * gif->height; i++)
+      p->hash += px_hash(i, p->rec->canvas + i * PX);
+    p->mode = GIF_FOLLOW;
+    p->recording = xTaskCreatePinnedToCore(record_task, "gif_record", GIF_CACHE_TASK_STACK, p, GIF_CACHE_TASK_PRIO,
+                                           NULL, GIF_CACHE_TASK_CORE) == pdPASS;
+  }
+  if (!p->recording)
+    fall_back(p);
+
+  lv_img_set_src(obj, &p->dsc);
+  lv_obj_add_event_cb(obj, delete_cb, LV_EVENT_DELETE, p);
+  p->timer = lv_timer_create(next_frame, 10, p);
+  p->last_call = lv_tick_get();
+  next_frame(p->timer);
+  return obj;
+}
+
+int32_t gif_cache_loops(lv_obj_t *obj) {
+  gif_player_t *p = (gif_player_t *)lv_obj_get_user_data(obj);
+  if (p == NULL || p->mode == GIF_DONE)
+    return -1;
+  return p->played;
+}
+
+void gif_cache_report(void) {
+  gif_cache_stat_t s = stat;
+  stat.record_max_us = 0;
+  stat.show_max_us = 0;
+  stat.decode_max_us = 0;
+  uint32_t recorded = s.recorded - stat_last.recorded, shown = s.shown - stat_last.shown;
+  uint32_t decoded = s.decoded - stat_last.decoded;
+  if (recorded == 0 && shown == 0 && decoded == 0) {
+    stat_last = s;
+    return;
+  }
+  Serial.printf("gif %u frames recorded", recorded);
+  if (recorded)
+    Serial.printf(" avg %u us max %u us off the UI", (s.record_us - stat_last.record_us) / recorded, s.record_max_us);
+  Serial.printf(", %u shown from the cache", shown);
+  if (shown)
+    Serial.printf(" avg %u us max %u us", (s.show_us - stat_last.show_us) / shown, s.show_max_us);
+  if (s.waits != stat_last.waits)
+    Serial.printf(", %u waits for the recorder", s.waits - stat_last.waits);
+  if (decoded)
+    Serial.printf(", %u decoded avg %u us max %u us", decoded, (s.decode_us - stat_last.decode_us) / decoded,
+                  s.decode_max_us);
+  uint32_t px = s.px_shown - stat_last.px_shown;
+  if (px)
+    Serial.printf(", redrawn %u%% of the image", (uint32_t)((uint64_t)(s.px_redrawn - stat_last.px_redrawn) * 100 / px));
+  Serial.printf(", cache %u KB (%u KB of spans)", cache_bytes / 1024, cache_raw / 1024);
+  if (s.fallbacks != stat_last.fallbacks)
+    Serial.printf(", %u players not cached", s.fallbacks - stat_last.fallbacks);
+  Serial.println();
+  stat_last = s;
+}
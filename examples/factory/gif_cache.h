@@ -0,0 +1,38 @@
+#pragma once
+#include "lvgl.h"
+
+/**
+ * GIF playback from a cache of frame deltas.
+ *
+ * lv_gif runs gifdec on every frame of every loop (LZW decode and palette
+ * conversion on the UI task) and invalidates the whole image each time. This
+ * player leaves the decoding to a recorder task of low priority on the other
+ * core. It decodes each frame once, diffs the canvas against the previous one
+ * and keeps the changed pixels as row spans, LZ4 packed in PSRAM, with their
+ * bounding rectangle. The UI only unpacks the spans into the shown canvas and
+ * invalidates that rectangle, from the first loop on. When the recorder falls
+ * behind, the UI keeps the current frame longer instead of decoding.
+ *
+ * Frames drawn over transparent pixels keep what the previous loop left, so
+ * the second loop does not always start like the first one. It is recorded
+ * too until its canvas matches the first loop again, then the recorder ends
+ * and the deltas of the first loop are replayed. If that does not happen
+ * within the second loop or the cache does not fit, the player starts over
+ * decoding on the UI like lv_gif does.
+ *
+ * Only image variables (lv_img_dsc_t holding the GIF file) are played. Sends
+ * LV_EVENT_READY after the last loop like lv_gif. Deleting the object waits
+ * for the recorder to finish the frame it is on.
+ */
+
+#define GIF_CACHE_MAX_FRAMES 256 // deltas per animation: first loop + the start of the second one
+#define GIF_CACHE_SPAN_GAP   8   // unchanged pixels joining two spans of a row rather than splitting them
+#define GIF_CACHE_TASK_PRIO  1   // recorder task, as low as the FFT task
+#define GIF_CACHE_TASK_CORE  0   // the UI runs on core 1
+#define GIF_CACHE_TASK_STACK (1024 * 4)
+
+lv_obj_t *gif_cache_create(lv_obj_t *parent, const lv_img_dsc_t *src);
+/* Loops shown to the end, -1 once the GIF has ended or if obj plays nothing */
+int32_t gif_cache_loops(lv_obj_t *obj);
+/* Frames recorded and shown since the last call: time per frame, waits for the recorder, area redrawn, cache size */
+void gif_cache_report(void);
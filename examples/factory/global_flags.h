@@ -21,6 +21,7 @@
 #define WAV_RING_1               _BV(2) // Beep
 #define FFT_READY                _BV(3)
 #define FFT_STOP                 _BV(4)
+#define WAV_WAKE                 _BV(5) // play_music_queue or play_time_queue has data
 /*******************app msg**********************/
 
 #define MSG_MENU_NAME_CHANGED    100
@@ -36,4 +37,8 @@
 #define MSG_MUSIC_TIME_ID        300
 #define MSG_MUSIC_TIME_END_ID    301
 
-#define MSG_FFT_ID               400
\ No newline at end of file
+#define MSG_FFT_ID               400
+
+#define MSG_RADIO_TEXT_ID        500
+#define MSG_NFC_TEXT_ID          501
+#define MSG_TEXT_MAX_LEN         256
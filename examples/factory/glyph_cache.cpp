@@ -0,0 +1,260 @@
+#include "glyph_cache.h"
+#include "Arduino.h"
+
+extern const uint8_t _lv_bpp1_opa_table[2];
+extern const uint8_t _lv_bpp2_opa_table[4];
+extern const uint8_t _lv_bpp4_opa_table[16];
+
+typedef struct glyph_s {
+  struct glyph_s *next; // hash chain
+  uint32_t letter;      // key
+  uint32_t size;        // bytes allocated, header included
+  uint32_t last_use;    // LRU stamp
+  bool pinned;
+  bool drawn;           // handed to LVGL since rendered
+} glyph_t;              // followed by box_w * box_h opacities
+
+typedef struct {
+  lv_font_t font;       // the copy handed out, first so the callbacks can cast back
+  const lv_font_t *orig;
+  glyph_t *buckets[GLYPH_CACHE_BUCKETS];
+  glyph_t *current;     // last glyph described as 8 bpp, its bitmap is asked next
+  glyph_cache_stat_t stat;
+  glyph_cache_stat_t stat_last;
+  uint32_t renders;
+  uint32_t renders_last;
+} glyph_font_t;
+
+typedef struct {
+  uint32_t draws;
+  uint32_t total_us;
+  uint32_t max_us;
+} label_stat_t;
+
+static glyph_font_t fonts[GLYPH_CACHE_MAX_FONTS];
+static uint8_t font_count = 0;
+static uint32_t use_clock = 0;
+static label_stat_t label_stat;
+static int64_t label_start;
+
+static uint8_t *bitmap(glyph_t *g) { return (uint8_t *)(g + 1); }
+
+static glyph_t *find(glyph_font_t *f, uint32_t letter) {
+  for (glyph_t *g = f->buckets[letter % GLYPH_CACHE_BUCKETS]; g; g = g->next)
+    if (g->letter == letter)
+      return g;
+  return NULL;
+}
+
+// Link pointing to the least recently used glyph that is not pinned
+static glyph_t **lru_victim(glyph_font_t *f) {
+  glyph_t **victim = NULL;
+  for (uint8_t i = 0; i < GLYPH_CACHE_BUCKETS; i++)
+    for (glyph_t **link = &f->buckets[i]; *link; link = &(*link)->next)
+      if (!(*link)->pinned && (victim == NULL || (*link)->last_use < (*victim)->last_use))
+        victim = link;
+  return victim;
+}
+
+static void evict(glyph_font_t *f, glyph_t **link) {
+  glyph_t *g = *link;
+  *link = g->next;
+  if (f->current == g)
+    f->current = NULL;
+  f->stat.used -= g->size;
+  f->stat.evictions++;
+  heap_caps_free(g);
+}
+
+// Rows of a font bitmap are not padded, pixels are packed MSB first
+static void expand(const uint8_t *src, uint8_t bpp, uint32_t n, uint8_t *out) {
+  if (bpp == 8) {
+    memcpy(out, src, n);
+    return;
+  }
+  const uint8_t *table = bpp == 1 ? _lv_bpp1_opa_table : bpp == 2 ? _lv_bpp2_opa_table : _lv_bpp4_opa_table;
+  uint8_t mask = (1 << bpp) - 1;
+  uint8_t shift = 8;
+  for (uint32_t i = 0; i < n; i++) {
+    shift -= bpp;
+    out[i] = table[(*src >> shift) & mask];
+    if (shift == 0) {
+      shift = 8;
+      src++;
+    }
+  }
+}
+
+static glyph_t *render(glyph_font_t *f, uint32_t letter, const lv_font_glyph_dsc_t *dsc) {
+  // 3 bpp glyphs are stored like 4 bpp ones, LVGL draws them so too
+  uint8_t bpp = dsc->bpp == 3 ? 4 : dsc->bpp;
+  if (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8)
+    return NULL;
+  uint32_t n = (uint32_t)dsc->box_w * dsc->box_h;
+  uint32_t size = sizeof(glyph_t) + n;
+  if (size > GLYPH_CACHE_SIZE)
+    return NULL;
+  while (f->stat.used + size > GLYPH_CACHE_SIZE) {
+    glyph_t **victim = lru_victim(f);
+    if (victim == NULL)
+      return NULL; // everything left is pinned
+    evict(f, victim);
+  }
+
+  int64_t start = esp_timer_get_time();
+  const uint8_t *src = f->orig->get_glyph_bitmap(f->orig, letter);
+  if (src == NULL)
+    return NULL;
+  glyph_t *g = (glyph_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+  if (g == NULL)
+    return NULL;
+  expand(src, bpp, n, bitmap(g));
+  g->letter = letter;
+  g->size = size;
+  g->pinned = false;
+  g->drawn = false;
+  glyph_t **bucket = &f->buckets[letter % GLYPH_CACHE_BUCKETS];
+  g->next = *bucket;
+  *bucket = g;
+
+  f->stat.used += size;
+  if (f->stat.used > f->stat.peak)
+    f->stat.peak = f->stat.used;
+  f->stat.render_us += esp_timer_get_time() - start;
+  f->renders++;
+  return g;
+}
+
+/* Metrics and kerning come from the original font, the bitmap from the cache.
+ * LVGL asks for the bitmap of a glyph right after its description, both have
+ * to agree on the bpp: a glyph that could not be cached keeps the original. */
+static bool get_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next) {
+  glyph_font_t *f = (glyph_font_t *)font;
+  f->current = NULL;
+  if (!f->orig->get_glyph_dsc(f->orig, dsc, letter, letter_next))
+    return false;
+  if (dsc->box_w == 0 || dsc->box_h == 0 || dsc->is_placeholder || f->orig->subpx != LV_FONT_SUBPX_NONE)
+    return true;
+  glyph_t *g = find(f, letter);
+  if (g == NULL)
+    g = render(f, letter, dsc);
+  if (g == NULL)
+    return true;
+  g->last_use = ++use_clock;
+  f->current = g;
+  dsc->bpp = 8;
+  return true;
+}
+
+static const uint8_t *get_bitmap(const lv_font_t *font, uint32_t letter) {
+  glyph_font_t *f = (glyph_font_t *)font;
+  glyph_t *g = f->current;
+  if (g == NULL || g->letter != letter) {
+    f->stat.overflows++;
+    return f->orig->get_glyph_bitmap(f->orig, letter);
+  }
+  if (g->drawn) {
+    f->stat.hits++;
+  } else {
+    g->drawn = true;
+    f->stat.misses++;
+  }
+  return bitmap(g);
+}
+
+static glyph_font_t *get_font(const lv_font_t *font) {
+  for (uint8_t i = 0; i < font_count; i++)
+    if (&fonts[i].font == font || fonts[i].orig == font)
+      return &fonts[i];
+  return NULL;
+}
+
+const lv_font_t *glyph_cache_font(const lv_font_t *font) {
+  glyph_font_t *f = get_font(font);
+  if (f)
+    return &f->font;
+  if (font_count == GLYPH_CACHE_MAX_FONTS) {
+    Serial.printf("glyph cache: more than %u fonts, %upx font not cached\n", GLYPH_CACHE_MAX_FONTS,
+                  font->line_height);
+    return font;
+  }
+  f = &fonts[font_count++];
+  f->font = *font;
+  f->font.get_glyph_dsc = get_dsc;
+  f->font.get_glyph_bitmap = get_bitmap;
+  f->orig = font;
+  return &f->font;
+}
+
+bool glyph_cache_pin(const lv_font_t *font, const char *chars) {
+  glyph_font_t *f = get_font(font);
+  if (f == NULL)
+    return false;
+  bool ok = true;
+  uint32_t i = 0;
+  while (chars[i]) {
+    uint32_t letter = _lv_txt_encoded_next(chars, &i);
+    lv_font_glyph_dsc_t dsc;
+    if (!get_dsc(&f->font, &dsc, letter, 0))
+      continue; // not in this font
+    if (f->current)
+      f->current->pinned = true;
+    else if (dsc.box_w && dsc.box_h)
+      ok = false;
+  }
+  f->current = NULL;
+  return ok;
+}
+
+static void track_cb(lv_event_t *e) {
+  // Draw events do not nest, one start time serves all labels
+  if (lv_event_get_code(e) == LV_EVENT_DRAW_MAIN_BEGIN) {
+    label_start = esp_timer_get_time();
+    return;
+  }
+  uint32_t us = esp_timer_get_time() - label_start;
+  label_stat.draws++;
+  label_stat.total_us += us;
+  if (us > label_stat.max_us)
+    label_stat.max_us = us;
+}
+
+void glyph_cache_track(lv_obj_t *label) {
+  lv_obj_add_event_cb(label, track_cb, LV_EVENT_DRAW_MAIN_BEGIN, NULL);
+  lv_obj_add_event_cb(label, track_cb, LV_EVENT_DRAW_MAIN_END, NULL);
+}
+
+bool glyph_cache_get_stat(const lv_font_t *font, glyph_cache_stat_t *stat) {
+  glyph_font_t *f = get_font(font);
+  if (f == NULL)
+    return false;
+  *stat = f->stat;
+  return true;
+}
+
+void glyph_cache_report(void) {
+  for (uint8_t i = 0; i < font_count; i++) {
+    glyph_font_t *f = &fonts[i];
+    glyph_cache_stat_t s = f->stat;
+    glyph_cache_stat_t *l = &f->stat_last;
+    if (s.hits == l->hits && s.misses == l->misses && s.overflows == l->overflows && f->renders == f->renders_last)
+      continue;
+    uint32_t hits = s.hits - l->hits, drawn = hits + s.misses - l->misses;
+    Serial.printf("glyphs %upx %u hits, %u misses (%u%% hit), %u evictions, %u KB of %u KB used (peak %u KB)",
+                  f->orig->line_height, hits, s.misses - l->misses, drawn ? hits * 100 / drawn : 0,
+                  s.evictions - l->evictions, s.used / 1024, GLYPH_CACHE_SIZE / 1024, s.peak / 1024);
+    if (f->renders != f->renders_last)
+      Serial.printf(", rendered in %u us avg", (s.render_us - l->render_us) / (f->renders - f->renders_last));
+    if (s.overflows != l->overflows)
+      Serial.printf(", %u drawn uncached", s.overflows - l->overflows);
+    Serial.println();
+    *l = s;
+    f->renders_last = f->renders;
+  }
+
+  if (label_stat.draws == 0)
+    return;
+  Serial.printf("glyph labels %u draws, %u us avg, %u us max\n", label_stat.draws,
+                label_stat.total_us / label_stat.draws, label_stat.max_us);
+  label_stat = {};
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "lvgl.h"
+#include <stdint.h>
+
+/**
+ * Rendered glyph cache for the large fonts of the factory UI.
+ *
+ * glyph_cache_font() returns a RAM copy of a font to use in its place. The
+ * copy renders each glyph once into PSRAM as 8 bpp coverage, through the same
+ * opacity tables LVGL applies while drawing, so the result is pixel identical
+ * and redraws skip the bit unpacking (and, for compressed fonts, the
+ * decompression) LVGL otherwise repeats for every glyph of every redraw.
+ * Metrics and kerning still come from the original font.
+ *
+ * Each font has its own cache keyed by code point, least recently used glyphs
+ * are freed when it grows over GLYPH_CACHE_SIZE bytes. glyph_cache_pin()
+ * renders a set of characters up front, e.g. the clock digits, and keeps them
+ * out of the eviction.
+ *
+ * glyph_cache_track() times the draws of a label for the report.
+ */
+
+#define GLYPH_CACHE_MAX_FONTS 4
+#define GLYPH_CACHE_BUCKETS   32           // hash chains per font
+#define GLYPH_CACHE_SIZE      (128 * 1024) // rendered bytes kept per font
+
+typedef struct {
+  uint32_t hits;      // glyphs drawn from the cache
+  uint32_t misses;    // glyphs rendered to be drawn
+  uint32_t evictions;
+  uint32_t overflows; // glyphs drawn from the original font, no room
+  uint32_t render_us; // total time spent rendering
+  uint32_t used;      // bytes rendered now
+  uint32_t peak;
+} glyph_cache_stat_t;
+
+/* Cached copy of font, the same copy for every call. Returns font itself if
+ * GLYPH_CACHE_MAX_FONTS fonts are cached already. */
+const lv_font_t *glyph_cache_font(const lv_font_t *font);
+/* Renders the characters of a UTF-8 string and keeps them, false if some of
+ * them do not fit */
+bool glyph_cache_pin(const lv_font_t *font, const char *chars);
+/* Adds the draw time of a label to the report */
+void glyph_cache_track(lv_obj_t *label);
+bool glyph_cache_get_stat(const lv_font_t *font, glyph_cache_stat_t *stat);
+/* Hit rate and render time per font, label draw time, since the last call */
+void glyph_cache_report(void);
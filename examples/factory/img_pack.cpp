@@ -0,0 +1,212 @@
+#include "img_pack.h"
+#include "Arduino.h"
+#include "lz4_block.h"
+
+typedef struct {
+  const lv_img_dsc_t *img; // key
+  const img_pack_t *pack;
+  uint8_t *pixels;         // PSRAM, NULL while not decoded
+  uint32_t last_use;       // LRU stamp
+  uint32_t decode_us;      // last decode
+  uint16_t decodes;
+  bool failed;
+  bool reported;
+} img_pack_entry_t;
+
+static img_pack_entry_t entries[IMG_PACK_MAX];
+static uint8_t entry_count = 0;
+static uint32_t use_clock = 0;
+static uint32_t cache_used = 0; // bytes decoded in PSRAM
+static img_pack_stat_t stat;
+static img_pack_stat_t stat_last;
+
+static const img_pack_t *get_pack(const void *src) {
+  if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE)
+    return NULL;
+  const lv_img_dsc_t *img = (const lv_img_dsc_t *)src;
+  if (img->header.cf != LV_IMG_CF_RAW && img->header.cf != LV_IMG_CF_RAW_ALPHA)
+    return NULL;
+  if (img->data_size != sizeof(img_pack_t))
+    return NULL;
+  const img_pack_t *pack = (const img_pack_t *)img->data;
+  return pack->magic == IMG_PACK_MAGIC ? pack : NULL;
+}
+
+static uint8_t px_size(const img_pack_t *pack) {
+  return pack->cf == LV_IMG_CF_TRUE_COLOR_ALPHA ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t);
+}
+
+static uint8_t *decode(const img_pack_t *pack) {
+  uint8_t *pixels = (uint8_t *)heap_caps_malloc(pack->raw_size, MALLOC_CAP_SPIRAM);
+  if (pixels == NULL)
+    return NULL;
+  if (pack->colors == 0) {
+    if (lz4_block_unpack(pack->lz4, pack->lz4_size, pixels, pack->raw_size))
+      return pixels;
+  } else {
+    // Indices go to the end of the buffer and are expanded from the front,
+    // pixel i never reaches index i + 1
+    uint8_t px = px_size(pack);
+    uint32_t n = pack->raw_size / px;
+    uint8_t *idx = pixels + pack->raw_size - n;
+    if (lz4_block_unpack(pack->lz4, pack->lz4_size, idx, n)) {
+      uint8_t *out = pixels;
+      bool ok = true;
+      for (uint32_t i = 0; i < n; i++) {
+        uint8_t c = idx[i];
+        if (c >= pack->colors) {
+          ok = false;
+          break;
+        }
+        const uint8_t *p = pack->palette + c * px;
+        *out++ = p[0];
+        *out++ = p[1];
+        if (px == 3)
+          *out++ = p[2];
+      }
+      if (ok)
+        return pixels;
+    }
+  }
+  heap_caps_free(pixels);
+  return NULL;
+}
+
+static lv_res_t img_pack_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header) {
+  const img_pack_t *pack = get_pack(src);
+  if (pack == NULL)
+    return LV_RES_INV;
+  const lv_img_dsc_t *img = (const lv_img_dsc_t *)src;
+  header->cf = pack->cf;
+  header->w = img->header.w;
+  header->h = img->header.h;
+  header->always_zero = 0;
+  return LV_RES_OK;
+}
+
+// Least recently used decoded entry other than keep, NULL if there is none
+static img_pack_entry_t *lru_victim(const img_pack_entry_t *keep) {
+  img_pack_entry_t *victim = NULL;
+  for (uint8_t i = 0; i < entry_count; i++) {
+    img_pack_entry_t *e = &entries[i];
+    if (e->pixels && e != keep && (victim == NULL || e->last_use < victim->last_use))
+      victim = e;
+  }
+  return victim;
+}
+
+static void evict(img_pack_entry_t *e) {
+  // Drop the LVGL cache entry first, it points to the pixels. Nothing else
+  // holds them: LVGL opens an image right before drawing it and the drawing
+  // is done before the next image is opened.
+  lv_img_cache_invalidate_src(e->img);
+  heap_caps_free(e->pixels);
+  e->pixels = NULL;
+  cache_used -= e->pack->raw_size;
+  stat.evictions++;
+}
+
+static lv_res_t img_pack_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+  const img_pack_t *pack = get_pack(dsc->src);
+  if (pack == NULL)
+    return LV_RES_INV;
+  const lv_img_dsc_t *img = (const lv_img_dsc_t *)dsc->src;
+
+  img_pack_entry_t *e = NULL;
+  for (uint8_t i = 0; i < entry_count; i++) {
+    if (entries[i].img == img) {
+      e = &entries[i];
+      break;
+    }
+  }
+  if (e == NULL) {
+    if (pack->raw_size != (uint32_t)img->header.w * img->header.h * px_size(pack))
+      return LV_RES_INV;
+    if (entry_count == IMG_PACK_MAX) {
+      stat.overflows++;
+      return LV_RES_INV;
+    }
+    e = &entries[entry_count++];
+    memset(e, 0, sizeof(*e));
+    e->img = img;
+    e->pack = pack;
+  }
+  if (e->failed)
+    return LV_RES_INV; // do not retry on every draw
+  e->last_use = ++use_clock;
+
+  if (e->pixels) {
+    stat.hits++;
+  } else {
+    stat.misses++;
+    img_pack_entry_t *victim;
+    while (cache_used + pack->raw_size > IMG_PACK_CACHE_SIZE && (victim = lru_victim(e)) != NULL)
+      evict(victim);
+    uint32_t start = (uint32_t)esp_timer_get_time();
+    e->pixels = decode(pack);
+    e->decode_us = (uint32_t)esp_timer_get_time() - start;
+    e->decodes++;
+    if (e->pixels == NULL) {
+      e->failed = true;
+      return LV_RES_INV;
+    }
+    cache_used += pack->raw_size;
+    if (cache_used > stat.peak)
+      stat.peak = cache_used;
+  }
+  dsc->img_data = e->pixels;
+  return LV_RES_OK;
+}
+
+static void img_pack_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+  // the pixels stay cached until evicted
+}
+
+void img_pack_init(void) {
+  lv_img_decoder_t *decoder = lv_img_decoder_create();
+  if (decoder == NULL)
+    return;
+  lv_img_decoder_set_info_cb(decoder, img_pack_info);
+  lv_img_decoder_set_open_cb(decoder, img_pack_open);
+  lv_img_decoder_set_close_cb(decoder, img_pack_close);
+  lv_img_cache_set_size(IMG_PACK_LVGL_CACHE);
+}
+
+void img_pack_get_stat(img_pack_stat_t *out) {
+  *out = stat;
+  out->used = cache_used;
+}
+
+void img_pack_report(void) {
+  uint32_t flash = 0, raw = 0;
+  for (uint8_t i = 0; i < entry_count; i++) {
+    img_pack_entry_t *e = &entries[i];
+    const img_pack_t *p = e->pack;
+    uint32_t packed = p->lz4_size + p->colors * px_size(p);
+    flash += packed;
+    raw += p->raw_size;
+    if (e->reported || e->decodes == 0)
+      continue;
+    e->reported = true;
+    if (e->failed) {
+      Serial.printf("img %-18s %ux%u decoding failed\n", p->name, e->img->header.w, e->img->header.h);
+      continue;
+    }
+    Serial.printf("img %-18s %ux%u ", p->name, e->img->header.w, e->img->header.h);
+    if (p->colors)
+      Serial.printf("%u colors, ", p->colors);
+    Serial.printf("flash %u B of %u B (%u%%), decoded in %u us\n", packed, p->raw_size, packed * 100 / p->raw_size,
+                  e->decode_us);
+  }
+
+  img_pack_stat_t s = stat;
+  if (s.hits == stat_last.hits && s.misses == stat_last.misses && s.overflows == stat_last.overflows)
+    return;
+  Serial.printf("img cache %u hits, %u misses, %u evictions, %u KB of %u KB used (peak %u KB), flash saved %u KB",
+                s.hits - stat_last.hits, s.misses - stat_last.misses, s.evictions - stat_last.evictions,
+                cache_used / 1024, IMG_PACK_CACHE_SIZE / 1024, s.peak / 1024, (raw - flash) / 1024);
+  if (s.overflows != stat_last.overflows)
+    Serial.printf(", %u opens over IMG_PACK_MAX", s.overflows - stat_last.overflows);
+  Serial.println();
+  stat_last = s;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "lvgl.h"
+#include <stdint.h>
+
+/**
+ * Compressed image assets.
+ *
+ * tools/img_pack.py turns the LVGL image converter output into an LZ4 block,
+ * through an 8 bit palette when the image has few enough distinct pixels. The
+ * packed lv_img_dsc_t keeps its name and size, its cf is LV_IMG_CF_RAW or
+ * LV_IMG_CF_RAW_ALPHA (so the built-in decoder leaves it alone) and data points
+ * to an img_pack_t.
+ *
+ * The decoder registered by img_pack_init() unpacks an asset into PSRAM the
+ * first time it is drawn and hands that buffer to LVGL afterwards, so drawing
+ * costs the same as a plain true color image. The decoded assets share
+ * IMG_PACK_CACHE_SIZE bytes: when a new one does not fit, the least recently
+ * opened ones are freed and dropped from the LVGL image cache.
+ *
+ * img_pack_init() sizes the LVGL image cache to IMG_PACK_LVGL_CACHE images
+ * (lv_conf.h only enables it), redrawing one of them does not reach the
+ * decoder at all. The hits counted here are opens
+ * served from PSRAM after LVGL dropped or never had the image.
+ *
+ * Only RGB565 without byte swap (lv_conf.h) is packed, the generated files
+ * fail to build with other color settings.
+ */
+
+#define IMG_PACK_MAGIC      0x314b5049   // "IPK1"
+#define IMG_PACK_MAX        16           // assets tracked by the decoder
+#define IMG_PACK_CACHE_SIZE (256 * 1024) // decoded bytes kept in PSRAM
+#define IMG_PACK_LVGL_CACHE 16           // images LVGL keeps open
+
+typedef struct {
+  uint32_t magic;
+  const char *name;
+  uint8_t cf;              // decoded format, LV_IMG_CF_TRUE_COLOR or LV_IMG_CF_TRUE_COLOR_ALPHA
+  uint16_t colors;         // palette entries, 0: the LZ4 block holds the pixels
+  uint32_t raw_size;       // decoded bytes
+  const uint8_t *palette;  // colors * pixel size (2 or 3) bytes
+  const uint8_t *lz4;      // LZ4 block of the pixels or palette indices
+  uint32_t lz4_size;
+} img_pack_t;
+
+typedef struct {
+  uint32_t hits;      // opens served from PSRAM
+  uint32_t misses;    // opens that decoded
+  uint32_t evictions;
+  uint32_t overflows; // opens refused, more than IMG_PACK_MAX assets
+  uint32_t used;      // bytes decoded now
+  uint32_t peak;
+} img_pack_stat_t;
+
+/* Call once after lv_init() */
+void img_pack_init(void);
+void img_pack_get_stat(img_pack_stat_t *stat);
+/* Assets decoded for the first time: flash used against the raw size, decode
+ * time. Cache hits, misses and evictions since the last call. */
+void img_pack_report(void);
@@ -0,0 +1,144 @@
+#include "lz4_block.h"
+#include <string.h>
+
+#define MIN_MATCH     4
+#define LAST_LITERALS 5  // the last 5 bytes are literals,
+#define MF_LIMIT      12 // no match starts in the last 12 bytes
+#define MAX_OFFSET    65535
+#define NO_POS        0xffffffff
+
+static uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static uint32_t hash(uint32_t v) { return (v * 2654435761u) >> (32 - LZ4_BLOCK_HASH_BITS); }
+
+// Most recent position first
+static void remember(uint32_t *bucket, uint32_t pos) {
+  memmove(bucket + 1, bucket, (LZ4_BLOCK_WAYS - 1) * sizeof(uint32_t));
+  bucket[0] = pos;
+}
+
+static uint8_t *put_len(uint8_t *op, uint32_t len) {
+  while (len >= 255) {
+    *op++ = 255;
+    len -= 255;
+  }
+  *op++ = len;
+  return op;
+}
+
+static uint8_t *put_literals(uint8_t *op, uint8_t *token, const uint8_t *lit, uint32_t len) {
+  *token = (len < 15 ? len : 15) << 4;
+  if (len >= 15)
+    op = put_len(op, len - 15);
+  memcpy(op, lit, len);
+  return op + len;
+}
+
+uint32_t lz4_block_pack(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t cap, uint32_t *table) {
+  if (cap < LZ4_BLOCK_BOUND(len))
+    return 0;
+  memset(table, 0xff, LZ4_BLOCK_TABLE_SIZE);
+  const uint8_t *ip = src, *anchor = src, *end = src + len;
+  uint8_t *op = dst;
+
+  if (len > MF_LIMIT) {
+    const uint8_t *limit = end - MF_LIMIT;
+    const uint8_t *match_end = end - LAST_LITERALS;
+    while (ip < limit) {
+      uint32_t v = read32(ip);
+      uint32_t *bucket = &table[hash(v) * LZ4_BLOCK_WAYS];
+      uint32_t pos = ip - src;
+      const uint8_t *match = NULL;
+      uint32_t ml = 0;
+      for (uint8_t i = 0; i < LZ4_BLOCK_WAYS; i++) {
+        uint32_t cand = bucket[i];
+        if (cand == NO_POS || pos - cand > MAX_OFFSET)
+          break; // older ones are farther
+        if (read32(src + cand) != v)
+          continue;
+        uint32_t len = MIN_MATCH;
+        while (ip + len < match_end && ip[len] == src[cand + len])
+          len++;
+        if (len > ml) {
+          ml = len;
+          match = src + cand;
+        }
+      }
+      remember(bucket, pos);
+      if (match == NULL) {
+        ip++;
+        continue;
+      }
+
+      uint8_t *token = op++;
+      op = put_literals(op, token, anchor, ip - anchor);
+      uint32_t offset = ip - match;
+      *op++ = offset & 0xff;
+      *op++ = offset >> 8;
+      ml -= MIN_MATCH;
+      *token |= ml < 15 ? ml : 15;
+      if (ml >= 15)
+        op = put_len(op, ml - 15);
+      ip += ml + MIN_MATCH;
+      anchor = ip;
+      if (ip < limit)
+        remember(&table[hash(read32(ip - 2)) * LZ4_BLOCK_WAYS], ip - 2 - src);
+    }
+  }
+  uint8_t *token = op++;
+  op = put_literals(op, token, anchor, end - anchor);
+  return op - dst;
+}
+
+bool lz4_block_unpack(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_len) {
+  const uint8_t *ip = src, *ip_end = src + src_len;
+  uint8_t *op = dst, *op_end = dst + dst_len;
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+    uint32_t len = token >> 4;
+    if (len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= ip_end)
+          return false;
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    if (len > (uint32_t)(ip_end - ip) || len > (uint32_t)(op_end - op))
+      return false;
+    memcpy(op, ip, len);
+    ip += len;
+    op += len;
+    if (ip == ip_end)
+      break; // the last sequence has literals only
+
+    if (ip_end - ip < 2)
+      return false;
+    uint32_t offset = ip[0] | ip[1] << 8;
+    ip += 2;
+    if (offset == 0 || offset > (uint32_t)(op - dst))
+      return false;
+    len = token & 15;
+    if (len == 15) {
+      uint8_t b;
+      do {
+        if (ip >= ip_end)
+          return false;
+        b = *ip++;
+        len += b;
+      } while (b == 255);
+    }
+    len += MIN_MATCH;
+    if (len > (uint32_t)(op_end - op))
+      return false;
+    const uint8_t *match = op - offset;
+    while (len--) // byte by byte: the match may overlap the output
+      *op++ = *match++;
+  }
+  return op == op_end;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * LZ4 block format (no frame, no checksum), the format of tools/img_pack.py.
+ *
+ * The packer is greedy and remembers the last LZ4_BLOCK_WAYS positions of each
+ * hash, taking the longest of their matches: fast enough for data produced at
+ * run time, the offline tools pack harder. Back references reach 64 KB like
+ * in any LZ4 block, the block length is not limited.
+ */
+
+#define LZ4_BLOCK_HASH_BITS 10
+#define LZ4_BLOCK_WAYS      8
+// Hash table size needed by lz4_block_pack(), in bytes
+#define LZ4_BLOCK_TABLE_SIZE ((sizeof(uint32_t) * LZ4_BLOCK_WAYS) << LZ4_BLOCK_HASH_BITS)
+// Largest packed size of n bytes
+#define LZ4_BLOCK_BOUND(n) ((n) + (n) / 255 + 16)
+
+/* Packs len bytes into dst, returns the packed size or 0 if cap is less than
+ * LZ4_BLOCK_BOUND(len). table: LZ4_BLOCK_TABLE_SIZE bytes of scratch. */
+uint32_t lz4_block_pack(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t cap, uint32_t *table);
+/* Unpacks a block that must fill dst exactly, false on corrupt input */
+bool lz4_block_unpack(const uint8_t *src, uint32_t src_len, uint8_t *dst, uint32_t dst_len);
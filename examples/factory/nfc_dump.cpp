@@ -0,0 +1,135 @@
+#include "nfc_dump.h"
+#include "Arduino.h"
+#include "freertos/semphr.h"
+
+const uint8_t nfc_dump_keys[NFC_DUMP_KEYS][6] = {
+    {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+    {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5},
+    {0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+static const char *const type_name[NFC_CARD_TYPES] = {
+    "other", "Classic Mini", "Classic 1K", "Classic 4K", "Ultralight", "Ultralight EV1", "NTAG213", "NTAG215", "NTAG216",
+};
+
+static nfc_dump_t dump[NFC_DUMP_CACHE];
+static SemaphoreHandle_t dump_lock = NULL;
+static uint32_t dump_stamp = 0;
+
+bool nfc_dump_begin(void) {
+  if (dump_lock)
+    return true;
+  uint8_t *data = (uint8_t *)heap_caps_malloc(NFC_DUMP_CACHE * NFC_DUMP_MAX, MALLOC_CAP_SPIRAM);
+  if (data == NULL)
+    return false;
+  dump_lock = xSemaphoreCreateMutex();
+  if (dump_lock == NULL) {
+    heap_caps_free(data);
+    return false;
+  }
+  for (uint8_t i = 0; i < NFC_DUMP_CACHE; i++) {
+    dump[i] = nfc_dump_t();
+    dump[i].data = data + i * NFC_DUMP_MAX;
+  }
+  return true;
+}
+
+const char *nfc_card_type_name(uint8_t type) { return type < NFC_CARD_TYPES ? type_name[type] : "?"; }
+
+static nfc_dump_t *find(const uint8_t *uid, uint8_t uid_len) {
+  for (uint8_t i = 0; i < NFC_DUMP_CACHE; i++) {
+    if (dump[i].uid_len == uid_len && memcmp(dump[i].uid, uid, uid_len) == 0)
+      return &dump[i];
+  }
+  return NULL;
+}
+
+nfc_dump_t *nfc_dump_claim(const uint8_t *uid, uint8_t uid_len) {
+  xSemaphoreTake(dump_lock, portMAX_DELAY);
+  nfc_dump_t *d = find(uid, uid_len);
+  if (d == NULL) {
+    // never used entries have stamp 0
+    d = &dump[0];
+    for (uint8_t i = 1; i < NFC_DUMP_CACHE; i++) {
+      if (dump[i].stamp < d->stamp)
+        d = &dump[i];
+    }
+    memcpy(d->uid, uid, uid_len);
+    d->uid_len = uid_len;
+    memset(d->key, NFC_KEY_UNKNOWN, sizeof(d->key));
+  }
+  d->valid = false;
+  d->size = 0;
+  d->unread = 0;
+  d->exchanges = 0;
+  xSemaphoreGive(dump_lock);
+  return d;
+}
+
+void nfc_dump_commit(nfc_dump_t *d) {
+  xSemaphoreTake(dump_lock, portMAX_DELAY);
+  d->stamp = ++dump_stamp;
+  d->valid = true;
+  xSemaphoreGive(dump_lock);
+}
+
+const nfc_dump_t *nfc_dump_lock(const uint8_t *uid, uint8_t uid_len) {
+  if (dump_lock == NULL)
+    return NULL;
+  xSemaphoreTake(dump_lock, portMAX_DELAY);
+  nfc_dump_t *d = find(uid, uid_len);
+  return d && d->valid ? d : NULL;
+}
+
+void nfc_dump_unlock(void) {
+  if (dump_lock)
+    xSemaphoreGive(dump_lock);
+}
+
+static void print_line(const uint8_t *data, uint16_t offset, uint8_t len) {
+  Serial.printf("  %04X ", offset);
+  for (uint8_t i = 0; i < 16; i++) {
+    if (i < len)
+      Serial.printf(" %02X", data[i]);
+    else
+      Serial.print("   ");
+  }
+  Serial.print("  ");
+  for (uint8_t i = 0; i < len; i++)
+    Serial.print(data[i] >= 0x20 && data[i] < 0x7F ? (char)data[i] : '.');
+  Serial.println();
+}
+
+bool nfc_dump_print(const uint8_t *uid, uint8_t uid_len) {
+  const nfc_dump_t *d = nfc_dump_lock(uid, uid_len);
+  if (d == NULL) {
+    nfc_dump_unlock();
+    return false;
+  }
+  Serial.printf("%s dump, %u bytes in %u exchanges, %u us\n", nfc_card_type_name(d->type), d->size, d->exchanges,
+                d->read_us);
+  bool classic = d->type == NFC_CARD_CLASSIC_MINI || d->type == NFC_CARD_CLASSIC_1K || d->type == NFC_CARD_CLASSIC_4K;
+  if (!classic) {
+    // pages 0..3 are UID, lock and capability bytes, the user data follows
+    for (uint16_t pos = 0; pos < d->size; pos += 16)
+      print_line(&d->data[pos], pos / 4, d->size - pos < 16 ? d->size - pos : 16);
+    nfc_dump_unlock();
+    return true;
+  }
+  for (uint8_t sector = 0, block = 0; block * 16 < d->size; sector++) {
+    uint8_t blocks = sector < 32 ? 4 : 16;
+    if (d->unread & (1ULL << sector)) {
+      Serial.printf(" sector %u: no key\n", sector);
+    } else {
+      const uint8_t *key = nfc_dump_keys[d->key[sector]];
+      Serial.printf(" sector %u, key A %02X%02X%02X%02X%02X%02X\n", sector, key[0], key[1], key[2], key[3], key[4],
+                    key[5]);
+      for (uint8_t i = 0; i < blocks; i++)
+        print_line(&d->data[(block + i) * 16], block + i, 16);
+    }
+    block += blocks;
+  }
+  nfc_dump_unlock();
+  return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Card dumps by UID, kept in PSRAM.
+ *
+ * nfc_reader fills one entry per card session. Besides the data an entry
+ * remembers which key opened each MIFARE Classic sector, so the next
+ * session of the same card authenticates every sector at the first
+ * attempt. When the cache is full the least recently read card is replaced.
+ */
+
+#define NFC_DUMP_CACHE  8    // cards
+#define NFC_DUMP_MAX    4096 // bytes, MIFARE Classic 4K
+#define NFC_SECTORS_MAX 40   // MIFARE Classic 4K
+#define NFC_KEY_UNKNOWN 0xFF
+
+typedef enum {
+  NFC_CARD_OTHER = 0, // ISO14443A, not dumped
+  NFC_CARD_CLASSIC_MINI,
+  NFC_CARD_CLASSIC_1K,
+  NFC_CARD_CLASSIC_4K,
+  NFC_CARD_ULTRALIGHT, // no GET_VERSION (Ultralight, Ultralight C), first 16 pages
+  NFC_CARD_ULTRALIGHT_EV1,
+  NFC_CARD_NTAG213,
+  NFC_CARD_NTAG215,
+  NFC_CARD_NTAG216,
+  NFC_CARD_TYPES
+} nfc_card_type_t;
+
+typedef struct {
+  uint8_t uid[7];
+  uint8_t uid_len;
+  uint8_t type;  // nfc_card_type_t
+  bool valid;    // the last session finished, data can be read
+  uint16_t size; // bytes in data: blocks * 16 (Classic) or pages * 4
+  uint16_t exchanges;
+  uint32_t read_us;
+  uint32_t stamp;                       // last session, for replacement
+  uint64_t unread;                      // Classic sectors without data (no key, access bits)
+  uint8_t key[NFC_SECTORS_MAX];         // Classic key A per sector, index in nfc_dump_keys
+  uint8_t *data;
+} nfc_dump_t;
+
+// Key A candidates for MIFARE Classic: transport, MAD, NFC Forum, zero
+#define NFC_DUMP_KEYS 4
+extern const uint8_t nfc_dump_keys[NFC_DUMP_KEYS][6];
+
+bool nfc_dump_begin(void);
+const char *nfc_card_type_name(uint8_t type);
+
+/* For nfc_reader: the entry of uid (keeping its keys) or the least recently
+ * read one, invalid until nfc_dump_commit() */
+nfc_dump_t *nfc_dump_claim(const uint8_t *uid, uint8_t uid_len);
+void nfc_dump_commit(nfc_dump_t *dump);
+
+/* Dump of a card or NULL. The cache stays locked until nfc_dump_unlock(),
+ * also when NULL is returned. */
+const nfc_dump_t *nfc_dump_lock(const uint8_t *uid, uint8_t uid_len);
+void nfc_dump_unlock(void);
+/* Prints the dump of a card on Serial, 16 bytes a line: Classic blocks by
+ * sector with the key that opened it, Ultralight / NTAG pages. False if
+ * the card is not in the cache. */
+bool nfc_dump_print(const uint8_t *uid, uint8_t uid_len);
@@ -0,0 +1,537 @@
+#include "nfc_reader.h"
+#include "Arduino.h"
+#include "freertos/queue.h"
+
+#define NFC_BLOCK 4 // first block of sector 1, sector 0 holds the manufacturer data
+
+// MIFARE Ultralight / NTAG commands
+#define UL_CMD_GET_VERSION 0x60
+#define UL_CMD_FAST_READ   0x3A
+#define UL_PAGES           16 // Ultralight without GET_VERSION, Ultralight C has more but no way to tell
+
+enum { NFC_IDLE = 0, NFC_REST, NFC_DETECT, NFC_SELECT, NFC_VERSION, NFC_AUTH, NFC_READ };
+enum { PHASE_ACK = 0, PHASE_RESPONSE };
+
+static Adafruit_PN532 *reader = NULL;
+static int8_t reader_irq = -1;
+static TaskHandle_t reader_task = NULL;
+static QueueHandle_t reader_queue = NULL;
+
+// only touched by the reader task
+static uint8_t state = NFC_IDLE;
+static uint8_t phase = PHASE_ACK;
+static uint32_t deadline_us; // of the frame expected now, not used while waiting for a card
+static uint32_t looking_us;  // the PN532 was still looking for a card at this time
+static volatile uint32_t irq_us; // last falling edge of the IRQ pin
+static uint32_t found_us;        // the detection response was read
+static uint32_t rest_start_us;
+static nfc_card_event_t card;
+static uint8_t last_uid[7];
+static uint8_t last_uid_len = 0;
+static uint32_t last_seen_us;
+// FAST_READ response, status byte and the frame around it
+static uint8_t resp[NFC_FAST_READ_PAGES * 4 + 2 + 8];
+static uint8_t resp_len; // clocked in for the response expected, the frame and nothing more
+
+// card session: what is dumped and where it is
+static struct {
+  nfc_dump_t *dump;
+  bool classic;
+  bool fast;         // FAST_READ supported
+  uint8_t resume;    // after a new select: NFC_AUTH or NFC_READ
+  uint8_t sectors;   // Classic
+  uint8_t sector;
+  uint8_t key;       // index in nfc_dump_keys being tried
+  uint8_t keys_left; // of this sector
+  uint8_t last_key;  // opened the previous sector
+  uint16_t pos;      // next block (Classic) or page
+  uint16_t end;      // of the sector or the card
+} ses;
+
+static nfc_reader_stat_t stat;
+static nfc_reader_stat_t stat_last;
+static uint32_t report_start = 0;
+
+static void IRAM_ATTR nfc_reader_isr(void) {
+  BaseType_t woken = pdFALSE;
+  irq_us = (uint32_t)esp_timer_get_time();
+  if (reader_task)
+    vTaskNotifyGiveFromISR(reader_task, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+static uint32_t now_us(void) { return (uint32_t)esp_timer_get_time(); }
+
+// IRQ is low while a frame is ready, without it one status read on the bus
+static bool frame_ready(void) {
+  if (reader_irq >= 0)
+    return digitalRead(reader_irq) == LOW;
+  stat.polls++;
+  return reader->responseReady();
+}
+
+static void send(uint8_t next, uint8_t *cmd, uint8_t len, uint8_t reply) {
+  reader->startCommand(cmd, len);
+  resp_len = reply + 8;
+  state = next;
+  phase = PHASE_ACK;
+  looking_us = now_us();
+  deadline_us = looking_us + NFC_CMD_TIMEOUT_MS * 1000;
+}
+
+static void rest(void) {
+  state = NFC_REST;
+  rest_start_us = now_us();
+}
+
+static void fail(void) {
+  stat.errors++;
+  reader->abortCommand();
+  rest();
+}
+
+static void start_detect(uint8_t next) {
+  uint8_t cmd[3] = {PN532_COMMAND_INLISTPASSIVETARGET, 1, PN532_MIFARE_ISO14443A};
+  send(next, cmd, sizeof(cmd), 7 + sizeof(card.uid));
+}
+
+// InDataExchange with the one listed target, reply is the card's answer
+static void exchange(uint8_t next, const uint8_t *data, uint8_t len, uint8_t reply) {
+  uint8_t cmd[2 + 12];
+  cmd[0] = PN532_COMMAND_INDATAEXCHANGE;
+  cmd[1] = 1;
+  memcpy(&cmd[2], data, len);
+  ses.dump->exchanges++;
+  send(next, cmd, len + 2, reply + 2);
+}
+
+// Classic: block, Ultralight: FAST_READ of up to NFC_FAST_READ_PAGES or READ of 4 pages
+static void start_read(void) {
+  if (ses.fast) {
+    uint16_t last = ses.pos + NFC_FAST_READ_PAGES - 1;
+    if (last >= ses.end)
+      last = ses.end - 1;
+    uint8_t cmd[3] = {UL_CMD_FAST_READ, (uint8_t)ses.pos, (uint8_t)last};
+    exchange(NFC_READ, cmd, sizeof(cmd), (last - ses.pos + 1) * 4);
+  } else {
+    uint8_t cmd[2] = {MIFARE_CMD_READ, (uint8_t)ses.pos};
+    exchange(NFC_READ, cmd, sizeof(cmd), 16);
+  }
+}
+
+static uint16_t sector_block(uint8_t sector) { return sector < 32 ? sector * 4 : 128 + (sector - 32) * 16; }
+
+static void start_auth(void) {
+  uint8_t cmd[12] = {MIFARE_CMD_AUTH_A, (uint8_t)sector_block(ses.sector)};
+  memcpy(&cmd[2], nfc_dump_keys[ses.key], 6);
+  // the last 4 bytes of a 7 byte UID
+  memcpy(&cmd[8], &card.uid[card.uid_len - 4], 4);
+  exchange(NFC_AUTH, cmd, sizeof(cmd), 0);
+}
+
+// the first key: the one that opened this sector of this card last time, else the previous sector's
+static void enter_sector(void) {
+  uint8_t key = ses.dump->key[ses.sector];
+  ses.key = key != NFC_KEY_UNKNOWN ? key : ses.last_key;
+  ses.keys_left = NFC_DUMP_KEYS;
+  ses.pos = sector_block(ses.sector);
+  ses.end = ses.pos + (ses.sector < 32 ? 4 : 16);
+}
+
+static void queue_event(void) {
+  uint32_t now = now_us();
+  card.latency_us = now - card.detect_us;
+  card.read_us = now - found_us;
+  stat.events++;
+  stat.latency_sum_us += card.latency_us;
+  stat.wait_sum_us += card.latency_us - card.read_us;
+  if (card.latency_us > stat.latency_max_us)
+    stat.latency_max_us = card.latency_us;
+  if (xQueueSend(reader_queue, &card, 0) != pdTRUE)
+    stat.queue_drops++;
+  memcpy(last_uid, card.uid, card.uid_len);
+  last_uid_len = card.uid_len;
+  last_seen_us = now;
+  rest();
+}
+
+static void finish(void) {
+  nfc_dump_t *d = ses.dump;
+  d->read_us = now_us() - found_us;
+  nfc_dump_commit(d);
+
+  nfc_type_stat_t *t = &stat.type[d->type];
+  t->dumps++;
+  t->exchanges += d->exchanges;
+  t->bytes += d->size;
+  t->read_us += d->read_us;
+  if (d->read_us > t->read_max_us)
+    t->read_max_us = d->read_us;
+
+  card.type = d->type;
+  card.size = d->size;
+  card.exchanges = d->exchanges;
+  card.complete = d->unread == 0;
+  // block 4 is the first of sector 1, pages 4..7 follow the header pages
+  if (ses.classic)
+    card.data_ok = d->size >= (NFC_BLOCK + 1) * 16 && !(d->unread & 2);
+  else
+    card.data_ok = d->size >= 32;
+  if (card.data_ok)
+    memcpy(card.data, &d->data[ses.classic ? NFC_BLOCK * 16 : 16], 16);
+  queue_event();
+}
+
+// after the last block of a sector or when a sector can not be read
+static void next_sector(bool selected) {
+  ses.sector++;
+  if (ses.sector >= ses.sectors) {
+    finish();
+    return;
+  }
+  enter_sector();
+  if (selected) {
+    start_auth();
+  } else {
+    // the card fell back to idle, select it again before the next authentication
+    ses.resume = NFC_AUTH;
+    start_detect(NFC_SELECT);
+  }
+}
+
+static void start_session(void) {
+  nfc_dump_t *d = nfc_dump_claim(card.uid, card.uid_len);
+  ses.dump = d;
+  ses.classic = card.sak & 0x08;
+  ses.fast = false;
+  if (ses.classic) {
+    if (card.sak == 0x09) {
+      d->type = NFC_CARD_CLASSIC_MINI;
+      ses.sectors = 5;
+    } else if (card.sak & 0x10) {
+      d->type = NFC_CARD_CLASSIC_4K;
+      ses.sectors = 40;
+    } else {
+      d->type = NFC_CARD_CLASSIC_1K;
+      ses.sectors = 16;
+    }
+    d->size = sector_block(ses.sectors) * 16;
+    memset(d->data, 0, d->size);
+    ses.sector = 0;
+    ses.last_key = 0;
+    enter_sector();
+    start_auth();
+  } else if (card.sak == 0x00) {
+    // Ultralight family, GET_VERSION tells the size and whether FAST_READ works
+    uint8_t cmd[1] = {UL_CMD_GET_VERSION};
+    d->type = NFC_CARD_ULTRALIGHT;
+    exchange(NFC_VERSION, cmd, sizeof(cmd), 8);
+  } else {
+    d->type = NFC_CARD_OTHER;
+    finish();
+  }
+}
+
+// InListPassiveTarget response: 4B NbTg Tg ATQA(2) SAK UIDlen UID
+static bool parse_target(int16_t len) {
+  return len >= 7 && resp[0] == PN532_RESPONSE_INLISTPASSIVETARGET && resp[1] == 1 && resp[6] >= 4 &&
+         resp[6] <= sizeof(card.uid) && len >= 7 + resp[6];
+}
+
+static void on_detect(int16_t len) {
+  if (len >= 2 && resp[0] == PN532_RESPONSE_INLISTPASSIVETARGET && resp[1] == 0) {
+    start_detect(NFC_DETECT); // retries ran out, keep looking
+    return;
+  }
+  if (!parse_target(len)) {
+    fail();
+    return;
+  }
+  uint32_t now = now_us();
+  stat.detections++;
+  // the card came after the last look that found none, the edge tells it closer
+  card.detect_us = reader_irq >= 0 ? irq_us : looking_us;
+  card.atqa = (resp[3] << 8) | resp[4];
+  card.sak = resp[5];
+  card.uid_len = resp[6];
+  memcpy(card.uid, &resp[7], card.uid_len);
+  card.data_ok = false;
+
+  if (card.uid_len == last_uid_len && memcmp(card.uid, last_uid, last_uid_len) == 0 &&
+      now - last_seen_us < NFC_REPEAT_MS * 1000) {
+    stat.repeats++;
+    last_seen_us = now;
+    rest();
+    return;
+  }
+  found_us = now;
+  start_session();
+}
+
+// the same card again after it fell back to idle
+static void on_select(int16_t len) {
+  if (!parse_target(len) || resp[6] != card.uid_len || memcmp(&resp[7], card.uid, card.uid_len) != 0) {
+    fail(); // gone or another card
+    return;
+  }
+  if (ses.resume == NFC_AUTH)
+    start_auth();
+  else
+    start_read();
+}
+
+// GET_VERSION: 00 vendor type subtype major minor storage protocol
+static void on_version(bool ok, int16_t len) {
+  nfc_dump_t *d = ses.dump;
+  uint16_t pages = 0;
+  if (ok && len >= 2 + 8 && resp[3] == 0x04) { // NXP
+    uint8_t type = resp[4], storage = resp[8];
+    if (type == 0x03 && storage == 0x0B) {
+      d->type = NFC_CARD_ULTRALIGHT_EV1;
+      pages = 20;
+    } else if (type == 0x03 && storage == 0x0E) {
+      d->type = NFC_CARD_ULTRALIGHT_EV1;
+      pages = 41;
+    } else if (type == 0x04 && storage == 0x0F) {
+      d->type = NFC_CARD_NTAG213;
+      pages = 45;
+    } else if (type == 0x04 && storage == 0x11) {
+      d->type = NFC_CARD_NTAG215;
+      pages = 135;
+    } else if (type == 0x04 && storage == 0x13) {
+      d->type = NFC_CARD_NTAG216;
+      pages = 231;
+    }
+  }
+  ses.pos = 0;
+  if (pages) {
+    ses.fast = true;
+    ses.end = pages;
+    d->size = pages * 4;
+    start_read();
+  } else {
+    // plain READ of the pages every Ultralight has
+    d->type = NFC_CARD_ULTRALIGHT;
+    ses.end = UL_PAGES;
+    d->size = UL_PAGES * 4;
+    if (ok) {
+      start_read(); // answered, still selected
+    } else {
+      // no GET_VERSION: the NAK sent the card back to idle
+      ses.resume = NFC_READ;
+      start_detect(NFC_SELECT);
+    }
+  }
+}
+
+static void on_auth(bool ok) {
+  if (ok) {
+    ses.dump->key[ses.sector] = ses.key;
+    ses.last_key = ses.key;
+    start_read();
+    return;
+  }
+  // a failed authentication leaves the card idle, every try needs a new select
+  stat.auth_fails++;
+  if (--ses.keys_left == 0) {
+    ses.dump->unread |= 1ULL << ses.sector;
+    next_sector(false);
+    return;
+  }
+  ses.key = (ses.key + 1) % NFC_DUMP_KEYS;
+  ses.resume = NFC_AUTH;
+  start_detect(NFC_SELECT);
+}
+
+static void on_read(bool ok, int16_t len) {
+  nfc_dump_t *d = ses.dump;
+  if (ses.classic) {
+    if (!ok || len < 2 + 16) {
+      // access bits forbid key A reads, the rest of the sector too
+      d->unread |= 1ULL << ses.sector;
+      next_sector(false);
+      return;
+    }
+    uint8_t *block = &d->data[ses.pos * 16];
+    memcpy(block, &resp[2], 16);
+    if (ses.pos + 1 == ses.end)
+      memcpy(block, nfc_dump_keys[ses.key], 6); // key A reads as zeros in the trailer
+    if (++ses.pos < ses.end)
+      start_read();
+    else
+      next_sector(true);
+    return;
+  }
+
+  if (!ok || len < 2 + 16 || (ses.fast && (len - 2) % 4 != 0)) {
+    d->size = ses.pos * 4; // what was read so far
+    d->unread = 1;
+    finish();
+    return;
+  }
+  uint16_t pages = ses.fast ? (len - 2) / 4 : 4;
+  if (pages > ses.end - ses.pos)
+    pages = ses.end - ses.pos;
+  memcpy(&d->data[ses.pos * 4], &resp[2], pages * 4);
+  ses.pos += pages;
+  if (ses.pos < ses.end)
+    start_read();
+  else
+    finish();
+}
+
+bool nfc_reader_begin(Adafruit_PN532 *nfc, int8_t irq_pin) {
+  if (!nfc_dump_begin())
+    return false;
+  if (reader_queue == NULL)
+    reader_queue = xQueueCreate(NFC_EVENT_QUEUE, sizeof(nfc_card_event_t));
+  if (reader_queue == NULL)
+    return false;
+  reader = nfc;
+  reader_irq = irq_pin;
+  reader_task = xTaskGetCurrentTaskHandle();
+  report_start = now_us();
+  state = NFC_IDLE;
+
+  // blocking, once: normal mode with the IRQ output, then InListPassiveTarget
+  // that keeps looking until a card comes
+  if (!reader->SAMConfig())
+    return false;
+  if (!reader->setPassiveActivationRetries(0xFF))
+    return false;
+  // setPassiveActivationRetries() only takes the ACK, the response follows it
+  uint32_t start = now_us();
+  while (!reader->responseReady()) {
+    if (now_us() - start >= NFC_CMD_TIMEOUT_MS * 1000)
+      return false;
+    delay(1);
+  }
+  if (reader->readResponse(resp, 8 + 1) < 1 || resp[0] != PN532_COMMAND_RFCONFIGURATION + 1)
+    return false;
+
+  if (reader_irq >= 0) {
+    pinMode(reader_irq, INPUT_PULLUP);
+    attachInterrupt(reader_irq, nfc_reader_isr, FALLING);
+  }
+  return true;
+}
+
+void nfc_reader_start(void) {
+  if (reader == NULL || state != NFC_IDLE)
+    return;
+  start_detect(NFC_DETECT);
+}
+
+void nfc_reader_stop(void) {
+  if (reader == NULL || state == NFC_IDLE)
+    return;
+  if (state != NFC_REST)
+    reader->abortCommand();
+  state = NFC_IDLE;
+}
+
+TickType_t nfc_reader_service(void) {
+  while (true) {
+    if (state == NFC_IDLE)
+      return portMAX_DELAY;
+    uint32_t now = now_us();
+    if (state == NFC_REST) {
+      uint32_t elapsed_ms = (now - rest_start_us) / 1000;
+      if (elapsed_ms < NFC_REST_MS)
+        return pdMS_TO_TICKS(NFC_REST_MS - elapsed_ms) + 1;
+      start_detect(NFC_DETECT);
+      continue;
+    }
+
+    // the card may take forever, everything else has a deadline
+    bool timed = phase == PHASE_ACK || state != NFC_DETECT;
+    if (!frame_ready()) {
+      if (!timed)
+        looking_us = now;
+      if (timed && (int32_t)(now - deadline_us) >= 0) {
+        fail();
+        continue;
+      }
+      if (reader_irq >= 0)
+        return timed ? pdMS_TO_TICKS((deadline_us - now) / 1000) + 1 : portMAX_DELAY;
+      return pdMS_TO_TICKS(timed ? NFC_POLL_CMD_MS : NFC_POLL_DETECT_MS);
+    }
+
+    if (phase == PHASE_ACK) {
+      if (!reader->readAck()) {
+        fail();
+        continue;
+      }
+      phase = PHASE_RESPONSE;
+      deadline_us = now + NFC_CMD_TIMEOUT_MS * 1000;
+      continue;
+    }
+    int16_t len = reader->readResponse(resp, resp_len);
+    // InDataExchange response: 41 status data
+    bool ok = len >= 2 && resp[0] == PN532_RESPONSE_INDATAEXCHANGE && (resp[1] & 0x3F) == 0;
+    switch (state) {
+    case NFC_DETECT:
+      on_detect(len);
+      break;
+    case NFC_SELECT:
+      on_select(len);
+      break;
+    case NFC_VERSION:
+      on_version(ok, len);
+      break;
+    case NFC_AUTH:
+      on_auth(ok);
+      break;
+    case NFC_READ:
+      on_read(ok, len);
+      break;
+    }
+  }
+}
+
+bool nfc_reader_get_event(nfc_card_event_t *ev, TickType_t wait) {
+  return reader_queue && xQueueReceive(reader_queue, ev, wait) == pdTRUE;
+}
+
+void nfc_reader_get_stat(nfc_reader_stat_t *s) { *s = stat; }
+
+void nfc_reader_report(void) {
+  if (reader == NULL)
+    return;
+  uint32_t now = now_us();
+  uint32_t period = now - report_start;
+  report_start = now;
+  nfc_reader_stat_t s = stat;
+  stat.latency_max_us = 0;
+  for (uint8_t i = 0; i < NFC_CARD_TYPES; i++)
+    stat.type[i].read_max_us = 0;
+  if (period < 100)
+    return;
+  if (s.detections == stat_last.detections && s.errors == stat_last.errors) {
+    stat_last = s; // only polls, nothing to tell
+    return;
+  }
+
+  uint32_t events = s.events - stat_last.events;
+  Serial.printf("nfc %u cards, %u held, %u status polls", events, s.repeats - stat_last.repeats,
+                s.polls - stat_last.polls);
+  if (events)
+    Serial.printf(", detect to read avg %u us (%u us until seen) max %u us",
+                  (s.latency_sum_us - stat_last.latency_sum_us) / events, (s.wait_sum_us - stat_last.wait_sum_us) / events,
+                  s.latency_max_us);
+  if (s.errors != stat_last.errors || s.auth_fails != stat_last.auth_fails || s.queue_drops != stat_last.queue_drops)
+    Serial.printf(", errors %u auth fails %u dropped %u", s.errors - stat_last.errors,
+                  s.auth_fails - stat_last.auth_fails, s.queue_drops - stat_last.queue_drops);
+  Serial.println();
+  for (uint8_t i = 0; i < NFC_CARD_TYPES; i++) {
+    nfc_type_stat_t *t = &s.type[i], *l = &stat_last.type[i];
+    uint32_t dumps = t->dumps - l->dumps;
+    if (dumps == 0)
+      continue;
+    Serial.printf("nfc %-14s %u dumps, %u B in %u exchanges, read avg %u us max %u us\n", nfc_card_type_name(i), dumps,
+                  (t->bytes - l->bytes) / dumps, (t->exchanges - l->exchanges) / dumps, (t->read_us - l->read_us) / dumps,
+                  t->read_max_us);
+  }
+  stat_last = s;
+}
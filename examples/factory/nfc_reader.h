@@ -0,0 +1,102 @@
+#pragma once
+#include <Adafruit_PN532.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "nfc_dump.h"
+
+/**
+ * Non-blocking PN532 card reader.
+ *
+ * A state machine runs the PN532 commands one frame at a time through the
+ * non-blocking Adafruit_PN532 calls (startCommand, responseReady, readAck,
+ * readResponse). Detection is InListPassiveTarget with unlimited retries,
+ * the PN532 keeps looking for a card by itself and only answers once one is
+ * in the field. Nothing blocks on the chip: between frames the engine
+ * returns how long the task may sleep, so radioBus stays free for the
+ * CC1101 and SD.
+ *
+ * Readiness comes from the IRQ pin when it is wired (the ISR notifies the
+ * task), otherwise from the SPI status byte, read every NFC_POLL_DETECT_MS
+ * while waiting for a card and every NFC_POLL_CMD_MS during a command.
+ * The latency of a card counts from the last status read that still found
+ * the PN532 looking (or from the IRQ edge), so the poll interval is part
+ * of it.
+ *
+ * Each new card is dumped completely into the nfc_dump cache with as few
+ * InDataExchange round trips as the card allows:
+ *  - NTAG21x / Ultralight EV1: GET_VERSION for the size, then FAST_READ of
+ *    NFC_FAST_READ_PAGES pages per exchange
+ *  - Ultralight / Ultralight C: READ, 4 pages per exchange
+ *  - MIFARE Classic: per sector one authentication with key A and one READ
+ *    per block. The key that opened a sector last time (or the previous
+ *    sector) is tried first, a failed key costs a new select.
+ * Then the card becomes one event in a queue. A card held in the field is
+ * reported once, again after it was away for NFC_REPEAT_MS.
+ */
+
+#define NFC_POLL_DETECT_MS  20 // status poll while waiting for a card, without IRQ
+#define NFC_POLL_CMD_MS     2  // status poll while a command runs
+#define NFC_CMD_TIMEOUT_MS  100
+#define NFC_REPEAT_MS       1000 // same UID within this time is the card still in the field
+#define NFC_REST_MS         50   // pause after a card before looking again
+#define NFC_EVENT_QUEUE     4
+#define NFC_FAST_READ_PAGES 32 // 128 bytes per exchange, well inside a PN532 frame
+
+typedef struct {
+  uint32_t detect_us;  // esp_timer time of the last poll before the card was found, or of the IRQ
+  uint32_t latency_us; // detection to event queued: poll wait and the whole dump
+  uint32_t read_us;    // detection response read to event queued, the dump alone
+  uint16_t atqa;
+  uint8_t sak;
+  uint8_t uid_len;
+  uint8_t uid[7];
+  uint8_t type;       // nfc_card_type_t
+  uint16_t size;      // bytes dumped, see nfc_dump_lock()
+  uint16_t exchanges; // PN532 round trips of the dump
+  bool complete;      // every sector / page could be read
+  bool data_ok;       // data holds block 4 (Classic) or pages 4..7 (Ultralight)
+  uint8_t data[16];
+} nfc_card_event_t;
+
+typedef struct {
+  uint32_t dumps;
+  uint32_t exchanges;
+  uint32_t bytes;
+  uint32_t read_us;
+  uint32_t read_max_us;
+} nfc_type_stat_t;
+
+typedef struct {
+  uint32_t detections;
+  uint32_t events;
+  uint32_t repeats; // card still in the field, no event
+  uint32_t polls;   // status reads
+  uint32_t errors;  // missing ACK, broken frame, timeout, card gone
+  uint32_t auth_fails;
+  uint32_t queue_drops;
+  uint32_t latency_max_us;
+  uint32_t latency_sum_us;
+  uint32_t wait_sum_us; // part of the latency until the detection response was read
+  nfc_type_stat_t type[NFC_CARD_TYPES]; // dump time per card type
+} nfc_reader_stat_t;
+
+/* After nfc->begin() and the firmware check, from the task that will call
+ * nfc_reader_service(). irq_pin is the PN532 IRQ output or -1. The calls
+ * below belong to that task too, except the event queue and statistics. */
+bool nfc_reader_begin(Adafruit_PN532 *nfc, int8_t irq_pin);
+
+/* Look for cards / abort the command in flight and leave the PN532 idle */
+void nfc_reader_start(void);
+void nfc_reader_stop(void);
+
+/* Advance the state machine, returns the ticks until it wants to run again.
+ * The task sleeps with ulTaskNotifyTake(pdTRUE, nfc_reader_service()). */
+TickType_t nfc_reader_service(void);
+
+/* Next card event, false if none within wait */
+bool nfc_reader_get_event(nfc_card_event_t *ev, TickType_t wait);
+
+void nfc_reader_get_stat(nfc_reader_stat_t *stat);
+/* Events, detect to read latency and dump time per card type since the last report */
+void nfc_reader_report(void);
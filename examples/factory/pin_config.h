@@ -16,7 +16,23 @@
 
 #define LV_SCREEN_WIDTH       320
 #define LV_SCREEN_HEIGHT      170
-#define LV_BUF_SIZE           (LV_SCREEN_WIDTH * LV_SCREEN_HEIGHT)
+// Partial height draw buffers, 34 lines = 5 strips per frame and under the 0x4000 pixel DMA limit
+#define LV_BUF_LINES          34
+#define LV_BUF_SIZE           (LV_SCREEN_WIDTH * LV_BUF_LINES)
+// 1: flush through TFT_eSPI DMA, 0: blocking pushColors (for comparison)
+#define LV_FLUSH_USE_DMA      1
+// 1: show refresh statistics (fps, KB/frame, render/flush/spi ms, area merging) on screen
+#define LV_REFR_STAT_OVERLAY  0
+// 1: print the refresh statistics on Serial every second
+#define LV_REFR_STAT_SERIAL   0
+// 1: print the per task load (wakeups/s, busy %, latency) on Serial every 5 s
+#define TASK_STAT_SERIAL      0
+// ui_task wakes up at least this often even when LVGL has no timer due
+#define UI_IDLE_MAX_MS        100
+// OneButton tick period while the button is pressed
+#define UI_BUTTON_TICK_MS     10
+// keep reading the encoder this long after the last input event
+#define UI_INDEV_ACTIVE_MS    500
 /*ESP32S3*/
 #define PIN_POWER_ON          46
 
@@ -56,4 +72,6 @@
 #define RADIO_CS_PIN          17
 #define RADIO_SW1_PIN         43
 #define RADIO_SW0_PIN         44
-#define NFC_CS                16
\ No newline at end of file
+#define NFC_CS                16
+#define NFC_IRQ_PIN           -1 // PN532 IRQ, -1: not connected, the SPI status is polled
+#define NFC_DUMP_SERIAL       1  // 1: print the whole dump of each new card on Serial
\ No newline at end of file
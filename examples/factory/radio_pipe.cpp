@@ -0,0 +1,221 @@
+#include "radio_pipe.h"
+#include "Arduino.h"
+#include "BlockRingBuffer.h"
+#include "spi_bus.h"
+
+#define EOP_RING 32 // end of packet stamps not serviced yet, power of two
+
+enum { PIPE_IDLE = 0, PIPE_RX, PIPE_TX };
+
+static CC1101 *pipe_radio = NULL;
+static Module *pipe_mod = NULL;
+static int8_t pipe_dev = -1;
+static TaskHandle_t pipe_consumer = NULL;
+static BlockRingBuffer pipe_ring;
+static volatile uint8_t pipe_state = PIPE_IDLE;
+
+// written by the interrupt, eop_tail only under the radio bus
+static volatile uint32_t eop_time[EOP_RING];
+static volatile uint32_t eop_head = 0;
+static uint32_t eop_tail = 0;
+
+static radio_pipe_stat_t stat;
+static radio_pipe_stat_t stat_last;
+static uint32_t report_start = 0;
+
+static void IRAM_ATTR radio_pipe_isr(void) {
+  uint32_t now = (uint32_t)esp_timer_get_time();
+  stat.irqs++;
+  if (pipe_state == PIPE_TX) {
+    // TXOFF_MODE: back in Rx on its own
+    stat.tx_packets++;
+    pipe_state = PIPE_RX;
+  } else if (pipe_state == PIPE_RX) {
+    eop_time[eop_head & (EOP_RING - 1)] = now;
+    eop_head++;
+  } else {
+    return; // edge of a packet cut by standby
+  }
+  BaseType_t woken = pdFALSE;
+  if (pipe_consumer)
+    vTaskNotifyGiveFromISR(pipe_consumer, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+static void strobe(uint8_t cmd) { pipe_mod->SPItransfer(pipe_mod->SPIwriteCommand, cmd, NULL, NULL, 0); }
+
+static uint8_t read_status(uint8_t reg) { return pipe_mod->SPIreadRegister(reg | RADIOLIB_CC1101_CMD_ACCESS_STATUS_REG); }
+
+// RXBYTES can be wrong while the radio writes the FIFO, read until two reads agree
+static uint8_t read_rxbytes(void) {
+  uint8_t n = read_status(RADIOLIB_CC1101_REG_RXBYTES), prev;
+  do {
+    prev = n;
+    n = read_status(RADIOLIB_CC1101_REG_RXBYTES);
+  } while (n != prev);
+  return n;
+}
+
+// under the bus: idle, empty Rx FIFO, pending stamps dropped
+static void pipe_idle(void) {
+  pipe_state = PIPE_IDLE;
+  strobe(RADIOLIB_CC1101_CMD_IDLE);
+  strobe(RADIOLIB_CC1101_CMD_FLUSH_RX);
+  eop_tail = eop_head;
+}
+
+bool radio_pipe_begin(CC1101 *radio, int8_t spi_dev) {
+  if (!pipe_ring.begin(sizeof(radio_pkt_t), RADIO_PIPE_RING))
+    return false;
+  pipe_radio = radio;
+  pipe_mod = radio->getMod();
+  pipe_dev = spi_dev;
+  report_start = (uint32_t)esp_timer_get_time();
+
+  if (!spi_bus_acquire(pipe_dev))
+    return false;
+  pipe_idle();
+  // the radio drops longer packets itself, a packet always fits the FIFO
+  int16_t state = pipe_radio->variablePacketLengthMode(RADIO_PKT_MAX_LEN);
+  // GDO0 high from sync word to end of packet, in both directions
+  state |= pipe_mod->SPIsetRegValue(RADIOLIB_CC1101_REG_IOCFG0, RADIOLIB_CC1101_GDOX_SYNC_WORD_SENT_OR_RECEIVED);
+  // stay in Rx after a received or sent packet
+  state |= pipe_mod->SPIsetRegValue(RADIOLIB_CC1101_REG_MCSM1, RADIOLIB_CC1101_RXOFF_RX | RADIOLIB_CC1101_TXOFF_RX, 3, 0);
+  spi_bus_release(pipe_dev);
+
+  pipe_radio->setGdo0Action(radio_pipe_isr, FALLING);
+  return state == RADIOLIB_ERR_NONE;
+}
+
+void radio_pipe_set_consumer(TaskHandle_t task) { pipe_consumer = task; }
+
+int16_t radio_pipe_start_rx(void) {
+  if (pipe_mod == NULL)
+    return RADIOLIB_ERR_UNKNOWN;
+  if (!spi_bus_acquire(pipe_dev))
+    return RADIOLIB_ERR_SPI_CMD_FAILED;
+  pipe_idle();
+  pipe_state = PIPE_RX;
+  strobe(RADIOLIB_CC1101_CMD_RX);
+  spi_bus_release(pipe_dev);
+  return RADIOLIB_ERR_NONE;
+}
+
+int16_t radio_pipe_send(const uint8_t *data, uint8_t len) {
+  if (pipe_mod == NULL)
+    return RADIOLIB_ERR_UNKNOWN;
+  if (len > RADIO_PKT_MAX_LEN)
+    return RADIOLIB_ERR_PACKET_TOO_LONG;
+  if (!spi_bus_acquire(pipe_dev))
+    return RADIOLIB_ERR_SPI_CMD_FAILED;
+  // keep what is complete, a packet coming in right now is lost
+  radio_pipe_service();
+  pipe_idle();
+  pipe_state = PIPE_TX;
+  int16_t state = pipe_radio->startTransmit((uint8_t *)data, len);
+  if (state != RADIOLIB_ERR_NONE) {
+    pipe_state = PIPE_RX;
+    strobe(RADIOLIB_CC1101_CMD_RX);
+  }
+  spi_bus_release(pipe_dev);
+  return state;
+}
+
+bool radio_pipe_tx_busy(void) { return pipe_state == PIPE_TX; }
+
+void radio_pipe_standby(void) {
+  if (pipe_mod == NULL)
+    return;
+  if (!spi_bus_acquire(pipe_dev))
+    return;
+  pipe_idle();
+  spi_bus_release(pipe_dev);
+}
+
+void radio_pipe_service(void) {
+  if (pipe_mod == NULL || eop_tail == eop_head)
+    return;
+  if (!spi_bus_acquire(pipe_dev))
+    return; // the stamps stay, serviced by the next call
+  while (eop_tail != eop_head && pipe_state != PIPE_IDLE) {
+    if (eop_head - eop_tail > EOP_RING) // stamps overwritten, the FIFO overflowed long ago anyway
+      eop_tail = eop_head - EOP_RING;
+    uint32_t t = eop_time[eop_tail & (EOP_RING - 1)];
+
+    uint8_t avail = read_rxbytes();
+    if (avail & 0x80) { // RXFIFO_OVERFLOW, the radio waits for a flush
+      stat.fifo_overflows++;
+      pipe_idle();
+      pipe_state = PIPE_RX;
+      strobe(RADIOLIB_CC1101_CMD_RX);
+      break;
+    }
+    eop_tail++;
+    if (avail == 0) // packet dropped by the radio (length, address)
+      continue;
+
+    radio_pkt_t *pkt = (radio_pkt_t *)pipe_ring.writeBlock();
+    uint8_t len = pipe_mod->SPIreadRegister(RADIOLIB_CC1101_REG_FIFO);
+    if (len == 0 || len > RADIO_PKT_MAX_LEN || avail < len + 3) {
+      // out of step with the FIFO, start over
+      stat.fifo_overflows++;
+      pipe_idle();
+      pipe_state = PIPE_RX;
+      strobe(RADIOLIB_CC1101_CMD_RX);
+      break;
+    }
+    // payload and the two appended status bytes in one burst, straight into the ring
+    static const uint8_t burst = RADIOLIB_CC1101_CMD_READ | RADIOLIB_CC1101_CMD_BURST | RADIOLIB_CC1101_REG_FIFO;
+    const spi_bus_xfer_t xfer[] = {{&burst, NULL, 1, false}, {NULL, pkt->data, (uint16_t)(len + 2), false}};
+    spi_bus_transfer(pipe_dev, xfer, 2);
+    uint8_t rssi_raw = pkt->data[len];
+    uint8_t lqi = pkt->data[len + 1];
+    if (!(lqi & RADIOLIB_CC1101_CRC_OK)) {
+      stat.crc_errors++;
+      continue;
+    }
+    pkt->time_us = t;
+    pkt->len = len;
+    pkt->lqi = lqi & 0x7F;
+    // same conversion as CC1101::getRSSI()
+    pkt->rssi = (rssi_raw >= 128 ? ((float)rssi_raw - 256.0f) : (float)rssi_raw) / 2.0f - 74.0f;
+    if (!pipe_ring.commitWrite()) {
+      stat.ring_drops++;
+      continue;
+    }
+    stat.rx_packets++;
+    stat.rx_bytes += len;
+    uint32_t latency = (uint32_t)esp_timer_get_time() - t;
+    if (latency > stat.latency_max_us)
+      stat.latency_max_us = latency;
+  }
+  spi_bus_release(pipe_dev);
+}
+
+const radio_pkt_t *radio_pipe_peek(void) { return (const radio_pkt_t *)pipe_ring.readBlock(); }
+
+void radio_pipe_release(void) { pipe_ring.releaseRead(); }
+
+void radio_pipe_get_stat(radio_pipe_stat_t *s) { *s = stat; }
+
+void radio_pipe_report(void) {
+  if (pipe_mod == NULL)
+    return;
+  uint32_t now = (uint32_t)esp_timer_get_time();
+  uint32_t period = now - report_start;
+  report_start = now;
+  radio_pipe_stat_t s = stat;
+  stat.latency_max_us = 0;
+  if (period < 100 || s.irqs == stat_last.irqs)
+    return;
+
+  Serial.printf("radio %u pkt/s %u B/s rx, %u pkt tx, irq %u, latency max %u us",
+                (uint32_t)((uint64_t)(s.rx_packets - stat_last.rx_packets) * 1000000 / period),
+                (uint32_t)((uint64_t)(s.rx_bytes - stat_last.rx_bytes) * 1000000 / period), s.tx_packets - stat_last.tx_packets,
+                s.irqs - stat_last.irqs, s.latency_max_us);
+  if (s.crc_errors || s.fifo_overflows || s.ring_drops)
+    Serial.printf(", crc %u overflow %u dropped %u", s.crc_errors, s.fifo_overflows, s.ring_drops);
+  Serial.println();
+  stat_last = s;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <RadioLib.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * Interrupt driven CC1101 packet engine.
+ *
+ * GDO0 is mapped to "sync word sent / received": it rises on the sync word
+ * and falls at the end of the packet. The falling edge ISR stamps the time
+ * and notifies the consumer task, which calls radio_pipe_service(). That
+ * drains every finished packet from the Rx FIFO with one burst read each,
+ * straight into a preallocated ring (payload, RSSI, LQI, timestamp).
+ *
+ * The radio is configured to return to Rx by itself after a packet
+ * (MCSM1 RXOFF_MODE / TXOFF_MODE = Rx), so receiving is re-armed in
+ * hardware within the calibration time. The CPU does not have to restart
+ * it, and packets arriving while the task is busy wait in the FIFO.
+ *
+ * Nothing on the hot path allocates. Packets longer than RADIO_PKT_MAX_LEN
+ * are filtered by the radio (PKTLEN), streaming longer ones is not covered.
+ */
+
+#define RADIO_PKT_MAX_LEN   61 // 64 byte FIFO - length byte - 2 status bytes
+#define RADIO_PIPE_RING     16 // packets, power of two
+
+typedef struct {
+  uint32_t time_us; // esp_timer time of the end of packet interrupt
+  float rssi;       // dBm
+  uint8_t lqi;
+  uint8_t len;
+  uint8_t data[RADIO_PKT_MAX_LEN + 2]; // + RSSI / LQI status bytes while draining
+} radio_pkt_t;
+
+typedef struct {
+  uint32_t irqs;
+  uint32_t rx_packets;
+  uint32_t rx_bytes;
+  uint32_t crc_errors;
+  uint32_t fifo_overflows;
+  uint32_t ring_drops; // consumer too slow
+  uint32_t tx_packets;
+  uint32_t latency_max_us; // interrupt to packet in the ring
+} radio_pipe_stat_t;
+
+/* Call once after radio.begin() and the modem settings, spi_dev is the spi_bus
+ * device of the radio. Attaches the GDO0 interrupt, the radio stays idle. */
+bool radio_pipe_begin(CC1101 *radio, int8_t spi_dev);
+/* Task to notify from the interrupt */
+void radio_pipe_set_consumer(TaskHandle_t task);
+
+/* Enter continuous receive (also after changing frequency, bandwidth, ...) */
+int16_t radio_pipe_start_rx(void);
+/* Send one packet, the radio goes back to Rx when it is out */
+int16_t radio_pipe_send(const uint8_t *data, uint8_t len);
+bool radio_pipe_tx_busy(void);
+void radio_pipe_standby(void);
+
+/* Consumer task, after each notification: move finished packets into the ring */
+void radio_pipe_service(void);
+
+/* Oldest received packet or NULL, valid until radio_pipe_release() */
+const radio_pkt_t *radio_pipe_peek(void);
+void radio_pipe_release(void);
+
+void radio_pipe_get_stat(radio_pipe_stat_t *stat);
+/* Packet and byte rates since the last report, plus the error counters */
+void radio_pipe_report(void);
@@ -0,0 +1,204 @@
+#include "refr_stat.h"
+#include "Arduino.h"
+
+typedef struct {
+  uint32_t frames;
+  uint32_t areas_in;  // invalidated areas handed over by LVGL
+  uint32_t areas_out; // areas left after coalescing
+  uint32_t dirty_px;  // sum of the invalidated areas
+  uint32_t px;        // pixels actually flushed
+  uint32_t parts;     // flush_cb calls
+  uint32_t frame_us;  // whole refresh, render + flush
+  uint32_t flush_us;  // time blocked in flush_cb
+  uint32_t spi_us;    // wire time of the parts
+} refr_stat_t;
+
+static refr_stat_t stat;
+static volatile uint32_t stat_spi_us; // added from the SPI interrupt
+static portMUX_TYPE stat_spi_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool stat_counting = true; // false while the overlay refreshes itself
+static uint32_t stat_last_report;
+static bool serial_report = false;
+static lv_obj_t *overlay = NULL;
+static lv_area_t overlay_area; // where the last overlay update invalidated
+static bool overlay_dirty = false;
+
+static uint32_t area_cost(const lv_area_t *a, uint32_t buf_px) {
+  uint32_t w = lv_area_get_width(a);
+  uint32_t h = lv_area_get_height(a);
+  // LVGL renders an area in parts of as many full rows as fit in the draw buffer
+  uint32_t rows = buf_px / w;
+  if (rows == 0)
+    rows = 1;
+  uint32_t parts = (h + rows - 1) / rows;
+  return w * h + parts * REFR_STAT_PART_COST_PX;
+}
+
+/* Join any two areas whose bounding box is cheaper to refresh than both of them.
+ * Unlike lv_refr_join_area() this also joins areas that do not touch, e.g. two
+ * labels on the same row, and keeps going until nothing more can be merged. */
+static void refr_stat_coalesce(lv_disp_t *disp) {
+  uint32_t buf_px = disp->driver->draw_buf->size;
+  lv_area_t joined;
+  bool merged = true;
+
+  while (merged) {
+    merged = false;
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+      for (uint16_t j = i + 1; j < disp->inv_p; j++) {
+        _lv_area_join(&joined, &disp->inv_areas[i], &disp->inv_areas[j]);
+        if (area_cost(&joined, buf_px) > area_cost(&disp->inv_areas[i], buf_px) + area_cost(&disp->inv_areas[j], buf_px))
+          continue;
+        lv_area_copy(&disp->inv_areas[i], &joined);
+        lv_area_copy(&disp->inv_areas[j], &disp->inv_areas[disp->inv_p - 1]);
+        disp->inv_p--;
+        j = i; // the grown area may now absorb earlier ones
+        merged = true;
+      }
+    }
+  }
+}
+
+/* Moves the areas the overlay invalidated out of the list, so they can be
+ * refreshed on their own and left out of the statistics */
+static uint16_t refr_stat_hold_overlay(lv_disp_t *disp, lv_area_t *held, uint16_t max) {
+  uint16_t n = 0;
+  // A new size invalidates the new coordinates now rather than inside the refresh
+  lv_obj_update_layout(overlay);
+  _lv_area_join(&overlay_area, &overlay_area, &overlay->coords);
+  for (uint16_t i = 0; i < disp->inv_p && n < max;) {
+    if (!_lv_area_is_in(&disp->inv_areas[i], &overlay_area, 0)) {
+      i++;
+      continue;
+    }
+    lv_area_copy(&held[n++], &disp->inv_areas[i]);
+    lv_area_copy(&disp->inv_areas[i], &disp->inv_areas[disp->inv_p - 1]);
+    disp->inv_p--;
+  }
+  return n;
+}
+
+static void refr_stat_timer(lv_timer_t *tmr) {
+  lv_disp_t *disp = (lv_disp_t *)tmr->user_data;
+  lv_area_t held[4];
+  uint16_t held_n = 0;
+
+  if (overlay_dirty && overlay) {
+    overlay_dirty = false;
+    held_n = refr_stat_hold_overlay(disp, held, sizeof(held) / sizeof(held[0]));
+  }
+
+  uint16_t areas = disp->inv_p;
+
+  if (areas && !disp->driver->full_refresh && !disp->driver->direct_mode) {
+    for (uint16_t i = 0; i < areas; i++)
+      stat.dirty_px += lv_area_get_size(&disp->inv_areas[i]);
+    refr_stat_coalesce(disp);
+    stat.areas_in += areas;
+    stat.areas_out += disp->inv_p;
+  }
+
+  uint32_t start = (uint32_t)esp_timer_get_time();
+  if (areas || held_n == 0)
+    _lv_disp_refr_timer(tmr);
+  if (areas) {
+    stat.frames++;
+    stat.frame_us += (uint32_t)esp_timer_get_time() - start;
+  }
+  if (held_n == 0)
+    return;
+
+  // The last part may still be on the wire, its SPI time belongs to the frame
+  lv_disp_draw_buf_t *draw_buf = disp->driver->draw_buf;
+  while (draw_buf->flushing)
+    ;
+  stat_counting = false;
+  for (uint16_t i = 0; i < held_n; i++)
+    _lv_inv_area(disp, &held[i]);
+  _lv_disp_refr_timer(tmr);
+  while (draw_buf->flushing)
+    ;
+  stat_counting = true;
+}
+
+static void refr_stat_report(lv_timer_t *tmr) {
+  uint32_t now = millis();
+  uint32_t period = now - stat_last_report;
+  stat_last_report = now;
+
+  portENTER_CRITICAL(&stat_spi_mux);
+  stat.spi_us = stat_spi_us;
+  stat_spi_us = 0;
+  portEXIT_CRITICAL(&stat_spi_mux);
+  if (stat.frames == 0) {
+    if (overlay) {
+      lv_obj_get_coords(overlay, &overlay_area);
+      overlay_dirty = true;
+      lv_label_set_text(overlay, "idle");
+    }
+    return;
+  }
+
+  uint32_t frames = stat.frames;
+  uint32_t fps = frames * 1000 / period;
+  uint32_t kb = stat.px * 2 / frames / 1024;
+  uint32_t render_us = (stat.frame_us > stat.flush_us ? stat.frame_us - stat.flush_us : 0) / frames;
+  uint32_t flush_us = stat.flush_us / frames;
+  uint32_t spi_us = stat.spi_us / frames;
+  // share of the pushed pixels that was really invalidated, overlaps count twice
+  uint32_t eff = stat.px ? (uint32_t)((uint64_t)stat.dirty_px * 100 / stat.px) : 0;
+
+  if (serial_report)
+    Serial.printf("refr: %u fps, %u KB/frame, render %u us, flush %u us, spi %u us, areas %u->%u, %u parts, dirty/pushed %u%%\r\n",
+                  fps, kb, render_us, flush_us, spi_us, stat.areas_in, stat.areas_out, stat.parts, eff);
+
+  if (overlay) {
+    lv_obj_get_coords(overlay, &overlay_area);
+    overlay_dirty = true;
+    lv_label_set_text_fmt(overlay, "%u fps %u KB\nr %u.%u f %u.%u s %u.%u ms\n%u->%u areas %u%%", fps, kb,
+                          render_us / 1000, render_us / 100 % 10, flush_us / 1000, flush_us / 100 % 10,
+                          spi_us / 1000, spi_us / 100 % 10, stat.areas_in, stat.areas_out, eff);
+  }
+  memset(&stat, 0, sizeof(stat));
+}
+
+void refr_stat_init(lv_disp_t *disp) {
+  lv_timer_set_cb(disp->refr_timer, refr_stat_timer);
+  lv_timer_create(refr_stat_report, REFR_STAT_PERIOD_MS, NULL);
+  stat_last_report = millis();
+}
+
+void refr_stat_set_overlay(bool en) {
+  if (en && !overlay) {
+    overlay = lv_label_create(lv_layer_sys());
+    lv_obj_set_style_text_font(overlay, &lv_font_montserrat_10, 0);
+    lv_obj_set_style_text_color(overlay, lv_color_white(), 0);
+    lv_obj_set_style_bg_color(overlay, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_60, 0);
+    lv_obj_align(overlay, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_label_set_text(overlay, "");
+  } else if (!en && overlay) {
+    lv_obj_del(overlay);
+    overlay = NULL;
+  }
+}
+
+bool refr_stat_get_overlay(void) { return overlay != NULL; }
+
+void refr_stat_set_serial(bool en) { serial_report = en; }
+
+void refr_stat_flush(uint32_t px, uint32_t flush_us) {
+  if (!stat_counting)
+    return;
+  stat.parts++;
+  stat.px += px;
+  stat.flush_us += flush_us;
+}
+
+void IRAM_ATTR refr_stat_spi(uint32_t spi_us) {
+  if (!stat_counting)
+    return;
+  portENTER_CRITICAL_SAFE(&stat_spi_mux);
+  stat_spi_us += spi_us;
+  portEXIT_CRITICAL_SAFE(&stat_spi_mux);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "lvgl.h"
+
+/**
+ * Instrumented refresh for the 320x170 panel.
+ *
+ * Wraps the LVGL display refresh timer: before LVGL renders, the invalidated
+ * areas are coalesced with a cost model that knows the draw buffer is a strip
+ * of the screen (every flushed part costs a window setup and an object tree
+ * walk on top of its pixels). Render, flush and SPI time, bytes pushed and
+ * merge efficiency are accumulated and reported every REFR_STAT_PERIOD_MS,
+ * optionally on Serial and on a small overlay on the system layer. The redraws
+ * of the overlay itself are refreshed separately and not counted.
+ */
+
+// Report period
+#define REFR_STAT_PERIOD_MS    1000
+// Fixed cost of one flushed part, in pixel equivalents (~0.4 ms at 40 MHz SPI)
+#define REFR_STAT_PART_COST_PX 1024
+
+void refr_stat_init(lv_disp_t *disp);
+void refr_stat_set_overlay(bool en);
+bool refr_stat_get_overlay(void);
+void refr_stat_set_serial(bool en);
+
+// Called from the flush callback: pixels of the part and time blocked in the driver
+void refr_stat_flush(uint32_t px, uint32_t flush_us);
+// Called when the SPI transfer of a part ended, may be called from an ISR
+void refr_stat_spi(uint32_t spi_us);
@@ -2,6 +2,7 @@
 #include "Arduino.h"
 #include "SD_MMC.h"
 #include "WiFi.h"
+#include "glyph_cache.h"
 #include "pin_config.h"
 #include "esp_sntp.h"
 #include "time.h"
@@ -173,15 +174,19 @@ static void ui_begin() {
   lv_obj_set_style_bg_color(min_cout, UI_FRAME_COLOR, 0);
   lv_obj_clear_flag(min_cout, LV_OBJ_FLAG_SCROLLABLE);
 
+  // The clock only ever shows these, rendered once and kept
+  const lv_font_t *clock_font = glyph_cache_font(&alibaba_font_60);
+  glyph_cache_pin(clock_font, "0123456789:");
+
   lv_obj_t *seg_text = lv_label_create(main_cout);
   lv_obj_align(seg_text, LV_ALIGN_CENTER, 0, -10);
-  lv_obj_set_style_text_font(seg_text, &alibaba_font_60, 0);
+  lv_obj_set_style_text_font(seg_text, clock_font, 0);
   lv_label_set_text(seg_text, ":");
   lv_obj_set_style_text_color(seg_text, UI_FONT_COLOR, 0);
 
   lv_obj_t *hour_text = lv_label_create(hour_cout);
   lv_obj_center(hour_text);
-  lv_obj_set_style_text_font(hour_text, &alibaba_font_60, 0);
+  lv_obj_set_style_text_font(hour_text, clock_font, 0);
   lv_label_set_text(hour_text, "12");
   lv_obj_set_style_text_color(hour_text, UI_FONT_COLOR, 0);
   lv_obj_add_event_cb(hour_text, update_text_subscriber_cb, LV_EVENT_MSG_RECEIVED, NULL);
@@ -189,11 +194,13 @@ static void ui_begin() {
 
   lv_obj_t *min_text = lv_label_create(min_cout);
   lv_obj_center(min_text);
-  lv_obj_set_style_text_font(min_text, &alibaba_font_60, 0);
+  lv_obj_set_style_text_font(min_text, clock_font, 0);
   lv_label_set_text(min_text, "34");
   lv_obj_set_style_text_color(min_text, UI_FONT_COLOR, 0);
   lv_obj_add_event_cb(min_text, update_text_subscriber_cb, LV_EVENT_MSG_RECEIVED, NULL);
   lv_msg_subsribe_obj(MSG_NEW_MIN, min_text, (void *)"%02d");
+  glyph_cache_track(hour_text);
+  glyph_cache_track(min_text);
 
 
   static lv_style_t style_line;
@@ -0,0 +1,246 @@
+#include "spi_bus.h"
+#include "Arduino.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// a task blocked in spi_bus_acquire(), lives on its stack
+typedef struct spi_waiter {
+  TaskHandle_t task;
+  SemaphoreHandle_t grant;
+  StaticSemaphore_t grant_buf;
+  bool granted;
+  struct spi_waiter *next;
+} spi_waiter_t;
+
+typedef struct {
+  const char *name;
+  int8_t cs;
+  uint8_t prio;
+  SPISettings settings;
+  spi_waiter_t *head; // waiting tasks, FIFO
+  spi_waiter_t *tail;
+  // statistics, reset by spi_bus_report()
+  uint32_t transactions;
+  uint32_t batched;
+  uint32_t bus_us;
+  uint32_t wait_us;
+  uint32_t wait_max_us;
+  uint32_t contended;
+} spi_dev_t;
+
+static SPIClass *bus_spi = NULL;
+static spi_dev_t dev[SPI_BUS_MAX_DEVICE];
+static uint8_t dev_count = 0;
+static portMUX_TYPE bus_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// owner state, guarded by bus_mux
+static int8_t owner = -1;
+static TaskHandle_t owner_task = NULL;
+static uint8_t owner_depth = 0;
+static uint32_t owner_since = 0;
+static uint32_t report_start = 0;
+
+void spi_bus_init(SPIClass *spi) {
+  bus_spi = spi;
+  report_start = (uint32_t)esp_timer_get_time();
+}
+
+int8_t spi_bus_add(const char *name, int8_t cs_pin, uint8_t prio, SPISettings settings) {
+  if (dev_count >= SPI_BUS_MAX_DEVICE)
+    return -1;
+  pinMode(cs_pin, OUTPUT);
+  digitalWrite(cs_pin, HIGH);
+  spi_dev_t *d = &dev[dev_count];
+  *d = spi_dev_t();
+  d->name = name;
+  d->cs = cs_pin;
+  d->prio = prio;
+  d->settings = settings;
+  return dev_count++;
+}
+
+int8_t spi_bus_find(int8_t cs_pin) {
+  for (uint8_t i = 0; i < dev_count; i++) {
+    if (dev[i].cs == cs_pin)
+      return i;
+  }
+  return -1;
+}
+
+/* Under bus_mux: hand the bus to the first waiter of the highest priority device, NULL if nobody waits */
+static spi_waiter_t *bus_pass_on(void) {
+  int8_t best = -1;
+  for (uint8_t i = 0; i < dev_count; i++) {
+    if (dev[i].head && (best < 0 || dev[i].prio > dev[best].prio))
+      best = i;
+  }
+  if (best < 0) {
+    owner = -1;
+    owner_task = NULL;
+    return NULL;
+  }
+  spi_waiter_t *w = dev[best].head;
+  dev[best].head = w->next;
+  if (dev[best].head == NULL)
+    dev[best].tail = NULL;
+  w->granted = true;
+  owner = best;
+  owner_task = w->task;
+  owner_depth = 1;
+  owner_since = (uint32_t)esp_timer_get_time();
+  dev[best].transactions++;
+  return w;
+}
+
+bool spi_bus_acquire(int8_t id, TickType_t timeout) {
+  if (id < 0 || id >= dev_count)
+    return false;
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  spi_dev_t *d = &dev[id];
+
+  portENTER_CRITICAL(&bus_mux);
+  if (owner_task == self && owner == id) { // nested
+    owner_depth++;
+    portEXIT_CRITICAL(&bus_mux);
+    return true;
+  }
+  if (owner < 0) {
+    owner = id;
+    owner_task = self;
+    owner_depth = 1;
+    owner_since = (uint32_t)esp_timer_get_time();
+    d->transactions++;
+    portEXIT_CRITICAL(&bus_mux);
+    return true;
+  }
+  if (owner_task == self || timeout == 0) {
+    // holding another device of this bus would deadlock, it has to be released first
+    d->contended++;
+    portEXIT_CRITICAL(&bus_mux);
+    return false;
+  }
+
+  spi_waiter_t w;
+  w.task = self;
+  w.grant = xSemaphoreCreateBinaryStatic(&w.grant_buf);
+  w.granted = false;
+  w.next = NULL;
+  if (d->tail)
+    d->tail->next = &w;
+  else
+    d->head = &w;
+  d->tail = &w;
+  d->contended++;
+  portEXIT_CRITICAL(&bus_mux);
+
+  uint32_t t = (uint32_t)esp_timer_get_time();
+  bool ok = xSemaphoreTake(w.grant, timeout) == pdTRUE;
+  if (!ok) {
+    portENTER_CRITICAL(&bus_mux);
+    ok = w.granted; // handed over right after the timeout
+    if (!ok) {
+      spi_waiter_t **p = &d->head;
+      spi_waiter_t *prev = NULL;
+      while (*p != &w) {
+        prev = *p;
+        p = &(*p)->next;
+      }
+      *p = w.next;
+      if (d->tail == &w)
+        d->tail = prev;
+    }
+    portEXIT_CRITICAL(&bus_mux);
+    if (ok)
+      xSemaphoreTake(w.grant, portMAX_DELAY); // given just after the grant, does not block long
+  }
+  vSemaphoreDelete(w.grant);
+
+  t = (uint32_t)esp_timer_get_time() - t;
+  portENTER_CRITICAL(&bus_mux);
+  d->wait_us += t;
+  if (t > d->wait_max_us)
+    d->wait_max_us = t;
+  portEXIT_CRITICAL(&bus_mux);
+  return ok;
+}
+
+void spi_bus_release(int8_t id) {
+  spi_waiter_t *next = NULL;
+  portENTER_CRITICAL(&bus_mux);
+  if (owner != id || owner_task != xTaskGetCurrentTaskHandle()) {
+    portEXIT_CRITICAL(&bus_mux);
+    return;
+  }
+  if (--owner_depth == 0) {
+    dev[id].bus_us += (uint32_t)esp_timer_get_time() - owner_since;
+    next = bus_pass_on();
+  }
+  portEXIT_CRITICAL(&bus_mux);
+  if (next)
+    xSemaphoreGive(next->grant);
+}
+
+bool spi_bus_transfer(int8_t id, const spi_bus_xfer_t *xfer, uint8_t count) {
+  if (bus_spi == NULL || !spi_bus_acquire(id))
+    return false;
+  spi_dev_t *d = &dev[id];
+  bus_spi->beginTransaction(d->settings);
+  digitalWrite(d->cs, LOW);
+  for (uint8_t i = 0; i < count; i++) {
+    // transferBytes() takes a non const tx pointer but does not write it
+    bus_spi->transferBytes((uint8_t *)xfer[i].tx, xfer[i].rx, xfer[i].len);
+    if (xfer[i].cs_break && i + 1 < count) {
+      digitalWrite(d->cs, HIGH);
+      digitalWrite(d->cs, LOW);
+    }
+  }
+  digitalWrite(d->cs, HIGH);
+  bus_spi->endTransaction();
+  d->batched++;
+  spi_bus_release(id);
+  return true;
+}
+
+void spi_bus_acquire_cs(int8_t cs_pin) {
+  int8_t id = spi_bus_find(cs_pin);
+  if (id < 0)
+    return;
+  // the hooks cannot fail the driver call: waiting forever only fails when this task holds
+  // another device of the bus, a locking bug that would otherwise corrupt the transfer
+  bool ok = spi_bus_acquire(id);
+  configASSERT(ok);
+  (void)ok;
+}
+
+void spi_bus_release_cs(int8_t cs_pin) { spi_bus_release(spi_bus_find(cs_pin)); }
+
+void spi_bus_report(void) {
+  uint32_t now = (uint32_t)esp_timer_get_time();
+  uint32_t period = now - report_start;
+  report_start = now;
+  if (period < 100)
+    return;
+
+  for (uint8_t i = 0; i < dev_count; i++) {
+    spi_dev_t *d = &dev[i];
+    portENTER_CRITICAL(&bus_mux);
+    uint32_t bus_us = d->bus_us;
+    if (owner == i) { // still held, count up to now
+      bus_us += now - owner_since;
+      owner_since = now;
+    }
+    uint32_t transactions = d->transactions, batched = d->batched, contended = d->contended;
+    uint32_t wait_us = d->wait_us, wait_max_us = d->wait_max_us;
+    d->bus_us = d->transactions = d->batched = d->contended = d->wait_us = d->wait_max_us = 0;
+    portEXIT_CRITICAL(&bus_mux);
+
+    if (transactions == 0 && contended == 0)
+      continue;
+    Serial.printf("spi %-6s %5u xfer/s (%u batched), bus %2u.%u%%", d->name,
+                  (uint32_t)((uint64_t)transactions * 1000000 / period), batched, bus_us / (period / 100),
+                  (bus_us * 10 / (period / 100)) % 10);
+    if (contended)
+      Serial.printf(", waited %u times avg %u us max %u us", contended, wait_us / contended, wait_max_us);
+    Serial.println();
+  }
+}
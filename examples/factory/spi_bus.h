@@ -0,0 +1,83 @@
+#pragma once
+#include <RadioLib.h>
+#include <SPI.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+/**
+ * Arbiter for the devices sharing radioBus (HSPI): CC1101, PN532 and SD.
+ *
+ * A device owns the bus from spi_bus_acquire() until the matching
+ * spi_bus_release(). Only one device is selected at a time, no other chip
+ * select is ever low meanwhile. Calls nest within the owning task, so a
+ * driver sequence (standby, set frequency, start receive) can be wrapped in
+ * one acquire while the driver still acquires per transaction.
+ *
+ * Tasks waiting for a busy bus queue per device. When the bus is released
+ * it goes to the device with the highest priority that has waiters, FIFO
+ * within the device. The radio gets the highest priority, its IRQ
+ * service (FIFO read after GDO0) should never wait for a PN532 poll.
+ *
+ * The libraries are hooked in per transaction: RadioLib via SpiBusModule
+ * below, Adafruit_PN532 via Adafruit_SPIDevice::setBusHooks(). The chip
+ * selects are driven by the drivers, application code must not touch them.
+ */
+
+#define SPI_BUS_MAX_DEVICE 4
+
+enum { SPI_BUS_PRIO_LOW = 0, SPI_BUS_PRIO_NORMAL = 1, SPI_BUS_PRIO_HIGH = 2 };
+
+typedef struct {
+  const uint8_t *tx; // NULL sends 0xFF
+  uint8_t *rx;       // NULL discards
+  uint16_t len;
+  bool cs_break; // deassert the chip select after this segment
+} spi_bus_xfer_t;
+
+void spi_bus_init(SPIClass *spi);
+
+/* Chip select is set up as output, high. Returns the device id, -1 if full */
+int8_t spi_bus_add(const char *name, int8_t cs_pin, uint8_t prio, SPISettings settings);
+/* Device id for a chip select pin, -1 if not registered */
+int8_t spi_bus_find(int8_t cs_pin);
+
+/* Blocks up to timeout ticks, true when the calling task owns the bus for id */
+bool spi_bus_acquire(int8_t id, TickType_t timeout = portMAX_DELAY);
+void spi_bus_release(int8_t id);
+
+/* Run several segments as one transaction of device id (one acquire, one
+ * beginTransaction, chip select low over all segments unless cs_break), each
+ * segment as a single bulk transfer instead of the byte by byte loop of the
+ * drivers. Used for the radio FIFO bursts, counted as "batched". */
+bool spi_bus_transfer(int8_t id, const spi_bus_xfer_t *xfer, uint8_t count);
+
+/* Same as acquire / release by chip select, for the driver hooks. Unknown
+ * pins pass through, the device is then not arbitrated. Asserts if the bus
+ * cannot be acquired. */
+void spi_bus_acquire_cs(int8_t cs_pin);
+void spi_bus_release_cs(int8_t cs_pin);
+
+/* Bus time, transactions and waiting per device since the last report */
+void spi_bus_report(void);
+
+/* RadioLib module whose transactions go through the arbiter */
+class SpiBusModule : public Module {
+public:
+  SpiBusModule(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE rst, RADIOLIB_PIN_TYPE gpio, SPIClass &spi,
+               SPISettings settings = RADIOLIB_DEFAULT_SPI_SETTINGS)
+      : Module(cs, irq, rst, gpio, spi, settings) {
+    setCb_SPIbeginTransaction(static_cast<SPIbeginTransaction_cb_t>(&SpiBusModule::busBeginTransaction));
+    setCb_SPIendTransaction(static_cast<SPIendTransaction_cb_t>(&SpiBusModule::busEndTransaction));
+  }
+
+private:
+  void busBeginTransaction() {
+    spi_bus_acquire_cs(getCs());
+    SPIbeginTransaction();
+  }
+  void busEndTransaction() {
+    SPIendTransaction();
+    spi_bus_release_cs(getCs());
+  }
+};
@@ -0,0 +1,100 @@
+#include "task_stat.h"
+#include "Arduino.h"
+
+typedef struct {
+  const char *name;
+  uint32_t wakeups;
+  uint32_t idle_us;
+  uint32_t sleep_start; // esp_timer time of the last task_stat_sleep()
+  bool sleeping;
+  uint32_t latency_us;
+  uint32_t latency_max;
+  uint32_t latency_count;
+  task_stat_info_t last; // written by task_stat_report()
+} task_stat_t;
+
+static task_stat_t stat[TASK_STAT_MAX];
+static uint8_t stat_count = 0;
+static uint32_t stat_period_start = 0;
+static bool serial_report = false;
+
+int8_t task_stat_register(const char *name) {
+  if (stat_count >= TASK_STAT_MAX)
+    return -1;
+  if (stat_count == 0)
+    stat_period_start = (uint32_t)esp_timer_get_time();
+  memset(&stat[stat_count], 0, sizeof(task_stat_t));
+  stat[stat_count].name = name;
+  stat[stat_count].last.name = name;
+  return stat_count++;
+}
+
+void task_stat_sleep(int8_t id) {
+  if (id < 0)
+    return;
+  stat[id].sleep_start = (uint32_t)esp_timer_get_time();
+  stat[id].sleeping = true;
+}
+
+void task_stat_wake(int8_t id) {
+  if (id < 0)
+    return;
+  stat[id].sleeping = false;
+  stat[id].idle_us += (uint32_t)esp_timer_get_time() - stat[id].sleep_start;
+  stat[id].wakeups++;
+}
+
+void task_stat_latency(int8_t id, uint32_t us) {
+  if (id < 0)
+    return;
+  stat[id].latency_us += us;
+  stat[id].latency_count++;
+  if (us > stat[id].latency_max)
+    stat[id].latency_max = us;
+}
+
+void task_stat_report(void) {
+  uint32_t now = (uint32_t)esp_timer_get_time();
+  uint32_t period = now - stat_period_start;
+  stat_period_start = now;
+  if (period == 0)
+    return;
+
+  for (uint8_t i = 0; i < stat_count; i++) {
+    task_stat_t *s = &stat[i];
+    // a task blocked right now gets the idle time up to here, the rest goes to the next period
+    if (s->sleeping) {
+      s->idle_us += now - s->sleep_start;
+      s->sleep_start = now;
+    }
+    uint32_t idle = s->idle_us > period ? period : s->idle_us;
+    task_stat_info_t *l = &s->last;
+    l->wakeups_per_s = (uint32_t)((uint64_t)s->wakeups * 1000000 / period);
+    l->load_permille = (uint64_t)(period - idle) * 1000 / period;
+    l->latency_avg_us = s->latency_count ? s->latency_us / s->latency_count : 0;
+    l->latency_max_us = s->latency_max;
+
+    if (serial_report) {
+      Serial.printf("task %-10s %4u wakeups/s, load %2u.%u%%", s->name, l->wakeups_per_s, l->load_permille / 10,
+                    l->load_permille % 10);
+      if (s->latency_count)
+        Serial.printf(", latency avg %u us max %u us", l->latency_avg_us, l->latency_max_us);
+      Serial.println();
+    }
+
+    s->wakeups = 0;
+    s->idle_us = 0;
+    s->latency_us = 0;
+    s->latency_max = 0;
+    s->latency_count = 0;
+  }
+}
+
+void task_stat_set_serial(bool en) { serial_report = en; }
+
+bool task_stat_get(int8_t id, task_stat_info_t *info) {
+  if (id < 0 || id >= stat_count)
+    return false;
+  *info = stat[id].last;
+  return true;
+}
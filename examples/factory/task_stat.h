@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+/**
+ * Per task load accounting for the event driven tasks.
+ *
+ * A task calls task_stat_sleep() right before it blocks (notification,
+ * queue, event group, delay) and task_stat_wake() when it runs again. The
+ * time in between is idle time, the rest counts as busy. Each slot is only
+ * written by its own task, task_stat_report() closes the period for all of
+ * them and prints it when enabled with task_stat_set_serial().
+ */
+
+#define TASK_STAT_MAX       6
+#define TASK_STAT_PERIOD_MS 5000
+
+int8_t task_stat_register(const char *name);
+void task_stat_sleep(int8_t id);
+void task_stat_wake(int8_t id);
+// Time from the event (e.g. an ISR) until the task handled it
+void task_stat_latency(int8_t id, uint32_t us);
+
+typedef struct {
+  const char *name;
+  uint32_t wakeups_per_s;
+  uint16_t load_permille;
+  uint32_t latency_avg_us;
+  uint32_t latency_max_us;
+} task_stat_info_t;
+
+void task_stat_report(void);
+void task_stat_set_serial(bool en);
+// Figures of the last report period, false for an unknown id
+bool task_stat_get(int8_t id, task_stat_info_t *info);
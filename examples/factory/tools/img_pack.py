@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+Packs LVGL image converter output (C array, true color / true color alpha) into
+the compressed format of img_pack.h.
+
+    python3 tools/img_pack.py src/img_led.c [src/img_mic.c ...]
+
+Each file is replaced by a packed one with the same lv_img_dsc_t name. Only the
+LV_COLOR_DEPTH 16, LV_COLOR_16_SWAP 0 pixels are kept (see lv_conf.h).
+
+Pixels go through an indexed palette when the image has at most 256 distinct
+pixels (color + alpha) and that comes out smaller, then through an LZ4 block
+(the plain LZ4 block format, no frame). Every asset is decoded again before it
+is written and compared with the original pixels.
+"""
+import re
+import sys
+
+HASH_CHAIN = 64      # match candidates tried per position
+MIN_MATCH = 4
+LAST_LITERALS = 5    # LZ4 block rules: the last 5 bytes are literals,
+MF_LIMIT = 12        # no match starts in the last 12 bytes
+MAX_OFFSET = 65535
+
+
+def lz4_pack(src):
+    n = len(src)
+    out = bytearray()
+    head = {}
+    prev = [-1] * n
+    i = anchor = 0
+
+    def put_len(l):
+        while l >= 255:
+            out.append(255)
+            l -= 255
+        out.append(l)
+
+    def insert(p):
+        if p + MIN_MATCH <= n:
+            k = src[p:p + MIN_MATCH]
+            prev[p] = head.get(k, -1)
+            head[k] = p
+
+    while i < n - MF_LIMIT:
+        key = src[i:i + MIN_MATCH]
+        cand = head.get(key, -1)
+        best = offset = tries = 0
+        while cand >= 0 and i - cand <= MAX_OFFSET and tries < HASH_CHAIN:
+            if src[cand:cand + MIN_MATCH] == key:
+                l = MIN_MATCH
+                while i + l < n - LAST_LITERALS and src[cand + l] == src[i + l]:
+                    l += 1
+                if l > best:
+                    best, offset = l, i - cand
+            cand = prev[cand]
+            tries += 1
+        if best < MIN_MATCH:
+            insert(i)
+            i += 1
+            continue
+        lit = i - anchor
+        ml = best - MIN_MATCH
+        out.append((min(lit, 15) << 4) | min(ml, 15))
+        if lit >= 15:
+            put_len(lit - 15)
+        out += src[anchor:i]
+        out += bytes((offset & 0xFF, offset >> 8))
+        if ml >= 15:
+            put_len(ml - 15)
+        for p in range(i, i + best):
+            insert(p)
+        i += best
+        anchor = i
+
+    lit = n - anchor
+    out.append(min(lit, 15) << 4)
+    if lit >= 15:
+        put_len(lit - 15)
+    out += src[anchor:]
+    return bytes(out)
+
+
+def lz4_unpack(src, size):
+    out = bytearray()
+    i = 0
+    while True:
+        token = src[i]
+        i += 1
+        lit = token >> 4
+        if lit == 15:
+            while True:
+                b = src[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += src[i:i + lit]
+        i += lit
+        if i >= len(src):
+            break
+        offset = src[i] | src[i + 1] << 8
+        i += 2
+        ml = token & 15
+        if ml == 15:
+            while True:
+                b = src[i]
+                i += 1
+                ml += b
+                if b != 255:
+                    break
+        for _ in range(ml + MIN_MATCH):
+            out.append(out[-offset])
+    if len(out) != size:
+        raise ValueError("LZ4 block decodes to %d bytes, not %d" % (len(out), size))
+    return bytes(out)
+
+
+def parse(text, path):
+    if "img_pack.h" in text:
+        raise ValueError("%s is packed already" % path)
+    name = re.search(r"const lv_img_dsc_t (\w+) =", text).group(1)
+    cf = re.search(r"\.header\.cf = (\w+)", text).group(1)
+    w = int(re.search(r"\.header\.w = (\d+)", text).group(1))
+    h = int(re.search(r"\.header\.h = (\d+)", text).group(1))
+    if cf not in ("LV_IMG_CF_TRUE_COLOR", "LV_IMG_CF_TRUE_COLOR_ALPHA"):
+        raise ValueError("%s: %s is not supported" % (path, cf))
+    start = text.index("#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0")
+    section = text[text.index("\n", start):text.index("#endif", start)]
+    section = re.sub(r"/\*.*?\*/", "", section, flags=re.S)
+    data = bytes(int(x, 16) for x in re.findall(r"0x([0-9a-fA-F]{2})", section))
+    px_size = 3 if cf.endswith("ALPHA") else 2
+    if len(data) != w * h * px_size:
+        raise ValueError("%s: %d bytes of pixels, expected %d" % (path, len(data), w * h * px_size))
+    return name, cf, w, h, px_size, data
+
+
+def pack(data, px_size):
+    """Returns (palette bytes, colors, LZ4 block), the smaller of indexed and direct."""
+    direct = lz4_pack(data)
+    pixels = [data[i:i + px_size] for i in range(0, len(data), px_size)]
+    colors = sorted(set(pixels))
+    if len(colors) <= 256:
+        index = {c: i for i, c in enumerate(colors)}
+        indexed = lz4_pack(bytes(index[p] for p in pixels))
+        if len(indexed) + len(colors) * px_size < len(direct):
+            return b"".join(colors), len(colors), indexed
+    return b"", 0, direct
+
+
+def unpack(palette, colors, block, raw_size, px_size):
+    if colors == 0:
+        return lz4_unpack(block, raw_size)
+    indices = lz4_unpack(block, raw_size // px_size)
+    return b"".join(palette[i * px_size:(i + 1) * px_size] for i in indices)
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def write(path, name, cf, w, h, px_size, data, palette, colors, block):
+    out = []
+    out.append("// Packed by tools/img_pack.py from the LVGL image converter output, see img_pack.h")
+    out.append('#include "../img_pack.h"')
+    out.append("")
+    out.append("#if LV_COLOR_DEPTH != 16 || LV_COLOR_16_SWAP != 0")
+    out.append('#error "%s is packed for RGB565 without byte swap, pack it again from the converter output"' % name)
+    out.append("#endif")
+    out.append("")
+    if colors:
+        out.append("// %d colors, %s" % (colors, "RGB565 + alpha" if px_size == 3 else "RGB565"))
+        out.append("static const uint8_t %s_palette[] = {" % name)
+        out.append(c_array(palette))
+        out.append("};")
+        out.append("")
+    out.append("// %s, %d bytes unpacked" % ("palette indices" if colors else "pixels", len(data) // px_size if colors else len(data)))
+    out.append("static const uint8_t %s_lz4[] = {" % name)
+    out.append(c_array(block))
+    out.append("};")
+    out.append("")
+    out.append("static const img_pack_t %s_pack = {" % name)
+    out.append("  .magic = IMG_PACK_MAGIC,")
+    out.append('  .name = "%s",' % name)
+    out.append("  .cf = %s," % cf)
+    out.append("  .colors = %d," % colors)
+    out.append("  .raw_size = %d," % len(data))
+    out.append("  .palette = %s," % ("%s_palette" % name if colors else "NULL"))
+    out.append("  .lz4 = %s_lz4," % name)
+    out.append("  .lz4_size = sizeof(%s_lz4)," % name)
+    out.append("};")
+    out.append("")
+    out.append("const lv_img_dsc_t %s = {" % name)
+    out.append("  .header.cf = %s," % ("LV_IMG_CF_RAW_ALPHA" if px_size == 3 else "LV_IMG_CF_RAW"))
+    out.append("  .header.always_zero = 0,")
+    out.append("  .header.reserved = 0,")
+    out.append("  .header.w = %d," % w)
+    out.append("  .header.h = %d," % h)
+    out.append("  .data_size = sizeof(img_pack_t),")
+    out.append("  .data = (const uint8_t *)&%s_pack," % name)
+    out.append("};")
+    with open(path, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+def main(paths):
+    if not paths:
+        print(__doc__.strip())
+        return 2
+    total_raw = total_packed = 0
+    for path in paths:
+        with open(path) as f:
+            text = f.read()
+        name, cf, w, h, px_size, data = parse(text, path)
+        palette, colors, block = pack(data, px_size)
+        if unpack(palette, colors, block, len(data), px_size) != data:
+            raise ValueError("%s: the packed pixels do not decode to the original" % path)
+        write(path, name, cf, w, h, px_size, data, palette, colors, block)
+        packed = len(palette) + len(block)
+        total_raw += len(data)
+        total_packed += packed
+        print("%-18s %3dx%-3d %-5s %s %6d -> %6d bytes (%d%%)" % (name, w, h, "alpha" if px_size == 3 else "",
+              "%3d colors" % colors if colors else "    direct", len(data), packed, 100 * packed // len(data)))
+    print("%-18s %27d -> %6d bytes (%d%%)" % ("total", total_raw, total_packed, 100 * total_packed // total_raw))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
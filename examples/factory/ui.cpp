@@ -1,6 +1,8 @@
 #include "ui.h"
 #include "Arduino.h"
 #include "app_typedef.h"
+#include "gif_cache.h"
+#include "glyph_cache.h"
 #include "global_flags.h"
 #include "lvgl.h"
 
@@ -23,9 +25,8 @@ static lv_indev_t *indev;
 void menu_name_label_event_cb(lv_event_t *e);
 
 void ui_boot_anim() {
-  lv_obj_t *logo_img = lv_gif_create(lv_scr_act());
+  lv_obj_t *logo_img = gif_cache_create(lv_scr_act(), &lilygo2_gif);
   lv_obj_center(logo_img);
-  lv_gif_set_src(logo_img, &lilygo2_gif);
   LV_DELAY(500);
   lv_obj_del(logo_img);
 }
@@ -148,10 +149,11 @@ void ui_init(void) {
   lv_obj_set_width(desc_label, LV_PCT(100));
   lv_obj_align(desc_label, LV_ALIGN_BOTTOM_MID, 0, -10);
   lv_obj_set_style_text_align(desc_label, LV_TEXT_ALIGN_CENTER, 0);
-  lv_obj_set_style_text_font(desc_label, &alibaba_font, 0);
+  lv_obj_set_style_text_font(desc_label, glyph_cache_font(&alibaba_font), 0);
   lv_label_set_long_mode(desc_label, LV_LABEL_LONG_SCROLL_CIRCULAR);
   lv_obj_add_event_cb(desc_label, menu_name_label_event_cb, LV_EVENT_MSG_RECEIVED, NULL);
   lv_msg_subsribe_obj(MSG_MENU_NAME_CHANGED, desc_label, NULL);
+  glyph_cache_track(desc_label);
 
   lv_event_send(lv_obj_get_child(panel, 0), LV_EVENT_FOCUSED, NULL);
   lv_obj_update_snap(panel, LV_ANIM_ON);
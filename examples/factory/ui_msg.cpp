@@ -0,0 +1,123 @@
+#include "ui_msg.h"
+#include "lvgl.h"
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+
+// set in 'middle' while the slot holds an update the UI has not taken yet
+#define SLOT_DIRTY 0x80
+
+typedef struct {
+  uint32_t id;
+  size_t size;
+  uint8_t *data;               // three slots of 'size' bytes
+  std::atomic<uint8_t> middle; // published slot, exchanged by producer and consumer
+  uint8_t back;                // slot being written, owned by the producer holding 'busy'
+  uint8_t front;               // slot last handed to LVGL, owned by ui_task
+  std::atomic<bool> busy;      // a producer is writing 'back'
+} ui_mailbox_t;
+
+static ui_mailbox_t mailbox[UI_MSG_MAX_MAILBOX];
+static std::atomic<uint8_t> mailbox_count{0};
+static std::atomic<uint32_t> posted{0};
+static std::atomic<uint32_t> coalesced{0};
+static std::atomic<uint32_t> dropped{0};
+static TaskHandle_t consumer = NULL;
+
+static ui_mailbox_t *find_mailbox(uint32_t msg_id) {
+  uint8_t n = mailbox_count.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < n; i++) {
+    if (mailbox[i].id == msg_id)
+      return &mailbox[i];
+  }
+  return NULL;
+}
+
+bool ui_msg_register(uint32_t msg_id, size_t size) {
+  uint8_t n = mailbox_count.load(std::memory_order_relaxed);
+  if (find_mailbox(msg_id) || n >= UI_MSG_MAX_MAILBOX)
+    return false;
+
+  ui_mailbox_t *mb = &mailbox[n];
+  mb->data = (uint8_t *)calloc(3, size);
+  if (mb->data == NULL)
+    return false;
+  mb->id = msg_id;
+  mb->size = size;
+  mb->back = 0;
+  mb->middle = 1;
+  mb->front = 2;
+  mb->busy = false;
+  mailbox_count.store(n + 1, std::memory_order_release);
+  return true;
+}
+
+void ui_msg_set_consumer(TaskHandle_t task) { consumer = task; }
+
+/* Claim the back slot, NULL if the mailbox is unknown or in use by another producer */
+static uint8_t *post_begin(ui_mailbox_t *mb) {
+  bool expected = false;
+  if (!mb->busy.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return NULL;
+  }
+  return &mb->data[mb->back * mb->size];
+}
+
+/* Publish the back slot and take the previous middle one as the new back slot */
+static void post_end(ui_mailbox_t *mb) {
+  uint8_t prev = mb->middle.exchange(mb->back | SLOT_DIRTY, std::memory_order_acq_rel);
+  mb->back = prev & ~SLOT_DIRTY;
+  if (prev & SLOT_DIRTY)
+    coalesced.fetch_add(1, std::memory_order_relaxed);
+  posted.fetch_add(1, std::memory_order_relaxed);
+  mb->busy.store(false, std::memory_order_release);
+  if (consumer)
+    xTaskNotifyGive(consumer);
+}
+
+bool ui_msg_post(uint32_t msg_id, const void *payload, size_t size) {
+  ui_mailbox_t *mb = find_mailbox(msg_id);
+  if (mb == NULL || size > mb->size)
+    return false;
+  uint8_t *slot = post_begin(mb);
+  if (slot == NULL)
+    return false;
+  memcpy(slot, payload, size);
+  post_end(mb);
+  return true;
+}
+
+bool ui_msg_post_text(uint32_t msg_id, const char *txt) {
+  ui_mailbox_t *mb = find_mailbox(msg_id);
+  if (mb == NULL)
+    return false;
+  char *slot = (char *)post_begin(mb);
+  if (slot == NULL)
+    return false;
+  strncpy(slot, txt ? txt : "", mb->size - 1);
+  slot[mb->size - 1] = '\0';
+  post_end(mb);
+  return true;
+}
+
+uint32_t ui_msg_dispatch(void) {
+  uint32_t sent = 0;
+  uint8_t n = mailbox_count.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < n; i++) {
+    ui_mailbox_t *mb = &mailbox[i];
+    if (!(mb->middle.load(std::memory_order_relaxed) & SLOT_DIRTY))
+      continue;
+    uint8_t prev = mb->middle.exchange(mb->front, std::memory_order_acq_rel);
+    mb->front = prev & ~SLOT_DIRTY;
+    lv_msg_send(mb->id, &mb->data[mb->front * mb->size]);
+    sent++;
+  }
+  return sent;
+}
+
+uint32_t ui_msg_get_posted(void) { return posted.load(std::memory_order_relaxed); }
+
+uint32_t ui_msg_get_coalesced(void) { return coalesced.load(std::memory_order_relaxed); }
+
+uint32_t ui_msg_get_dropped(void) { return dropped.load(std::memory_order_relaxed); }
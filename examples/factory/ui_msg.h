@@ -0,0 +1,49 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * Mailboxes between the worker tasks and the UI task.
+ *
+ * LVGL is not thread safe, so tasks other than ui_task must not call
+ * lv_msg_send() or touch objects. They post into a mailbox instead: every
+ * message ID owns a fixed size triple buffer, a post copies the payload into
+ * the free slot and publishes it with one atomic exchange. Posting never
+ * blocks and never allocates, an update that the UI has not picked up yet is
+ * simply replaced by the newer one (only the latest FFT frame or music time
+ * matters).
+ *
+ * ui_task calls ui_msg_dispatch() once per lv_timer_handler() tick, which
+ * forwards every new payload with lv_msg_send(). The payload pointer given to
+ * subscribers is valid for the duration of their callback. If a consumer task
+ * is set, every post also sends it a task notification so it can sleep until
+ * there is something to draw.
+ */
+
+#define UI_MSG_MAX_MAILBOX 12
+
+/* Create the mailbox for msg_id, call once from ui_task before the producers run */
+bool ui_msg_register(uint32_t msg_id, size_t size);
+
+/* Task notified (xTaskNotifyGive) after each post, NULL for none */
+void ui_msg_set_consumer(TaskHandle_t task);
+
+/* Any task: copy size bytes (<= registered size) into the mailbox. Returns false
+ * if the mailbox does not exist or another task is posting to it right now. */
+bool ui_msg_post(uint32_t msg_id, const void *payload, size_t size);
+/* Same for a string, truncated to the mailbox size */
+bool ui_msg_post_text(uint32_t msg_id, const char *txt);
+
+template <typename T> static inline bool ui_msg_post(uint32_t msg_id, const T &value) {
+  return ui_msg_post(msg_id, &value, sizeof(T));
+}
+
+/* ui_task only: forward the pending updates to the LVGL subscribers */
+uint32_t ui_msg_dispatch(void);
+
+/* statistics over all mailboxes */
+uint32_t ui_msg_get_posted(void);
+uint32_t ui_msg_get_coalesced(void);
+uint32_t ui_msg_get_dropped(void);
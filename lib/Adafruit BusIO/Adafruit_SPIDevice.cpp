@@ -283,6 +283,8 @@ uint8_t Adafruit_SPIDevice::transfer(uint8_t send) {
 void Adafruit_SPIDevice::beginTransaction(void) {
   if (_spi) {
 #ifdef BUSIO_HAS_HW_SPI
+    if (_busAcquire)
+      _busAcquire(_cs);
     _spi->beginTransaction(*_spiSetting);
 #endif
   }
@@ -295,10 +297,27 @@ void Adafruit_SPIDevice::endTransaction(void) {
   if (_spi) {
 #ifdef BUSIO_HAS_HW_SPI
     _spi->endTransaction();
+    if (_busRelease)
+      _busRelease(_cs);
 #endif
   }
 }
 
+Adafruit_SPIDevice::bus_hook_t Adafruit_SPIDevice::_busAcquire = nullptr;
+Adafruit_SPIDevice::bus_hook_t Adafruit_SPIDevice::_busRelease = nullptr;
+
+/*!
+ *    @brief  Set the functions called before beginTransaction() and after
+ *            endTransaction() of every hardware SPI device
+ *    @param  acquire Gets the chip select pin of the device, may block until
+ *            the bus is free
+ *    @param  release Gets the chip select pin of the device
+ */
+void Adafruit_SPIDevice::setBusHooks(bus_hook_t acquire, bus_hook_t release) {
+  _busAcquire = acquire;
+  _busRelease = release;
+}
+
 /*!
  *    @brief  Assert/Deassert the CS pin if it is defined
  *    @param  value The state the CS is set to
@@ -118,7 +118,13 @@ public:
   void beginTransactionWithAssertingCS();
   void endTransactionWithDeassertingCS();
 
+  /*! Called with the chip select pin around every hardware SPI transaction,
+   *  lets several devices on one bus be arbitrated. nullptr to disable. */
+  typedef void (*bus_hook_t)(int8_t cspin);
+  static void setBusHooks(bus_hook_t acquire, bus_hook_t release);
+
 private:
+  static bus_hook_t _busAcquire, _busRelease;
 #ifdef BUSIO_HAS_HW_SPI
   SPIClass *_spi = nullptr;
   SPISettings *_spiSetting = nullptr;
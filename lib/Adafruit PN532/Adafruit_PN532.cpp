@@ -537,6 +537,102 @@ bool Adafruit_PN532::setPassiveActivationRetries(uint8_t maxRetries) {
   return 1;
 }
 
+/**************************************************************************/
+/*!
+    @brief  Writes a command frame and returns at once. Unlike
+            sendCommandCheckAck() this does not wait for the PN532: the
+            caller checks responseReady() (or the IRQ pin) from time to
+            time, then takes the ACK with readAck(), waits for ready again
+            and takes the response with readResponse(). Each step is one
+            short bus transaction, the bus is free in between.
+
+    @param  cmd       Pointer to the command buffer
+    @param  cmdlen    Command length in bytes
+*/
+/**************************************************************************/
+void Adafruit_PN532::startCommand(uint8_t *cmd, uint8_t cmdlen) {
+  writecommand(cmd, cmdlen);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Checks once whether the PN532 has an ACK or response frame
+            ready, without waiting.
+
+    @returns  true if a frame can be read
+*/
+/**************************************************************************/
+bool Adafruit_PN532::responseReady(void) { return isready(); }
+
+/**************************************************************************/
+/*!
+    @brief  Reads the ACK frame of the command started by startCommand(),
+            only after responseReady().
+
+    @returns  true if the PN532 acknowledged the command
+*/
+/**************************************************************************/
+bool Adafruit_PN532::readAck(void) { return readack(); }
+
+/**************************************************************************/
+/*!
+    @brief  Reads the response frame of the command started by
+            startCommand(), only after readAck() and responseReady().
+
+    @param  response   Buffer for the response code (command + 1) and
+                       the data that follows it. The whole frame is read
+                       into it first, so it needs 8 bytes more than the
+                       longest response expected.
+    @param  maxLength  Size of the buffer, a longer frame is an error
+
+    @returns  Number of bytes in response, -1 for a broken frame
+*/
+/**************************************************************************/
+int16_t Adafruit_PN532::readResponse(uint8_t *response, uint8_t maxLength) {
+  // preamble, start code, LEN, LCS, TFI ... DCS, postamble
+  readdata(response, maxLength);
+
+  if (maxLength < 8 || response[0] != 0 || response[1] != 0 ||
+      response[2] != 0xFF) {
+    return -1;
+  }
+  uint8_t length = response[3];
+  if (response[4] != (uint8_t)(~length + 1) || length < 2 ||
+      length + 7 > maxLength || response[5] != PN532_PN532TOHOST) {
+    return -1;
+  }
+  uint8_t checksum = 0;
+  for (uint8_t i = 0; i < length + 1; i++) {
+    checksum += response[5 + i];
+  }
+  if (checksum != 0) {
+    return -1;
+  }
+
+  // TFI is not passed on
+  length--;
+  memmove(response, response + 6, length);
+  return length;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Aborts the command in progress (e.g. InListPassiveTarget still
+            waiting for a card) by sending an ACK frame to the PN532.
+*/
+/**************************************************************************/
+void Adafruit_PN532::abortCommand(void) {
+  if (spi_dev) {
+    uint8_t packet[7] = {PN532_SPI_DATAWRITE};
+    memcpy(packet + 1, pn532ack, 6);
+    spi_dev->write(packet, 7);
+  } else if (i2c_dev) {
+    i2c_dev->write(pn532ack, 6);
+  } else if (ser_dev) {
+    ser_dev->write(pn532ack, 6);
+  }
+}
+
 /***** ISO14443A Commands ******/
 
 /**************************************************************************/
@@ -160,6 +160,13 @@ public:
   uint8_t readGPIO(void);
   bool setPassiveActivationRetries(uint8_t maxRetries);
 
+  // Non-blocking command interface, nothing in here waits for the PN532
+  void startCommand(uint8_t *cmd, uint8_t cmdlen);
+  bool responseReady(void);
+  bool readAck(void);
+  int16_t readResponse(uint8_t *response, uint8_t maxLength);
+  void abortCommand(void);
+
   // ISO14443A functions
   bool readPassiveTargetID(
       uint8_t cardbaudrate, uint8_t *uid, uint8_t *uidLength,
@@ -0,0 +1,25 @@
+// Host stand-in for Adafruit_PN532: the calls nfc_reader makes, answered by the fake PN532 in
+// reader_bench.cpp. Constants as in ../../Adafruit_PN532.h.
+#pragma once
+#include <stdint.h>
+
+#define PN532_COMMAND_SAMCONFIGURATION    (0x14)
+#define PN532_COMMAND_RFCONFIGURATION     (0x32)
+#define PN532_COMMAND_INLISTPASSIVETARGET (0x4A)
+#define PN532_COMMAND_INDATAEXCHANGE      (0x40)
+#define PN532_RESPONSE_INDATAEXCHANGE     (0x41)
+#define PN532_RESPONSE_INLISTPASSIVETARGET (0x4B)
+#define PN532_MIFARE_ISO14443A            (0x00)
+#define MIFARE_CMD_AUTH_A                 (0x60)
+#define MIFARE_CMD_READ                   (0x30)
+
+class Adafruit_PN532 {
+public:
+  bool SAMConfig(void);
+  bool setPassiveActivationRetries(uint8_t maxRetries);
+  void startCommand(uint8_t *cmd, uint8_t cmdlen);
+  bool responseReady(void);
+  bool readAck(void);
+  int16_t readResponse(uint8_t *response, uint8_t maxLength);
+  void abortCommand(void);
+};
@@ -0,0 +1,38 @@
+// Host stand-in for the Arduino core, only what the factory NFC reader uses. The clock and the
+// pins are those of the simulation in reader_bench.cpp.
+#pragma once
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IRAM_ATTR
+#define LOW          0
+#define HIGH         1
+#define INPUT_PULLUP 0x05
+#define FALLING      0x02
+
+int64_t esp_timer_get_time(void);
+void delay(uint32_t ms);
+int digitalRead(uint8_t pin);
+void pinMode(uint8_t pin, uint8_t mode);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+
+#define MALLOC_CAP_SPIRAM 0
+static inline void *heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+static inline void heap_caps_free(void *p) { free(p); }
+
+struct HostSerial {
+  int printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n;
+  }
+  void print(const char *s) { fputs(s, stdout); }
+  void print(char c) { putchar(c); }
+  void println(void) { putchar('\n'); }
+};
+extern HostSerial Serial;
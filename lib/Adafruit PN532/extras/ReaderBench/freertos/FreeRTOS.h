@@ -0,0 +1,11 @@
+// Host stand-in for FreeRTOS, one task and a 1 ms tick
+#pragma once
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+#define pdTRUE             1
+#define pdFALSE            0
+#define portMAX_DELAY      0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(ms))
+#define portYIELD_FROM_ISR()
@@ -0,0 +1,36 @@
+// Single task queue: a ring of copies, nothing waits
+#pragma once
+#include "FreeRTOS.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  uint8_t *items;
+  uint32_t size, length, head, count;
+} HostQueue;
+typedef HostQueue *QueueHandle_t;
+
+static inline QueueHandle_t xQueueCreate(uint32_t length, uint32_t size) {
+  HostQueue *q = (HostQueue *)calloc(1, sizeof(HostQueue));
+  q->items = (uint8_t *)malloc(length * size);
+  q->size = size;
+  q->length = length;
+  return q;
+}
+
+static inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t wait) {
+  if (q->count == q->length)
+    return pdFALSE;
+  memcpy(q->items + (q->head + q->count) % q->length * q->size, item, q->size);
+  q->count++;
+  return pdTRUE;
+}
+
+static inline BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t wait) {
+  if (q->count == 0)
+    return pdFALSE;
+  memcpy(item, q->items + q->head * q->size, q->size);
+  q->head = (q->head + 1) % q->length;
+  q->count--;
+  return pdTRUE;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void) { return (TaskHandle_t)1; }
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) { *woken = pdTRUE; }
@@ -0,0 +1,393 @@
+/*
+  reader_bench.cpp
+
+  Host model of the factory NFC reader (examples/factory/nfc_reader.cpp and nfc_dump.cpp), not an
+  Arduino sketch. The reader is built against the Arduino.h, Adafruit_PN532.h and freertos/ in
+  this directory and talks to a fake PN532 on a simulated clock: SPI transfers take their time at
+  the 1 MHz of the factory, commands take what the ISO14443A air interface needs, and cards enter
+  and leave the field on a fixed schedule. The loop sleeps the way nfc_task does, for the ticks
+  nfc_reader_service() returns or until the IRQ edge.
+
+    g++ -O2 -I. -I../../../../examples/factory ../../../../examples/factory/nfc_reader.cpp \
+      ../../../../examples/factory/nfc_dump.cpp reader_bench.cpp -o reader_bench && ./reader_bench
+
+  Per card type, with the status byte polled and with the IRQ pin, it prints the latency the
+  reader reports, the true one (card in the field to event queued, only known here) and the dump
+  time alone, which is what the latency was before it counted from the poll. After the polled run
+  one card is printed back from the dump cache with nfc_dump_print(). Exits with 1 when a
+  card is missed or reported twice, or a reported latency is further from the true one than the
+  poll interval (early) or the PN532 polling cycle and activation (late) explain.
+
+  The figures come from the timing constants below, not from a board.
+*/
+#include "Arduino.h"
+#include "nfc_reader.h"
+#include <stdio.h>
+#include <vector>
+
+static const uint8_t IRQ_PIN = 9;
+static const uint32_t PRESENTS = 20;  // of each card
+static const uint32_t IN_FIELD_MS = 1500;
+
+// timing model
+static const uint32_t SPI_BYTE_US = 8;      // 1 MHz
+static const uint32_t SPI_SETUP_US = 15;    // CS and driver per transfer
+static const uint32_t ACK_US = 600;         // command frame in to ACK ready
+static const uint32_t LOCAL_US = 500;       // command without the card
+static const uint32_t CYCLE_US = 5000;      // a card entering is found within one polling cycle
+static const uint32_t EXCHANGE_US = 700;    // framing, CRC and frame delay per InDataExchange
+static const uint32_t AUTH_US = 2500;       // three pass authentication
+static const uint32_t WAKE_US = 50;         // IRQ edge to the task running
+static uint32_t air_us(uint32_t bytes) { return bytes * 9 * 944 / 100; } // 106 kbit/s, parity
+
+HostSerial Serial;
+
+typedef struct {
+  const char *name;
+  uint8_t sak;
+  uint16_t atqa;
+  uint8_t uid_len;
+  uint8_t version_type; // GET_VERSION product type, 0: NAK
+  uint8_t version_storage;
+  uint16_t size;        // bytes
+  const uint8_t *sector_key; // Classic: index in nfc_dump_keys per sector
+} card_t;
+
+static const uint8_t mad_card_keys[16] = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2};
+static const card_t cards[] = {
+    {"NTAG215", 0x00, 0x0044, 7, 0x04, 0x11, 135 * 4, NULL},
+    {"NTAG213", 0x00, 0x0044, 7, 0x04, 0x0F, 45 * 4, NULL},
+    {"Ultralight", 0x00, 0x0044, 7, 0, 0, 16 * 4, NULL},
+    {"Classic 1K", 0x08, 0x0004, 4, 0, 0, 1024, mad_card_keys},
+};
+#define CARD_TYPES (sizeof(cards) / sizeof(cards[0]))
+
+typedef struct {
+  const card_t *card;
+  uint8_t uid[7];
+  uint64_t arrive_us, leave_us;
+  uint32_t events;
+} present_t;
+
+static uint64_t sim_us = 0;
+static std::vector<present_t> schedule;
+static uint32_t rng = 12345;
+static uint32_t rnd(uint32_t n) {
+  rng = rng * 1103515245 + 12345;
+  return (rng >> 8) % n;
+}
+
+int64_t esp_timer_get_time(void) { return sim_us; }
+void delay(uint32_t ms) { sim_us += ms * 1000ULL; }
+
+static present_t *present_at(uint64_t t) {
+  for (present_t &p : schedule)
+    if (t >= p.arrive_us && t < p.leave_us)
+      return &p;
+  return NULL;
+}
+
+static uint64_t next_arrival(uint64_t t) {
+  for (present_t &p : schedule)
+    if (p.arrive_us > t)
+      return p.arrive_us;
+  return UINT64_MAX;
+}
+
+/* --- fake PN532 --- */
+
+static uint64_t ack_at = 0;  // ACK frame ready, 0: no command
+static uint64_t resp_at = 0; // response frame ready
+static bool ack_taken;
+static uint8_t cmd[64];
+static uint8_t cmd_len;
+static bool selected = false; // the listed card is active
+static int auth_sector = -1;
+static uint8_t out[300]; // response code and data, TFI left out
+static int out_len;
+
+static void spi(uint32_t bytes) { sim_us += SPI_SETUP_US + bytes * SPI_BYTE_US; }
+
+static bool frame_ready(void) {
+  if (ack_at == 0)
+    return false;
+  return ack_taken ? sim_us >= resp_at : sim_us >= ack_at;
+}
+
+static uint64_t next_edge(void) {
+  if (ack_at == 0)
+    return UINT64_MAX;
+  return ack_taken ? resp_at : ack_at;
+}
+
+static uint8_t card_byte(const present_t *p, uint32_t i) { return (uint8_t)(i * 7 + p->uid[1]); }
+
+// InDataExchange to the listed card, the answer and the time it takes on air
+static uint32_t exchange(present_t *p) {
+  const uint8_t *d = &cmd[2];
+  out[0] = PN532_RESPONSE_INDATAEXCHANGE;
+  out[1] = 0x00;
+  out_len = 2;
+  if (p == NULL || !selected) {
+    out[1] = 0x01; // timeout, nobody answers
+    return 5000;
+  }
+  const card_t *c = p->card;
+  if (c->sector_key && d[0] == MIFARE_CMD_AUTH_A) {
+    int sector = d[1] < 128 ? d[1] / 4 : 32 + (d[1] - 128) / 16;
+    if (memcmp(&d[2], nfc_dump_keys[c->sector_key[sector]], 6) != 0) {
+      out[1] = 0x14; // wrong key, the card goes idle
+      selected = false;
+      auth_sector = -1;
+    } else {
+      auth_sector = sector;
+    }
+    return AUTH_US;
+  }
+  if (c->sector_key && d[0] == MIFARE_CMD_READ) {
+    if (d[1] / 4 != auth_sector) {
+      out[1] = 0x14;
+      selected = false;
+      return EXCHANGE_US;
+    }
+    for (uint32_t i = 0; i < 16; i++)
+      out[2 + i] = (d[1] % 4 == 3 && i < 6) ? 0 : card_byte(p, d[1] * 16 + i); // key A reads as zeros
+    out_len = 18;
+    return EXCHANGE_US + air_us(4 + 18);
+  }
+  if (!c->sector_key && d[0] == 0x60) { // GET_VERSION
+    if (c->version_type == 0) {
+      out[1] = 0x01; // NAK, the card goes idle
+      selected = false;
+      return EXCHANGE_US + air_us(3);
+    }
+    uint8_t version[8] = {0x00, 0x04, c->version_type, 0x02, 0x01, 0x00, c->version_storage, 0x03};
+    memcpy(&out[2], version, 8);
+    out_len = 10;
+    return EXCHANGE_US + air_us(3 + 10);
+  }
+  if (!c->sector_key && (d[0] == MIFARE_CMD_READ || d[0] == 0x3A)) {
+    uint32_t pages = c->size / 4;
+    uint32_t first = d[1], last = d[0] == MIFARE_CMD_READ ? first + 3 : d[2];
+    if (first >= pages || last < first || (d[0] == 0x3A && last >= pages)) {
+      out[1] = 0x01;
+      selected = false;
+      return EXCHANGE_US + air_us(3);
+    }
+    for (uint32_t i = 0; i < (last - first + 1) * 4; i++)
+      out[2 + i] = card_byte(p, (first * 4 + i) % c->size); // READ wraps around
+    out_len = 2 + (last - first + 1) * 4;
+    return EXCHANGE_US + air_us(4 + out_len);
+  }
+  out[1] = 0x27; // not a command of this card
+  return EXCHANGE_US;
+}
+
+void Adafruit_PN532::startCommand(uint8_t *frame, uint8_t len) {
+  spi(len + 9);
+  memcpy(cmd, frame, len);
+  cmd_len = len;
+  ack_taken = false;
+  ack_at = sim_us + ACK_US;
+  out_len = 1;
+  out[0] = cmd[0] + 1;
+
+  if (cmd[0] == PN532_COMMAND_INLISTPASSIVETARGET) {
+    // unlimited retries: the answer comes once a card is in the field
+    present_t *p = present_at(ack_at);
+    uint64_t found;
+    if (p) {
+      found = ack_at;
+    } else {
+      found = next_arrival(ack_at);
+      if (found != UINT64_MAX)
+        found += rnd(CYCLE_US);
+      p = found == UINT64_MAX ? NULL : present_at(found);
+    }
+    if (p == NULL) {
+      resp_at = UINT64_MAX;
+      return;
+    }
+    const card_t *c = p->card;
+    resp_at = found + (c->uid_len == 7 ? 3000 : 2000); // REQA, anticollision per cascade level, SELECT
+    out[1] = 1;
+    out[2] = 1;
+    out[3] = c->atqa >> 8;
+    out[4] = c->atqa & 0xFF;
+    out[5] = c->sak;
+    out[6] = c->uid_len;
+    memcpy(&out[7], p->uid, c->uid_len);
+    out_len = 7 + c->uid_len;
+    selected = true;
+    auth_sector = -1;
+  } else if (cmd[0] == PN532_COMMAND_INDATAEXCHANGE) {
+    resp_at = ack_at + exchange(present_at(ack_at));
+  } else {
+    resp_at = ack_at + LOCAL_US;
+  }
+}
+
+bool Adafruit_PN532::responseReady(void) {
+  spi(2);
+  return frame_ready();
+}
+
+bool Adafruit_PN532::readAck(void) {
+  spi(7);
+  if (ack_at == 0 || ack_taken || sim_us < ack_at)
+    return false;
+  ack_taken = true;
+  return true;
+}
+
+int16_t Adafruit_PN532::readResponse(uint8_t *response, uint8_t maxLength) {
+  spi(1 + maxLength);
+  bool ok = ack_at && ack_taken && sim_us >= resp_at && out_len + 8 <= maxLength;
+  ack_at = 0;
+  if (!ok)
+    return -1;
+  memcpy(response, out, out_len);
+  return out_len;
+}
+
+void Adafruit_PN532::abortCommand(void) {
+  spi(7);
+  ack_at = 0;
+  selected = false;
+}
+
+bool Adafruit_PN532::SAMConfig(void) {
+  uint8_t frame[3] = {PN532_COMMAND_SAMCONFIGURATION, 0x01, 0x14};
+  startCommand(frame, sizeof(frame));
+  sim_us = resp_at;
+  ack_at = 0;
+  return true;
+}
+
+// like the library: waits for the ACK, leaves the response to the caller
+bool Adafruit_PN532::setPassiveActivationRetries(uint8_t maxRetries) {
+  uint8_t frame[5] = {PN532_COMMAND_RFCONFIGURATION, 5, 0xFF, 0x01, maxRetries};
+  startCommand(frame, sizeof(frame));
+  sim_us = ack_at;
+  return readAck();
+}
+
+static Adafruit_PN532 nfc;
+static bool irq_wired = false;
+static void (*irq_isr)(void) = NULL;
+
+int digitalRead(uint8_t pin) { return pin == IRQ_PIN && irq_wired && frame_ready() ? LOW : HIGH; }
+void pinMode(uint8_t pin, uint8_t mode) {}
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) { irq_isr = isr; }
+
+/* --- bench --- */
+
+typedef struct {
+  uint32_t events;
+  uint64_t reported, reported_max, truth, truth_max, read, read_max, exchanges;
+} result_t;
+
+static void add(uint64_t *sum, uint64_t *max, uint64_t v) {
+  *sum += v;
+  if (v > *max)
+    *max = v;
+}
+
+static bool run(bool irq, uint8_t run_id) {
+  schedule.clear();
+  uint64_t t = sim_us + 1500000;
+  for (uint8_t c = 0; c < CARD_TYPES; c++) {
+    for (uint32_t i = 0; i < PRESENTS; i++) {
+      present_t p = {&cards[c], {0x04, (uint8_t)(0x10 * run_id + c), 0x5A, 0xC3, 0x21, 0x80, 0x7E}, 0, 0, 0};
+      // away long enough not to count as still held
+      t += (NFC_REPEAT_MS + 200 + rnd(1000)) * 1000ULL;
+      p.arrive_us = t;
+      t += IN_FIELD_MS * 1000ULL;
+      p.leave_us = t;
+      schedule.push_back(p);
+    }
+  }
+  uint64_t end = t + 1000000;
+
+  irq_wired = irq;
+  if (!nfc_reader_begin(&nfc, irq ? IRQ_PIN : -1)) {
+    printf("nfc_reader_begin failed\n");
+    return false;
+  }
+  nfc_reader_start();
+  result_t res[CARD_TYPES] = {};
+  bool ok = true;
+  while (sim_us < end) {
+    TickType_t wait = nfc_reader_service();
+    nfc_card_event_t ev;
+    while (nfc_reader_get_event(&ev, 0)) {
+      present_t *p = present_at(sim_us);
+      if (p == NULL) {
+        printf("event after the card left\n");
+        ok = false;
+        continue;
+      }
+      p->events++;
+      result_t *r = &res[p->card - cards];
+      uint64_t truth = sim_us - p->arrive_us;
+      r->events++;
+      add(&r->reported, &r->reported_max, ev.latency_us);
+      add(&r->truth, &r->truth_max, truth);
+      add(&r->read, &r->read_max, ev.read_us);
+      r->exchanges += ev.exchanges;
+      /* Counted from the last poll that found no card it can be one poll interval early, from the
+       * IRQ edge it misses the PN532 polling cycle and the activation. Never the dump. */
+      int64_t error = (int64_t)ev.latency_us - (int64_t)truth;
+      if (error > (irq ? 0 : NFC_POLL_DETECT_MS * 1000 + 1000) || -error > CYCLE_US + 3000 + 1000 ||
+          ev.latency_us < ev.read_us) {
+        printf("%s: reported %u us, true %llu us, dump %u us\n", p->card->name, ev.latency_us,
+               (unsigned long long)truth, ev.read_us);
+        ok = false;
+      }
+    }
+
+    uint64_t wake = wait == portMAX_DELAY ? UINT64_MAX : sim_us + wait * 1000ULL;
+    uint64_t edge = next_edge();
+    if (irq && edge >= sim_us && edge < wake) {
+      sim_us = edge;
+      irq_isr();
+      sim_us += WAKE_US;
+      continue;
+    }
+    sim_us = wake < end ? wake : end;
+  }
+  nfc_reader_stop();
+
+  printf("\n%s, cards in the field for %u ms, %u times each\n", irq ? "IRQ pin" : "status polled every 20 ms",
+         IN_FIELD_MS, PRESENTS);
+  printf("%-12s %6s %11s %11s %11s %11s %11s %11s %9s\n", "card", "events", "reported", "max", "true", "max",
+         "dump", "max", "exchanges");
+  for (uint8_t c = 0; c < CARD_TYPES; c++) {
+    result_t *r = &res[c];
+    uint32_t n = r->events ? r->events : 1;
+    printf("%-12s %6u %8llu us %8llu us %8llu us %8llu us %8llu us %8llu us %9.1f\n", cards[c].name, r->events,
+           (unsigned long long)(r->reported / n), (unsigned long long)r->reported_max,
+           (unsigned long long)(r->truth / n), (unsigned long long)r->truth_max, (unsigned long long)(r->read / n),
+           (unsigned long long)r->read_max, (double)r->exchanges / n);
+  }
+  for (present_t &p : schedule) {
+    if (p.events != 1) {
+      printf("%s at %llu ms: %u events\n", p.card->name, (unsigned long long)(p.arrive_us / 1000), p.events);
+      ok = false;
+    }
+  }
+  nfc_reader_report();
+  if (!irq) {
+    // what nfc_task prints with NFC_DUMP_SERIAL, read back from the cache
+    present_t &p = schedule[PRESENTS];
+    ok = nfc_dump_print(p.uid, p.card->uid_len) && ok;
+  }
+  return ok;
+}
+
+int main() {
+  bool ok = run(false, 0);
+  ok = run(true, 1) && ok;
+  printf("\n%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
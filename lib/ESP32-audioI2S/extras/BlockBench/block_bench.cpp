@@ -0,0 +1,193 @@
+/*
+ * block_bench.cpp
+ *
+ * Host benchmark of the I2S output path, not an Arduino sketch. Compares the former per frame
+ * path of Audio (playSample: three biquad chains, Gain and one 4 byte i2s_write per frame) with
+ * the block path of playChunk/playBlock (the same biquads over 256 frames, Gain over the block,
+ * one i2s_write per block).
+ *
+ *   g++ -O2 block_bench.cpp -o block_bench -lpthread && ./block_bench
+ *
+ * i2s_write is modelled as what the IDF driver does per call: take the driver mutex, copy into
+ * a DMA ring, give the mutex back. The real driver adds queue handling per call, so on the
+ * device the per frame path loses more than shown here. getDSPTime()/getI2STime() of Audio
+ * give the device figures.
+ */
+#include <chrono>
+#include <math.h>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+static const uint16_t FRAMES = 256;        // Audio::m_i2sBlockFrames
+static const uint32_t RATE   = 44100;
+static const uint32_t BLOCKS = 20000;      // ~116s of audio
+enum : uint8_t {LEFTCHANNEL = 0, RIGHTCHANNEL = 1};
+
+//---------------------------------------------------------------------------------------------------------------------
+// i2s_write model: driver mutex and a copy into the DMA ring
+static std::mutex s_driver;
+static uint8_t    s_dma[8 * 1024];
+static uint32_t   s_dmaPos = 0;
+static uint32_t   s_calls = 0;
+
+__attribute__((noinline)) static int i2s_write(const void* src, size_t size, size_t* written) {
+    std::lock_guard<std::mutex> lock(s_driver);
+    const uint8_t* p = (const uint8_t*)src;
+    size_t left = size;
+    while(left) {
+        size_t n = sizeof(s_dma) - s_dmaPos;
+        if(n > left) n = left;
+        memcpy(s_dma + s_dmaPos, p, n);
+        s_dmaPos = (s_dmaPos + n) % sizeof(s_dma);
+        p += n;
+        left -= n;
+    }
+    s_calls++;
+    *written = size;
+    return 0;
+}
+//---------------------------------------------------------------------------------------------------------------------
+// the biquads of the former Audio::IIR_calculateCoefficients(), boost coefficients only
+struct Filters {
+    float c[3][5];                         // a0, a1, a2, b1, b2
+    float z[3][2][2][2];                   // filter, z1/z2, in/out, channel
+    int8_t vol = 21 * 3 - 10;              // Audio::m_vol after setVolume(..) on the factory
+    int8_t balance = 0;
+
+    void shelfOrPeak(float* f, int type, float Fc, float G, float Q) {
+        float K = tanf((float)PI * Fc / RATE), V = powf(10, fabsf(G) / 20.0f), norm;
+        if(type == 0) {
+            norm = 1 / (1 + sqrtf(2) * K + K * K);
+            f[0] = (1 + sqrtf(2*V) * K + V * K * K) * norm; f[1] = 2 * (V * K * K - 1) * norm;
+            f[2] = (1 - sqrtf(2*V) * K + V * K * K) * norm; f[3] = 2 * (K * K - 1) * norm;
+            f[4] = (1 - sqrtf(2) * K + K * K) * norm;
+        }
+        else if(type == 1) {
+            norm = 1 / (1 + 1/Q * K + K * K);
+            f[0] = (1 + V/Q * K + K * K) * norm; f[1] = 2 * (K * K - 1) * norm;
+            f[2] = (1 - V/Q * K + K * K) * norm; f[3] = f[1]; f[4] = (1 - 1/Q * K + K * K) * norm;
+        }
+        else {
+            norm = 1 / (1 + sqrtf(2) * K + K * K);
+            f[0] = (V + sqrtf(2*V) * K + K * K) * norm; f[1] = 2 * (K * K - V) * norm;
+            f[2] = (V - sqrtf(2*V) * K + K * K) * norm; f[3] = 2 * (K * K - 1) * norm;
+            f[4] = (1 - sqrtf(2) * K + K * K) * norm;
+        }
+    }
+    Filters() {
+        memset(z, 0, sizeof(z));
+        shelfOrPeak(c[0], 0,  500, 4, 0);
+        shelfOrPeak(c[1], 1, 3000, 3, 2.5f);
+        shelfOrPeak(c[2], 2, 6000, 5, 0);
+    }
+    void gains(int32_t& gl, int32_t& gr) {
+        float step = (float)vol / 64;
+        uint8_t l = 0, r = 0;
+        if(balance < 0) { step = step * (float)(abs(balance) * 4); l = (uint8_t)step; }
+        if(balance > 0) { step = step * balance * 4; r = (uint8_t)step; }
+        gl = vol - l;
+        gr = vol - r;
+    }
+
+    // former IIR_filterChain0..2: one frame through one filter, both channels
+    __attribute__((noinline)) int16_t* chain(int f, int16_t in[2]) {
+        static int16_t out[2];
+        for(int ch = 0; ch < 2; ch++) {
+            float x = in[ch];
+            float y = c[f][0] * x + c[f][1] * z[f][0][0][ch] + c[f][2] * z[f][1][0][ch]
+                    - c[f][3] * z[f][0][1][ch] - c[f][4] * z[f][1][1][ch];
+            z[f][1][0][ch] = z[f][0][0][ch]; z[f][0][0][ch] = x;
+            z[f][1][1][ch] = z[f][0][1][ch]; z[f][0][1][ch] = y;
+            out[ch] = (int16_t)y;
+        }
+        return out;
+    }
+    // former playSample()
+    __attribute__((noinline)) bool playSample(int16_t sample[2]) {
+        sample[LEFTCHANNEL]  = sample[LEFTCHANNEL]  >> 1;
+        sample[RIGHTCHANNEL] = sample[RIGHTCHANNEL] >> 1;
+        sample = chain(0, sample);
+        sample = chain(1, sample);
+        sample = chain(2, sample);
+        int32_t gl, gr;
+        gains(gl, gr);
+        int32_t vl = (sample[LEFTCHANNEL] * gl) >> 6, vr = (sample[RIGHTCHANNEL] * gr) >> 6;
+        uint32_t s32 = (vl << 16) | (vr & 0xffff);
+        size_t written;
+        return i2s_write(&s32, sizeof(s32), &written) == 0 && written == 4;
+    }
+
+    // playBlock(): the filters in turn over the block, Gain, one write
+    __attribute__((noinline)) bool playBlock(int16_t* blk, uint16_t frames) {
+        static uint32_t out[FRAMES];
+        for(uint16_t i = 0; i < frames * 2; i++) blk[i] = blk[i] >> 1;
+        for(int f = 0; f < 3; f++) {
+            for(int ch = 0; ch < 2; ch++) {
+                float x1 = z[f][0][0][ch], x2 = z[f][1][0][ch], y1 = z[f][0][1][ch], y2 = z[f][1][1][ch];
+                int16_t* p = blk + ch;
+                for(uint16_t i = 0; i < frames; i++, p += 2) {
+                    float x = *p;
+                    float y = c[f][0] * x + c[f][1] * x1 + c[f][2] * x2 - c[f][3] * y1 - c[f][4] * y2;
+                    x2 = x1; x1 = x; y2 = y1; y1 = y;
+                    *p = (int16_t)y;
+                }
+                z[f][0][0][ch] = x1; z[f][1][0][ch] = x2; z[f][0][1][ch] = y1; z[f][1][1][ch] = y2;
+            }
+        }
+        int32_t gl, gr;
+        gains(gl, gr);
+        for(uint16_t i = 0; i < frames; i++) {
+            int32_t vl = (blk[i * 2 + LEFTCHANNEL] * gl) >> 6, vr = (blk[i * 2 + RIGHTCHANNEL] * gr) >> 6;
+            out[i] = (vl << 16) | (vr & 0xffff);
+        }
+        size_t written;
+        return i2s_write(out, frames * sizeof(uint32_t), &written) == 0 && written == frames * sizeof(uint32_t);
+    }
+};
+//---------------------------------------------------------------------------------------------------------------------
+static int16_t s_signal[64][FRAMES * 2];   // a few blocks of decoded audio, reused
+
+template <typename F> static double bench(const char* name, F&& fn, double ref) {
+    static int16_t blk[FRAMES * 2];
+    const uint32_t n = sizeof(s_signal) / sizeof(s_signal[0]);
+    s_calls = 0;
+    s_dmaPos = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < BLOCKS; i++) {
+        memcpy(blk, s_signal[i % n], sizeof(blk));
+        fn(blk);
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    double perFrame = ns / ((double)BLOCKS * FRAMES);
+    double audioSec = (double)BLOCKS * FRAMES / RATE;
+    printf("%-22s %7.2f ns/frame", name, perFrame);
+    printf(ref > 0 ? "  %5.2fx faster" : "              ", ref / perFrame);
+    printf("  %8.0f i2s_write/s of audio  %5.3f%% of a core\n", s_calls / audioSec, ns / 1e7 / audioSec);
+    return perFrame;
+}
+//---------------------------------------------------------------------------------------------------------------------
+int main() {
+    srand(1);
+    for(auto& blk : s_signal)
+        for(auto& s : blk) s = (int16_t)((rand() % 65536) - 32768);
+
+    Filters perFrame, block;
+    double ref = bench("per frame (former)", [&](int16_t* b) {
+        for(uint16_t i = 0; i < FRAMES; i++) perFrame.playSample(b + i * 2);
+    }, 0);
+    static uint8_t dmaFrame[sizeof(s_dma)];
+    memcpy(dmaFrame, s_dma, sizeof(s_dma));
+    bench("per block", [&](int16_t* b) { block.playBlock(b, FRAMES); }, ref);
+
+    // both paths compute the same samples, so the last ring of output is the same
+    bool same = memcmp(dmaFrame, s_dma, sizeof(s_dma)) == 0;
+    printf("same output: %s\n", same ? "yes" : "NO");
+    return same ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+/*
+ * Host stand-in of the Arduino / ESP-IDF API used by the mp3, aac and flac decoders, see
+ * decoder_bench.cpp. Allocations are counted so the bench can report the decoder buffers.
+ */
+#ifndef _DECODER_BENCH_ARDUINO_H
+#define _DECODER_BENCH_ARDUINO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+
+#define log_e(fmt, ...) fprintf(stderr, "E: " fmt "\n", ##__VA_ARGS__)
+#define log_i(fmt, ...) do {} while(0)
+#define log_d(fmt, ...) do {} while(0)
+
+extern size_t bench_alloc_bytes;           // taken through the allocators below
+
+static inline void* bench_alloc(size_t size) {
+    bench_alloc_bytes += size;
+    return malloc(size);
+}
+static inline void* heap_caps_malloc_prefer(size_t size, size_t, ...) { return bench_alloc(size); }
+static inline void* ps_malloc(size_t size) { return bench_alloc(size); }
+static inline bool psramFound() { return true; }
+
+template <typename T> T min(T a, T b) { return a < b ? a : b; }
+template <typename T> T max(T a, T b) { return a > b ? a : b; }
+
+#endif
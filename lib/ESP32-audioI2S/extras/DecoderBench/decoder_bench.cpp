@@ -0,0 +1,303 @@
+/*
+ * decoder_bench.cpp
+ *
+ * Host build of examples/decoder_bench, not an Arduino sketch. The mp3, aac (ADTS) and flac
+ * decoders of the library are built against the Arduino.h next to this file and fed whole files
+ * from memory, the same way the sketch does on the device.
+ *
+ *   make                     builds decoder_bench
+ *   make run FILES="a.mp3 b.flac"
+ *   make check               fails unless every file matches its "<file>.crc"
+ *   make profile FILES=...   builds with -pg, runs, writes the flat gprof profile to gprof.txt
+ *
+ *   ./decoder_bench [-n passes] [-u | -c] file...
+ *
+ * Per file: frames, frames per second, realtime factor, bytes allocated by the decoder, decode
+ * errors, CPU time of the decode calls and the CRC32 of the PCM. The decoders are fixed point, the
+ * PCM and so the CRC are the same as on the device: "<file>.crc" (8 hex digits) is checked when it
+ * exists and written with -u, with -c a missing one is an error too. Timing is the best of -n
+ * passes. The peak RSS of the process is printed at the end. Exits with 1 on a CRC mismatch, a
+ * missing reference with -c or a file that could not be decoded.
+ *
+ * The default files are those of additional_info/Testfiles: the mp3 files, sample1.aac (the first
+ * 160 frames of sample1.m4a with ADTS headers) and tone.flac (1.5 s of stereo tones, fixed
+ * predictor). Their references are committed next to them.
+ */
+#include "mp3_decoder/mp3_decoder.h"
+#include "aac_decoder/aac_decoder.h"
+#include "flac_decoder/flac_decoder.h"
+#include <sys/resource.h>
+#include <time.h>
+
+size_t bench_alloc_bytes = 0;
+
+enum bench_codec_t { BENCH_MP3, BENCH_AAC, BENCH_FLAC };
+
+typedef struct {
+    uint32_t frames;
+    uint32_t samples;       // PCM samples (all channels)
+    uint32_t errors;
+    double   decode_us;
+    uint32_t sample_rate;
+    uint8_t  channels;
+    size_t   heap_used;     // bytes taken by the decoder buffers
+    uint32_t crc;
+} bench_result_t;
+
+// Input handed to one decode call, at most what Audio buffers for a frame (m_frameSizeFLAC): the
+// FLAC decoder counts the bytes left in an int16_t
+#define BENCH_WINDOW (16 * 1024)
+
+static short pcm[2 * 8192]; // large enough for one FLAC block (MAX_BLOCKSIZE, stereo)
+
+static double cpu_us() {
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+// Same CRC32 as the sketch, table driven so it stays out of the profile
+static uint32_t crc_table[256];
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+    if(!crc_table[1]) {
+        for(uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for(int k = 0; k < 8; k++)
+                c = (c >> 1) ^ (0xEDB88320 & (0 - (c & 1)));
+            crc_table[i] = c;
+        }
+    }
+    crc = ~crc;
+    while(len--)
+        crc = (crc >> 8) ^ crc_table[(crc ^ *data++) & 0xFF];
+    return ~crc;
+}
+
+// Skip the "fLaC" marker and metadata blocks, hand STREAMINFO to the decoder.
+static int flac_parse_header(uint8_t *data, size_t len) {
+    if(len < 42 || memcmp(data, "fLaC", 4) != 0) return -1;
+    size_t pos = 4;
+    bool last = false;
+    while(!last && pos + 4 <= len) {
+        last = data[pos] & 0x80;
+        uint8_t type = data[pos] & 0x7F;
+        uint32_t size = (data[pos + 1] << 16) | (data[pos + 2] << 8) | data[pos + 3];
+        uint8_t *b = &data[pos + 4];
+        if(type == 0 && size >= 18) { // STREAMINFO
+            uint32_t sampleRate = (b[10] << 12) | (b[11] << 4) | (b[12] >> 4);
+            uint8_t channels = ((b[12] >> 1) & 0x07) + 1;
+            uint8_t bps = (((b[12] & 0x01) << 4) | (b[13] >> 4)) + 1;
+            uint32_t totalSamples = (b[14] << 24) | (b[15] << 16) | (b[16] << 8) | b[17];
+            FLACSetRawBlockParams(channels, sampleRate, bps, totalSamples, len);
+        }
+        pos += 4 + size;
+    }
+    return pos <= len ? (int)pos : -1;
+}
+
+// Same loop as bench_run() of the sketch
+static bool bench_run(bench_codec_t codec, uint8_t *data, size_t len, bench_result_t *r) {
+    memset(r, 0, sizeof(*r));
+
+    size_t heap_before = bench_alloc_bytes;
+    bool ok = false;
+    if(codec == BENCH_MP3) ok = MP3Decoder_AllocateBuffers();
+    if(codec == BENCH_AAC) ok = AACDecoder_AllocateBuffers();
+    if(codec == BENCH_FLAC) ok = FLACDecoder_AllocateBuffers();
+    if(!ok) return false;
+    r->heap_used = bench_alloc_bytes - heap_before;
+
+    size_t pos = 0;
+    if(codec == BENCH_FLAC) {
+        FLACDecoderReset();
+        int start = flac_parse_header(data, len);
+        if(start < 0) {
+            FLACDecoder_FreeBuffers();
+            return false;
+        }
+        pos = start;
+    }
+
+    bool synced = false;
+    while(pos < len) {
+        int avail = len - pos < BENCH_WINDOW ? len - pos : BENCH_WINDOW;
+        if(!synced) {
+            int next = -1;
+            if(codec == BENCH_MP3) next = MP3FindSyncWord(data + pos, avail);
+            if(codec == BENCH_AAC) next = AACFindSyncWord(data + pos, avail);
+            if(codec == BENCH_FLAC) next = FLACFindSyncWord(data + pos, avail);
+            if(next < 0) break;
+            pos += next;
+            avail -= next;
+            synced = true;
+        }
+
+        int bytesLeft = avail;
+        int ret = 0;
+        double t = cpu_us();
+        if(codec == BENCH_MP3) ret = MP3Decode(data + pos, &bytesLeft, pcm, 0);
+        if(codec == BENCH_AAC) ret = AACDecode(data + pos, &bytesLeft, pcm);
+        if(codec == BENCH_FLAC) ret = FLACDecode(data + pos, &bytesLeft, pcm);
+        r->decode_us += cpu_us() - t;
+
+        int used = avail - bytesLeft;
+        if(ret < 0) {
+            // MP3 needs a few frames of main data before the first output, that is not an error
+            if(!(codec == BENCH_MP3 && ret == ERR_MP3_MAINDATA_UNDERFLOW)) {
+                r->errors++;
+                synced = false;
+            }
+            pos += used ? used : 1;
+            continue;
+        }
+        pos += used;
+
+        int samples = 0;
+        if(codec == BENCH_MP3) samples = MP3GetOutputSamps();
+        if(codec == BENCH_AAC) samples = AACGetOutputSamps();
+        if(codec == BENCH_FLAC) samples = FLACGetOutputSamps();
+        // FLAC returns after the frame header, then once per part of the output, the last part ends a frame
+        if(codec != BENCH_FLAC || (ret == ERR_FLAC_NONE && samples > 0)) r->frames++;
+        if(samples > 0) {
+            r->samples += samples;
+            r->crc = crc32_update(r->crc, (const uint8_t *)pcm, samples * sizeof(short));
+        }
+        if(!used && !samples) pos++; // never stall on a frame that produces nothing
+    }
+
+    if(codec == BENCH_MP3) {
+        r->sample_rate = MP3GetSampRate();
+        r->channels = MP3GetChannels();
+        MP3Decoder_FreeBuffers();
+    }
+    if(codec == BENCH_AAC) {
+        r->sample_rate = AACGetSampRate();
+        r->channels = AACGetChannels();
+        AACDecoder_FreeBuffers();
+    }
+    if(codec == BENCH_FLAC) {
+        r->sample_rate = FLACGetSampRate();
+        r->channels = FLACGetChannels();
+        FLACDecoder_FreeBuffers();
+    }
+    return true;
+}
+
+static uint8_t *read_file(const char *path, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if(!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    *len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = (uint8_t *)malloc(*len ? *len : 1);
+    if(data && fread(data, 1, *len, f) != *len) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    return data;
+}
+
+static bool read_reference(const char *path, uint32_t *crc) {
+    char crc_path[512];
+    snprintf(crc_path, sizeof(crc_path), "%s.crc", path);
+    FILE *f = fopen(crc_path, "r");
+    if(!f) return false;
+    char s[16] = "";
+    bool ok = fgets(s, sizeof(s), f) != NULL;
+    fclose(f);
+    *crc = strtoul(s, NULL, 16);
+    return ok;
+}
+
+static void write_reference(const char *path, uint32_t crc) {
+    char crc_path[512];
+    snprintf(crc_path, sizeof(crc_path), "%s.crc", path);
+    FILE *f = fopen(crc_path, "w");
+    if(!f) return;
+    fprintf(f, "%08X\n", crc);
+    fclose(f);
+}
+
+static bool bench_file(const char *path, int passes, bool update, bool strict) {
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    bench_codec_t codec;
+    if(strstr(name, ".mp3")) codec = BENCH_MP3;
+    else if(strstr(name, ".aac")) codec = BENCH_AAC;
+    else if(strstr(name, ".flac")) codec = BENCH_FLAC;
+    else {
+        printf("%-24s skipped, not .mp3, .aac or .flac\n", name);
+        return true;
+    }
+
+    size_t len;
+    uint8_t *data = read_file(path, &len);
+    if(!data) {
+        printf("%-24s cannot read\n", name);
+        return false;
+    }
+
+    bench_result_t r, best;
+    for(int p = 0; p < passes; p++) {
+        if(!bench_run(codec, data, len, &r)) {
+            printf("%-24s decoder init failed\n", name);
+            free(data);
+            return false;
+        }
+        if(p == 0 || r.decode_us < best.decode_us) best = r;
+    }
+    free(data);
+    r = best;
+
+    double seconds = r.decode_us / 1e6;
+    double audio_seconds = (r.channels && r.sample_rate) ? (double)r.samples / r.channels / r.sample_rate : 0;
+    uint32_t ref;
+    const char *check = "NEW";
+    bool ok = r.samples > 0;
+    if(update) {
+        write_reference(path, r.crc);
+        check = "SAVED";
+    }
+    else if(read_reference(path, &ref)) {
+        check = ref == r.crc ? "OK" : "MISMATCH";
+        ok = ok && ref == r.crc;
+    }
+    else if(strict) {
+        check = "MISSING";
+        ok = false;
+    }
+
+    printf("%-24s %6u %9.1f %8.1fx %6zu %3u %8.1f  %08X %s\n",
+           name, r.frames, seconds > 0 ? r.frames / seconds : 0,
+           seconds > 0 ? audio_seconds / seconds : 0,
+           r.heap_used / 1024, r.errors, r.decode_us / 1000, r.crc, check);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int passes = 3;
+    bool update = false;
+    bool strict = false;
+    int first = 1;
+    for(; first < argc && argv[first][0] == '-'; first++) {
+        if(!strcmp(argv[first], "-n") && first + 1 < argc) passes = atoi(argv[++first]);
+        else if(!strcmp(argv[first], "-u")) update = true;
+        else if(!strcmp(argv[first], "-c")) strict = true;
+        else break;
+    }
+    if(first >= argc || passes < 1 || (update && strict)) {
+        fprintf(stderr, "usage: %s [-n passes] [-u | -c] file...\n", argv[0]);
+        return 2;
+    }
+
+    bool ok = true;
+    printf("file                     frames   frame/s  realtime heapKB err  cpu(ms)  crc32\n");
+    for(int i = first; i < argc; i++)
+        ok = bench_file(argv[i], passes, update, strict) && ok;
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    printf("peak RSS: %ld KB\n", ru.ru_maxrss);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/*
+ * eq_bench.cpp
+ *
+ * Host benchmark for the Equalizer, not an Arduino sketch. Compares the former three biquad
+ * chain of Audio (per channel, int16 between the stages) with the Equalizer cascade and checks
+ * that flat bands pass the signal bit exact and that a gain step does not click.
+ *
+ *   g++ -O2 -I../../src eq_bench.cpp ../../src/Equalizer.cpp -o eq_bench && ./eq_bench
+ *
+ * The numbers are relative: a desktop FPU is much faster than the ESP32-S3 one, but the ratio
+ * between the variants is what the I2S task budget depends on.
+ */
+#include "Equalizer.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+static const uint16_t FRAMES = 256;        // Audio::m_i2sBlockFrames
+static const uint32_t RATE   = 44100;
+static const uint32_t BLOCKS = 20000;      // ~116s of audio
+static const uint32_t RUNS   = 5;
+
+//---------------------------------------------------------------------------------------------------------------------
+// the former Audio::IIR_calculateCoefficients() / IIR_filterBlock(), boost coefficients only
+struct Legacy {
+    float c[3][5];                         // a0, a1, a2, b1, b2
+    float z[3][2][2][2];                   // filter, z1/z2, in/out, channel
+
+    void shelfOrPeak(float* f, int type, float Fc, float G, float Q) {
+        float K = tanf((float)PI * Fc / RATE), V = powf(10, fabsf(G) / 20.0f), norm;
+        if(type == 0) {
+            norm = 1 / (1 + sqrtf(2) * K + K * K);
+            f[0] = (1 + sqrtf(2*V) * K + V * K * K) * norm; f[1] = 2 * (V * K * K - 1) * norm;
+            f[2] = (1 - sqrtf(2*V) * K + V * K * K) * norm; f[3] = 2 * (K * K - 1) * norm;
+            f[4] = (1 - sqrtf(2) * K + K * K) * norm;
+        }
+        else if(type == 1) {
+            norm = 1 / (1 + 1/Q * K + K * K);
+            f[0] = (1 + V/Q * K + K * K) * norm; f[1] = 2 * (K * K - 1) * norm;
+            f[2] = (1 - V/Q * K + K * K) * norm; f[3] = f[1]; f[4] = (1 - 1/Q * K + K * K) * norm;
+        }
+        else {
+            norm = 1 / (1 + sqrtf(2) * K + K * K);
+            f[0] = (V + sqrtf(2*V) * K + K * K) * norm; f[1] = 2 * (K * K - V) * norm;
+            f[2] = (V - sqrtf(2*V) * K + K * K) * norm; f[3] = 2 * (K * K - 1) * norm;
+            f[4] = (1 - sqrtf(2) * K + K * K) * norm;
+        }
+    }
+    Legacy(float g0, float g1, float g2) {
+        memset(z, 0, sizeof(z));
+        shelfOrPeak(c[0], 0,  500, g0, 0);
+        shelfOrPeak(c[1], 1, 3000, g1, 2.5f);
+        shelfOrPeak(c[2], 2, 6000, g2, 0);
+    }
+    void process(int16_t* buff, uint16_t frames) {
+        for(int f = 0; f < 3; f++) {
+            for(int ch = 0; ch < 2; ch++) {
+                float x1 = z[f][0][0][ch], x2 = z[f][1][0][ch], y1 = z[f][0][1][ch], y2 = z[f][1][1][ch];
+                int16_t* p = buff + ch;
+                for(uint16_t i = 0; i < frames; i++, p += 2) {
+                    float x = *p;
+                    float y = c[f][0] * x + c[f][1] * x1 + c[f][2] * x2 - c[f][3] * y1 - c[f][4] * y2;
+                    x2 = x1; x1 = x; y2 = y1; y1 = y;
+                    *p = (int16_t)y;
+                }
+                z[f][0][0][ch] = x1; z[f][1][0][ch] = x2; z[f][0][1][ch] = y1; z[f][1][1][ch] = y2;
+            }
+        }
+    }
+};
+//---------------------------------------------------------------------------------------------------------------------
+static int16_t s_signal[64][FRAMES * 2];   // a few blocks of noise, reused
+
+static void makeSignal() {
+    srand(1);
+    for(auto& blk : s_signal)
+        for(auto& s : blk) s = (int16_t)((rand() % 32768) - 16384);  // Audio halves the input
+}
+//---------------------------------------------------------------------------------------------------------------------
+template <typename F> static double bench(const char* name, F&& fn, double ref) {
+    // best of RUNS, the checksum is the one of the first run (the filters keep their memory)
+    static int16_t blk[FRAMES * 2];
+    const uint32_t n = sizeof(s_signal) / sizeof(s_signal[0]);
+    uint32_t sum = 0;
+    double perFrame = 0;
+    for(uint32_t r = 0; r < RUNS; r++) {
+        uint32_t s = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for(uint32_t i = 0; i < BLOCKS; i++) {
+            memcpy(blk, s_signal[i % n], sizeof(blk));
+            fn(blk);
+            s += (uint16_t)blk[i % (FRAMES * 2)];
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        if(r == 0) sum = s;
+        if(r == 0 || ns / ((double)BLOCKS * FRAMES) < perFrame) perFrame = ns / ((double)BLOCKS * FRAMES);
+    }
+    printf("%-28s %7.2f ns/frame", name, perFrame);
+    if(ref > 0) printf("  %5.2fx", perFrame / ref);
+    printf("   (chk %08x)\n", (unsigned)sum);
+    return perFrame;
+}
+//---------------------------------------------------------------------------------------------------------------------
+static bool checkFlat() {
+    Equalizer eq;
+    eq.setSampleRate(RATE);
+    for(uint8_t i = 0; i < Equalizer::maxBands; i++) eq.setBand(i, Equalizer::PEAK, 100 * (i + 1), 0);
+    eq.setBandCount(Equalizer::maxBands);
+    int16_t blk[FRAMES * 2];
+    for(uint32_t b = 0; b < 64; b++) {
+        memcpy(blk, s_signal[b], sizeof(blk));
+        eq.process(blk, FRAMES);
+        if(memcmp(blk, s_signal[b], sizeof(blk))) return false;
+    }
+    return eq.getActiveBands() == 0;
+}
+//---------------------------------------------------------------------------------------------------------------------
+static int maxStep(float rampMs) {
+    // 1kHz sine, the peak band at 1kHz jumps from 0 to -20dB after 10 blocks. Returns the largest
+    // second difference, a click shows up as a kink (the undisturbed sine gives ~160)
+    Equalizer eq;
+    eq.setSampleRate(RATE);
+    eq.setRampTime(rampMs);
+    eq.setBand(0, Equalizer::PEAK, 1000, 0, 1.0f);
+    eq.setBandCount(1);
+    int16_t blk[FRAMES * 2];
+    int16_t last = 0, last2 = 0;
+    int worst = 0;
+    uint32_t t = 0;
+    for(uint32_t b = 0; b < 60; b++) {
+        if(b == 10) eq.setBandGain(0, -20);
+        for(uint16_t i = 0; i < FRAMES; i++, t++) blk[i * 2] = blk[i * 2 + 1] = (int16_t)(8000 * sinf(2 * (float)PI * 1000 * t / RATE));
+        eq.process(blk, FRAMES);
+        for(uint16_t i = 0; i < FRAMES; i++) {
+            int d = abs(blk[i * 2] - 2 * last + last2);
+            if(b >= 5 && d > worst) worst = d;
+            last2 = last;
+            last  = blk[i * 2];
+        }
+    }
+    return worst;
+}
+//---------------------------------------------------------------------------------------------------------------------
+int main() {
+    makeSignal();
+
+    Legacy legacy(4, -3, 5);
+    double ref = bench("legacy 3 biquads", [&](int16_t* b) { legacy.process(b, FRAMES); }, 0);
+
+    Equalizer eq3;
+    eq3.setSampleRate(RATE);
+    eq3.setRampTime(0);
+    eq3.setBand(0, Equalizer::LOWSHELF, 500, 4);
+    eq3.setBand(1, Equalizer::PEAK, 3000, -3, 2.5f);
+    eq3.setBand(2, Equalizer::HIGHSHELF, 6000, 5);
+    eq3.setBandCount(3);
+    bench("Equalizer 3 bands", [&](int16_t* b) { eq3.process(b, FRAMES); }, ref);
+
+    const int8_t gains[10] = {4, 2, 0, -2, -3, 0, 0, 2, 3, 5};   // 7 of 10 bands active
+    const int8_t all[10]   = {4, 2, 1, -2, -3, -1, 1, 2, 3, 5};  // all active
+    for(int k = 0; k < 2; k++) {
+        const int8_t* g = k ? all : gains;
+        Equalizer eq10;
+        eq10.setSampleRate(RATE);
+        eq10.setRampTime(0);
+        const float ratio = powf(16000.0f / 32.0f, 1.0f / 9), q = sqrtf(ratio) / (ratio - 1);
+        float f = 32;
+        for(uint8_t i = 0; i < 10; i++, f *= ratio)
+            eq10.setBand(i, i == 0 ? Equalizer::LOWSHELF : (i == 9 ? Equalizer::HIGHSHELF : Equalizer::PEAK), f, g[i], q);
+        eq10.setBandCount(10);
+        bench(k ? "Equalizer 10 bands, 10 used" : "Equalizer 10 bands, 7 used", [&](int16_t* b) { eq10.process(b, FRAMES); }, ref);
+    }
+
+    Equalizer flat;
+    flat.setSampleRate(RATE);
+    flat.setBandCount(10);
+    bench("Equalizer 10 bands, flat", [&](int16_t* b) { flat.process(b, FRAMES); }, ref);
+
+    bool ok = checkFlat();
+    printf("flat bands bit exact: %s\n", ok ? "yes" : "NO");
+    printf("largest step, 0 -> -20dB at once: %d, ramped (50ms/10dB): %d\n", maxStep(0), maxStep(50));
+    return ok ? 0 : 1;
+}
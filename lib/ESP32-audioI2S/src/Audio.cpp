@@ -220,13 +220,7 @@ Audio::Audio(bool internalDAC /* = false */, uint8_t channelEnabled /* = I2S_DAC
 
     i2s_zero_dma_buffer((i2s_port_t) m_i2s_num);
 
-    for(int i = 0; i <3; i++) {
-        m_filter[i].a0  = 1;
-        m_filter[i].a1  = 0;
-        m_filter[i].a2  = 0;
-        m_filter[i].b1  = 0;
-        m_filter[i].b2  = 0;
-    }
+    setTone(0, 0, 0);   // flat
 }
 //---------------------------------------------------------------------------------------------------------------------
 void Audio::setBufsize(int rambuf_sz, int psrambuf_sz) {
@@ -345,6 +339,7 @@ void Audio::setDefaults() {
     m_chunkcount = 0;                                       // for chunked streams
     m_contentlength = 0;                                    // If Content-Length is known, count it
     m_curSample = 0;
+    m_i2sPendingBytes = 0;                                  // a block left from the last stream is dropped
     m_metaint = 0;                                          // No metaint yet
     m_LFcount = 0;                                          // For end of header detection
     m_controlCounter = 0;                                   // Status within readID3data() and readWaveHeader()
@@ -2229,85 +2224,102 @@ bool Audio::pauseResume() {
 //---------------------------------------------------------------------------------------------------------------------
 bool Audio::playChunk() {
     // If we've got data, try and pump it out..
-    int16_t sample[2];
-    if(getBitsPerSample() == 8) {
-        if(getChannels() == 1) {
-            while(m_validSamples) {
-                uint8_t x =  m_outBuff[m_curSample] & 0x00FF;
-                uint8_t y = (m_outBuff[m_curSample] & 0xFF00) >> 8;
-                sample[LEFTCHANNEL]  = x;
-                sample[RIGHTCHANNEL] = x;
-                while(1) {
-                    if(playSample(sample)) break;
-                } // Can't send?
-                sample[LEFTCHANNEL]  = y;
-                sample[RIGHTCHANNEL] = y;
-                while(1) {
-                    if(playSample(sample)) break;
-                } // Can't send?
-                m_validSamples--;
-                m_curSample++;
-            }
-        }
-        if(getChannels() == 2) {
-            while(m_validSamples) {
-                uint8_t x =  m_outBuff[m_curSample] & 0x00FF;
-                uint8_t y = (m_outBuff[m_curSample] & 0xFF00) >> 8;
-                if(!m_f_forceMono) { // stereo mode
-                    sample[LEFTCHANNEL]  = x;
-                    sample[RIGHTCHANNEL] = y;
+    // the samples are collected block by block as signed 16 bit stereo, then filtered, gained
+    // and handed over to the I2S driver with one i2s_write per block. The read position only
+    // moves on once a block is written completely: a block the driver did not take is kept
+    // in m_i2sOut and written first on the next call, it is neither dropped nor filtered twice.
+    if(getBitsPerSample() != 8 && getBitsPerSample() != 16) {
+        log_e("BitsPer Sample must be 8 or 16!");
+        return false;
+    }
+    if(m_i2sPendingBytes) {
+        if(!writeBlock()) return false; // Can't send
+        m_validSamples -= m_i2sPendingUsed;
+        m_curSample += m_i2sPendingUsed;
+    }
+    while(m_validSamples) {
+        int16_t* blk = m_i2sBlock;
+        uint16_t frames = 0;
+        int16_t  used = 0;              // m_outBuff entries in this block
+        int16_t  cur = m_curSample;
+        if(getBitsPerSample() == 8) {
+            if(getChannels() == 1) { // one word holds two mono samples
+                while(used < m_validSamples && frames + 2 <= m_i2sBlockFrames) {
+                    int16_t x =  m_outBuff[cur] & 0x00FF;
+                    int16_t y = (m_outBuff[cur] & 0xFF00) >> 8;
+                    blk[frames * 2 + LEFTCHANNEL]  = x;
+                    blk[frames * 2 + RIGHTCHANNEL] = x;
+                    frames++;
+                    blk[frames * 2 + LEFTCHANNEL]  = y;
+                    blk[frames * 2 + RIGHTCHANNEL] = y;
+                    frames++;
+                    used++;
+                    cur++;
                 }
-                else { // force mono
-                    uint8_t xy = (x + y) / 2;
-                    sample[LEFTCHANNEL]  = xy;
-                    sample[RIGHTCHANNEL] = xy;
+            }
+            if(getChannels() == 2) {
+                while(used < m_validSamples && frames < m_i2sBlockFrames) {
+                    int16_t x =  m_outBuff[cur] & 0x00FF;
+                    int16_t y = (m_outBuff[cur] & 0xFF00) >> 8;
+                    if(!m_f_forceMono) { // stereo mode
+                        blk[frames * 2 + LEFTCHANNEL]  = x;
+                        blk[frames * 2 + RIGHTCHANNEL] = y;
+                    }
+                    else { // force mono
+                        int16_t xy = (x + y) / 2;
+                        blk[frames * 2 + LEFTCHANNEL]  = xy;
+                        blk[frames * 2 + RIGHTCHANNEL] = xy;
+                    }
+                    frames++;
+                    used++;
+                    cur++;
                 }
-
-                while(1) {
-                    if(playSample(sample)) break;
-                } // Can't send?
-                m_validSamples--;
-                m_curSample++;
             }
-        }
-        m_curSample = 0;
-        return true;
-    }
-    if(getBitsPerSample() == 16) {
-        if(getChannels() == 1) {
-            while(m_validSamples) {
-                sample[LEFTCHANNEL]  = m_outBuff[m_curSample];
-                sample[RIGHTCHANNEL] = m_outBuff[m_curSample];
-                if(!playSample(sample)) {
-                    return false;
-                } // Can't send
-                m_validSamples--;
-                m_curSample++;
+            // Upsample from unsigned 8 bits to signed 16 bits
+            for(uint16_t i = 0; i < frames * 2; i++) {
+                blk[i] = (blk[i] - 128) << 8;
             }
         }
-        if(getChannels() == 2) {
-            while(m_validSamples) {
+        if(getBitsPerSample() == 16) {
+            if(getChannels() == 1) {
+                uint16_t n = min((int)m_validSamples, (int)m_i2sBlockFrames);
+                const int16_t* src = m_outBuff + m_curSample;
+                for(uint16_t i = 0; i < n; i++) {
+                    blk[i * 2 + LEFTCHANNEL]  = src[i];
+                    blk[i * 2 + RIGHTCHANNEL] = src[i];
+                }
+                frames = n;
+            }
+            if(getChannels() == 2) {
+                uint16_t n = min((int)m_validSamples, (int)m_i2sBlockFrames);
+                const int16_t* src = m_outBuff + m_curSample * 2;
                 if(!m_f_forceMono) { // stereo mode
-                    sample[LEFTCHANNEL]  = m_outBuff[m_curSample * 2];
-                    sample[RIGHTCHANNEL] = m_outBuff[m_curSample * 2 + 1];
+                    memcpy(blk, src, n * 2 * sizeof(int16_t));
                 }
                 else { // mono mode, #100
-                    int16_t xy = (m_outBuff[m_curSample * 2] + m_outBuff[m_curSample * 2 + 1]) / 2;
-                    sample[LEFTCHANNEL] = xy;
-                    sample[RIGHTCHANNEL] = xy;
+                    for(uint16_t i = 0; i < n; i++) {
+                        int16_t xy = (src[i * 2] + src[i * 2 + 1]) / 2;
+                        blk[i * 2 + LEFTCHANNEL]  = xy;
+                        blk[i * 2 + RIGHTCHANNEL] = xy;
+                    }
                 }
-                if(!playSample(sample)) {
-                    return false;
-                } // Can't send
-                m_validSamples--;
-                m_curSample++;
+                frames = n;
             }
+            used = frames;
         }
-        m_curSample = 0;
-        return true;
+        if(!frames) { // unsupported channel count, nothing can be played
+            m_validSamples = 0;
+            break;
+        }
+        if(!playBlock(frames)) {
+            m_i2sPendingUsed = used;
+            return false;
+        } // Can't send
+        m_validSamples -= used;
+        m_curSample += used;
     }
-    log_e("BitsPer Sample must be 8 or 16!");
-    return false;
+    m_curSample = 0;
+    return true;
 }
 //---------------------------------------------------------------------------------------------------------------------
 void Audio::loop() {
@@ -4158,7 +4170,7 @@ bool Audio::setSampleRate(uint32_t sampRate) {
     if(!sampRate) sampRate = 16000; // fuse, if there is no value -> set default #209
     i2s_set_sample_rates((i2s_port_t)m_i2s_num, sampRate);
     m_sampleRate = sampRate;
-    IIR_calculateCoefficients(m_gain0, m_gain1, m_gain2); // must be recalculated after each samplerate change
+    m_eq.setSampleRate(sampRate);   // coefficients must be recalculated after each samplerate change
     return true;
 }
 uint32_t Audio::getSampleRate(){
@@ -4227,62 +4239,92 @@ void Audio::setI2SCommFMT_LSB(bool commFMT) {
     i2s_driver_install  ((i2s_port_t)m_i2s_num, &m_i2s_config, 0, NULL);
 }
 //---------------------------------------------------------------------------------------------------------------------
-bool Audio::playSample(int16_t sample[2]) {
+bool Audio::playBlock(uint16_t frames) {
+    uint32_t t = micros();
+    int16_t* blk = m_i2sBlock;
 
-    if (getBitsPerSample() == 8) { // Upsample from unsigned 8 bits to signed 16 bits
-        sample[LEFTCHANNEL]  = ((sample[LEFTCHANNEL]  & 0xff) -128) << 8;
-        sample[RIGHTCHANNEL] = ((sample[RIGHTCHANNEL] & 0xff) -128) << 8;
+    for(uint16_t i = 0; i < frames * 2; i++) {
+        blk[i] = blk[i] >> 1; // half Vin so we can boost up to 6dB in filters
     }
 
-    sample[LEFTCHANNEL]  = sample[LEFTCHANNEL]  >> 1; // half Vin so we can boost up to 6dB in filters
-    sample[RIGHTCHANNEL] = sample[RIGHTCHANNEL] >> 1;
-
     // Filterchain, can commented out if not used
-    sample = IIR_filterChain0(sample);
-    sample = IIR_filterChain1(sample);
-    sample = IIR_filterChain2(sample);
+    m_eq.process(blk, frames);
     //-------------------------------------------
 
-    uint32_t s32 = Gain(sample); // vosample2lume;
+    Gain(blk, m_i2sOut, frames);
 
     if(m_f_internalDAC) {
-        s32 += 0x80008000;
+        for(uint16_t i = 0; i < frames; i++) m_i2sOut[i] += 0x80008000;
     }
+    m_dspTime_us += micros() - t;
+    m_dspFrames += frames;
 
-    esp_err_t err = i2s_write((i2s_port_t) m_i2s_num, (const char*) &s32, sizeof(uint32_t), &m_i2s_bytesWritten, 1000);
-    if(err != ESP_OK) {
-        log_e("ESP32 Errorcode %i", err);
-        return false;
-    }
-    if(m_i2s_bytesWritten < 4) {
-        log_e("Can't stuff any more in I2S..."); // increase waitingtime or outputbuffer
-        return false;
+    m_i2sPendingBytes = frames * sizeof(uint32_t);
+    m_i2sWrittenBytes = 0;
+    return writeBlock();
+}
+//---------------------------------------------------------------------------------------------------------------------
+bool Audio::writeBlock() {
+    // writes what is left of m_i2sOut, a partial write is continued on the next call
+    uint32_t t = micros();
+    const uint8_t* out = (const uint8_t*) m_i2sOut;
+    bool ok = true;
+    while(m_i2sPendingBytes) {
+        esp_err_t err = i2s_write((i2s_port_t) m_i2s_num, out + m_i2sWrittenBytes, m_i2sPendingBytes,
+                                  &m_i2s_bytesWritten, 1000);
+        if(err != ESP_OK) {
+            log_e("ESP32 Errorcode %i", err);
+            ok = false;
+            break;
+        }
+        if(m_i2s_bytesWritten == 0) {
+            log_e("Can't stuff any more in I2S..."); // increase waitingtime or outputbuffer
+            ok = false;
+            break;
+        }
+        m_i2sWrittenBytes += m_i2s_bytesWritten;
+        m_i2sPendingBytes -= m_i2s_bytesWritten;
     }
-    return true;
+    m_i2sTime_us += micros() - t;
+    return ok;
 }
 //---------------------------------------------------------------------------------------------------------------------
 void Audio::setTone(int8_t gainLowPass, int8_t gainBandPass, int8_t gainHighPass){
     // see https://www.earlevel.com/main/2013/10/13/biquad-calculator-v2/
     // values can be between -40 ... +6 (dB)
+    // The gains glide to the new values (setEqRampTime), the filter memories are kept,
+    // so adjusting the tone while playing does not click.
 
-    m_gain0 = gainLowPass;
-    m_gain1 = gainBandPass;
-    m_gain2 = gainHighPass;
-
-    IIR_calculateCoefficients(m_gain0, m_gain1, m_gain2);
+    m_eq.setBand(0, Equalizer::LOWSHELF,   500, gainLowPass);           // Frequency LowShelf[Hz]
+    m_eq.setBand(1, Equalizer::PEAK,      3000, gainBandPass, 2.5f);    // Frequency PeakEQ[Hz], Q
+    m_eq.setBand(2, Equalizer::HIGHSHELF, 6000, gainHighPass);          // Frequency HighShelf[Hz]
+    m_eq.setBandCount(3);
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Audio::setTone(const int8_t* gains, uint8_t bands){
+    // graphic equalizer, bands (2...10) spread logarithmically between 32Hz and 16kHz
+    // the outer bands are shelves, the ones in between peaks one band spacing wide
+    // values can be between -40 ... +6 (dB)
 
-    /*
-        This will cause a clicking sound when adjusting the EQ.
-        Because when the EQ is adjusted, the IIR filter will be cleared and played,
-        mixed in the audio data frame, and a click-like sound will be produced.
-    */
-    /*
-    int16_t tmp[2]; tmp[0] = 0; tmp[1]= 0;
+    if(bands < 2) bands = 2;
+    if(bands > Equalizer::maxBands) bands = Equalizer::maxBands;
+    const float ratio = powf(16000.0f / 32.0f, 1.0f / (bands - 1));   // frequency step between two bands
+    const float q     = sqrtf(ratio) / (ratio - 1);                    // bandwidth = one step
 
-    IIR_filterChain0(tmp, true ); // flush the filter
-    IIR_filterChain1(tmp, true ); // flush the filter
-    IIR_filterChain2(tmp, true ); // flush the filter
-    */
+    float f = 32;
+    for(uint8_t i = 0; i < bands; i++) {
+        uint8_t type = Equalizer::PEAK;
+        if(i == 0)         type = Equalizer::LOWSHELF;
+        if(i == bands - 1) type = Equalizer::HIGHSHELF;
+        m_eq.setBand(i, type, f, gains[i], q);
+        f *= ratio;
+    }
+    m_eq.setBandCount(bands);
+}
+//---------------------------------------------------------------------------------------------------------------------
+bool Audio::setEqBand(uint8_t band, uint8_t type, float freq, float gainDb, float q){
+    // one band of the parametric EQ, setEqBandCount() decides how many of them are used
+    return m_eq.setBand(band, type, freq, gainDb, q);
 }
 //---------------------------------------------------------------------------------------------------------------------
 void Audio::forceMono(bool m) { // #100 mono option
@@ -4312,8 +4354,7 @@ uint8_t Audio::getI2sPort() {
     return m_i2s_num;
 }
 //---------------------------------------------------------------------------------------------------------------------
-int32_t Audio::Gain(int16_t s[2]) {
-    int32_t v[2];
+void Audio::Gain(const int16_t* s, uint32_t* out, uint16_t frames) {
     float step = (float)m_vol /64;
     uint8_t l = 0, r = 0;
 
@@ -4326,10 +4367,13 @@ int32_t Audio::Gain(int16_t s[2]) {
         r = (uint8_t)(step);
     }
 
-    v[LEFTCHANNEL] = (s[LEFTCHANNEL]  * (m_vol - l)) >> 6;
-    v[RIGHTCHANNEL]= (s[RIGHTCHANNEL] * (m_vol - r)) >> 6;
-
-    return (v[LEFTCHANNEL] << 16) | (v[RIGHTCHANNEL] & 0xffff);
+    const int32_t gl = m_vol - l;
+    const int32_t gr = m_vol - r;
+    for(uint16_t i = 0; i < frames; i++) {
+        int32_t vl = (s[i * 2 + LEFTCHANNEL]  * gl) >> 6;
+        int32_t vr = (s[i * 2 + RIGHTCHANNEL] * gr) >> 6;
+        out[i] = (vl << 16) | (vr & 0xffff);
+    }
 }
 //---------------------------------------------------------------------------------------------------------------------
 uint32_t Audio::inBufferFilled() {
@@ -4341,243 +4385,3 @@ uint32_t Audio::inBufferFree() {
     // current audio input buffer free space in bytes
     return InBuff.freeSpace();
 }
-//---------------------------------------------------------------------------------------------------------------------
-//            ***     D i g i t a l   b i q u a d r a t i c     f i l t e r     ***
-//---------------------------------------------------------------------------------------------------------------------
-void Audio::IIR_calculateCoefficients(int8_t G0, int8_t G1, int8_t G2){  // Infinite Impulse Response (IIR) filters
-
-    // G1 - gain low shelf   set between -40 ... +6 dB
-    // G2 - gain peakEQ      set between -40 ... +6 dB
-    // G3 - gain high shelf  set between -40 ... +6 dB
-    // https://www.earlevel.com/main/2012/11/26/biquad-c-source-code/
-
-    if(getSampleRate() < 1000) return;  // fuse
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-
-    if(G0 < -40) G0 = -40;      // -40dB -> Vin*0.01
-    if(G0 > 6) G0 = 6;          // +6dB -> Vin*2
-    if(G1 < -40) G1 = -40;
-    if(G1 > 6) G1 = 6;
-    if(G2 < -40) G2 = -40;
-    if(G2 > 6) G2 = 6;
-
-    const float FcLS   =  500;  // Frequency LowShelf[Hz]
-    const float FcPKEQ = 3000;  // Frequency PeakEQ[Hz]
-    const float FcHS   = 6000;  // Frequency HighShelf[Hz]
-
-    float K, norm, Q, Fc, V ;
-
-    // LOWSHELF
-    Fc = (float)FcLS / (float)getSampleRate(); // Cutoff frequency
-    K = tanf((float)PI * Fc);
-    V = powf(10, fabs(G0) / 20.0);
-
-    if (G0 >= 0) {  // boost
-        norm = 1 / (1 + sqrtf(2) * K + K * K);
-        m_filter[LOWSHELF].a0 = (1 + sqrtf(2*V) * K + V * K * K) * norm;
-        m_filter[LOWSHELF].a1 = 2 * (V * K * K - 1) * norm;
-        m_filter[LOWSHELF].a2 = (1 - sqrtf(2*V) * K + V * K * K) * norm;
-        m_filter[LOWSHELF].b1 = 2 * (K * K - 1) * norm;
-        m_filter[LOWSHELF].b2 = (1 - sqrtf(2) * K + K * K) * norm;
-    }
-    else {          // cut
-        norm = 1 / (1 + sqrtf(2*V) * K + V * K * K);
-        m_filter[LOWSHELF].a0 = (1 + sqrtf(2) * K + K * K) * norm;
-        m_filter[LOWSHELF].a1 = 2 * (K * K - 1) * norm;
-        m_filter[LOWSHELF].a2 = (1 - sqrtf(2) * K + K * K) * norm;
-        m_filter[LOWSHELF].b1 = 2 * (V * K * K - 1) * norm;
-        m_filter[LOWSHELF].b2 = (1 - sqrtf(2*V) * K + V * K * K) * norm;
-    }
-
-    // PEAK EQ
-    Fc = (float)FcPKEQ / (float)getSampleRate(); // Cutoff frequency
-    K = tanf((float)PI * Fc);
-    V = powf(10, fabs(G1) / 20.0);
-    Q = 2.5; // Quality factor
-    if (G1 >= 0) { // boost
-        norm = 1 / (1 + 1/Q * K + K * K);
-        m_filter[PEAKEQ].a0 = (1 + V/Q * K + K * K) * norm;
-        m_filter[PEAKEQ].a1 = 2 * (K * K - 1) * norm;
-        m_filter[PEAKEQ].a2 = (1 - V/Q * K + K * K) * norm;
-        m_filter[PEAKEQ].b1 = m_filter[PEAKEQ].a1;
-        m_filter[PEAKEQ].b2 = (1 - 1/Q * K + K * K) * norm;
-    }
-    else {    // cut
-        norm = 1 / (1 + V/Q * K + K * K);
-        m_filter[PEAKEQ].a0 = (1 + 1/Q * K + K * K) * norm;
-        m_filter[PEAKEQ].a1 = 2 * (K * K - 1) * norm;
-        m_filter[PEAKEQ].a2 = (1 - 1/Q * K + K * K) * norm;
-        m_filter[PEAKEQ].b1 = m_filter[PEAKEQ].a1;
-        m_filter[PEAKEQ].b2 = (1 - V/Q * K + K * K) * norm;
-    }
-
-    // HIGHSHELF
-    Fc = (float)FcHS / (float)getSampleRate(); // Cutoff frequency
-    K = tanf((float)PI * Fc);
-    V = powf(10, fabs(G2) / 20.0);
-    if (G2 >= 0) {  // boost
-        norm = 1 / (1 + sqrtf(2) * K + K * K);
-        m_filter[HIFGSHELF].a0 = (V + sqrtf(2*V) * K + K * K) * norm;
-        m_filter[HIFGSHELF].a1 = 2 * (K * K - V) * norm;
-        m_filter[HIFGSHELF].a2 = (V - sqrtf(2*V) * K + K * K) * norm;
-        m_filter[HIFGSHELF].b1 = 2 * (K * K - 1) * norm;
-        m_filter[HIFGSHELF].b2 = (1 - sqrtf(2) * K + K * K) * norm;
-    }
-    else {
-        norm = 1 / (V + sqrtf(2*V) * K + K * K);
-        m_filter[HIFGSHELF].a0 = (1 + sqrtf(2) * K + K * K) * norm;
-        m_filter[HIFGSHELF].a1 = 2 * (K * K - 1) * norm;
-        m_filter[HIFGSHELF].a2 = (1 - sqrtf(2) * K + K * K) * norm;
-        m_filter[HIFGSHELF].b1 = 2 * (K * K - V) * norm;
-        m_filter[HIFGSHELF].b2 = (V - sqrtf(2*V) * K + K * K) * norm;
-    }
-
-//    log_i("LS a0=%f, a1=%f, a2=%f, b1=%f, b2=%f", m_filter[0].a0, m_filter[0].a1, m_filter[0].a2,
-//                                                  m_filter[0].b1, m_filter[0].b2);
-//    log_i("EQ a0=%f, a1=%f, a2=%f, b1=%f, b2=%f", m_filter[1].a0, m_filter[1].a1, m_filter[1].a2,
-//                                                  m_filter[1].b1, m_filter[1].b2);
-//    log_i("HS a0=%f, a1=%f, a2=%f, b1=%f, b2=%f", m_filter[2].a0, m_filter[2].a1, m_filter[2].a2,
-//                                                  m_filter[2].b1, m_filter[2].b2);
-}
-//---------------------------------------------------------------------------------------------------------------------
-int16_t* Audio::IIR_filterChain0(int16_t iir_in[2], bool clear){  // Infinite Impulse Response (IIR) filters
-
-    uint8_t z1 = 0, z2 = 1;
-    enum: uint8_t {in = 0, out = 1};
-    float inSample[2];
-    float outSample[2];
-    static int16_t iir_out[2];
-
-    if(clear){
-        memset(m_filterBuff, 0, sizeof(m_filterBuff));            // zero IIR filterbuffer
-        iir_out[0] = 0;
-        iir_out[1] = 0;
-        iir_in[0]  = 0;
-        iir_in[1]  = 0;
-    }
-
-    inSample[LEFTCHANNEL]  = (float)(iir_in[LEFTCHANNEL]);
-    inSample[RIGHTCHANNEL] = (float)(iir_in[RIGHTCHANNEL]);
-
-    outSample[LEFTCHANNEL] =   m_filter[0].a0  * inSample[LEFTCHANNEL]
-                             + m_filter[0].a1  * m_filterBuff[0][z1][in] [LEFTCHANNEL]
-                             + m_filter[0].a2  * m_filterBuff[0][z2][in] [LEFTCHANNEL]
-                             - m_filter[0].b1  * m_filterBuff[0][z1][out][LEFTCHANNEL]
-                             - m_filter[0].b2  * m_filterBuff[0][z2][out][LEFTCHANNEL];
-
-    m_filterBuff[0][z2][in] [LEFTCHANNEL]  = m_filterBuff[0][z1][in][LEFTCHANNEL];
-    m_filterBuff[0][z1][in] [LEFTCHANNEL]  = inSample[LEFTCHANNEL];
-    m_filterBuff[0][z2][out][LEFTCHANNEL]  = m_filterBuff[0][z1][out][LEFTCHANNEL];
-    m_filterBuff[0][z1][out][LEFTCHANNEL]  = outSample[LEFTCHANNEL];
-    iir_out[LEFTCHANNEL] = (int16_t)outSample[LEFTCHANNEL];
-
-
-    outSample[RIGHTCHANNEL] =  m_filter[0].a0 * inSample[RIGHTCHANNEL]
-                             + m_filter[0].a1 * m_filterBuff[0][z1][in] [RIGHTCHANNEL]
-                             + m_filter[0].a2 * m_filterBuff[0][z2][in] [RIGHTCHANNEL]
-                             - m_filter[0].b1 * m_filterBuff[0][z1][out][RIGHTCHANNEL]
-                             - m_filter[0].b2 * m_filterBuff[0][z2][out][RIGHTCHANNEL];
-
-    m_filterBuff[0][z2][in] [RIGHTCHANNEL] = m_filterBuff[0][z1][in][RIGHTCHANNEL];
-    m_filterBuff[0][z1][in] [RIGHTCHANNEL] = inSample[RIGHTCHANNEL];
-    m_filterBuff[0][z2][out][RIGHTCHANNEL] = m_filterBuff[0][z1][out][RIGHTCHANNEL];
-    m_filterBuff[0][z1][out][RIGHTCHANNEL] = outSample[RIGHTCHANNEL];
-    iir_out[RIGHTCHANNEL] = (int16_t) outSample[RIGHTCHANNEL];
-
-    return iir_out;
-}
-//---------------------------------------------------------------------------------------------------------------------
-int16_t* Audio::IIR_filterChain1(int16_t iir_in[2], bool clear){  // Infinite Impulse Response (IIR) filters
-
-    uint8_t z1 = 0, z2 = 1;
-    enum: uint8_t {in = 0, out = 1};
-    float inSample[2];
-    float outSample[2];
-    static int16_t iir_out[2];
-
-    if(clear){
-        memset(m_filterBuff, 0, sizeof(m_filterBuff));            // zero IIR filterbuffer
-        iir_out[0] = 0;
-        iir_out[1] = 0;
-        iir_in[0]  = 0;
-        iir_in[1]  = 0;
-    }
-
-    inSample[LEFTCHANNEL]  = (float)(iir_in[LEFTCHANNEL]);
-    inSample[RIGHTCHANNEL] = (float)(iir_in[RIGHTCHANNEL]);
-
-    outSample[LEFTCHANNEL] =   m_filter[1].a0  * inSample[LEFTCHANNEL]
-                             + m_filter[1].a1  * m_filterBuff[1][z1][in] [LEFTCHANNEL]
-                             + m_filter[1].a2  * m_filterBuff[1][z2][in] [LEFTCHANNEL]
-                             - m_filter[1].b1  * m_filterBuff[1][z1][out][LEFTCHANNEL]
-                             - m_filter[1].b2  * m_filterBuff[1][z2][out][LEFTCHANNEL];
-
-    m_filterBuff[1][z2][in] [LEFTCHANNEL]  = m_filterBuff[1][z1][in][LEFTCHANNEL];
-    m_filterBuff[1][z1][in] [LEFTCHANNEL]  = inSample[LEFTCHANNEL];
-    m_filterBuff[1][z2][out][LEFTCHANNEL]  = m_filterBuff[1][z1][out][LEFTCHANNEL];
-    m_filterBuff[1][z1][out][LEFTCHANNEL]  = outSample[LEFTCHANNEL];
-    iir_out[LEFTCHANNEL] = (int16_t)outSample[LEFTCHANNEL];
-
-
-    outSample[RIGHTCHANNEL] =  m_filter[1].a0 * inSample[RIGHTCHANNEL]
-                             + m_filter[1].a1 * m_filterBuff[1][z1][in] [RIGHTCHANNEL]
-                             + m_filter[1].a2 * m_filterBuff[1][z2][in] [RIGHTCHANNEL]
-                             - m_filter[1].b1 * m_filterBuff[1][z1][out][RIGHTCHANNEL]
-                             - m_filter[1].b2 * m_filterBuff[1][z2][out][RIGHTCHANNEL];
-
-    m_filterBuff[1][z2][in] [RIGHTCHANNEL] = m_filterBuff[1][z1][in][RIGHTCHANNEL];
-    m_filterBuff[1][z1][in] [RIGHTCHANNEL] = inSample[RIGHTCHANNEL];
-    m_filterBuff[1][z2][out][RIGHTCHANNEL] = m_filterBuff[1][z1][out][RIGHTCHANNEL];
-    m_filterBuff[1][z1][out][RIGHTCHANNEL] = outSample[RIGHTCHANNEL];
-    iir_out[RIGHTCHANNEL] = (int16_t) outSample[RIGHTCHANNEL];
-
-    return iir_out;
-}
-//---------------------------------------------------------------------------------------------------------------------
-int16_t* Audio::IIR_filterChain2(int16_t iir_in[2], bool clear){  // Infinite Impulse Response (IIR) filters
-
-    uint8_t z1 = 0, z2 = 1;
-    enum: uint8_t {in = 0, out = 1};
-    float inSample[2];
-    float outSample[2];
-    static int16_t iir_out[2];
-
-    if(clear){
-        memset(m_filterBuff, 0, sizeof(m_filterBuff));            // zero IIR filterbuffer
-        iir_out[0] = 0;
-        iir_out[1] = 0;
-        iir_in[0]  = 0;
-        iir_in[1]  = 0;
-    }
-
-    inSample[LEFTCHANNEL]  = (float)(iir_in[LEFTCHANNEL]);
-    inSample[RIGHTCHANNEL] = (float)(iir_in[RIGHTCHANNEL]);
-
-    outSample[LEFTCHANNEL] =   m_filter[2].a0  * inSample[LEFTCHANNEL]
-                             + m_filter[2].a1  * m_filterBuff[2][z1][in] [LEFTCHANNEL]
-                             + m_filter[2].a2  * m_filterBuff[2][z2][in] [LEFTCHANNEL]
-                             - m_filter[2].b1  * m_filterBuff[2][z1][out][LEFTCHANNEL]
-                             - m_filter[2].b2  * m_filterBuff[2][z2][out][LEFTCHANNEL];
-
-    m_filterBuff[2][z2][in] [LEFTCHANNEL]  = m_filterBuff[2][z1][in][LEFTCHANNEL];
-    m_filterBuff[2][z1][in] [LEFTCHANNEL]  = inSample[LEFTCHANNEL];
-    m_filterBuff[2][z2][out][LEFTCHANNEL]  = m_filterBuff[2][z1][out][LEFTCHANNEL];
-    m_filterBuff[2][z1][out][LEFTCHANNEL]  = outSample[LEFTCHANNEL];
-    iir_out[LEFTCHANNEL] = (int16_t)outSample[LEFTCHANNEL];
-
-
-    outSample[RIGHTCHANNEL] =  m_filter[2].a0 * inSample[RIGHTCHANNEL]
-                             + m_filter[2].a1 * m_filterBuff[2][z1][in] [RIGHTCHANNEL]
-                             + m_filter[2].a2 * m_filterBuff[2][z2][in] [RIGHTCHANNEL]
-                             - m_filter[2].b1 * m_filterBuff[2][z1][out][RIGHTCHANNEL]
-                             - m_filter[2].b2 * m_filterBuff[2][z2][out][RIGHTCHANNEL];
-
-    m_filterBuff[2][z2][in] [RIGHTCHANNEL] = m_filterBuff[2][z1][in][RIGHTCHANNEL];
-    m_filterBuff[2][z1][in] [RIGHTCHANNEL] = inSample[RIGHTCHANNEL];
-    m_filterBuff[2][z2][out][RIGHTCHANNEL] = m_filterBuff[2][z1][out][RIGHTCHANNEL];
-    m_filterBuff[2][z1][out][RIGHTCHANNEL] = outSample[RIGHTCHANNEL];
-    iir_out[RIGHTCHANNEL] = (int16_t) outSample[RIGHTCHANNEL];
-
-    return iir_out;
-}
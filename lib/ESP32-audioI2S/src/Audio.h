@@ -19,6 +19,7 @@
 #include <WiFiClientSecure.h>
 
 #include <driver/i2s.h>
+#include "Equalizer.h"
 
 #ifdef SDFATFS_USED
 #include <SdFat.h>  // https://github.com/greiman/SdFat
@@ -195,9 +196,16 @@ public:
     uint32_t inBufferFilled(); // returns the number of stored bytes in the inputbuffer
     uint32_t inBufferFree();   // returns the number of free bytes in the inputbuffer
     void setTone(int8_t gainLowPass, int8_t gainBandPass, int8_t gainHighPass);
+    void setTone(const int8_t* gains, uint8_t bands);  // graphic EQ, bands log spaced 32Hz...16kHz
+    bool setEqBand(uint8_t band, uint8_t type, float freq, float gainDb, float q = 0.707f); // Equalizer::LOWSHELF...
+    void setEqBandCount(uint8_t bands) {m_eq.setBandCount(bands);}
+    void setEqRampTime(float msPer10dB) {m_eq.setRampTime(msPer10dB);}  // 0 -> tone changes take effect at once
     void setI2SCommFMT_LSB(bool commFMT);
     int getCodec() {return m_codec;}
     const char *getCodecname() {return codecname[m_codec];}
+    uint32_t getDSPFrames()  {return m_dspFrames;}   // stereo frames sent to I2S
+    uint32_t getDSPTime()    {return m_dspTime_us;}  // µs spent in filter and gain
+    uint32_t getI2STime()    {return m_i2sTime_us;}  // µs spent waiting in i2s_write
     enum : int { CODEC_NONE, CODEC_WAV, CODEC_MP3, CODEC_AAC, CODEC_M4A, CODEC_FLAC, CODEC_OGG,
                  CODEC_OGG_FLAC, CODEC_OGG_OPUS};
 
@@ -236,9 +244,10 @@ private:
     bool setChannels(int channels);
     bool setBitrate(int br);
     bool playChunk();
-    bool playSample(int16_t sample[2]) ;
+    bool playBlock(uint16_t frames);
+    bool writeBlock();
     void playI2Sremains();
-    int32_t Gain(int16_t s[2]);
+    void Gain(const int16_t* s, uint32_t* out, uint16_t frames);
     bool fill_InputBuf();
     void showstreamtitle(const char* ml);
     bool parseContentType(const char* ct);
@@ -247,13 +256,9 @@ private:
     esp_err_t I2Sstart(uint8_t i2s_num);
     esp_err_t I2Sstop(uint8_t i2s_num);
     void urlencode(char* buff, uint16_t buffLen, bool spacesOnly = false);
-    int16_t* IIR_filterChain0(int16_t iir_in[2], bool clear = false);
-    int16_t* IIR_filterChain1(int16_t* iir_in, bool clear = false);
-    int16_t* IIR_filterChain2(int16_t* iir_in, bool clear = false);
     inline void setDatamode(uint8_t dm){m_datamode=dm;}
     inline uint8_t getDatamode(){return m_datamode;}
     inline uint32_t streamavail(){ return _client ? _client->available() : 0;}
-    void IIR_calculateCoefficients(int8_t G1, int8_t G2, int8_t G3);
 
     // implement several function with respect to the index of string
     void trim(char *s) {
@@ -392,19 +397,10 @@ private:
                  M4A_ILST = 7, M4A_MP4A = 8, M4A_AMRDY = 99, M4A_OKAY = 100};
     enum : int { OGG_BEGIN = 0, OGG_MAGIC = 1, OGG_HEADER = 2, OGG_FIRST = 3, OGG_AMRDY = 99, OGG_OKAY = 100};
     typedef enum { LEFTCHANNEL=0, RIGHTCHANNEL=1 } SampleIndex;
-    typedef enum { LOWSHELF = 0, PEAKEQ = 1, HIFGSHELF =2 } FilterType;
 
     const uint8_t volumetable[22]={   0,  1,  2,  3,  4 , 6 , 8, 10, 12, 14, 17,
                                      20, 23, 27, 30 ,34, 38, 43 ,48, 52, 58, 64}; //22 elements
 
-    typedef struct _filter{
-        float a0;
-        float a1;
-        float a2;
-        float b1;
-        float b2;
-    } filter_t;
-
     File              audiofile;    // @suppress("Abstract class cannot be instantiated")
     WiFiClient        client;       // @suppress("Abstract class cannot be instantiated")
     WiFiClientSecure  clientsecure; // @suppress("Abstract class cannot be instantiated")
@@ -421,7 +417,7 @@ private:
     char            m_lastHost[512];                // Store the last URL to a webstream
     char*           m_playlistBuff = NULL;          // stores playlistdata
     const uint16_t  m_plsBuffEntryLen = 256;        // length of each entry in playlistBuff
-    filter_t        m_filter[3];                    // digital filters
+    Equalizer       m_eq;                           // tone control, biquad cascade
     int             m_LFcount = 0;                  // Detection of end of header
     uint32_t        m_sampleRate=16000;
     uint32_t        m_bitRate=0;                    // current bitrate given fom decoder
@@ -437,10 +433,18 @@ private:
     uint8_t         m_playlistFormat = 0;           // M3U, PLS, ASX
     uint8_t         m_m3u8codec = CODEC_NONE;       // M4A
     uint8_t         m_codec = CODEC_NONE;           //
-    uint8_t         m_filterType[2];                // lowpass, highpass
     int16_t         m_outBuff[2048*2];              // Interleaved L/R
     int16_t         m_validSamples = 0;
     int16_t         m_curSample = 0;
+    static const uint16_t m_i2sBlockFrames = 256;   // frames per i2s_write
+    int16_t         m_i2sBlock[m_i2sBlockFrames * 2]; // Interleaved L/R, signed 16 bit work buffer
+    uint32_t        m_i2sOut[m_i2sBlockFrames];     // gained frames as written to I2S
+    uint16_t        m_i2sWrittenBytes = 0;          // of m_i2sOut, taken by the driver
+    uint16_t        m_i2sPendingBytes = 0;          // of m_i2sOut, still to be written
+    int16_t         m_i2sPendingUsed = 0;           // m_outBuff entries of the pending block
+    uint32_t        m_dspFrames = 0;
+    uint32_t        m_dspTime_us = 0;
+    uint32_t        m_i2sTime_us = 0;
     uint16_t        m_datamode = 0;                 // Statemaschine
     uint16_t        m_streamTitleHash = 0;          // remember streamtitle, ignore multiple occurence in metadata
     uint16_t        m_streamUrlHash = 0;            // remember streamURL, ignore multiple occurence in metadata
@@ -485,13 +489,8 @@ private:
     float           m_audioCurrentTime = 0;
     uint32_t        m_audioDataStart = 0;           // in bytes
     size_t          m_audioDataSize = 0;            //
-    float           m_filterBuff[3][2][2][2];       // IIR filters memory for Audio DSP
     size_t          m_i2s_bytesWritten = 0;         // set in i2s_write() but not used
     size_t          m_file_size = 0;                // size of the file
-    uint16_t        m_filterFrequency[2];
-    int8_t          m_gain0 = 0;                    // cut or boost filters (EQ)
-    int8_t          m_gain1 = 0;
-    int8_t          m_gain2 = 0;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
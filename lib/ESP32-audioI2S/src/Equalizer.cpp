@@ -0,0 +1,247 @@
+/*
+ * Equalizer.cpp
+ *
+ * Coefficients follow https://www.earlevel.com/main/2012/11/26/biquad-c-source-code/
+ * (the same formulas the former three filter chain used). The bands keep a direct
+ * form I memory, plain input / output samples, which stays valid when the
+ * coefficients change between two blocks; the block itself runs in transposed
+ * direct form II, whose state is derived from it (see runBand()).
+ */
+#include "Equalizer.h"
+#include <math.h>
+#include <string.h>
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+Equalizer::Equalizer() {
+    memset(m_band, 0, sizeof(m_band));
+    for(uint8_t i = 0; i < maxBands; i++) {
+        m_band[i].type = PEAK;
+        m_band[i].freq = 1000;
+        m_band[i].q    = 0.707f;
+        m_band[i].b0   = 1;
+    }
+    setRampTime(50);
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::bypass(band_t& b, float last, float prev, uint8_t ch) {
+    // a bypassed band passes the signal unchanged (y == x), keeping its memory current
+    // lets it start again later without a step
+    b.x2[ch] = b.y2[ch] = prev;
+    b.x1[ch] = b.y1[ch] = last;
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::setSampleRate(uint32_t sampleRate) {
+    if(sampleRate < 1000) return;  // fuse
+    m_sampleRate = sampleRate;
+    setRampTime(m_rampMs);                                      // same time, new slope per frame
+    for(uint8_t i = 0; i < maxBands; i++) m_band[i].version++;  // recalculate all
+}
+//---------------------------------------------------------------------------------------------------------------------
+bool Equalizer::setBand(uint8_t band, uint8_t type, float freq, float gainDb, float q) {
+    if(band >= maxBands || type > HIGHSHELF || freq <= 0 || q <= 0) return false;
+    if(gainDb < -40) gainDb = -40;  // -40dB -> Vin*0.01
+    if(gainDb >   6) gainDb =   6;  // +6dB  -> Vin*2, Audio halves the input for this headroom
+    m_band[band].type   = type;
+    m_band[band].freq   = freq;
+    m_band[band].q      = q;
+    m_band[band].target = gainDb;
+    m_band[band].version++;         // last, process() picks up the new set with the next block
+    return true;
+}
+//---------------------------------------------------------------------------------------------------------------------
+bool Equalizer::setBandGain(uint8_t band, float gainDb) {
+    if(band >= maxBands) return false;
+    return setBand(band, m_band[band].type, m_band[band].freq, gainDb, m_band[band].q);
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::setBandCount(uint8_t count) {
+    if(count > maxBands) count = maxBands;
+    m_bandCount = count;
+}
+//---------------------------------------------------------------------------------------------------------------------
+uint8_t Equalizer::getActiveBands() {
+    uint8_t n = 0;
+    for(uint8_t i = 0; i < m_bandCount; i++) if(m_band[i].active) n++;
+    return n;
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::setRampTime(float msPer10dB) {
+    // 10dB in msPer10dB milliseconds, as dB per frame at the current samplerate
+    m_rampMs = msPer10dB;
+    if(msPer10dB <= 0) m_rampDbPerFrame = 0;
+    else               m_rampDbPerFrame = 10.0f / (msPer10dB * m_sampleRate / 1000.0f);
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::reset() {
+    for(uint8_t i = 0; i < maxBands; i++) {
+        memset(m_band[i].x1, 0, sizeof(m_band[i].x1));
+        memset(m_band[i].x2, 0, sizeof(m_band[i].x2));
+        memset(m_band[i].y1, 0, sizeof(m_band[i].y1));
+        memset(m_band[i].y2, 0, sizeof(m_band[i].y2));
+    }
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::calcCoefficients(band_t& b) {
+
+    float Fc = b.freq / (float)m_sampleRate;
+    if(Fc > 0.45f) Fc = 0.45f;      // keep tanf() away from Nyquist
+    const float K  = tanf((float)PI * Fc);
+    const float V  = powf(10, fabsf(b.gain) / 20.0f);
+    const float Q  = b.q;
+    const float r2 = sqrtf(2), r2V = sqrtf(2 * V);
+    float norm;
+
+    switch(b.type) {
+        case LOWSHELF:
+            if(b.gain >= 0) {   // boost
+                norm = 1 / (1 + r2 * K + K * K);
+                b.b0 = (1 + r2V * K + V * K * K) * norm;
+                b.b1 = 2 * (V * K * K - 1) * norm;
+                b.b2 = (1 - r2V * K + V * K * K) * norm;
+                b.a1 = 2 * (K * K - 1) * norm;
+                b.a2 = (1 - r2 * K + K * K) * norm;
+            }
+            else {              // cut
+                norm = 1 / (1 + r2V * K + V * K * K);
+                b.b0 = (1 + r2 * K + K * K) * norm;
+                b.b1 = 2 * (K * K - 1) * norm;
+                b.b2 = (1 - r2 * K + K * K) * norm;
+                b.a1 = 2 * (V * K * K - 1) * norm;
+                b.a2 = (1 - r2V * K + V * K * K) * norm;
+            }
+            break;
+        case PEAK:
+            if(b.gain >= 0) {   // boost
+                norm = 1 / (1 + 1/Q * K + K * K);
+                b.b0 = (1 + V/Q * K + K * K) * norm;
+                b.b1 = 2 * (K * K - 1) * norm;
+                b.b2 = (1 - V/Q * K + K * K) * norm;
+                b.a1 = b.b1;
+                b.a2 = (1 - 1/Q * K + K * K) * norm;
+            }
+            else {              // cut
+                norm = 1 / (1 + V/Q * K + K * K);
+                b.b0 = (1 + 1/Q * K + K * K) * norm;
+                b.b1 = 2 * (K * K - 1) * norm;
+                b.b2 = (1 - 1/Q * K + K * K) * norm;
+                b.a1 = b.b1;
+                b.a2 = (1 - V/Q * K + K * K) * norm;
+            }
+            break;
+        default:                // HIGHSHELF
+            if(b.gain >= 0) {   // boost
+                norm = 1 / (1 + r2 * K + K * K);
+                b.b0 = (V + r2V * K + K * K) * norm;
+                b.b1 = 2 * (K * K - V) * norm;
+                b.b2 = (V - r2V * K + K * K) * norm;
+                b.a1 = 2 * (K * K - 1) * norm;
+                b.a2 = (1 - r2 * K + K * K) * norm;
+            }
+            else {              // cut
+                norm = 1 / (V + r2V * K + K * K);
+                b.b0 = (1 + r2 * K + K * K) * norm;
+                b.b1 = 2 * (K * K - 1) * norm;
+                b.b2 = (1 - r2 * K + K * K) * norm;
+                b.a1 = 2 * (K * K - V) * norm;
+                b.a2 = (V - r2V * K + K * K) * norm;
+            }
+            break;
+    }
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::updateBands(uint16_t frames) {
+
+    // Gains move towards their target by at most one ramp step per block, the coefficients are
+    // recalculated for every step. Each intermediate filter is a proper (stable) biquad, so a
+    // change sweeps smoothly instead of clicking.
+    const float step = m_rampDbPerFrame * frames;
+
+    for(uint8_t i = 0; i < m_bandCount; i++) {
+        band_t& b = m_band[i];
+        uint32_t v = b.version;
+        float target = b.target;
+        if(v == b.seen && b.gain == target) continue;
+        b.seen = v;
+
+        if(step <= 0 || fabsf(target - b.gain) <= step) b.gain = target;
+        else b.gain += (target > b.gain) ? step : -step;
+
+        bool active = (b.gain != 0);
+        if(active) calcCoefficients(b);
+        b.active = active;
+    }
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::runBand(band_t& b, float* w, uint16_t frames) {
+
+    // Transposed direct form II, two multiply-adds on the recursion path instead of five. The
+    // state is derived from the direct form I memory (last two inputs and outputs) the band
+    // keeps, so a coefficient change between blocks still has no transient.
+    const uint16_t n = frames * 2;
+    const float xl1 = w[n - 2], xr1 = w[n - 1];                         // overwritten below
+    const float xl2 = frames > 1 ? w[n - 4] : b.x1[0], xr2 = frames > 1 ? w[n - 3] : b.x1[1];
+    const float b0 = b.b0, b1 = b.b1, b2 = b.b2, a1 = b.a1, a2 = b.a2;
+    float sl1 = b1 * b.x1[0] + b2 * b.x2[0] - a1 * b.y1[0] - a2 * b.y2[0], sl2 = b2 * b.x1[0] - a2 * b.y1[0];
+    float sr1 = b1 * b.x1[1] + b2 * b.x2[1] - a1 * b.y1[1] - a2 * b.y2[1], sr2 = b2 * b.x1[1] - a2 * b.y1[1];
+
+    // left and right are two independent recursions, running them in the same loop keeps
+    // the FPU pipeline busy while the other channel waits for its previous result
+    for(uint16_t k = 0; k < n; k += 2) {
+        float xl = w[k], xr = w[k + 1];
+        float yl = b0 * xl + sl1;
+        float yr = b0 * xr + sr1;
+        sl1 = b1 * xl - a1 * yl + sl2;
+        sr1 = b1 * xr - a1 * yr + sr2;
+        sl2 = b2 * xl - a2 * yl;
+        sr2 = b2 * xr - a2 * yr;
+        w[k] = yl; w[k + 1] = yr;
+    }
+    b.y2[0] = frames > 1 ? w[n - 4] : b.y1[0]; b.y1[0] = w[n - 2];
+    b.y2[1] = frames > 1 ? w[n - 3] : b.y1[1]; b.y1[1] = w[n - 1];
+    b.x1[0] = xl1; b.x2[0] = xl2;
+    b.x1[1] = xr1; b.x2[1] = xr2;
+}
+//---------------------------------------------------------------------------------------------------------------------
+void Equalizer::process(int16_t* buff, uint16_t frames) {
+
+    if(frames > maxFrames) {                 // split long blocks
+        process(buff, maxFrames);
+        process(buff + maxFrames * 2, frames - maxFrames);
+        return;
+    }
+    updateBands(frames);
+
+    uint8_t active = 0;
+    for(uint8_t i = 0; i < m_bandCount; i++) if(m_band[i].active) active++;
+
+    const uint16_t n = frames * 2;
+    if(n == 0) return;
+
+    if(!active) {   // all flat, nothing to compute
+        for(uint8_t i = 0; i < m_bandCount; i++) {
+            for(uint8_t ch = 0; ch < 2; ch++) {
+                bypass(m_band[i], buff[n - 2 + ch], frames > 1 ? buff[n - 4 + ch] : m_band[i].x1[ch], ch);
+            }
+        }
+        return;
+    }
+
+    float* w = m_work;
+    for(uint16_t i = 0; i < n; i++) w[i] = buff[i];
+
+    for(uint8_t i = 0; i < m_bandCount; i++) {
+        band_t& b = m_band[i];
+        if(b.active) runBand(b, w, frames);
+        else for(uint8_t ch = 0; ch < 2; ch++) bypass(b, w[n - 2 + ch], frames > 1 ? w[n - 4 + ch] : b.x1[ch], ch);
+    }
+
+    for(uint16_t i = 0; i < n; i++) {
+        float y = w[i];
+        if(y >  32767.0f) y =  32767.0f;
+        if(y < -32768.0f) y = -32768.0f;
+        buff[i] = (int16_t)y;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Equalizer.h
+ *
+ * N-band parametric equalizer for Audio, a cascade of biquads working on
+ * stereo interleaved 16 bit blocks. No Arduino dependencies, so it can also
+ * be built and benchmarked on a host.
+ */
+
+#pragma once
+#include <stdint.h>
+
+class Equalizer {
+
+public:
+    enum : uint8_t { LOWSHELF = 0, PEAK = 1, HIGHSHELF = 2 };
+    static const uint8_t  maxBands  = 10;
+    static const uint16_t maxFrames = 256;  // longest block accepted by process()
+
+    Equalizer();
+    void    setSampleRate(uint32_t sampleRate);
+    // shelves use a fixed slope (Q = 0.707), q only applies to PEAK
+    bool    setBand(uint8_t band, uint8_t type, float freq, float gainDb, float q = 0.707f);
+    bool    setBandGain(uint8_t band, float gainDb);
+    void    setBandCount(uint8_t count);  // bands >= count are bypassed
+    uint8_t getBandCount() {return m_bandCount;}
+    uint8_t getActiveBands();             // bands that are not flat right now
+    void    setRampTime(float msPer10dB); // gain change speed, 0 jumps at once
+    void    reset();                      // clear the filter memories
+    void    process(int16_t* buff, uint16_t frames);
+
+private:
+    typedef struct {
+        // written by setBand() from any task, picked up by process() at the next block
+        volatile uint8_t  type;
+        volatile float    freq;
+        volatile float    q;
+        volatile float    target;   // dB
+        volatile uint32_t version;
+        // owned by process()
+        uint32_t seen;
+        float    gain;              // dB the coefficients below belong to
+        bool     active;            // false: gain is 0 dB, band is skipped
+        float    b0, b1, b2, a1, a2;
+        float    x1[2], x2[2], y1[2], y2[2];
+    } band_t;
+
+    void calcCoefficients(band_t& b);
+    void bypass(band_t& b, float last, float prev, uint8_t ch);
+    void updateBands(uint16_t frames);
+    void runBand(band_t& b, float* w, uint16_t frames);
+
+    band_t   m_band[maxBands];
+    uint8_t  m_bandCount = 0;
+    uint32_t m_sampleRate = 44100;
+    float    m_rampMs = 0;
+    float    m_rampDbPerFrame = 0;
+    float    m_work[maxFrames * 2];     // float copy of the block while the biquads run
+};
@@ -510,4 +510,8 @@ inline int MULSHIFT32(int x, int y) { int z; z = (uint64_t) x * (uint64_t) y >>
 inline uint64_t MADD64(uint64_t sum64, int x, int y) {sum64 += (uint64_t) x * (uint64_t) y; return sum64;}/* returns 64-bit value in [edx:eax] */
 inline uint64_t xSAR64(uint64_t x, int n){return x >> n;}
 inline int FASTABS(int x){ return __builtin_abs(x);} //xtensa has a fast abs instruction //fb
+#ifdef __XTENSA__
 #define CLZ(x) __builtin_clz(x) //fb
+#else
+#define CLZ(x) ((x) ? __builtin_clz(x) : 32) // nsau gives 32 for 0, __builtin_clz(0) is undefined elsewhere
+#endif
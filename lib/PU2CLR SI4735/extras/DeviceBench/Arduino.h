@@ -0,0 +1,31 @@
+// Host stand-in for the Arduino core, what SI4735 and BandScan use. Time is the simulated clock
+// of device_bench.cpp: delays advance it, nothing sleeps.
+#pragma once
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef uint8_t byte;
+#define PROGMEM
+#define pgm_read_byte_near(p) (*(const uint8_t *)(p))
+#define pgm_read_word_near(p) (*(const uint16_t *)(p))
+#define OUTPUT 0x03
+#define LOW    0
+#define HIGH   1
+using std::max;
+using std::min;
+
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+uint32_t millis(void);
+uint32_t micros(void);
+static inline void pinMode(uint8_t pin, uint8_t mode) {}
+static inline void digitalWrite(uint8_t pin, uint8_t val) {}
+
+struct HostSerial {
+  void print(const char *s) { fputs(s, stdout); }
+  void println(const char *s) { puts(s); }
+  void println(void) { putchar('\n'); }
+};
+extern HostSerial Serial;
@@ -0,0 +1,35 @@
+// Host stand-in for Wire. Transactions go to the fake device in device_bench.cpp, each takes the
+// time of its bytes at the bus clock.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+class TwoWire {
+public:
+  void begin(void) {}
+  void setClock(uint32_t hz) { clock = hz; }
+  void beginTransmission(uint8_t address) { len = 0; }
+  size_t write(uint8_t data) {
+    if (len < sizeof(buf))
+      buf[len++] = data;
+    return 1;
+  }
+  size_t write(const uint8_t *data, size_t n) {
+    for (size_t i = 0; i < n; i++)
+      write(data[i]);
+    return n;
+  }
+  uint8_t endTransmission(void);
+  uint8_t requestFrom(int address, int n);
+  int read(void) { return pos < rx_len ? rx[pos++] : -1; }
+
+  uint32_t clock = 100000;
+
+private:
+  uint8_t buf[32];
+  uint8_t len = 0;
+  uint8_t rx[32];
+  uint8_t rx_len = 0;
+  uint8_t pos = 0;
+};
+extern TwoWire Wire;
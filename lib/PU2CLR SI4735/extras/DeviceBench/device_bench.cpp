@@ -0,0 +1,298 @@
+/*
+  device_bench.cpp
+
+  Host runs of SI4735 against a fake device, not an Arduino sketch. The library is built against
+  the Arduino.h / Wire.h in this directory. Wire transactions go to a fake SI473X on a simulated
+  clock: each takes the time of its bytes at the bus clock, CTS comes back MIN_CMD_US after a
+  command, and a tune completes TUNE_US after it was started. The FM band has a fixed set of
+  stations, with weaker copies of each on the next channels and noise everywhere else.
+
+    g++ -O2 -I. -I../../src -I../../../../examples/SI473x_Shield device_bench.cpp ../../src/SI4735.cpp \
+      ../../src/RdsDecoder.cpp ../../../../examples/SI473x_Shield/BandScan.cpp -o device_bench && ./device_bench
+
+  Scan: sweeps FM 87.0-108.0 MHz in 100 kHz steps with BandScan (examples/SI473x_Shield). It is
+  compared with the same sweep done with blocking setFrequency() steps, the same RSQ readings on
+  the same candidates. Both have to find every station and nothing else.
+
+  Patch: loadPatch() of patch_ssb_compressed.h through a recording Wire. The 0x15 / 0x16 lines on
+  the bus have to be patch_init.h byte for byte, sent at setPatchI2CClock(). A second loadPatch()
+  in SSB mode may only send the SSB config, one after reset() has to upload again.
+
+  Exits with 1 when a check fails. Times are those of the model, not of a board.
+*/
+#include "BandScan.h"
+#include <SI4735.h>
+#include <vector>
+
+namespace full {
+#include "patch_init.h"
+}
+namespace packed {
+#include "patch_ssb_compressed.h"
+}
+
+// device model
+static const uint32_t TUNE_US = 15000;    // FM tune, data sheet maximum 60 ms
+static const uint32_t MIN_CMD_US = 300;   // command to CTS
+static const uint32_t POWER_UP_US = 110000;
+static const uint32_t WIRE_SETUP_US = 50; // driver and start / stop per transaction
+static const uint32_t LOOP_US = 200;      // rest of the sketch's loop() between two service() calls
+
+static const uint16_t SCAN_MIN = 8700, SCAN_MAX = 10800, SCAN_STEP = 10;
+static const uint16_t stations[] = {8790, 8950, 9120, 9330, 9480, 9710, 9890, 10020, 10170, 10330, 10390, 10550, 10710};
+#define STATIONS (sizeof(stations) / sizeof(stations[0]))
+
+HostSerial Serial;
+TwoWire Wire;
+
+static uint64_t sim_us = 0;
+void delay(uint32_t ms) { sim_us += ms * 1000ULL; }
+void delayMicroseconds(uint32_t us) { sim_us += us; }
+uint32_t millis(void) { return sim_us / 1000; }
+uint32_t micros(void) { return sim_us; }
+
+static uint32_t rng = 1;
+static uint8_t noise(uint8_t n) {
+  rng = rng * 1103515245 + 12345;
+  return (rng >> 16) % n;
+}
+
+/* --- fake SI473X --- */
+
+static uint64_t cts_at = 0;
+static uint64_t stc_at = 0; // 0: no tune in flight
+static bool stc = false;
+static uint16_t tuned = 0;
+static uint8_t resp[16];
+static uint8_t resp_len = 0;
+
+typedef struct {
+  std::vector<uint8_t> bytes;
+  uint32_t clock;
+} transaction_t;
+static std::vector<transaction_t> recorded;
+
+// RSSI, SNR, valid of a channel
+static void channel(uint16_t freq, uint8_t *rssi, uint8_t *snr, bool *valid) {
+  *rssi = 6 + noise(4);
+  *snr = noise(2);
+  *valid = false;
+  for (uint8_t i = 0; i < STATIONS; i++) {
+    uint16_t d = freq > stations[i] ? freq - stations[i] : stations[i] - freq;
+    if (d == 0) {
+      *rssi = 38 + i % 4 * 6 + noise(3);
+      *snr = 18 + i % 3 * 5 + noise(3);
+      *valid = true;
+    } else if (d == SCAN_STEP && !*valid) {
+      *rssi = 22 + noise(3); // splatter of the station next door, above the floor but not valid
+      *snr = 2 + noise(2);
+    }
+  }
+}
+
+static uint8_t status(void) {
+  if (stc_at && sim_us >= stc_at) {
+    stc = true;
+    stc_at = 0;
+  }
+  return (sim_us >= cts_at ? 0x80 : 0) | (stc ? 0x01 : 0);
+}
+
+static void command(const uint8_t *cmd, uint8_t len) {
+  cts_at = sim_us + MIN_CMD_US;
+  resp_len = 0;
+  switch (cmd[0]) {
+  case 0x01: // POWER_UP
+    cts_at = sim_us + POWER_UP_US;
+    break;
+  case 0x20: // FM_TUNE_FREQ
+    tuned = cmd[2] << 8 | cmd[3];
+    stc = false;
+    stc_at = sim_us + TUNE_US;
+    break;
+  case 0x22: { // FM_TUNE_STATUS
+    uint8_t rssi, snr;
+    bool valid;
+    channel(tuned, &rssi, &snr, &valid);
+    uint8_t r[7] = {(uint8_t)valid, (uint8_t)(tuned >> 8), (uint8_t)tuned, rssi, snr, 0, 0};
+    memcpy(resp, r, 7);
+    resp_len = 7;
+    if (cmd[1] & 0x01)
+      stc = false; // INTACK
+    break;
+  }
+  case 0x23: { // FM_RSQ_STATUS
+    uint8_t rssi, snr;
+    bool valid;
+    channel(tuned, &rssi, &snr, &valid);
+    uint8_t r[7] = {0, (uint8_t)valid, 0, rssi, snr, 0, 0};
+    memcpy(resp, r, 7);
+    resp_len = 7;
+    break;
+  }
+  }
+}
+
+static uint32_t bus_us(uint32_t bytes) { return WIRE_SETUP_US + (bytes + 1) * 9 * 1000000ULL / Wire.clock; }
+
+uint8_t TwoWire::endTransmission(void) {
+  sim_us += bus_us(len);
+  recorded.push_back({std::vector<uint8_t>(buf, buf + len), clock});
+  if (status() & 0x80)
+    command(buf, len);
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(int address, int n) {
+  sim_us += bus_us(n);
+  rx[0] = status();
+  for (int i = 1; i < n; i++)
+    rx[i] = i - 1 < resp_len ? resp[i - 1] : 0;
+  rx_len = n;
+  pos = 0;
+  return n;
+}
+
+/* --- scan --- */
+
+static SI4735 rx;
+static BandScan scan(rx);
+
+static bool check_map(const char *name, const bool *valid, uint16_t channels) {
+  bool ok = true;
+  for (uint16_t i = 0; i < channels; i++) {
+    uint16_t freq = SCAN_MIN + i * SCAN_STEP;
+    bool station = false;
+    for (uint8_t s = 0; s < STATIONS; s++)
+      station |= stations[s] == freq;
+    if (valid[i] != station) {
+      printf("%s: %u.%u MHz %s\n", name, freq / 100, freq / 10 % 10, station ? "missed" : "is no station");
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+static bool scan_bench(void) {
+  uint16_t channels = (SCAN_MAX - SCAN_MIN) / SCAN_STEP + 1;
+  bool valid[channels];
+
+  // BandScan, service() from loop()
+  rng = 1;
+  uint64_t start = sim_us;
+  scan.start(SCAN_MIN, SCAN_MAX, SCAN_STEP);
+  while (scan.isRunning()) {
+    scan.service();
+    sim_us += LOOP_US;
+  }
+  uint64_t scan_us = sim_us - start;
+  for (uint16_t i = 0; i < channels; i++)
+    valid[i] = scan.getChannel(i).refined.valid;
+  bool ok = scan.isComplete() && check_map("BandScan", valid, channels);
+
+  // the same with setFrequency(): fixed maxDelaySetFrequency after every tune
+  rng = 1;
+  start = sim_us;
+  uint8_t floor = 0xFF;
+  uint16_t candidates = 0;
+  for (uint16_t i = 0; i < channels; i++) {
+    rx.setFrequency(SCAN_MIN + i * SCAN_STEP);
+    rx.getStatus(1, 0);
+    uint8_t rssi = rx.getReceivedSignalStrengthIndicator();
+    valid[i] = rx.getStatusValid();
+    if (floor == 0xFF)
+      floor = rssi;
+    if (valid[i] || rssi >= floor + SCAN_CANDIDATE_DB) {
+      candidates++;
+      for (uint8_t s = 0; s < SCAN_DWELL_SAMPLES; s++) {
+        delay(SCAN_SAMPLE_TIME);
+        rx.getCurrentReceivedSignalQuality();
+      }
+    } else {
+      floor = (floor * 7 + rssi + 4) / 8;
+    }
+  }
+  uint64_t blocking_us = sim_us - start;
+  ok = check_map("setFrequency", valid, channels) && ok;
+
+  printf("FM %u.%u-%u.%u MHz, %u channels, %u stations, tune %u ms\n", SCAN_MIN / 100, SCAN_MIN / 10 % 10,
+         SCAN_MAX / 100, SCAN_MAX / 10 % 10, channels, (unsigned)STATIONS, TUNE_US / 1000);
+  printf("  BandScan      %6.2f s, %5.1f ms/ch, %u looked at longer, %u stations\n", scan_us / 1e6,
+         scan_us / 1e3 / channels, scan.getCandidates(), scan.getStations());
+  printf("  setFrequency  %6.2f s, %5.1f ms/ch, %u looked at longer (maxDelaySetFrequency %u ms)\n",
+         blocking_us / 1e6, blocking_us / 1e3 / channels, candidates, MAX_DELAY_AFTER_SET_FREQUENCY);
+  return ok;
+}
+
+/* --- patch --- */
+
+static const si4735_compressed_patch ssbPatch = {packed::ssb_patch_content, sizeof packed::ssb_patch_content,
+                                                 packed::cmd_0x15, sizeof packed::cmd_0x15};
+
+// patch lines on the bus since the last clear, false if one was not sent at the patch clock
+static bool patch_lines(std::vector<uint8_t> *lines, uint32_t *others) {
+  bool ok = true;
+  *others = 0;
+  for (transaction_t &t : recorded) {
+    if (t.bytes.size() == 8 && (t.bytes[0] == 0x15 || t.bytes[0] == 0x16)) {
+      lines->insert(lines->end(), t.bytes.begin(), t.bytes.end());
+      ok &= t.clock == 400000;
+    } else {
+      (*others)++;
+    }
+  }
+  return ok;
+}
+
+static bool patch_bench(void) {
+  bool ok = true;
+  rx.setI2CStandardMode();
+  recorded.clear();
+  if (!rx.loadPatch(&ssbPatch, 1)) {
+    printf("loadPatch() refused\n");
+    return false;
+  }
+  std::vector<uint8_t> lines;
+  uint32_t others;
+  if (!patch_lines(&lines, &others)) {
+    printf("patch lines not sent at 400 kHz\n");
+    ok = false;
+  }
+  bool same = lines.size() == sizeof full::ssb_patch_content &&
+              memcmp(lines.data(), full::ssb_patch_content, lines.size()) == 0;
+  printf("SSB patch: %u line writes, %u other writes, %s patch_init.h, %u ms at 400 kHz, bus at %u Hz after\n",
+         (unsigned)(lines.size() / 8), others, same ? "same bytes as" : "DIFFERENT from", rx.getPatchLoadTime() / 1000,
+         Wire.clock);
+  ok = ok && same && Wire.clock == 100000;
+
+  // LSB to USB, as the sketch switches sidebands
+  rx.setSSB(7000, 7300, 7100, 1, 1);
+  recorded.clear();
+  lines.clear();
+  rx.loadPatch(&ssbPatch, 2);
+  patch_lines(&lines, &others);
+  bool config_only = lines.empty();
+  for (transaction_t &t : recorded)
+    config_only &= t.bytes.size() && t.bytes[0] == SET_PROPERTY;
+  config_only &= !recorded.empty();
+  printf("  loaded again: %u line writes, %u other writes, %s\n", (unsigned)(lines.size() / 8), others,
+         config_only ? "SSB config only" : "NOT only the SSB config");
+  ok = ok && config_only;
+
+  rx.reset();
+  recorded.clear();
+  lines.clear();
+  rx.loadPatch(&ssbPatch, 1);
+  patch_lines(&lines, &others);
+  printf("  after reset(): %u line writes\n", (unsigned)(lines.size() / 8));
+  return ok && lines.size() == sizeof full::ssb_patch_content;
+}
+
+int main() {
+  rx.setup(12, FM_CURRENT_MODE);
+  rx.setFM(SCAN_MIN, SCAN_MAX, 10390, SCAN_STEP);
+  bool ok = scan_bench();
+  ok = patch_bench() && ok;
+  printf("%s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,396 @@
+/*
+  rds_replay.cpp
+
+  Host replay of RDS group streams through RdsDecoder, not an Arduino sketch.
+
+    g++ -O2 -I../../src rds_replay.cpp ../../src/RdsDecoder.cpp -o rds_replay
+
+  ./rds_replay log.txt
+    Decodes a recorded stream, one group per line as written by RDS Spy or redsea (--output hex):
+    four blocks of 4 hex digits, "----" for a missing block. Anything after the fourth block is
+    ignored. Prints what changes, then the station data and the counters.
+
+  ./rds_replay [-o stream.txt]
+    Synthesizes a station (PS, RadioText with RT+, clock time, AF) and sends it through the decoder
+    at several block error rates. Errors are injected as the SI473X reports them: corrected blocks
+    (BLE 1, 2), uncorrectable blocks (BLE 3) and a few wrong corrections reported as BLE 1. Checks
+    the decoded data, and that no wrong character was ever shown, exits with 1 on a mismatch.
+    The last-group-wins PS decoding of getRdsText0A() is run next to it for comparison.
+    -o writes the stream of the 5 % run in the log format above.
+*/
+#include "RdsDecoder.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t PI = 0x5423;
+static const uint8_t PTY = 10; // pop music
+static const char *PS = "RADIO 42";
+static const char *RT1 = "Now playing: Sting - Englishman in New York";
+static const char *RT2 = "Next: the news at noon";
+static const uint32_t MJD = 60000; // 2023-02-25
+static const uint8_t HOUR = 11, MINUTE = 58;
+static const int8_t OFFSET = 2;                      // UTC + 1:00
+static const uint16_t AF[3] = {8910, 9580, 10390}; // 89.1, 95.8, 103.9 MHz
+static const uint8_t RTPLUS_GROUP = 22;              // 11A
+static const uint32_t CYCLES = 300;                  // a cycle is 24 groups, about 2.1 s on air
+
+static uint32_t rnd = 1;
+
+static uint32_t random32()
+{
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 17;
+    rnd ^= rnd << 5;
+    return rnd;
+}
+
+static uint16_t blockB(uint8_t type, uint8_t low)
+{
+    return (uint16_t)(type << 11 | 1 << 10 | PTY << 5 | (low & 0x1F));
+}
+
+static uint8_t afCode(uint16_t f)
+{
+    return (f - 8750) / 10;
+}
+
+/*
+  One cycle of the synthetic station: 4 x 0A, 16 x 2A, 4A, 3A, 11A and another 0A.
+  item selects RT1 (0) or RT2 (1), the A/B flag and the RT+ toggle follow it.
+*/
+static uint8_t buildCycle(uint16_t groups[][4], uint8_t item)
+{
+    const char *rt = item ? RT2 : RT1;
+    char text[64];
+    uint8_t len = strlen(rt);
+    uint8_t n = 0;
+
+    memset(text, ' ', sizeof(text));
+    memcpy(text, rt, len);
+    text[len] = 0x0D;
+
+    uint16_t afPairs[2] = {(uint16_t)((224 + 3) << 8 | afCode(AF[0])), (uint16_t)(afCode(AF[1]) << 8 | afCode(AF[2]))};
+    for (uint8_t a = 0; a < 5; a++)
+    {
+        uint8_t addr = a & 3;
+        uint16_t *g = groups[n++];
+        g[0] = PI;
+        g[1] = blockB(0, 0x08 | addr); // MS = music
+        g[2] = afPairs[addr & 1];
+        g[3] = (uint16_t)(PS[addr * 2] << 8 | PS[addr * 2 + 1]);
+        if (a == 3)
+        {
+            // the rest of the cycle in between, as stations mix their groups
+            for (uint8_t s = 0; s < 16; s++)
+            {
+                g = groups[n++];
+                g[0] = PI;
+                g[1] = blockB(4, item << 4 | s);
+                g[2] = (uint16_t)((uint8_t)text[s * 4] << 8 | (uint8_t)text[s * 4 + 1]);
+                g[3] = (uint16_t)((uint8_t)text[s * 4 + 2] << 8 | (uint8_t)text[s * 4 + 3]);
+            }
+            g = groups[n++];
+            g[0] = PI;
+            g[1] = blockB(8, MJD >> 15);
+            g[2] = (uint16_t)((MJD & 0x7FFF) << 1 | HOUR >> 4);
+            g[3] = (uint16_t)((HOUR & 0x0F) << 12 | MINUTE << 6 | (OFFSET < 0 ? 0x20 : 0) | abs(OFFSET));
+            g = groups[n++];
+            g[0] = PI;
+            g[1] = blockB(6, RTPLUS_GROUP);
+            g[2] = 0;
+            g[3] = RDS_RTPLUS_AID;
+        }
+    }
+
+    // RT+: item 0 tags the artist and the title, item 1 the current programme
+    uint8_t t1 = item ? RDS_RTPLUS_PROGRAMME_NOW : RDS_RTPLUS_ARTIST, s1 = item ? 0 : 13, l1 = item ? 4 : 5;
+    uint8_t t2 = item ? 0 : RDS_RTPLUS_TITLE, s2 = item ? 0 : 21, l2 = item ? 1 : 22;
+    uint16_t *g = groups[n++];
+    g[0] = PI;
+    g[1] = blockB(RTPLUS_GROUP, item << 4 | 1 << 3 | t1 >> 3);
+    g[2] = (uint16_t)((t1 & 7) << 13 | s1 << 7 | (l1 - 1) << 1 | t2 >> 5);
+    g[3] = (uint16_t)((t2 & 0x1F) << 11 | s2 << 5 | (l2 - 1));
+    return n;
+}
+
+/*
+  Error levels as FM_RDS_STATUS reports them. A block with 3 - 5 corrected bits may well be
+  miscorrected, one with 1 - 2 rarely. Uncorrectable blocks carry garbage.
+*/
+static void corrupt(uint16_t *blocks, uint8_t *errors, uint32_t perMille)
+{
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        errors[i] = 0;
+        if (random32() % 1000 >= perMille)
+            continue;
+        uint32_t r = random32() % 100;
+        if (r < 45)
+        {
+            errors[i] = 1;
+            if (r < 2)
+                blocks[i] ^= 1 << (random32() % 16);
+        }
+        else if (r < 70)
+        {
+            errors[i] = 2;
+            if (r < 60)
+                blocks[i] ^= 1 << (random32() % 16) | 1 << (random32() % 16);
+        }
+        else
+        {
+            errors[i] = 3;
+            blocks[i] = random32();
+        }
+    }
+}
+
+/*
+  PS as getRdsText0A() builds it: the last group wins, every block the device delivered is used.
+*/
+class LastGroupPS
+{
+public:
+    LastGroupPS() { memset(ps, ' ', 8); ps[8] = 0; }
+    void processGroup(const uint16_t *blocks, const uint8_t *errors)
+    {
+        if (errors[1] == 3 || errors[3] == 3 || (blocks[1] >> 11) > 1)
+            return;
+        uint8_t addr = blocks[1] & 3;
+        ps[addr * 2] = blocks[3] >> 8;
+        ps[addr * 2 + 1] = blocks[3] & 0xFF;
+    }
+    char ps[9];
+};
+
+// a shown string that is neither the expected text nor a part of it still being received
+static bool wrongText(const char *shown, const char *expected)
+{
+    for (uint8_t i = 0; shown[i]; i++)
+        if (shown[i] != ' ' && shown[i] != expected[i])
+            return true;
+    return false;
+}
+
+static bool expectText(RdsDecoder &rds, uint8_t type, const char *expected)
+{
+    char text[65];
+    if (!rds.getRtPlusText(type, text, sizeof(text)))
+        return false;
+    return strcmp(text, expected) == 0;
+}
+
+static void printStat(const rds_stat *s)
+{
+    printf("  groups %u, dropped %u, lost %u, blocks ok %u corrected %u/%u bad %u\n", s->groups, s->dropped, s->lost,
+           s->blocks[0], s->blocks[1], s->blocks[2], s->blocks[3]);
+    printf("  group types:");
+    for (uint8_t t = 0; t < 32; t++)
+        if (s->groupType[t])
+            printf(" %u%c %u", t >> 1, t & 1 ? 'B' : 'A', s->groupType[t]);
+    printf("\n");
+}
+
+static void printStation(RdsDecoder &rds)
+{
+    uint16_t year;
+    uint8_t month, day, hour, minute;
+    int8_t offset;
+
+    printf("  PI %04X PTY %u%s%s%s PS \"%s\"%s\n", rds.getPI(), rds.getPTY(), rds.getTP() ? " TP" : "",
+           rds.getTA() ? " TA" : "", rds.getMS() ? " music" : " speech", rds.getPS(), rds.isPSComplete() ? "" : " (incomplete)");
+    printf("  RT \"%s\"%s\n", rds.getRT(), rds.isRTComplete() ? "" : " (incomplete)");
+    if (rds.getTime(&year, &month, &day, &hour, &minute, &offset))
+        printf("  CT %04u-%02u-%02u %02u:%02u UTC, local offset %+d min\n", year, month, day, hour, minute, offset * 30);
+    if (rds.getAFCount())
+    {
+        printf("  AF");
+        for (uint8_t i = 0; i < rds.getAFCount(); i++)
+            printf(" %u.%u", rds.getAF(i) / 100, rds.getAF(i) / 10 % 10);
+        printf("\n");
+    }
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        rds_rtplus_tag tag;
+        char text[65];
+        if (rds.getRtPlusTag(i, &tag))
+            printf("  RT+ type %u \"%s\"\n", tag.type, rds.getRtPlusText(tag.type, text, sizeof(text)) ? text : "");
+    }
+}
+
+// groups of a log, changes printed as they come
+static int replay(const char *name)
+{
+    FILE *f = fopen(name, "r");
+    if (f == NULL)
+    {
+        perror(name);
+        return 2;
+    }
+    RdsDecoder rds;
+    char line[256];
+    uint32_t n = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        uint16_t blocks[4];
+        uint8_t errors[4];
+        char *p = line;
+        uint8_t i;
+        for (i = 0; i < 4; i++)
+        {
+            while (*p == ' ' || *p == '\t')
+                p++;
+            if (strncmp(p, "----", 4) == 0)
+            {
+                blocks[i] = 0;
+                errors[i] = 3;
+                p += 4;
+                continue;
+            }
+            char *end;
+            unsigned long v = strtoul(p, &end, 16);
+            if (end - p != 4)
+                break;
+            blocks[i] = v;
+            errors[i] = 0;
+            p = end;
+        }
+        if (i < 4)
+            continue; // comment, header or a broken line
+        rds.processGroup(blocks, errors);
+        n++;
+        uint8_t changes = rds.getChanges();
+        if (changes & RDS_CHANGED_PI)
+            printf("%6u PI %04X\n", n, rds.getPI());
+        if ((changes & RDS_CHANGED_PS) && rds.isPSComplete())
+            printf("%6u PS \"%s\"\n", n, rds.getPS());
+        if ((changes & RDS_CHANGED_RT) && rds.isRTComplete())
+            printf("%6u RT \"%s\"\n", n, rds.getRT());
+        if (changes & RDS_CHANGED_CT)
+        {
+            uint16_t year;
+            uint8_t month, day, hour, minute;
+            int8_t offset;
+            rds.getTime(&year, &month, &day, &hour, &minute, &offset);
+            printf("%6u CT %04u-%02u-%02u %02u:%02u UTC%+d min\n", n, year, month, day, hour, minute, offset * 30);
+        }
+    }
+    fclose(f);
+    printf("%s: %u groups\n", name, n);
+    printStation(rds);
+    printStat(rds.getStat());
+    return 0;
+}
+
+// the synthetic station at an error rate in blocks per thousand, true if everything decoded right
+static bool run(uint32_t perMille, FILE *out)
+{
+    RdsDecoder rds;
+    LastGroupPS naive;
+    uint16_t cycle[32][4];
+    bool ok = true;
+    uint32_t psFirst = 0, rtFirst = 0, wrongPS = 0, wrongRT = 0, naiveWrong = 0;
+    uint32_t n = 0;
+    char item1[65] = "";
+    bool item1Tags = false;
+    double ns = 0;
+
+    rnd = 12345 + perMille;
+    for (uint32_t c = 0; c < CYCLES; c++)
+    {
+        uint8_t item = c >= CYCLES / 2;
+        uint8_t count = buildCycle(cycle, item);
+        if (c == CYCLES / 2)
+        {
+            // what was decoded of the first item, before the A/B flag toggles
+            strcpy(item1, rds.getRT());
+            item1Tags = expectText(rds, RDS_RTPLUS_ARTIST, "Sting") && expectText(rds, RDS_RTPLUS_TITLE, "Englishman in New York");
+        }
+        for (uint8_t g = 0; g < count; g++)
+        {
+            uint8_t errors[4];
+            corrupt(cycle[g], errors, perMille);
+            if (out)
+            {
+                for (uint8_t i = 0; i < 4; i++)
+                    fprintf(out, i < 3 ? (errors[i] == 3 ? "---- " : "%04X ") : (errors[i] == 3 ? "----\n" : "%04X\n"), cycle[g][i]);
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            rds.processGroup(cycle[g], errors);
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+            naive.processGroup(cycle[g], errors);
+            n++;
+
+            uint8_t changes = rds.getChanges();
+            if ((changes & RDS_CHANGED_PS) && wrongText(rds.getPS(), PS))
+                wrongPS++;
+            if ((changes & RDS_CHANGED_RT) && wrongText(rds.getRT(), item ? RT2 : RT1))
+                wrongRT++;
+            if (!psFirst && strcmp(rds.getPS(), PS) == 0)
+                psFirst = n;
+            if (!rtFirst && strcmp(rds.getRT(), RT1) == 0)
+                rtFirst = n;
+            if (wrongText(naive.ps, PS))
+                naiveWrong++;
+        }
+    }
+
+    uint16_t year;
+    uint8_t month, day, hour, minute;
+    int8_t offset;
+    bool ct = rds.getTime(&year, &month, &day, &hour, &minute, &offset) && year == 2023 && month == 2 && day == 25 &&
+              hour == HOUR && minute == MINUTE && offset == OFFSET;
+    bool af = rds.getAFCount() == 3;
+    for (uint8_t i = 0; af && i < 3; i++)
+        af = rds.getAF(i) == AF[0] || rds.getAF(i) == AF[1] || rds.getAF(i) == AF[2];
+
+    ok &= rds.getPI() == PI && rds.getPTY() == PTY && rds.getTP() && rds.getMS();
+    ok &= strcmp(rds.getPS(), PS) == 0 && strcmp(rds.getRT(), RT2) == 0 && rds.isRTComplete();
+    ok &= strcmp(item1, RT1) == 0 && item1Tags;
+    ok &= expectText(rds, RDS_RTPLUS_PROGRAMME_NOW, "Next") && !expectText(rds, RDS_RTPLUS_TITLE, "Englishman in New York");
+    ok &= ct && af && wrongPS == 0 && wrongRT == 0;
+
+    const rds_stat *s = rds.getStat();
+    printf("%2u.%u %% block errors: PS after %u groups, RT after %u, wrong PS shown %u, wrong RT shown %u, "
+           "last-group PS wrong in %u of %u groups, %.0f ns/group  %s\n",
+           perMille / 10, perMille % 10, psFirst, rtFirst, wrongPS, wrongRT, naiveWrong, n, ns / n, ok ? "ok" : "MISMATCH");
+    if (!ok)
+    {
+        printStation(rds);
+        printStat(s);
+    }
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *out = NULL;
+    if (argc == 3 && strcmp(argv[1], "-o") == 0)
+    {
+        out = fopen(argv[2], "w");
+        if (out == NULL)
+        {
+            perror(argv[2]);
+            return 2;
+        }
+    }
+    else if (argc == 2)
+    {
+        return replay(argv[1]);
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [log.txt | -o stream.txt]\n", argv[0]);
+        return 2;
+    }
+
+    static const uint32_t rates[] = {0, 10, 50, 100, 200};
+    bool ok = true;
+    for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+        ok &= run(rates[i], rates[i] == 50 ? out : NULL);
+    if (out)
+        fclose(out);
+    return ok ? 0 : 1;
+}
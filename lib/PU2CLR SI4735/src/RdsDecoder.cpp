@@ -0,0 +1,486 @@
+/**
+ * @brief Incremental RDS group decoder
+ *
+ * @details See RdsDecoder.h. Group layout: block B holds the group type (bits 15-12), the version
+ * @details (bit 11, 0 = A, 1 = B), TP (bit 10), PTY (bits 9-5) and 5 bits depending on the group.
+ */
+
+#include "RdsDecoder.h"
+#include <string.h>
+
+RdsDecoder::RdsDecoder()
+{
+    clearStat();
+    reset();
+}
+
+/**
+ * @brief Forgets everything about the station, call it after tuning
+ *
+ * @details The counters are kept, see clearStat().
+ *
+ * @param frequency the new frequency, only stored (see getFrequency())
+ */
+void RdsDecoder::reset(uint16_t frequency)
+{
+    this->frequency = frequency;
+    pi = piCand = 0;
+    piConf = 0;
+    clearContent();
+}
+
+/**
+ * @brief Clears the group and block counters
+ */
+void RdsDecoder::clearStat()
+{
+    memset(&stat, 0, sizeof(stat));
+}
+
+/**
+ * @brief Everything that belongs to a program, on reset and when the PI changes
+ */
+void RdsDecoder::clearContent()
+{
+    pty = 0;
+    tp = ta = ms = false;
+    memset(psCand, 0, sizeof(psCand));
+    memset(psConf, 0, sizeof(psConf));
+    memset(psShow, ' ', 8);
+    psShow[8] = '\0';
+    psSeen = 0;
+    rtFlag = -1;
+    rtMax = 64;
+    clearRT();
+    ctValid = false;
+    afCount = afUsed = afNext = 0;
+    rtPlusGroup = -1;
+    rtPlusToggle = -1;
+    rtPlusRunning = false;
+    memset(rtPlus, 0, sizeof(rtPlus));
+    changes = RDS_CHANGED_PTY | RDS_CHANGED_PS | RDS_CHANGED_RT | RDS_CHANGED_AF | RDS_CHANGED_RTPLUS;
+}
+
+void RdsDecoder::clearRT()
+{
+    memset(rtCand, 0, sizeof(rtCand));
+    memset(rtConf, 0, sizeof(rtConf));
+    memset(rtChars, ' ', sizeof(rtChars));
+    rtSeen = 0;
+    rtShow[0] = '\0';
+}
+
+/**
+ * @brief Decodes one group
+ *
+ * @details Blocks with an error level above RDS_MAX_ERRORS are not used. Without block B the
+ * @details group type is unknown and the group is dropped.
+ *
+ * @param blocks  blocks A to D
+ * @param errors  error level of each block, as BLEA to BLED of FM_RDS_STATUS:
+ *                0 = none, 1 = 1-2 bits corrected, 2 = 3-5 bits corrected, 3 = uncorrectable
+ */
+void RdsDecoder::processGroup(const uint16_t *blocks, const uint8_t *errors)
+{
+    for (uint8_t i = 0; i < 4; i++)
+        stat.blocks[errors[i] & 3]++;
+    if (errors[0] <= RDS_MAX_ERRORS)
+        processPI(blocks[0]);
+    if (errors[1] > RDS_MAX_ERRORS)
+    {
+        stat.dropped++;
+        return;
+    }
+    stat.groups++;
+
+    uint16_t b = blocks[1];
+    uint8_t type = b >> 11; // type * 2 + version
+    bool versionB = b & 0x0800;
+    bool useC = errors[2] <= RDS_MAX_ERRORS;
+    bool useD = errors[3] <= RDS_MAX_ERRORS;
+    stat.groupType[type]++;
+
+    // version B groups repeat the PI in block C
+    if (versionB && useC)
+        processPI(blocks[2]);
+
+    bool newTp = b & 0x0400;
+    uint8_t newPty = (b >> 5) & 0x1F;
+    if (newTp != tp || newPty != pty)
+    {
+        tp = newTp;
+        pty = newPty;
+        changes |= RDS_CHANGED_PTY;
+    }
+
+    switch (type)
+    {
+    case 0: // 0A
+    case 1: // 0B
+        ta = b & 0x10;
+        ms = b & 0x08;
+        if (type == 0 && useC)
+            processAF(blocks[2]);
+        if (useD)
+            processPS(b & 0x03, blocks[3]);
+        break;
+    case 4: // 2A
+    case 5: // 2B
+        if (rtFlag != ((b >> 4) & 1))
+        {
+            // A/B flag toggled: a new text
+            rtFlag = (b >> 4) & 1;
+            clearRT();
+            changes |= RDS_CHANGED_RT;
+        }
+        processRT(b & 0x0F, type == 4, blocks[2], blocks[3], useC && type == 4, useD);
+        break;
+    case 6: // 3A
+        if (useD)
+            processODA(b, blocks[3]);
+        break;
+    case 8: // 4A
+        if (useC && useD)
+            processCT(b, blocks[2], blocks[3]);
+        break;
+    }
+    if (type == rtPlusGroup && useC && useD)
+        processRtPlus(b, blocks[2], blocks[3]);
+}
+
+/**
+ * @brief A new PI must be received RDS_VOTE_SHOW times in a row, then it is another program
+ */
+void RdsDecoder::processPI(uint16_t newPi)
+{
+    if (newPi != piCand)
+    {
+        piCand = newPi;
+        piConf = 1;
+    }
+    else if (piConf < RDS_VOTE_SHOW)
+    {
+        piConf++;
+    }
+    if (piConf >= RDS_VOTE_SHOW && pi != piCand)
+    {
+        if (pi != 0)
+            clearContent();
+        pi = piCand;
+        changes |= RDS_CHANGED_PI;
+    }
+}
+
+/**
+ * @brief Votes one received character against the candidate of its position
+ *
+ * @details The same character again raises the confidence, up to RDS_VOTE_MAX. Another
+ * @details character lowers it, and replaces the candidate once it is down to 1. The candidate is
+ * @details shown when its confidence reaches RDS_VOTE_SHOW.
+ *
+ * @return true if the shown character changed
+ */
+bool RdsDecoder::vote(char *cand, uint8_t *conf, char *shown, char c)
+{
+    if (c == *cand)
+    {
+        if (*conf < RDS_VOTE_MAX)
+            (*conf)++;
+    }
+    else if (*conf > 1)
+    {
+        (*conf)--;
+        return false;
+    }
+    else
+    {
+        *cand = c;
+        *conf = 1;
+    }
+    if (*conf >= RDS_VOTE_SHOW && *shown != *cand)
+    {
+        *shown = *cand;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Characters below 0x20 are shown as spaces, the RadioText end mark is handled before
+ */
+static char printable(uint8_t c)
+{
+    return c < 0x20 ? ' ' : (char)c;
+}
+
+void RdsDecoder::processPS(uint8_t address, uint16_t blockD)
+{
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        uint8_t pos = address * 2 + i;
+        char c = printable(i == 0 ? blockD >> 8 : blockD & 0xFF);
+        bool changed = vote(&psCand[pos], &psConf[pos], &psShow[pos], c);
+        if (psConf[pos] >= RDS_VOTE_SHOW && !(psSeen & (1 << pos)))
+        {
+            psSeen |= 1 << pos;
+            changed = true;
+        }
+        if (changed)
+            changes |= RDS_CHANGED_PS;
+    }
+}
+
+bool RdsDecoder::isPSComplete()
+{
+    return psSeen == 0xFF;
+}
+
+/**
+ * @brief Alternative frequencies, method A: a count code (224 - 249) then the frequency codes
+ *
+ * @details Codes 1 - 204 are 87.6 to 107.9 MHz. 250 announces an LF/MF frequency in the other byte, skipped.
+ * @details A frequency is listed once received RDS_VOTE_SHOW times, so a miscorrected block does not add one.
+ */
+void RdsDecoder::processAF(uint16_t blockC)
+{
+    uint8_t code[2] = {(uint8_t)(blockC >> 8), (uint8_t)(blockC & 0xFF)};
+    if (code[0] == 250)
+        return;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        // the same code twice in a block is one reception
+        if (code[i] < 1 || code[i] > 204 || (i == 1 && code[1] == code[0]))
+            continue;
+        uint16_t f = 8750 + code[i] * 10;
+        uint8_t j = 0;
+        while (j < afUsed && af[j] != f)
+            j++;
+        if (j == afUsed)
+        {
+            if (afUsed < RDS_AF_MAX)
+                afUsed++;
+            else if (afCount < RDS_AF_MAX)
+                j = afCount + afNext++ % (RDS_AF_MAX - afCount);
+            else
+                continue;
+            af[j] = f;
+            afHits[j] = 0;
+        }
+        if (j < afCount || ++afHits[j] < RDS_VOTE_SHOW)
+            continue;
+        // confirmed: swap it to the end of the confirmed ones
+        af[j] = af[afCount];
+        afHits[j] = afHits[afCount];
+        af[afCount++] = f;
+        changes |= RDS_CHANGED_AF;
+    }
+}
+
+void RdsDecoder::rtChar(uint8_t pos, char c)
+{
+    bool changed = vote(&rtCand[pos], &rtConf[pos], &rtChars[pos], c);
+    if (rtConf[pos] >= RDS_VOTE_SHOW && !(rtSeen & (1ULL << pos)))
+    {
+        rtSeen |= 1ULL << pos;
+        changed = true;
+    }
+    if (changed)
+    {
+        buildRT();
+        changes |= RDS_CHANGED_RT;
+    }
+}
+
+/**
+ * @brief RadioText, 2A: 4 characters in blocks C and D, 2B: 2 characters in block D
+ *
+ * @details Switching between 2A and 2B clears the text as well.
+ */
+void RdsDecoder::processRT(uint8_t address, bool versionA, uint16_t blockC, uint16_t blockD, bool useC, bool useD)
+{
+    if (!useC && !useD)
+        return;
+    uint8_t max = versionA ? 64 : 32;
+    if (rtMax != max)
+    {
+        rtMax = max;
+        clearRT();
+        changes |= RDS_CHANGED_RT;
+    }
+    uint8_t pos = address * (versionA ? 4 : 2);
+    if (versionA && useC)
+    {
+        rtChar(pos, blockC >> 8 == 0x0D ? '\r' : printable(blockC >> 8));
+        rtChar(pos + 1, (blockC & 0xFF) == 0x0D ? '\r' : printable(blockC & 0xFF));
+    }
+    if (useD)
+    {
+        uint8_t d = versionA ? 2 : 0;
+        rtChar(pos + d, blockD >> 8 == 0x0D ? '\r' : printable(blockD >> 8));
+        rtChar(pos + d + 1, (blockD & 0xFF) == 0x0D ? '\r' : printable(blockD & 0xFF));
+    }
+}
+
+/**
+ * @brief The shown RadioText: up to the end mark, positions not voted in yet as spaces, trailing spaces removed
+ */
+void RdsDecoder::buildRT()
+{
+    uint8_t len = 0;
+    while (len < rtMax && !((rtSeen & (1ULL << len)) && rtChars[len] == '\r'))
+    {
+        rtShow[len] = rtChars[len];
+        len++;
+    }
+    while (len > 0 && rtShow[len - 1] == ' ')
+        len--;
+    rtShow[len] = '\0';
+}
+
+bool RdsDecoder::isRTComplete()
+{
+    for (uint8_t i = 0; i < rtMax; i++)
+    {
+        if (!(rtSeen & (1ULL << i)))
+            return false;
+        if (rtChars[i] == '\r')
+            return true;
+    }
+    return rtSeen != 0;
+}
+
+/**
+ * @brief Clock time and date (4A), UTC as Modified Julian Day, hour and minute, plus the local offset
+ */
+void RdsDecoder::processCT(uint16_t blockB, uint16_t blockC, uint16_t blockD)
+{
+    uint32_t mjd = ((uint32_t)(blockB & 0x03) << 15) | (blockC >> 1);
+    uint8_t hour = ((blockC & 0x01) << 4) | (blockD >> 12);
+    uint8_t minute = (blockD >> 6) & 0x3F;
+    int8_t offset = blockD & 0x1F;
+    if (blockD & 0x20)
+        offset = -offset;
+    if (mjd == 0 || hour > 23 || minute > 59)
+        return;
+    ctValid = true;
+    ctMjd = mjd;
+    ctHour = hour;
+    ctMinute = minute;
+    ctOffset = offset;
+    changes |= RDS_CHANGED_CT;
+}
+
+/**
+ * @brief Gets the last clock time received
+ *
+ * @details Date from the Modified Julian Day with the integer form of the conversion in annex G of the RDS standard.
+ *
+ * @param offset  local time offset in half hours, local time = UTC + offset * 30 minutes
+ * @return false if no clock time was received yet
+ */
+bool RdsDecoder::getTime(uint16_t *year, uint8_t *month, uint8_t *day, uint8_t *hour, uint8_t *minute, int8_t *offset)
+{
+    if (!ctValid)
+        return false;
+    int32_t y = ((int32_t)ctMjd * 100 - 1507820) / 36525;
+    int32_t t = (int32_t)ctMjd - 14956 - y * 36525 / 100;
+    int32_t m = (t * 10000 - 1000) / 306001;
+    int32_t k = (m == 14 || m == 15) ? 1 : 0;
+    *day = t - m * 306001 / 10000;
+    *month = m - 1 - k * 12;
+    *year = 1900 + y + k;
+    *hour = ctHour;
+    *minute = ctMinute;
+    *offset = ctOffset;
+    return true;
+}
+
+/**
+ * @brief Open Data Application announcement (3A): the group type in block B, the AID in block D
+ */
+void RdsDecoder::processODA(uint16_t blockB, uint16_t blockD)
+{
+    if (blockD == RDS_RTPLUS_AID)
+        rtPlusGroup = blockB & 0x1F;
+}
+
+/**
+ * @brief RadioText+ group: two tags (content type, start, length) pointing into the RadioText
+ *
+ * @details A new item toggle bit means a new item, the old tags are cleared.
+ */
+void RdsDecoder::processRtPlus(uint16_t blockB, uint16_t blockC, uint16_t blockD)
+{
+    int8_t toggle = (blockB >> 4) & 0x01;
+    rtPlusRunning = blockB & 0x08;
+    if (toggle != rtPlusToggle)
+    {
+        rtPlusToggle = toggle;
+        memset(rtPlus, 0, sizeof(rtPlus));
+        changes |= RDS_CHANGED_RTPLUS;
+    }
+    rds_rtplus_tag tag[2];
+    tag[0].type = ((blockB & 0x07) << 3) | (blockC >> 13);
+    tag[0].start = (blockC >> 7) & 0x3F;
+    tag[0].length = ((blockC >> 1) & 0x3F) + 1;
+    tag[1].type = ((blockC & 0x01) << 5) | (blockD >> 11);
+    tag[1].start = (blockD >> 5) & 0x3F;
+    tag[1].length = (blockD & 0x1F) + 1;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (tag[i].type == 0 || tag[i].start + tag[i].length > 64)
+            continue;
+        if (memcmp(&tag[i], &rtPlus[i], sizeof(rds_rtplus_tag)) != 0)
+        {
+            rtPlus[i] = tag[i];
+            changes |= RDS_CHANGED_RTPLUS;
+        }
+    }
+}
+
+/**
+ * @brief Gets one of the two RT+ tags of the current item
+ *
+ * @return false if there is no tag at idx
+ */
+bool RdsDecoder::getRtPlusTag(uint8_t idx, rds_rtplus_tag *tag)
+{
+    if (idx > 1 || rtPlus[idx].type == 0)
+        return false;
+    *tag = rtPlus[idx];
+    return true;
+}
+
+/**
+ * @brief Copies the part of the RadioText tagged with a content type, e.g. RDS_RTPLUS_TITLE
+ *
+ * @return false if no tag has this type or the RadioText there is not complete
+ */
+bool RdsDecoder::getRtPlusText(uint8_t type, char *text, uint8_t size)
+{
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        if (rtPlus[i].type != type || type == 0)
+            continue;
+        uint8_t n = 0;
+        for (uint8_t j = rtPlus[i].start; j < rtPlus[i].start + rtPlus[i].length && n + 1 < size; j++)
+        {
+            if (!(rtSeen & (1ULL << j)) || rtChars[j] == '\r')
+                return false;
+            text[n++] = rtChars[j];
+        }
+        text[n] = '\0';
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief What changed since the last call, RDS_CHANGED_* bits
+ */
+uint8_t RdsDecoder::getChanges()
+{
+    uint8_t c = changes;
+    changes = 0;
+    return c;
+}
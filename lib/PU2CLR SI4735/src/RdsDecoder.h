@@ -0,0 +1,169 @@
+/**
+ * @brief Incremental RDS group decoder
+ *
+ * @details Decodes every RDS group the SI473X hands over (see SI4735::getRdsGroups()), instead of
+ * @details looking at the last group when the text is asked for. Text characters are voted: a
+ * @details character is shown once it was received RDS_VOTE_SHOW times in a row from blocks with
+ * @details at most 1-2 corrected bit errors, so a corrupted block does not overwrite good text.
+ * @details Decodes PI, PTY, TP/TA/MS, PS (0A/0B), RadioText (2A/2B), clock time (4A),
+ * @details alternative frequencies (0A, method A) and RadioText+ (ODA 0x4BD7).
+ * @details Plain C++ without Arduino calls, it can be driven by recorded group streams on a host
+ * @details (see extras/RdsReplay).
+ *
+ * @see IEC 62106 / EN 50067 (RDS), RadioText Plus specification (RT+)
+ */
+
+#ifndef _RDS_DECODER_H
+#define _RDS_DECODER_H
+
+#include <stdint.h>
+
+#define RDS_AF_MAX 25      //!< Alternative frequencies kept, confirmed or not
+#define RDS_VOTE_MAX 2     //!< Confidence limit of a character; a shown character survives this many disagreeing receptions
+#define RDS_VOTE_SHOW 2    //!< Receptions in a row to show a new character
+#define RDS_MAX_ERRORS 1   //!< Highest block error level (BLE) decoded: 1 = 1-2 bit errors corrected by the device
+#define RDS_RTPLUS_AID 0x4BD7
+
+// getChanges() bits
+#define RDS_CHANGED_PI 0x01
+#define RDS_CHANGED_PTY 0x02
+#define RDS_CHANGED_PS 0x04
+#define RDS_CHANGED_RT 0x08
+#define RDS_CHANGED_CT 0x10
+#define RDS_CHANGED_AF 0x20
+#define RDS_CHANGED_RTPLUS 0x40
+
+// RT+ content types (subset)
+#define RDS_RTPLUS_TITLE 1
+#define RDS_RTPLUS_ALBUM 2
+#define RDS_RTPLUS_ARTIST 4
+#define RDS_RTPLUS_PROGRAMME_NOW 33
+#define RDS_RTPLUS_STATIONNAME_LONG 31
+
+/**
+ * @brief Group and block counters
+ */
+typedef struct
+{
+    uint32_t groups;        //!< Groups decoded (block B usable)
+    uint32_t dropped;       //!< Groups with an uncorrectable block B
+    uint32_t lost;          //!< FIFO overruns reported by the device
+    uint32_t blocks[4];     //!< Blocks per error level: 0 = none, 1 = 1-2 bits corrected, 2 = 3-5 bits corrected, 3 = uncorrectable
+    uint32_t groupType[32]; //!< Groups per type, index type * 2 + version (0A = 0, 0B = 1, 2A = 4 ...)
+} rds_stat;
+
+/**
+ * @brief RadioText+ tag, a part of the RadioText
+ */
+typedef struct
+{
+    uint8_t type;   //!< Content type, 0 = none
+    uint8_t start;  //!< First character in the RadioText
+    uint8_t length; //!< Characters
+} rds_rtplus_tag;
+
+class RdsDecoder
+{
+public:
+    RdsDecoder();
+
+    void reset(uint16_t frequency = 0);
+    void clearStat();
+    void processGroup(const uint16_t *blocks, const uint8_t *errors);
+    /**
+     * @brief The device discarded groups (FIFO overrun)
+     */
+    inline void addLost() { stat.lost++; };
+
+    /**
+     * @brief Frequency given to reset(), SI4735::getRdsGroups() resets the decoder when it changes
+     */
+    inline uint16_t getFrequency() { return frequency; };
+    inline bool hasPI() { return piConf >= RDS_VOTE_SHOW; };
+    inline uint16_t getPI() { return pi; };
+    inline uint8_t getPTY() { return pty; };
+    inline bool getTP() { return tp; };
+    inline bool getTA() { return ta; };
+    inline bool getMS() { return ms; };
+
+    /**
+     * @brief Program Service name, 8 characters, spaces where nothing was voted in yet
+     */
+    inline const char *getPS() { return psShow; };
+    bool isPSComplete();
+    /**
+     * @brief RadioText up to the end mark (0x0D) or 64 characters (32 for 2B)
+     */
+    inline const char *getRT() { return rtShow; };
+    bool isRTComplete();
+
+    bool getTime(uint16_t *year, uint8_t *month, uint8_t *day, uint8_t *hour, uint8_t *minute, int8_t *offset);
+
+    inline uint8_t getAFCount() { return afCount; };
+    /**
+     * @brief Alternative frequency in 10 kHz like the FM frequencies of SI4735 (10390 = 103.9 MHz)
+     */
+    inline uint16_t getAF(uint8_t idx) { return idx < afCount ? af[idx] : 0; };
+
+    bool getRtPlusTag(uint8_t idx, rds_rtplus_tag *tag);
+    bool getRtPlusText(uint8_t type, char *text, uint8_t size);
+    inline bool getRtPlusRunning() { return rtPlusRunning; };
+
+    uint8_t getChanges();
+    inline const rds_stat *getStat() { return &stat; };
+
+private:
+    void clearContent();
+    void processPI(uint16_t pi);
+    void processPS(uint8_t address, uint16_t blockD);
+    void processAF(uint16_t blockC);
+    void processRT(uint8_t address, bool versionA, uint16_t blockC, uint16_t blockD, bool useC, bool useD);
+    void rtChar(uint8_t pos, char c);
+    void processCT(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    void processODA(uint16_t blockB, uint16_t blockD);
+    void processRtPlus(uint16_t blockB, uint16_t blockC, uint16_t blockD);
+    bool vote(char *cand, uint8_t *conf, char *shown, char c);
+    void clearRT();
+    void buildRT();
+
+    uint16_t frequency;
+    uint16_t pi;
+    uint16_t piCand;
+    uint8_t piConf;
+    uint8_t pty;
+    bool tp, ta, ms;
+
+    char psCand[8];
+    uint8_t psConf[8];
+    char psShow[9];
+    uint8_t psSeen; //!< Bit per position shown at least once
+
+    char rtCand[64];
+    uint8_t rtConf[64];
+    char rtChars[64];
+    uint64_t rtSeen;
+    char rtShow[65];
+    uint8_t rtMax;  //!< 64 (2A) or 32 (2B)
+    int8_t rtFlag;  //!< A/B text flag, -1 before the first RadioText group
+
+    bool ctValid;
+    uint32_t ctMjd;
+    uint8_t ctHour, ctMinute;
+    int8_t ctOffset; //!< Local time offset in half hours
+
+    uint16_t af[RDS_AF_MAX]; //!< Confirmed frequencies first, then the ones received once
+    uint8_t afHits[RDS_AF_MAX];
+    uint8_t afCount;         //!< Confirmed
+    uint8_t afUsed;
+    uint8_t afNext;          //!< Unconfirmed entry to replace when the list is full
+
+    int8_t rtPlusGroup; //!< Group type code (type * 2 + version) carrying RT+, -1 if not announced
+    int8_t rtPlusToggle;
+    bool rtPlusRunning;
+    rds_rtplus_tag rtPlus[2];
+
+    uint8_t changes;
+    rds_stat stat;
+};
+
+#endif
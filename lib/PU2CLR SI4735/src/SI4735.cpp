@@ -301,6 +301,7 @@ void SI4735::setDeviceOtherI2CAddress(uint8_t i2cAddr)
  */
 void SI4735::reset()
 {
+    loadedPatch = NULL;
     pinMode(resetPin, OUTPUT);
     delay(10);
     digitalWrite(resetPin, LOW);
@@ -467,6 +468,7 @@ void SI4735::powerDown(void)
     Wire.write(POWER_DOWN);
     Wire.endTransmission();
     delayMicroseconds(2500);
+    loadedPatch = NULL; // the patch RAM does not survive the power down
 }
 
 /**
@@ -686,6 +688,28 @@ void SI4735::setTuneFrequencyAntennaCapacitor(uint16_t capacitor)
  * @param uint16_t  freq is the frequency to change. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
  */
 void SI4735::setFrequency(uint16_t freq)
+{
+    startTune(freq);
+    waitToSend();                // Wait for the si473x is ready.
+    delay(maxDelaySetFrequency); // For some reason I need to delay here.
+}
+
+/**
+ * @ingroup   group08 Tune Frequency
+ *
+ * @brief Starts tuning to a frequency and returns without waiting for the tune to complete.
+ *
+ * @details Sends the same command as setFrequency(), without the fixed maxDelaySetFrequency wait.
+ * @details Poll isTuneComplete() until it returns true, then getStatus(1, 0) acknowledges the tune and
+ * @details gives RSSI, SNR and the valid flag of the new channel (getReceivedSignalStrengthIndicator(),
+ * @details getStatusSNR(), getStatusValid()). Useful where the tune time is most of the work, like a band scan.
+ *
+ * @see isTuneComplete()
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); pages 70, 135
+ *
+ * @param uint16_t  freq is the frequency to change. For example, FM => 10390 = 103.9 MHz; AM => 810 = 810 kHz.
+ */
+void SI4735::startTune(uint16_t freq)
 {
     waitToSend(); // Wait for the si473x is ready.
     currentFrequency.value = freq;
@@ -711,9 +735,24 @@ void SI4735::setFrequency(uint16_t freq)
         Wire.write(currentFrequencyParams.arg.ANTCAPL);
 
     Wire.endTransmission();
-    waitToSend();                // Wait for the si473x is ready.
     currentWorkFrequency = freq; // check it
-    delay(maxDelaySetFrequency); // For some reason I need to delay here.
+}
+
+/**
+ * @ingroup   group08 Tune Frequency
+ *
+ * @brief Checks whether the tune started by startTune() or setFrequency() is complete.
+ *
+ * @details Reads the status byte (GET_INT_STATUS). The STCINT bit stays set until getStatus(1, 0) clears it.
+ *
+ * @see startTune()
+ * @see Si47XX PROGRAMMING GUIDE; AN332 (REV 1.0); page 135
+ *
+ * @return true if the Seek/Tune Complete interrupt was triggered
+ */
+bool SI4735::isTuneComplete()
+{
+    return getInterruptStatus().refined.STCINT;
 }
 
 /**
@@ -2622,6 +2661,59 @@ bool SI4735::getRdsDateTime(uint16_t *rYear, uint16_t *rMonth, uint16_t *rDay, u
     return false;
 }
 
+/**
+ * @ingroup group16 RDS
+ * @brief   Hands every group waiting in the RDS FIFO to an RdsDecoder
+ * @details getRdsText0A(), getRdsText2A() etc. only look at the group of the last getRdsStatus() call,
+ * @details groups received in between are lost. This method empties the FIFO (up to 25 groups on the SI473X)
+ * @details so the decoder sees all of them, with the block error levels. Call it often, e.g. on every loop:
+ * @details at 11.4 groups per second the FIFO lasts about two seconds.
+ * @details The decoder is reset when the frequency changed since the last call.
+ * @code
+ *      RdsDecoder rds;
+ *      .
+ *      .
+ *      if (si4735.getRdsGroups(rds) && (rds.getChanges() & RDS_CHANGED_PS))
+ *          Serial.println(rds.getPS());
+ * @endcode
+ * @param decoder  the decoder that keeps the station data
+ * @return the number of groups read
+ * @see RdsDecoder
+ */
+uint8_t SI4735::getRdsGroups(RdsDecoder &decoder)
+{
+    uint16_t blocks[4];
+    uint8_t errors[4];
+    uint8_t n = 0;
+
+    if (currentTune != FM_TUNE_FREQ)
+        return 0;
+
+    if (decoder.getFrequency() != currentWorkFrequency)
+        decoder.reset(currentWorkFrequency);
+
+    // a bound in case the FIFO fills up as fast as it is read
+    while (n < 32)
+    {
+        getRdsStatus(1, 0, 0);
+        if (currentRdsStatus.resp.GRPLOST)
+            decoder.addLost();
+        if (currentRdsStatus.resp.RDSFIFOUSED == 0)
+            break;
+        blocks[0] = currentRdsStatus.resp.BLOCKAH << 8 | currentRdsStatus.resp.BLOCKAL;
+        blocks[1] = currentRdsStatus.resp.BLOCKBH << 8 | currentRdsStatus.resp.BLOCKBL;
+        blocks[2] = currentRdsStatus.resp.BLOCKCH << 8 | currentRdsStatus.resp.BLOCKCL;
+        blocks[3] = currentRdsStatus.resp.BLOCKDH << 8 | currentRdsStatus.resp.BLOCKDL;
+        errors[0] = currentRdsStatus.resp.BLEA;
+        errors[1] = currentRdsStatus.resp.BLEB;
+        errors[2] = currentRdsStatus.resp.BLEC;
+        errors[3] = currentRdsStatus.resp.BLED;
+        decoder.processGroup(blocks, errors);
+        n++;
+    }
+    return n;
+}
+
 /**
  * @ingroup group16 RDS Time and Date
  * @brief Gets the RDS the Time and Date when the Group type is 4 
@@ -3305,34 +3397,36 @@ bool SI4735::downloadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_
  */
 bool SI4735::downloadCompressedPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, const uint16_t *cmd_0x15, const int16_t cmd_0x15_size)
 {
-    uint8_t cmd, content;
+    uint8_t line[8];
     uint16_t command_line = 0;
+    // cmd_0x15 is in ascending order, next_0x15 is the next line in it
+    uint16_t idx_0x15 = 0;
+    uint16_t n_0x15 = cmd_0x15_size / sizeof(uint16_t);
+    uint16_t next_0x15 = (n_0x15 > 0) ? pgm_read_word_near(cmd_0x15) : 0xFFFF;
     // Send patch to the SI4735 device
     for (uint16_t offset = 0; offset < ssb_patch_content_size; offset += 7)
     {
-        // Checks if the current line starts with 0x15
-        cmd = 0x16;
-        for (uint16_t i = 0; i < cmd_0x15_size / sizeof(uint16_t); i++)
+        line[0] = 0x16;
+        if (command_line == next_0x15)
         {
-            if (pgm_read_word_near(cmd_0x15 + i) == command_line)
-            { // it needs performance improvement: save the last "i" value to be used next time
-                cmd = 0x15;
-                break;
-            }
+            line[0] = 0x15;
+            idx_0x15++;
+            next_0x15 = (idx_0x15 < n_0x15) ? pgm_read_word_near(cmd_0x15 + idx_0x15) : 0xFFFF;
         }
-        Wire.beginTransmission(deviceAddress);
-        Wire.write(cmd);
         for (uint16_t i = 0; i < 7; i++)
-        {
-            content = pgm_read_byte_near(ssb_patch_content + (i + offset));
-            Wire.write(content);
-        }
+            line[i + 1] = pgm_read_byte_near(ssb_patch_content + (i + offset));
+        // one transaction per line, it is one command for the device
+        Wire.beginTransmission(deviceAddress);
+        Wire.write(line, 8);
         Wire.endTransmission();
         delayMicroseconds(MIN_DELAY_WAIT_SEND_LOOP); // Need check the minimum value
         command_line++;
     }
     delayMicroseconds(250);
-    return true;
+    // the status after the last line tells if the device refused any of them
+    waitToSend();
+    Wire.requestFrom(deviceAddress, 1);
+    return !(Wire.read() & 0x40);
 }
 
 /**
@@ -3389,6 +3483,51 @@ void SI4735::loadCompressedPatch(const uint8_t *ssb_patch_content, const uint16_
     delay(25);
 }
 
+/**
+ * @ingroup group17 Patch and SSB support
+ * @brief Loads a compressed patch, unless it is still in the device RAM
+ * @details The patch stays in the device until a power down or a reset, so switching between LSB and USB,
+ * @details SSB bands or bandwidths does not need another upload. Switching to AM or FM powers the device down.
+ * @details The upload runs at the bus clock of setPatchI2CClock() (400kHz by default) and goes back to the
+ * @details clock of the setI2C* methods. getPatchLoadTime() tells how long it took.
+ * @code
+ *   #include <patch_ssb_compressed.h>
+ *   const si4735_compressed_patch ssbPatch = {ssb_patch_content, sizeof ssb_patch_content, cmd_0x15, sizeof cmd_0x15};
+ *
+ *   void loadSSB()
+ *   {
+ *     rx.loadPatch(&ssbPatch, bandwidthSSB[bwIdxSSB].idx);
+ *     rx.setSSB(...);
+ *   }
+ * @endcode
+ * @param patch         the patch, kept by its address
+ * @param ssb_audiobw   SSB Audio bandwidth; 0 = 1.2kHz (default); 1=2.2kHz; 2=3kHz; 3=4kHz; 4=500Hz; 5=1kHz.
+ * @return false if the device refused the patch
+ * @see isPatchLoaded, getPatchLoadTime, setPatchI2CClock
+ */
+bool SI4735::loadPatch(const si4735_compressed_patch *patch, uint8_t ssb_audiobw)
+{
+    if (loadedPatch != patch)
+    {
+        uint32_t start = micros();
+        bool ok;
+
+        Wire.setClock(patchI2CClock);
+        queryLibraryId();
+        patchPowerUp();
+        delay(50);
+        ok = downloadCompressedPatch(patch->content, patch->size, patch->cmd_0x15, patch->cmd_0x15_size);
+        Wire.setClock(currentI2CClock);
+        patchLoadTime = micros() - start;
+        if (!ok)
+            return false;
+        loadedPatch = patch;
+    }
+    setSSBConfig(ssb_audiobw, 1, 0, 0, 0, 1);
+    delay(25);
+    return true;
+}
+
 /**
  * @ingroup group17 Patch and SSB support
  * @brief Transfers the content of a patch stored in an eeprom to the SI4735 device.
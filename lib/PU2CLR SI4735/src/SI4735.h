@@ -22,6 +22,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "RdsDecoder.h"
 
 #define POWER_UP_FM 0  // FM
 #define POWER_UP_AM 1  // AM and SSB (if patch applyed)
@@ -1033,6 +1034,28 @@ typedef union
     uint8_t raw[32];
 } si4735_eeprom_patch_header;
 
+/**
+ * @ingroup group01
+ *
+ * @brief A patch stored in the compressed format of patch_ssb_compressed.h
+ * @details Each patch line is 8 bytes, the first one the command 0x15 or 0x16. Only the other 7 bytes are
+ * @details stored, plus the numbers of the lines starting with 0x15. The patch content is encrypted, a general
+ * @details purpose compressor (LZ, deflate) takes less than 2% off it; dropping the command bytes takes 11%.
+ * @details Declare it const next to the arrays, loadPatch() knows it by its address.
+ * @code
+ *   #include <patch_ssb_compressed.h>
+ *   const si4735_compressed_patch ssbPatch = {ssb_patch_content, sizeof ssb_patch_content, cmd_0x15, sizeof cmd_0x15};
+ * @endcode
+ * @see SI4735::loadPatch(const si4735_compressed_patch *patch, uint8_t ssb_audiobw)
+ */
+typedef struct
+{
+    const uint8_t *content;   //!< 7 bytes per line (PROGMEM)
+    uint16_t size;            //!< content size in bytes
+    const uint16_t *cmd_0x15; //!< Lines starting with 0x15, ascending (PROGMEM)
+    uint16_t cmd_0x15_size;   //!< cmd_0x15 size in bytes
+} si4735_compressed_patch;
+
 /**
  * @ingroup group01
  *
@@ -1123,6 +1146,11 @@ protected:
     uint8_t currentSsbStatus;
     int8_t audioMuteMcuPin = -1;
 
+    const si4735_compressed_patch *loadedPatch = NULL; //!< Patch in the device RAM, NULL after power down or reset
+    uint32_t patchLoadTime = 0;                        //!< Last patch upload (in us)
+    long currentI2CClock = 100000;                     //!< Bus clock set by the setI2C* methods
+    long patchI2CClock = 400000;                       //!< Bus clock of the patch upload
+
     void waitInterrupr(void);
     si47x_status getInterruptStatus();
 
@@ -1221,6 +1249,8 @@ public:
     void powerDown(void);
 
     void setFrequency(uint16_t);
+    void startTune(uint16_t);
+    bool isTuneComplete();
 
     void getStatus(uint8_t, uint8_t);
 
@@ -2638,6 +2668,7 @@ public:
     char *getRdsTime(void);
     char *getRdsDateTime(void);
     bool getRdsDateTime(uint16_t *year, uint16_t *month, uint16_t *day, uint16_t *hour, uint16_t *minute);
+    uint8_t getRdsGroups(RdsDecoder &decoder);
 
     void getNext2Block(char *);
     void getNext4Block(char *);
@@ -2674,6 +2705,32 @@ public:
     bool downloadCompressedPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, const uint16_t *cmd_0x15, const int16_t cmd_0x15_size);
     void loadPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, uint8_t ssb_audiobw = 1);
     void loadCompressedPatch(const uint8_t *ssb_patch_content, const uint16_t ssb_patch_content_size, const uint16_t *cmd_0x15, const int16_t cmd_0x15_size, uint8_t ssb_audiobw = 1);
+    bool loadPatch(const si4735_compressed_patch *patch, uint8_t ssb_audiobw = 1);
+
+    /**
+     * @ingroup group17 Patch and SSB support
+     * @brief Checks if a patch is in the device RAM
+     * @details The patch is lost on power down (setAM(), setFM() from another mode) and reset.
+     * @see loadPatch(const si4735_compressed_patch *patch, uint8_t ssb_audiobw)
+     * @param patch the patch given to loadPatch()
+     */
+    inline bool isPatchLoaded(const si4735_compressed_patch *patch) { return loadedPatch == patch; };
+
+    /**
+     * @ingroup group17 Patch and SSB support
+     * @brief Time of the last patch upload of loadPatch(const si4735_compressed_patch *patch, uint8_t ssb_audiobw)
+     * @details From the library id query to the last patch line, in microseconds. Not updated when the patch was already loaded.
+     */
+    inline uint32_t getPatchLoadTime() { return patchLoadTime; };
+
+    /**
+     * @ingroup group17 Patch and SSB support
+     * @brief Sets the I2C bus clock used to upload a patch
+     * @details The default is 400kHz, the fastest bus clock of the Si47XX data sheet. The bus goes back to the
+     * @details clock set by the setI2C* methods afterwards.
+     * @param value in Hz
+     */
+    inline void setPatchI2CClock(long value) { patchI2CClock = value; };
     si4735_eeprom_patch_header downloadPatchFromEeprom(int eeprom_i2c_address);
     void ssbPowerUp();
 
@@ -2781,6 +2838,7 @@ public:
      */
     inline void setI2CLowSpeedMode(void)
     {
+        currentI2CClock = 10000;
         Wire.setClock(10000);
     };
 
@@ -2789,7 +2847,11 @@ public:
      *
      * @brief Sets I2C bus to 100kHz
      */
-    inline void setI2CStandardMode(void) { Wire.setClock(100000); };
+    inline void setI2CStandardMode(void)
+    {
+        currentI2CClock = 100000;
+        Wire.setClock(100000);
+    };
 
     /**
      * @ingroup group18 MCU I2C Speed
@@ -2798,6 +2860,7 @@ public:
      */
     inline void setI2CFastMode(void)
     {
+        currentI2CClock = 400000;
         Wire.setClock(400000);
     };
 
@@ -2809,7 +2872,11 @@ public:
      *
      * @param value in Hz. For example: The values 500000 sets the bus to 500kHz.
      */
-    inline void setI2CFastModeCustom(long value = 500000) { Wire.setClock(value); };
+    inline void setI2CFastModeCustom(long value = 500000)
+    {
+        currentI2CClock = value;
+        Wire.setClock(value);
+    };
 
     /**
      * @ingroup group18 MCU External Audio Mute
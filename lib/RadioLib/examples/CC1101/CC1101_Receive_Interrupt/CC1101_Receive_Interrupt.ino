@@ -112,6 +112,14 @@ void loop() {
       int state = radio.readData(byteArr, 8);
     */
 
+    // or into your own buffer together with RSSI and LQI,
+    // this does not allocate any memory
+    /*
+      byte buff[64];
+      RadioLibPacket packet = { buff, sizeof(buff) };
+      int state = radio.readData(packet);
+    */
+
     if (state == RADIOLIB_ERR_NONE) {
       // packet was successfully received
       Serial.println(F("[CC1101] Received packet!"));
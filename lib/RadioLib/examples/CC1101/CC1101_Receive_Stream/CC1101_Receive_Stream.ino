@@ -0,0 +1,124 @@
+/*
+   RadioLib CC1101 Receive Stream Example
+
+   This example receives packets longer than the 64 byte FIFO,
+   sent by the Transmit Stream example, using CC1101 FSK radio
+   module. GDO0 interrupt drains the FIFO and GDO2 interrupt
+   signals the end of the packet.
+
+   Both GDO0 and GDO2 have to be connected. The FIFO has to be
+   drained within 32 bytes on air, at high bit rates keep
+   the loop() free of anything slow while streaming.
+
+   For default module settings, see the wiki page
+   https://github.com/jgromes/RadioLib/wiki/Default-configuration#cc1101
+
+   For full API reference, see the GitHub Pages
+   https://jgromes.github.io/RadioLib/
+*/
+
+// include the library
+#include <RadioLib.h>
+
+// CC1101 has the following connections:
+// CS pin:    10
+// GDO0 pin:  2
+// RST pin:   unused
+// GDO2 pin:  3
+CC1101 radio = new Module(10, 2, RADIOLIB_NC, 3);
+
+// or using RadioShield
+// https://github.com/jgromes/RadioShield
+//CC1101 radio = RadioShield.ModuleA;
+
+// received data, longer packets are dropped
+byte packet[1024];
+
+void setup() {
+  Serial.begin(9600);
+
+  // initialize CC1101 with default settings
+  Serial.print(F("[CC1101] Initializing ... "));
+  int state = radio.begin();
+  if (state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true);
+  }
+
+  // set the functions that will be called
+  // when the FIFO fills up and when the packet ends
+  radio.setGdo0Action(setFlag, RISING);
+  radio.setGdo2Action(setFlag, RISING);
+
+  // start listening for packets
+  Serial.print(F("[CC1101] Starting to listen ... "));
+  state = radio.startReceiveStream(packet, sizeof(packet));
+  if (state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true);
+  }
+}
+
+// flag to indicate that the radio needs attention
+volatile bool streamFlag = false;
+
+// this function is called when the Rx FIFO
+// fills up or the packet has been received
+// IMPORTANT: this function MUST be 'void' type
+//            and MUST NOT have any arguments!
+void setFlag(void) {
+  streamFlag = true;
+}
+
+void loop() {
+  // check if the radio needs attention
+  if(!streamFlag) {
+    return;
+  }
+
+  // reset flag
+  streamFlag = false;
+
+  // drain the FIFO, or finish the packet
+  int state = radio.streamService();
+  if(radio.isStreaming()) {
+    return;
+  }
+
+  if (state == RADIOLIB_ERR_NONE) {
+    // packet was successfully received
+    Serial.print(F("[CC1101] Received packet of "));
+    Serial.print(radio.getStreamLength());
+    Serial.println(F(" bytes"));
+
+    // print RSSI (Received Signal Strength Indicator)
+    // of the last received packet
+    Serial.print(F("[CC1101] RSSI:\t\t"));
+    Serial.print(radio.getRSSI());
+    Serial.println(F(" dBm"));
+
+    // print LQI (Link Quality Indicator)
+    // of the last received packet, lower is better
+    Serial.print(F("[CC1101] LQI:\t\t"));
+    Serial.println(radio.getLQI());
+
+  } else if (state == RADIOLIB_ERR_CRC_MISMATCH) {
+    // packet was received, but is malformed
+    Serial.println(F("CRC error!"));
+
+  } else {
+    // some other error occurred
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+
+  }
+
+  // put module back to listen mode
+  radio.startReceiveStream(packet, sizeof(packet));
+}
@@ -0,0 +1,116 @@
+/*
+   RadioLib CC1101 Transmit Stream Example
+
+   This example transmits packets longer than the 64 byte FIFO
+   using CC1101 FSK radio module. The packet is sent in infinite
+   length mode, GDO0 interrupt refills the FIFO and GDO2 interrupt
+   signals the end of the packet. Each packet can contain
+   64 to 65535 bytes of binary data.
+
+   Both GDO0 and GDO2 have to be connected. The FIFO has to be
+   refilled within 33 bytes on air, at high bit rates keep
+   the loop() free of anything slow while streaming.
+
+   For default module settings, see the wiki page
+   https://github.com/jgromes/RadioLib/wiki/Default-configuration#cc1101
+
+   For full API reference, see the GitHub Pages
+   https://jgromes.github.io/RadioLib/
+*/
+
+// include the library
+#include <RadioLib.h>
+
+// CC1101 has the following connections:
+// CS pin:    10
+// GDO0 pin:  2
+// RST pin:   unused
+// GDO2 pin:  3
+CC1101 radio = new Module(10, 2, RADIOLIB_NC, 3);
+
+// or using RadioShield
+// https://github.com/jgromes/RadioShield
+//CC1101 radio = RadioShield.ModuleA;
+
+// the packet, it must stay valid until the stream has finished
+byte packet[1024];
+
+void setup() {
+  Serial.begin(9600);
+
+  // initialize CC1101 with default settings
+  Serial.print(F("[CC1101] Initializing ... "));
+  int state = radio.begin();
+  if (state == RADIOLIB_ERR_NONE) {
+    Serial.println(F("success!"));
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+    while (true);
+  }
+
+  // set the functions that will be called
+  // when the FIFO needs data and when the packet is sent
+  radio.setGdo0Action(setFlag, RISING);
+  radio.setGdo2Action(setFlag, RISING);
+
+  for(size_t i = 0; i < sizeof(packet); i++) {
+    packet[i] = i & 0xFF;
+  }
+
+  // start transmitting the first packet
+  Serial.print(F("[CC1101] Sending first packet ... "));
+  state = radio.startTransmitStream(packet, sizeof(packet));
+  if (state != RADIOLIB_ERR_NONE) {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+  }
+}
+
+// flag to indicate that the radio needs attention
+volatile bool streamFlag = false;
+
+// this function is called when the Tx FIFO
+// runs low or the packet has been sent
+// IMPORTANT: this function MUST be 'void' type
+//            and MUST NOT have any arguments!
+void setFlag(void) {
+  streamFlag = true;
+}
+
+void loop() {
+  // check if the radio needs attention
+  if(!streamFlag) {
+    return;
+  }
+
+  // reset flag
+  streamFlag = false;
+
+  // refill the FIFO, or finish the packet
+  int state = radio.streamService();
+  if(radio.isStreaming()) {
+    return;
+  }
+
+  if (state == RADIOLIB_ERR_NONE) {
+    // packet was successfully sent
+    Serial.println(F("transmission finished!"));
+
+  } else {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+
+  }
+
+  // wait a second before transmitting again
+  delay(1000);
+
+  // send another one
+  Serial.print(F("[CC1101] Sending another packet ... "));
+  state = radio.startTransmitStream(packet, sizeof(packet));
+  if (state != RADIOLIB_ERR_NONE) {
+    Serial.print(F("failed, code "));
+    Serial.println(state);
+  }
+}
@@ -0,0 +1,253 @@
+/*
+  afsk_bench.cpp
+
+  Host benchmark of the AFSK modem, not an Arduino sketch. RadioLib is built against the Arduino.h /
+  SPI.h of PacketBench. Without arguments, APRS frames are rendered by PCMLayer (the same code that
+  feeds the speaker), mixed with noise and decoded by AFSKReceiver. With a WAV file (16-bit PCM, the
+  first channel is used), the recording is decoded instead.
+
+    g++ -O2 -DARDUINO=100 -I../PacketBench -I../../src afsk_bench.cpp ../../src/Module.cpp \
+      ../../src/protocols/PhysicalLayer/PhysicalLayer.cpp ../../src/protocols/AFSK/AFSK.cpp \
+      ../../src/protocols/AX25/AX25.cpp ../../src/protocols/APRS/APRS.cpp ../../src/protocols/PCM/PCM.cpp \
+      ../../src/protocols/AFSKReceiver/AFSKReceiver.cpp -o afsk_bench
+
+    ./afsk_bench [-r sample rate] [-n frames] [-s SNR dB] [-o rendered.wav] [recording.wav]
+
+  Decoding time is CPU time of this process, reported as frames per CPU second and as how many times
+  faster than real time the audio is decoded.
+*/
+#include "protocols/APRS/APRS.h"
+#include "protocols/PCM/PCM.h"
+#include "protocols/AFSKReceiver/AFSKReceiver.h"
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+
+static const size_t BLOCK = 256; // samples per call, like one I2S block
+static const int PASSES = 5;
+
+static std::vector<int16_t> audio;
+static uint32_t decoded = 0;
+static bool verbose = false;
+
+// Arduino API of the host, only the module of PCMLayer uses it and it replaces the timing
+SPIClass SPI;
+void SPIClass::begin() {}
+void SPIClass::end() {}
+void SPIClass::beginTransaction(SPISettings) {}
+uint8_t SPIClass::transfer(uint8_t b) { return(b); }
+void SPIClass::endTransaction() {}
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return(LOW); }
+void tone(uint8_t, unsigned int, unsigned long) {}
+void noTone(uint8_t) {}
+void attachInterrupt(uint8_t, void (*)(void), int) {}
+void detachInterrupt(uint8_t) {}
+void yield(void) {}
+void delay(unsigned long) {}
+void delayMicroseconds(unsigned int) {}
+unsigned long millis(void) { return(0); }
+unsigned long micros(void) { return(0); }
+
+static void sink(const int16_t* samples, size_t len) {
+  audio.insert(audio.end(), samples, samples + len);
+}
+
+// prints "SRC>DST:info" of a UI frame
+static void frameReceived(const uint8_t* frame, size_t len) {
+  decoded++;
+  if(!verbose) {
+    return;
+  }
+  char call[2][10];
+  for(int a = 0; a < 2; a++) {
+    int n = 0;
+    for(int i = 0; i < 6; i++) {
+      char c = frame[7*a + i] >> 1;
+      if(c != ' ') {
+        call[a][n++] = c;
+      }
+    }
+    uint8_t ssid = (frame[7*a + 6] >> 1) & 0x0F;
+    if(ssid) {
+      n += sprintf(&call[a][n], "-%d", ssid);
+    }
+    call[a][n] = 0;
+  }
+  // skip the repeaters, control and PID
+  size_t pos = 14;
+  while((pos < len) && !(frame[pos - 1] & 0x01)) {
+    pos += 7;
+  }
+  pos += 2;
+  printf("  %s>%s:%.*s\n", call[1], call[0], (int)(pos < len ? len - pos : 0), &frame[pos < len ? pos : len]);
+}
+
+static uint32_t noiseState = 12345;
+static float gauss() {
+  // sum of uniforms, close enough to normal for a benchmark
+  float s = 0;
+  for(int i = 0; i < 12; i++) {
+    noiseState = noiseState * 1664525UL + 1013904223UL;
+    s += (float)(noiseState >> 8) / 16777216.0f;
+  }
+  return(s - 6.0f);
+}
+
+static double cpuSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return(ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static bool readWav(const char* path, uint32_t& rate) {
+  FILE* f = fopen(path, "rb");
+  if(!f) {
+    return(false);
+  }
+  uint8_t hdr[12];
+  if((fread(hdr, 1, 12, f) != 12) || memcmp(hdr, "RIFF", 4) || memcmp(&hdr[8], "WAVE", 4)) {
+    fclose(f);
+    return(false);
+  }
+  uint16_t channels = 0, bits = 0;
+  uint8_t chunk[8];
+  while(fread(chunk, 1, 8, f) == 8) {
+    uint32_t size = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+    if(!memcmp(chunk, "fmt ", 4)) {
+      uint8_t fmt[16];
+      if((size < 16) || (fread(fmt, 1, 16, f) != 16)) {
+        break;
+      }
+      channels = fmt[2] | (fmt[3] << 8);
+      rate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16) | ((uint32_t)fmt[7] << 24);
+      bits = fmt[14] | (fmt[15] << 8);
+      fseek(f, size - 16 + (size & 1), SEEK_CUR);
+    } else if(!memcmp(chunk, "data", 4) && (bits == 16) && (channels > 0)) {
+      std::vector<int16_t> raw(size / 2);
+      size_t n = fread(raw.data(), 2, raw.size(), f);
+      for(size_t i = 0; i + channels <= n; i += channels) {
+        audio.push_back(raw[i]);
+      }
+      fclose(f);
+      return(true);
+    } else {
+      fseek(f, size + (size & 1), SEEK_CUR);
+    }
+  }
+  fclose(f);
+  return(false);
+}
+
+static void put32(FILE* f, uint32_t v) { uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)}; fwrite(b, 1, 4, f); }
+static void put16(FILE* f, uint16_t v) { uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)}; fwrite(b, 1, 2, f); }
+
+static void writeWav(const char* path, uint32_t rate) {
+  FILE* f = fopen(path, "wb");
+  if(!f) {
+    return;
+  }
+  fwrite("RIFF", 1, 4, f); put32(f, 36 + audio.size() * 2); fwrite("WAVEfmt ", 1, 8, f);
+  put32(f, 16); put16(f, 1); put16(f, 1); put32(f, rate); put32(f, rate * 2); put16(f, 2); put16(f, 16);
+  fwrite("data", 1, 4, f); put32(f, audio.size() * 2);
+  fwrite(audio.data(), 2, audio.size(), f);
+  fclose(f);
+}
+
+int main(int argc, char** argv) {
+  uint32_t rate = 16000;
+  int frames = 100;
+  float snr = 20;
+  const char* in = NULL;
+  const char* out = NULL;
+  for(int i = 1; i < argc; i++) {
+    if(!strcmp(argv[i], "-r") && (i + 1 < argc)) {
+      rate = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+      frames = atoi(argv[++i]);
+    } else if(!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+      snr = atof(argv[++i]);
+    } else if(!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+      out = argv[++i];
+    } else if(!strcmp(argv[i], "-v")) {
+      verbose = true;
+    } else {
+      in = argv[i];
+    }
+  }
+
+  int sent = 0;
+  if(in) {
+    if(!readWav(in, rate)) {
+      printf("%s: not a 16-bit PCM WAV file\n", in);
+      return(1);
+    }
+    printf("%s: %.1f s at %u Hz\n", in, (double)audio.size() / rate, rate);
+  } else {
+    PCMLayer pcm(rate, sink);
+    PCMClient afsk(&pcm);
+    AX25Client ax25(&afsk);
+    APRSClient aprs(&ax25);
+    int16_t state = pcm.begin(8000);
+    state |= ax25.begin("N0CALL", 7);
+    state |= aprs.begin('>');
+    if(state != RADIOLIB_ERR_NONE) {
+      printf("begin failed, code %d\n", state);
+      return(1);
+    }
+
+    double t0 = cpuSeconds();
+    for(sent = 0; sent < frames; sent++) {
+      char lat[] = "4911.67N";
+      char lon[] = "01635.96E";
+      char msg[64];
+      snprintf(msg, sizeof(msg), "AFSK bench frame %d, a comment of some length", sent);
+      lat[3] = '0' + sent % 10;
+      aprs.sendPosition((char*)"APRS", 0, lat, lon, msg);
+      pcm.silence(200000);
+    }
+    pcm.flush();
+    double t = cpuSeconds() - t0;
+    printf("rendered %d frames, %.1f s of audio at %u Hz in %.3f CPU s (%.0fx real time)\n",
+           frames, (double)audio.size() / rate, rate, t, (double)audio.size() / rate / t);
+    if(out) {
+      writeWav(out, rate);
+    }
+
+    // white noise for the requested tone to noise ratio, over the whole band
+    float noise = 8000.0f / sqrtf(2.0f) / powf(10.0f, snr / 20.0f);
+    for(size_t i = 0; i < audio.size(); i++) {
+      float s = audio[i] + noise * gauss();
+      audio[i] = (int16_t)(s > 32767 ? 32767 : (s < -32768 ? -32768 : s));
+    }
+  }
+
+  AFSKReceiver rx(rate);
+  rx.setFrameAction(frameReceived);
+  double t = 0;
+  for(int p = 0; p < PASSES; p++) {
+    if(rx.begin() != RADIOLIB_ERR_NONE) {
+      printf("receiver does not support %u Hz\n", rate);
+      return(1);
+    }
+    decoded = 0;
+    verbose = verbose && (p == 0);
+    double t0 = cpuSeconds();
+    for(size_t i = 0; i < audio.size(); i += BLOCK) {
+      rx.process(&audio[i], (audio.size() - i < BLOCK) ? (audio.size() - i) : BLOCK);
+    }
+    t += cpuSeconds() - t0;
+  }
+  t /= PASSES;
+
+  double seconds = (double)audio.size() / rate;
+  printf("decoded %u frames", rx.getFrames());
+  if(!in) {
+    printf(" of %d at %.0f dB SNR", sent, snr);
+  }
+  printf(", %u FCS errors\n", rx.getErrors());
+  printf("%.4f CPU s for %.1f s of audio: %.0f frames per CPU second, %.0fx real time, %.1f ns per sample\n",
+         t, seconds, rx.getFrames() / t, seconds / t, t * 1e9 / audio.size());
+  return((!in && ((int)rx.getFrames() != sent)) ? 1 : 0);
+}
@@ -0,0 +1,76 @@
+// Minimal Arduino API for building RadioLib on a host, see packet_bench.cpp.
+// Only what Module, PhysicalLayer and CC1101 use is declared, the functions are
+// implemented by the bench.
+#if !defined(_PACKET_BENCH_ARDUINO_H)
+#define _PACKET_BENCH_ARDUINO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+
+#define LOW     0
+#define HIGH    1
+#define INPUT   0
+#define OUTPUT  1
+#define CHANGE  1
+#define FALLING 2
+#define RISING  3
+
+#define PROGMEM
+typedef const char* PGM_P;
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+class __FlashStringHelper;
+#define F(str) (reinterpret_cast<const __FlashStringHelper*>(str))
+#define digitalPinToInterrupt(p) (p)
+
+template <typename T> T min(T a, T b) { return(a < b ? a : b); }
+template <typename T> T max(T a, T b) { return(a > b ? a : b); }
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+void yield(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+unsigned long millis(void);
+unsigned long micros(void);
+
+// heap backed like the Arduino one: one allocation per non empty string
+class String {
+  public:
+    String(const char* str = "") { set(str, strlen(str)); }
+    String(const String& str) { set(str._buf, str._len); }
+    ~String() { delete[] _buf; }
+    String& operator=(const String& str) {
+      if(this != &str) {
+        delete[] _buf;
+        set(str._buf, str._len);
+      }
+      return(*this);
+    }
+    const char* c_str() const { return(_buf ? _buf : ""); }
+    size_t length() const { return(_len); }
+
+  private:
+    void set(const char* str, size_t len) {
+      _len = len;
+      _buf = NULL;
+      if(len) {
+        _buf = new char[len + 1];
+        memcpy(_buf, str, len + 1);
+      }
+    }
+    char* _buf;
+    size_t _len;
+};
+
+#endif
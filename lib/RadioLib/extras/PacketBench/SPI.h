@@ -0,0 +1,30 @@
+// Minimal Arduino SPI API for building RadioLib on a host, see packet_bench.cpp.
+#if !defined(_PACKET_BENCH_SPI_H)
+#define _PACKET_BENCH_SPI_H
+
+#include "Arduino.h"
+
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+class SPISettings {
+  public:
+    SPISettings(uint32_t clock = 2000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0) {
+      (void)clock;
+      (void)bitOrder;
+      (void)dataMode;
+    }
+};
+
+class SPIClass {
+  public:
+    void begin();
+    void end();
+    void beginTransaction(SPISettings settings);
+    uint8_t transfer(uint8_t b);
+    void endTransaction();
+};
+
+extern SPIClass SPI;
+
+#endif
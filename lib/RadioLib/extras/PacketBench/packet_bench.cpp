@@ -0,0 +1,290 @@
+/*
+  packet_bench.cpp
+
+  Host benchmark of the CC1101 packet path, not an Arduino sketch. RadioLib is built against the
+  Arduino.h / SPI.h in this directory, the SPI bus is wired to a fake CC1101 that keeps registers
+  and FIFOs in memory. Compares the String methods with the RadioLibPacket methods, counting heap
+  allocations per packet, and checks a packet read into a too short buffer and the end of a Tx
+  stream. Exits with 1 when a check fails.
+
+    g++ -O2 -DARDUINO=100 -I. -I../../src packet_bench.cpp ../../src/Module.cpp \
+      ../../src/protocols/PhysicalLayer/PhysicalLayer.cpp ../../src/modules/CC1101/CC1101.cpp \
+      -o packet_bench && ./packet_bench
+
+  Times are host times. They only show the CPU cost of the library on top of SPI, which on the
+  target is dominated by the bus itself (see SPI bytes per packet).
+*/
+#include "modules/CC1101/CC1101.h"
+#include <chrono>
+#include <new>
+#include <stdio.h>
+
+static const uint8_t PIN_CS = 10;
+static const uint8_t PIN_IRQ = 2;
+static const uint32_t PACKETS = 200000;
+static const uint8_t PAYLOAD_LEN = 24;
+
+// heap allocations since start
+static uint32_t allocs = 0;
+
+void* operator new(size_t size) {
+  allocs++;
+  void* p = malloc(size);
+  if(!p) {
+    throw std::bad_alloc();
+  }
+  return(p);
+}
+void* operator new[](size_t size) { return(operator new(size)); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// CC1101 SPI protocol: header byte (read, burst, address), then data bytes. Addresses 0x30 - 0x3D
+// are command strobes without the burst bit and status registers with it.
+class FakeCC1101 {
+  public:
+    uint32_t spiBytes = 0;
+    uint32_t txPackets = 0;
+
+    void select() {
+      _first = true;
+    }
+
+    uint8_t transfer(uint8_t b) {
+      spiBytes++;
+      if(_first) {
+        _first = false;
+        _read = b & 0x80;
+        _burst = b & 0x40;
+        _addr = b & 0x3F;
+        if((_addr >= 0x30) && (_addr <= 0x3D) && !_burst) {
+          strobe(_addr);
+        }
+        return(0x0F);
+      }
+
+      if(_addr == 0x3F) {
+        if(_read) {
+          return(rxPop());
+        }
+        _txCount++;
+        return(0x0F);
+      }
+      if(_addr == 0x3E) {
+        // PATABLE, only the first entry is used
+        if(!_read) {
+          _paTable = b;
+        }
+        return(_paTable);
+      }
+      if(_addr >= 0x30) {
+        switch(_addr) {
+          case 0x31: return(0x14); // VERSION
+          case 0x35: // MARCSTATE
+            if(_txEndReads) {
+              _txEndReads--;
+              return(0x14);
+            }
+            return(0x01);
+          case 0x3A: return(_txCount);
+          case 0x3B: return(_rxCount);
+          default: return(0);
+        }
+      }
+
+      uint8_t val = 0x0F;
+      if(_read) {
+        val = _reg[_addr];
+      } else {
+        _reg[_addr] = b;
+      }
+      if(_burst) {
+        _addr++;
+      }
+      return(val);
+    }
+
+    // what the radio puts into the Rx FIFO: length, payload, RSSI, LQI with CRC_OK
+    void receive(const uint8_t* data, uint8_t len) {
+      rxPush(len);
+      for(uint8_t i = 0; i < len; i++) {
+        rxPush(data[i]);
+      }
+      rxPush(0xE0);
+      rxPush(0x80 | 0x12);
+    }
+
+    uint8_t rxBytes() const {
+      return(_rxCount);
+    }
+
+    // the Tx FIFO has gone out, MARCSTATE reads TX_END for the next reads, then IDLE
+    void txDrained(uint8_t txEndReads) {
+      _txCount = 0;
+      _txEndReads = txEndReads;
+    }
+
+  private:
+    void strobe(uint8_t cmd) {
+      switch(cmd) {
+        case 0x30: // SRES
+          memset(_reg, 0, sizeof(_reg));
+          break;
+        case 0x35: // STX, the frame is out at once
+          txPackets++;
+          _txCount = 0;
+          break;
+        case 0x3A: // SFRX
+          _rxHead = _rxCount = 0;
+          break;
+        case 0x3B: // SFTX
+          _txCount = 0;
+          break;
+      }
+    }
+
+    void rxPush(uint8_t b) {
+      if(_rxCount < sizeof(_rx)) {
+        _rx[(_rxHead + _rxCount++) % sizeof(_rx)] = b;
+      }
+    }
+
+    uint8_t rxPop() {
+      if(_rxCount == 0) {
+        return(0);
+      }
+      uint8_t b = _rx[_rxHead];
+      _rxHead = (_rxHead + 1) % sizeof(_rx);
+      _rxCount--;
+      return(b);
+    }
+
+    uint8_t _reg[0x30] = {0};
+    uint8_t _rx[64];
+    uint8_t _rxHead = 0;
+    uint8_t _rxCount = 0;
+    uint8_t _txCount = 0;
+    uint8_t _paTable = 0;
+    uint8_t _txEndReads = 0;
+    bool _first = false;
+    bool _read = false;
+    bool _burst = false;
+    uint8_t _addr = 0;
+};
+
+static FakeCC1101 fake;
+static unsigned long fakeMicros = 0;
+
+// Arduino API of the host
+SPIClass SPI;
+void SPIClass::begin() {}
+void SPIClass::end() {}
+void SPIClass::beginTransaction(SPISettings) {}
+uint8_t SPIClass::transfer(uint8_t b) { return(fake.transfer(b)); }
+void SPIClass::endTransaction() {}
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if((pin == PIN_CS) && (value == LOW)) {
+    fake.select();
+  }
+}
+int digitalRead(uint8_t) { return(LOW); }
+void tone(uint8_t, unsigned int, unsigned long) {}
+void noTone(uint8_t) {}
+void attachInterrupt(uint8_t, void (*)(void), int) {}
+void detachInterrupt(uint8_t) {}
+void yield(void) {}
+void delay(unsigned long ms) { fakeMicros += ms * 1000; }
+void delayMicroseconds(unsigned int us) { fakeMicros += us; }
+unsigned long millis(void) { return(fakeMicros / 1000); }
+unsigned long micros(void) { return(fakeMicros++); }
+
+template <typename F> static void bench(const char* name, F&& fn) {
+  uint32_t a = allocs;
+  uint32_t spi = fake.spiBytes;
+  auto t0 = std::chrono::steady_clock::now();
+  bool ok = true;
+  for(uint32_t i = 0; i < PACKETS; i++) {
+    ok &= fn(i);
+  }
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+  printf("%-28s %7.1f ns/pkt  %5.2f allocs/pkt  %5.1f SPI bytes/pkt  %s\n", name, ns / PACKETS,
+         (double)(allocs - a) / PACKETS, (double)(fake.spiBytes - spi) / PACKETS, ok ? "ok" : "MISMATCH");
+}
+
+int main() {
+  Module mod(PIN_CS, PIN_IRQ, RADIOLIB_NC, RADIOLIB_NC, SPI);
+  CC1101 radio(&mod);
+  int16_t state = radio.begin();
+  if(state != RADIOLIB_ERR_NONE) {
+    printf("begin failed, code %d\n", state);
+    return(1);
+  }
+
+  uint8_t payload[PAYLOAD_LEN];
+  for(uint8_t i = 0; i < PAYLOAD_LEN; i++) {
+    payload[i] = 'A' + (i % 26);
+  }
+
+  bench("Rx readData(String&)", [&](uint32_t) {
+    fake.receive(payload, PAYLOAD_LEN);
+    String str;
+    int16_t st = radio.readData(str);
+    return((st == RADIOLIB_ERR_NONE) && (str.length() == PAYLOAD_LEN) && !memcmp(str.c_str(), payload, PAYLOAD_LEN));
+  });
+
+  uint8_t buff[RADIOLIB_CC1101_MAX_PACKET_LENGTH];
+  RadioLibPacket rx = { buff, sizeof(buff), 0, 0, 0, 0 };
+  bench("Rx readData(RadioLibPacket&)", [&](uint32_t) {
+    fake.receive(payload, PAYLOAD_LEN);
+    int16_t st = radio.readData(rx);
+    return((st == RADIOLIB_ERR_NONE) && (rx.len == PAYLOAD_LEN) && !memcmp(rx.data, payload, PAYLOAD_LEN) && (rx.lqi == 0x12));
+  });
+
+  // a packet longer than the buffer: cut, the rest must not be read as RSSI / LQI
+  uint8_t small[8];
+  RadioLibPacket cut = { small, sizeof(small), 0, 0, 0, 0 };
+  fake.receive(payload, PAYLOAD_LEN);
+  state = radio.readData(cut);
+  bool cutOk = (state == RADIOLIB_ERR_PACKET_TOO_LONG) && (cut.len == sizeof(small)) &&
+               !memcmp(small, payload, sizeof(small)) && (cut.rssi == 0) && (cut.lqi == 0) && (fake.rxBytes() == 0);
+  fake.receive(payload, PAYLOAD_LEN);
+  state = radio.readData(rx);
+  cutOk = cutOk && (state == RADIOLIB_ERR_NONE) && (rx.len == PAYLOAD_LEN) && (rx.lqi == 0x12);
+  printf("packet longer than the buffer: %s\n", cutOk ? "cut, FIFO flushed" : "WRONG");
+
+  // stream whose end of packet interrupt is served while the radio is still in TX_END
+  static uint8_t streamData[100];
+  state = radio.startTransmitStream(streamData, sizeof(streamData));
+  state |= radio.streamService();   // FIFO threshold: the rest of the payload
+  fake.txDrained(3);
+  state |= radio.streamService();   // end of packet, the last edge
+  bool streamOk = (state == RADIOLIB_ERR_NONE) && !radio.isStreaming();
+  printf("stream end served in TX_END: %s\n", streamOk ? "finished" : "STUCK");
+
+  uint32_t sent = fake.txPackets;
+  bench("Tx startTransmit(String&)", [&](uint32_t) {
+    // sketches typically build the String per packet
+    char text[PAYLOAD_LEN + 1];
+    memcpy(text, payload, PAYLOAD_LEN);
+    text[PAYLOAD_LEN] = 0;
+    String str(text);
+    return(radio.startTransmit(str) == RADIOLIB_ERR_NONE);
+  });
+
+  RadioLibPacket slots[8];
+  RadioLibPacketQueue queue(slots, 8);
+  bench("Tx startTransmit(queue)", [&](uint32_t i) {
+    // refill in batches, send one frame per "Tx done interrupt"
+    if((i % 8) == 0) {
+      while(queue.push(payload, PAYLOAD_LEN) == RADIOLIB_ERR_NONE);
+    }
+    return(radio.startTransmit(queue) == RADIOLIB_ERR_NONE);
+  });
+
+  bool txOk = (fake.txPackets - sent) == 2 * PACKETS;
+  printf("frames sent: %s\n", txOk ? "all" : "MISSING");
+  return((txOk && cutOk && streamOk) ? 0 : 1);
+}
@@ -107,6 +107,7 @@
   //#define RADIOLIB_EXCLUDE_MORSE
   //#define RADIOLIB_EXCLUDE_RTTY
   //#define RADIOLIB_EXCLUDE_SSTV
+  //#define RADIOLIB_EXCLUDE_PCM        // dependent on RADIOLIB_EXCLUDE_AFSK
 
 #else
   #if defined(__AVR__) && !(defined(ARDUINO_AVR_UNO_WIFI_REV2) || defined(ARDUINO_AVR_NANO_EVERY) || defined(ARDUINO_ARCH_MEGAAVR))
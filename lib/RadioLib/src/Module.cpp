@@ -35,10 +35,10 @@ Module::Module(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE rs
   setCb_millis(::millis);
   setCb_micros(::micros);
   setCb_SPIbegin(&Module::SPIbegin);
-  setCb_SPIbeginTransaction(&Module::beginTransaction);
-  setCb_SPItransfer(&Module::transfer);
-  setCb_SPIendTransaction(&Module::endTransaction);
-  setCb_SPIend(&Module::end);
+  setCb_SPIbeginTransaction(&Module::SPIbeginTransaction);
+  setCb_SPItransfer(&Module::SPItransfer);
+  setCb_SPIendTransaction(&Module::SPIendTransaction);
+  setCb_SPIend(&Module::SPIend);
 }
 
 Module::Module(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE rst, RADIOLIB_PIN_TYPE gpio, SPIClass& spi, SPISettings spiSettings):
@@ -69,10 +69,10 @@ Module::Module(RADIOLIB_PIN_TYPE cs, RADIOLIB_PIN_TYPE irq, RADIOLIB_PIN_TYPE rs
   setCb_millis(::millis);
   setCb_micros(::micros);
   setCb_SPIbegin(&Module::SPIbegin);
-  setCb_SPIbeginTransaction(&Module::beginTransaction);
-  setCb_SPItransfer(&Module::transfer);
-  setCb_SPIendTransaction(&Module::endTransaction);
-  setCb_SPIend(&Module::end);
+  setCb_SPIbeginTransaction(&Module::SPIbeginTransaction);
+  setCb_SPItransfer(&Module::SPItransfer);
+  setCb_SPIendTransaction(&Module::SPIendTransaction);
+  setCb_SPIend(&Module::SPIend);
 }
 #else
 
@@ -199,8 +199,8 @@ void Module::SPIwriteRegister(uint8_t reg, uint8_t data) {
 }
 
 void Module::SPItransfer(uint8_t cmd, uint8_t reg, uint8_t* dataOut, uint8_t* dataIn, uint8_t numBytes) {
-  // start SPI transaction
-  this->SPIbeginTransaction();
+  // start SPI transaction, through the override so a shared bus can be arbitrated
+  this->beginTransaction();
 
   // pull CS low
   this->digitalWrite(_cs, LOW);
@@ -242,7 +242,7 @@ void Module::SPItransfer(uint8_t cmd, uint8_t reg, uint8_t* dataOut, uint8_t* da
   this->digitalWrite(_cs, HIGH);
 
   // end SPI transaction
-  this->SPIendTransaction();
+  this->endTransaction();
 }
 
 void Module::pinMode(RADIOLIB_PIN_TYPE pin, RADIOLIB_PIN_MODE mode) {
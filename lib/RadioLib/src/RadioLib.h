@@ -91,6 +91,8 @@
 #include "protocols/SSTV/SSTV.h"
 #include "protocols/FSK4/FSK4.h"
 #include "protocols/APRS/APRS.h"
+#include "protocols/PCM/PCM.h"
+#include "protocols/AFSKReceiver/AFSKReceiver.h"
 
 // only create Radio class when using RadioShield
 #if defined(RADIOLIB_RADIOSHIELD)
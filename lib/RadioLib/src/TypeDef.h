@@ -293,6 +293,21 @@
 */
 #define RADIOLIB_ERR_INVALID_NUM_BROAD_ADDRS                   (-601)
 
+/*!
+  \brief Tx FIFO ran empty while streaming a packet, the FIFO was not refilled in time.
+*/
+#define RADIOLIB_ERR_TX_FIFO_UNDERFLOW                         (-602)
+
+/*!
+  \brief Rx FIFO overflowed while streaming a packet, the FIFO was not drained in time.
+*/
+#define RADIOLIB_ERR_RX_FIFO_OVERFLOW                          (-603)
+
+/*!
+  \brief Packet is too short to be streamed, it fits the FIFO and has to be sent in packet mode.
+*/
+#define RADIOLIB_ERR_STREAM_TOO_SHORT                          (-604)
+
 // SX126x-specific status codes
 
 /*!
@@ -375,6 +390,18 @@
 */
 #define RADIOLIB_ERR_RANGING_TIMEOUT                           (-901)
 
+// PhysicalLayer packet status codes
+
+/*!
+  \brief RadioLibPacketQueue has no frame to send.
+*/
+#define RADIOLIB_ERR_QUEUE_EMPTY                               (-1001)
+
+/*!
+  \brief RadioLibPacketQueue has no free slot to queue a frame.
+*/
+#define RADIOLIB_ERR_QUEUE_FULL                                (-1002)
+
 /*!
   \}
 */
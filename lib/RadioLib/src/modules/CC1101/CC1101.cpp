@@ -224,7 +224,7 @@ void CC1101::clearGdo0Action() {
 }
 
 void CC1101::setGdo2Action(void (*func)(void), RADIOLIB_INTERRUPT_STATUS dir) {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
   _mod->pinMode(_mod->getGpio(), INPUT);
@@ -232,7 +232,7 @@ void CC1101::setGdo2Action(void (*func)(void), RADIOLIB_INTERRUPT_STATUS dir) {
 }
 
 void CC1101::clearGdo2Action() {
-  if(_mod->getGpio() != RADIOLIB_NC) {
+  if(_mod->getGpio() == RADIOLIB_NC) {
     return;
   }
   _mod->detachInterrupt(RADIOLIB_DIGITAL_PIN_TO_INTERRUPT(_mod->getGpio()));
@@ -336,9 +336,11 @@ int16_t CC1101::startReceive() {
 int16_t CC1101::readData(uint8_t* data, size_t len) {
   // get packet length
   size_t length = getPacketLength();
+  bool truncated = false;
   if((len != 0) && (len < length)) {
     // user requested less data than we got, only return what was requested
     length = len;
+    truncated = true;
   }
 
   // check address filtering
@@ -381,6 +383,22 @@ int16_t CC1101::readData(uint8_t* data, size_t len) {
     bytesInFIFO = SPIgetRegValue(RADIOLIB_CC1101_REG_RXBYTES, 6, 0);
   }
 
+  if(truncated) {
+    // the rest of the payload is still in the FIFO, ahead of the status bytes: flush it
+    // rather than take it for RSSI / LQI (a packet received behind it is lost as well)
+    SPIsendCommand(RADIOLIB_CC1101_CMD_IDLE);
+    SPIsendCommand(RADIOLIB_CC1101_CMD_FLUSH_RX);
+    _rawRSSI = 0;
+    _rawLQI = 0;
+    _packetLengthQueried = false;
+    if(SPIgetRegValue(RADIOLIB_CC1101_REG_MCSM1, 3, 2) == RADIOLIB_CC1101_RXOFF_IDLE) {
+      standby();
+    } else {
+      SPIsendCommand(RADIOLIB_CC1101_CMD_RX);
+    }
+    return(RADIOLIB_ERR_NONE);
+  }
+
   // check if status bytes are enabled (default: RADIOLIB_CC1101_APPEND_STATUS_ON)
   bool isAppendStatus = SPIgetRegValue(RADIOLIB_CC1101_REG_PKTCTRL1, 2, 2) == RADIOLIB_CC1101_APPEND_STATUS_ON;
 
@@ -415,6 +433,76 @@ int16_t CC1101::readData(uint8_t* data, size_t len) {
   return(RADIOLIB_ERR_NONE);
 }
 
+int16_t CC1101::startTransmitStream(uint8_t* data, size_t len) {
+  // check packet length
+  if(len < RADIOLIB_CC1101_STREAM_MIN_LENGTH) {
+    return(RADIOLIB_ERR_STREAM_TOO_SHORT);
+  }
+  if(len > RADIOLIB_CC1101_STREAM_MAX_LENGTH) {
+    return(RADIOLIB_ERR_PACKET_TOO_LONG);
+  }
+
+  _streamData = data;
+  _streamSize = len;
+  _streamLen = len;
+  int16_t state = startStream(RADIOLIB_CC1101_STREAM_TX);
+  RADIOLIB_ASSERT(state);
+
+  // length header and the first part of the payload, the rest is written from streamService
+  _streamHeader[0] = (uint8_t)(len >> 8);
+  _streamHeader[1] = (uint8_t)len;
+  SPIwriteRegisterBurst(RADIOLIB_CC1101_REG_FIFO, _streamHeader, 2);
+  _streamPos = RADIOLIB_CC1101_FIFO_SIZE - 2;
+  SPIwriteRegisterBurst(RADIOLIB_CC1101_REG_FIFO, _streamData, _streamPos);
+
+  // set RF switch (if present)
+  _mod->setRfSwitchState(LOW, HIGH);
+
+  // set mode to transmit
+  _streamMode = RADIOLIB_CC1101_STREAM_TX;
+  SPIsendCommand(RADIOLIB_CC1101_CMD_TX);
+
+  return(state);
+}
+
+int16_t CC1101::startReceiveStream(uint8_t* data, size_t len) {
+  _streamData = data;
+  _streamSize = len;
+  _streamLen = 0;
+  int16_t state = startStream(RADIOLIB_CC1101_STREAM_RX);
+  RADIOLIB_ASSERT(state);
+
+  // set RF switch (if present)
+  _mod->setRfSwitchState(HIGH, LOW);
+
+  // set mode to receive
+  _streamMode = RADIOLIB_CC1101_STREAM_RX;
+  SPIsendCommand(RADIOLIB_CC1101_CMD_RX);
+
+  return(state);
+}
+
+int16_t CC1101::streamService() {
+  if(_streamMode == RADIOLIB_CC1101_STREAM_TX) {
+    return(streamTransmit());
+  } else if(_streamMode == RADIOLIB_CC1101_STREAM_RX) {
+    return(streamReceive());
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+bool CC1101::isStreaming() {
+  return(_streamMode != RADIOLIB_CC1101_STREAM_NONE);
+}
+
+size_t CC1101::getStreamLength() {
+  return(_streamLen);
+}
+
+size_t CC1101::getStreamPosition() {
+  return(_streamPos);
+}
+
 int16_t CC1101::setFrequency(float freq) {
   // check allowed frequency range
   if(!(((freq > 300.0) && (freq < 348.0)) ||
@@ -711,6 +799,11 @@ uint8_t CC1101::getLQI() const {
   return(_rawLQI);
 }
 
+void CC1101::getPacketInfo(RadioLibPacket& packet) {
+  packet.rssi = getRSSI();
+  packet.lqi = _rawLQI;
+}
+
 size_t CC1101::getPacketLength(bool update) {
   if(!_packetLengthQueried && update) {
     if (_packetLengthConfig == RADIOLIB_CC1101_LENGTH_CONFIG_VARIABLE) {
@@ -928,6 +1021,195 @@ void CC1101::getExpMant(float target, uint16_t mantOffset, uint8_t divExp, uint8
 	}
 }
 
+int16_t CC1101::startStream(uint8_t mode) {
+  // set mode to standby
+  standby();
+
+  // flush the FIFO of this direction
+  SPIsendCommand(mode == RADIOLIB_CC1101_STREAM_TX ? RADIOLIB_CC1101_CMD_FLUSH_TX : RADIOLIB_CC1101_CMD_FLUSH_RX);
+
+  // keep the packet mode, it is restored when the stream is over
+  _streamPktCtrl1 = SPIreadRegister(RADIOLIB_CC1101_REG_PKTCTRL1);
+  _streamPktCtrl0 = SPIreadRegister(RADIOLIB_CC1101_REG_PKTCTRL0);
+  _streamPktLen = SPIreadRegister(RADIOLIB_CC1101_REG_PKTLEN);
+  _streamPos = 0;
+  _streamHeaderLen = 0;
+  _streamFixed = false;
+
+  int16_t state;
+  if(mode == RADIOLIB_CC1101_STREAM_TX) {
+    // GDO0 rises when the Tx FIFO drained below 33 bytes
+    state = SPIsetRegValue(RADIOLIB_CC1101_REG_IOCFG0, RADIOLIB_CC1101_GDO0_INV | RADIOLIB_CC1101_GDOX_TX_FIFO_ABOVE_THR, 6, 0);
+    state |= SPIsetRegValue(RADIOLIB_CC1101_REG_FIFOTHR, RADIOLIB_CC1101_FIFO_THR_TX_33_RX_32, 3, 0);
+
+    // the radio stops when its byte counter reaches PKTLEN in fixed length mode,
+    // a packet that is not longer than that counter does not need infinite length mode
+    size_t total = _streamLen + 2;
+    state |= SPIsetRegValue(RADIOLIB_CC1101_REG_PKTLEN, (uint8_t)total);
+    _streamFixed = (total <= RADIOLIB_CC1101_MAX_PACKET_LENGTH);
+  } else {
+    // GDO0 rises when the Rx FIFO holds 4 bytes (enough for the length header), 32 bytes later on
+    state = SPIsetRegValue(RADIOLIB_CC1101_REG_IOCFG0, RADIOLIB_CC1101_GDOX_RX_FIFO_FULL, 6, 0);
+    state |= SPIsetRegValue(RADIOLIB_CC1101_REG_FIFOTHR, RADIOLIB_CC1101_FIFO_THR_TX_61_RX_4, 3, 0);
+  }
+
+  // GDO2 rises at the end of the packet
+  state |= SPIsetRegValue(RADIOLIB_CC1101_REG_IOCFG2, RADIOLIB_CC1101_GDO2_INV | RADIOLIB_CC1101_GDOX_SYNC_WORD_SENT_OR_RECEIVED, 6, 0);
+
+  // no address byte, the length is in the header
+  state |= SPIsetRegValue(RADIOLIB_CC1101_REG_PKTCTRL1, RADIOLIB_CC1101_ADR_CHK_NONE, 1, 0);
+  state |= SPIsetRegValue(RADIOLIB_CC1101_REG_PKTCTRL0, _streamFixed ? RADIOLIB_CC1101_LENGTH_CONFIG_FIXED : RADIOLIB_CC1101_LENGTH_CONFIG_INFINITE, 1, 0);
+  return(state);
+}
+
+int16_t CC1101::streamTransmit() {
+  uint8_t marcState = SPIgetRegValue(RADIOLIB_CC1101_REG_MARCSTATE, 4, 0);
+  if(marcState == RADIOLIB_CC1101_MARC_STATE_TXFIFO_UNDERFLOW) {
+    return(streamFinish(RADIOLIB_ERR_TX_FIFO_UNDERFLOW));
+  }
+
+  uint8_t bytesInFIFO = SPIgetRegValue(RADIOLIB_CC1101_REG_TXBYTES, 6, 0);
+  size_t left = _streamLen - _streamPos;
+  if(left == 0) {
+    // everything is in the FIFO, the next interrupt is the end of packet (GDO2)
+    if(bytesInFIFO != 0) {
+      return(RADIOLIB_ERR_NONE);
+    }
+
+    // The FIFO is empty, only the byte in the shift register and the CRC are still going out. The
+    // end of packet edge can be served while the radio is still in TX_END and no edge follows, so
+    // wait here until it has left Tx: a few bytes at the current bit rate, plus calibration.
+    uint32_t timeout = (uint32_t)(4 * 8 * 1000.0 / _br) + 1000;
+    uint32_t start = _mod->micros();
+    while((marcState == RADIOLIB_CC1101_MARC_STATE_TX) || (marcState == RADIOLIB_CC1101_MARC_STATE_TX_END)) {
+      if(_mod->micros() - start > timeout) {
+        return(streamFinish(RADIOLIB_ERR_TX_TIMEOUT));
+      }
+      _mod->yield();
+      marcState = SPIgetRegValue(RADIOLIB_CC1101_REG_MARCSTATE, 4, 0);
+    }
+    return(streamFinish(RADIOLIB_ERR_NONE));
+  }
+
+  // switch to fixed length once the end of the packet is within one turn of the byte counter,
+  // one byte of margin for the one in the shift register
+  if(!_streamFixed && (left + bytesInFIFO < RADIOLIB_CC1101_MAX_PACKET_LENGTH)) {
+    int16_t state = SPIsetRegValue(RADIOLIB_CC1101_REG_PKTCTRL0, RADIOLIB_CC1101_LENGTH_CONFIG_FIXED, 1, 0);
+    RADIOLIB_ASSERT(state);
+    _streamFixed = true;
+  }
+
+  // top the FIFO up
+  uint8_t bytesToWrite = min((size_t)(RADIOLIB_CC1101_FIFO_SIZE - bytesInFIFO), left);
+  SPIwriteRegisterBurst(RADIOLIB_CC1101_REG_FIFO, &_streamData[_streamPos], bytesToWrite);
+  _streamPos += bytesToWrite;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t CC1101::streamReceive() {
+  uint8_t marcState = SPIgetRegValue(RADIOLIB_CC1101_REG_MARCSTATE, 4, 0);
+  if(marcState == RADIOLIB_CC1101_MARC_STATE_RXFIFO_OVERFLOW) {
+    return(streamFinish(RADIOLIB_ERR_RX_FIFO_OVERFLOW));
+  }
+
+  // RXBYTES can be wrong while the radio writes the FIFO, read until two reads agree
+  uint8_t bytesInFIFO = SPIgetRegValue(RADIOLIB_CC1101_REG_RXBYTES, 6, 0);
+  uint8_t prev;
+  do {
+    prev = bytesInFIFO;
+    bytesInFIFO = SPIgetRegValue(RADIOLIB_CC1101_REG_RXBYTES, 6, 0);
+  } while(bytesInFIFO != prev);
+
+  // the last byte in the FIFO must not be read while the radio can still write to it (errata)
+  size_t statusLen = (SPIgetRegValue(RADIOLIB_CC1101_REG_PKTCTRL1, 2, 2) == RADIOLIB_CC1101_APPEND_STATUS_ON) ? 2 : 0;
+  bool complete = (_streamHeaderLen == 2) && (_streamPos + bytesInFIFO >= _streamLen + statusLen);
+  uint8_t keep = ((marcState == RADIOLIB_CC1101_MARC_STATE_RX) && !complete) ? 1 : 0;
+
+  // length header
+  while((_streamHeaderLen < 2) && (bytesInFIFO > keep)) {
+    _streamHeader[_streamHeaderLen++] = SPIreadRegister(RADIOLIB_CC1101_REG_FIFO);
+    bytesInFIFO--;
+    if(_streamHeaderLen < 2) {
+      continue;
+    }
+
+    _streamLen = ((size_t)_streamHeader[0] << 8) | _streamHeader[1];
+    if(_streamLen > _streamSize) {
+      return(streamFinish(RADIOLIB_ERR_PACKET_TOO_LONG));
+    }
+
+    // same as in Tx, the byte counter is still well below PKTLEN for a packet of at least RADIOLIB_CC1101_STREAM_MIN_LENGTH bytes
+    size_t total = _streamLen + 2;
+    int16_t state = SPIsetRegValue(RADIOLIB_CC1101_REG_PKTLEN, (uint8_t)total);
+    if(total <= RADIOLIB_CC1101_MAX_PACKET_LENGTH) {
+      state |= SPIsetRegValue(RADIOLIB_CC1101_REG_PKTCTRL0, RADIOLIB_CC1101_LENGTH_CONFIG_FIXED, 1, 0);
+      _streamFixed = true;
+    }
+
+    // drain in chunks of 32 bytes from now on
+    state |= SPIsetRegValue(RADIOLIB_CC1101_REG_FIFOTHR, RADIOLIB_CC1101_FIFO_THR_TX_33_RX_32, 3, 0);
+    if(state != RADIOLIB_ERR_NONE) {
+      return(streamFinish(state));
+    }
+  }
+  if(_streamHeaderLen < 2) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // switch to fixed length once the end of the packet is within one turn of the byte counter
+  if(!_streamFixed && (_streamLen < _streamPos + bytesInFIFO + RADIOLIB_CC1101_MAX_PACKET_LENGTH)) {
+    int16_t state = SPIsetRegValue(RADIOLIB_CC1101_REG_PKTCTRL0, RADIOLIB_CC1101_LENGTH_CONFIG_FIXED, 1, 0);
+    if(state != RADIOLIB_ERR_NONE) {
+      return(streamFinish(state));
+    }
+    _streamFixed = true;
+  }
+
+  // payload
+  uint8_t bytesToRead = 0;
+  if(bytesInFIFO > keep) {
+    bytesToRead = min((size_t)(bytesInFIFO - keep), _streamLen - _streamPos);
+  }
+  SPIreadRegisterBurst(RADIOLIB_CC1101_REG_FIFO, bytesToRead, &_streamData[_streamPos]);
+  _streamPos += bytesToRead;
+  bytesInFIFO -= bytesToRead;
+  if(_streamPos < _streamLen) {
+    return(RADIOLIB_ERR_NONE);
+  }
+
+  // status bytes
+  if(statusLen) {
+    if(bytesInFIFO < statusLen) {
+      return(RADIOLIB_ERR_NONE);
+    }
+    _rawRSSI = SPIreadRegister(RADIOLIB_CC1101_REG_FIFO);
+    uint8_t val = SPIreadRegister(RADIOLIB_CC1101_REG_FIFO);
+    _rawLQI = val & 0x7F;
+    if(_crcOn && (val & RADIOLIB_CC1101_CRC_OK) == RADIOLIB_CC1101_CRC_ERROR) {
+      return(streamFinish(RADIOLIB_ERR_CRC_MISMATCH));
+    }
+  }
+  return(streamFinish(RADIOLIB_ERR_NONE));
+}
+
+int16_t CC1101::streamFinish(int16_t state) {
+  uint8_t mode = _streamMode;
+  _streamMode = RADIOLIB_CC1101_STREAM_NONE;
+
+  // a failed stream leaves the radio in Rx or in an error state, a finished one in TXOFF_MODE / RXOFF_MODE
+  if((state != RADIOLIB_ERR_NONE) || ((mode == RADIOLIB_CC1101_STREAM_RX) &&
+     (SPIgetRegValue(RADIOLIB_CC1101_REG_MCSM1, 3, 2) == RADIOLIB_CC1101_RXOFF_IDLE))) {
+    standby();
+    SPIsendCommand(mode == RADIOLIB_CC1101_STREAM_TX ? RADIOLIB_CC1101_CMD_FLUSH_TX : RADIOLIB_CC1101_CMD_FLUSH_RX);
+  }
+
+  // restore the packet mode and address filtering
+  SPIwriteRegister(RADIOLIB_CC1101_REG_PKTCTRL1, _streamPktCtrl1);
+  SPIwriteRegister(RADIOLIB_CC1101_REG_PKTCTRL0, _streamPktCtrl0);
+  SPIwriteRegister(RADIOLIB_CC1101_REG_PKTLEN, _streamPktLen);
+  return(state);
+}
+
 int16_t CC1101::setPacketMode(uint8_t mode, uint16_t len) {
   // check length
   if (len > RADIOLIB_CC1101_MAX_PACKET_LENGTH) {
@@ -993,18 +1275,18 @@ void CC1101::SPIwriteRegisterBurst(uint8_t reg, uint8_t* data, size_t len) {
 }
 
 void CC1101::SPIsendCommand(uint8_t cmd) {
+  // start transfer, the bus has to be owned before NSS goes low
+  _mod->beginTransaction();
+
   // pull NSS low
   _mod->digitalWrite(_mod->getCs(), LOW);
 
-  // start transfer
-  _mod->SPIbeginTransaction();
-
   // send the command byte
   _mod->SPItransfer(cmd);
 
   // stop transfer
-  _mod->SPIendTransaction();
   _mod->digitalWrite(_mod->getCs(), HIGH);
+  _mod->endTransaction();
 }
 
 #endif
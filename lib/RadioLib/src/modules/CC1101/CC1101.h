@@ -12,6 +12,11 @@
 #define RADIOLIB_CC1101_CRYSTAL_FREQ                           26.0
 #define RADIOLIB_CC1101_DIV_EXPONENT                           16
 #define RADIOLIB_CC1101_FIFO_SIZE                              64
+#define RADIOLIB_CC1101_STREAM_MIN_LENGTH                      64
+#define RADIOLIB_CC1101_STREAM_MAX_LENGTH                      0xFFFF
+#define RADIOLIB_CC1101_STREAM_NONE                            0
+#define RADIOLIB_CC1101_STREAM_TX                              1
+#define RADIOLIB_CC1101_STREAM_RX                              2
 
 // CC1101 SPI commands
 #define RADIOLIB_CC1101_CMD_READ                               0b10000000
@@ -170,6 +175,7 @@
 #define RADIOLIB_CC1101_RX_ATTEN_12_DB                         0b00100000  //  5     4                     12 dB
 #define RADIOLIB_CC1101_RX_ATTEN_18_DB                         0b00110000  //  5     4                     18 dB
 #define RADIOLIB_CC1101_FIFO_THR_TX_61_RX_4                    0b00000000  //  3     0     TX fifo threshold: 61, RX fifo threshold: 4
+#define RADIOLIB_CC1101_FIFO_THR_TX_33_RX_32                   0b00000111  //  3     0     TX fifo threshold: 33, RX fifo threshold: 32
 
 // CC1101_REG_SYNC1
 #define RADIOLIB_CC1101_SYNC_WORD_MSB                          0xD3        //  7     0     sync word MSB
@@ -659,6 +665,65 @@ class CC1101: public PhysicalLayer {
     */
     int16_t readData(uint8_t* data, size_t len) override;
 
+    /*!
+      \brief Interrupt-driven transmit of a packet longer than the FIFO. The packet is sent in infinite length mode,
+      with a 2-byte length header in front of the payload, and switched to fixed length for the last 255 bytes.
+      GDO0 rises when the Tx FIFO drains below 33 bytes, GDO2 rises at the end of the packet, both have to call
+      streamService(). Address filtering is not used. The buffer must stay valid until the stream has finished.
+      Once the Tx FIFO is empty, streamService() waits for the radio to leave Tx (the last few bytes).
+
+      \param data Binary data to be sent.
+
+      \param len Number of bytes to send, RADIOLIB_CC1101_STREAM_MIN_LENGTH to RADIOLIB_CC1101_STREAM_MAX_LENGTH.
+      Shorter packets fit the FIFO and have to be sent with startTransmit.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmitStream(uint8_t* data, size_t len);
+
+    /*!
+      \brief Interrupt-driven receive of a packet sent by startTransmitStream. GDO0 rises when the Rx FIFO holds
+      32 bytes or more, GDO2 rises at the end of the packet, both have to call streamService().
+      The buffer must stay valid until the stream has finished.
+
+      \param data Pointer to array to save the received binary data.
+
+      \param len Size of the array. Longer packets are dropped with RADIOLIB_ERR_PACKET_TOO_LONG.
+
+      \returns \ref status_codes
+    */
+    int16_t startReceiveStream(uint8_t* data, size_t len);
+
+    /*!
+      \brief Refills the Tx FIFO or drains the Rx FIFO of the current stream with burst transfers.
+      Call it after every GDO0 or GDO2 interrupt, outside of the interrupt service routine.
+      On an error the stream is stopped and the radio is put to standby.
+
+      \returns \ref status_codes
+    */
+    int16_t streamService();
+
+    /*!
+      \brief Checks whether a stream is still in progress.
+
+      \returns True until the packet has been sent or received completely, or the stream failed.
+    */
+    bool isStreaming();
+
+    /*!
+      \brief Gets the payload length of the current or last stream. When receiving, it is known once the length header arrived.
+
+      \returns Payload length in bytes.
+    */
+    size_t getStreamLength();
+
+    /*!
+      \brief Gets the number of payload bytes moved through the FIFO in the current or last stream.
+
+      \returns Number of bytes written to the Tx FIFO or read from the Rx FIFO.
+    */
+    size_t getStreamPosition();
+
     // configuration methods
 
     /*!
@@ -786,6 +851,13 @@ class CC1101: public PhysicalLayer {
     */
    uint8_t getLQI() const;
 
+    /*!
+      \brief Fills in RSSI and LQI of the last received packet.
+
+      \param packet Packet to update.
+    */
+    void getPacketInfo(RadioLibPacket& packet) override;
+
      /*!
       \brief Query modem for the packet length of received payload.
 
@@ -950,8 +1022,24 @@ class CC1101: public PhysicalLayer {
     uint8_t _syncWordLength = 2;
     int8_t _power = 0;
 
+    uint8_t _streamMode = RADIOLIB_CC1101_STREAM_NONE;
+    uint8_t* _streamData = NULL;
+    size_t _streamSize = 0;
+    size_t _streamLen = 0;
+    size_t _streamPos = 0;
+    uint8_t _streamHeader[2] = {0, 0};
+    uint8_t _streamHeaderLen = 0;
+    bool _streamFixed = false;
+    uint8_t _streamPktCtrl1 = 0;
+    uint8_t _streamPktCtrl0 = 0;
+    uint8_t _streamPktLen = 0;
+
     int16_t config();
     int16_t directMode();
+    int16_t startStream(uint8_t mode);
+    int16_t streamTransmit();
+    int16_t streamReceive();
+    int16_t streamFinish(int16_t state);
     static void getExpMant(float target, uint16_t mantOffset, uint8_t divExp, uint8_t expMax, uint8_t& exp, uint8_t& mant);
     int16_t setPacketMode(uint8_t mode, uint16_t len);
 };
@@ -41,14 +41,14 @@ class AFSKClient  {
 
       \returns \ref status_codes
     */
-    int16_t tone(uint16_t freq, bool autoStart = true);
+    virtual int16_t tone(uint16_t freq, bool autoStart = true);
 
     /*!
       \brief Stops transmitting audio tone.
 
       \returns \ref status_codes
     */
-    int16_t noTone();
+    virtual int16_t noTone();
 
 #if !defined(RADIOLIB_GODMODE)
   private:
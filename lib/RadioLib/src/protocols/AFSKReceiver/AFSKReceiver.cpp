@@ -0,0 +1,167 @@
+#include "AFSKReceiver.h"
+#if !defined(RADIOLIB_EXCLUDE_AFSK) && !defined(RADIOLIB_EXCLUDE_AX25)
+
+AFSKReceiver::AFSKReceiver(uint32_t sampleRate, uint16_t mark, uint16_t space, uint16_t baud) {
+  _sampleRate = sampleRate;
+  _mark = mark;
+  _space = space;
+  _baud = baud;
+}
+
+int16_t AFSKReceiver::begin() {
+  // the correlators span one bit, at least a few samples of it
+  if((_baud == 0) || (_sampleRate < 4UL*_baud) || ((_sampleRate + _baud/2) / _baud > RADIOLIB_AFSK_RX_MAX_BIT_LEN)) {
+    return(RADIOLIB_ERR_INVALID_BIT_RATE);
+  }
+  if((_mark == 0) || (_space == 0) || (_mark >= _sampleRate/2) || (_space >= _sampleRate/2)) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+
+  for(uint16_t i = 0; i < RADIOLIB_AFSK_RX_TABLE_SIZE; i++) {
+    _cos[i] = (int16_t)(16384.0 * cos(2.0 * M_PI * i / RADIOLIB_AFSK_RX_TABLE_SIZE));
+  }
+  _oscStep[0] = (uint32_t)(((uint64_t)_mark << 32) / _sampleRate);
+  _oscStep[1] = (uint32_t)(((uint64_t)_space << 32) / _sampleRate);
+  _pllStep = (uint32_t)(((uint64_t)_baud << 32) / _sampleRate);
+  _bitLen = (_sampleRate + _baud/2) / _baud;
+
+  memset(_prodI, 0, sizeof(_prodI));
+  memset(_prodQ, 0, sizeof(_prodQ));
+  for(uint8_t i = 0; i < 2; i++) {
+    _oscPhase[i] = 0;
+    _sumI[i] = 0;
+    _sumQ[i] = 0;
+  }
+  _pos = 0;
+  _dc = 0;
+  _pll = 0;
+  _level = false;
+  _lastSample = false;
+  _shift = 0;
+  _ones = 0;
+  _bitCount = 0;
+  _inFrame = false;
+  _frameLen = 0;
+  _frames = 0;
+  _errors = 0;
+  return(RADIOLIB_ERR_NONE);
+}
+
+void AFSKReceiver::setFrameAction(void (*func)(const uint8_t* frame, size_t len)) {
+  _frameAction = func;
+}
+
+void AFSKReceiver::process(const int16_t* samples, size_t len) {
+  for(size_t n = 0; n < len; n++) {
+    // remove DC, one pole high pass well below the tones
+    int32_t x = samples[n];
+    _dc += x - (_dc >> 8);
+    x -= _dc >> 8;
+
+    // slide both correlators by one sample: add the newest product, drop the one that is a bit old
+    // (16-bit sample * Q14 >> 8 keeps the sum of 64 products in 32 bits, and sums of integers do not drift)
+    float energy[2];
+    for(uint8_t t = 0; t < 2; t++) {
+      uint8_t idx = _oscPhase[t] >> 24;
+      _oscPhase[t] += _oscStep[t];
+      int32_t i = (x * _cos[idx]) >> 8;
+      int32_t q = (x * _cos[(uint8_t)(idx - RADIOLIB_AFSK_RX_TABLE_SIZE/4)]) >> 8;
+      _sumI[t] += i - _prodI[t][_pos];
+      _sumQ[t] += q - _prodQ[t][_pos];
+      _prodI[t][_pos] = i;
+      _prodQ[t][_pos] = q;
+      energy[t] = (float)_sumI[t]*(float)_sumI[t] + (float)_sumQ[t]*(float)_sumQ[t];
+    }
+    if(++_pos >= _bitLen) {
+      _pos = 0;
+    }
+    bool level = energy[0] > energy[1];
+
+    // transitions are expected half way between two bit samples, pull the clock towards that
+    if(level != _level) {
+      _level = level;
+      _pll -= (uint32_t)((int32_t)(_pll - 0x80000000UL) / 4);
+    }
+
+    // sample in the middle of the bit when the clock wraps
+    uint32_t prev = _pll;
+    _pll += _pllStep;
+    if(_pll < prev) {
+      // NRZI: no change is 1, change is 0
+      receiveBit(level == _lastSample);
+      _lastSample = level;
+    }
+  }
+}
+
+uint32_t AFSKReceiver::getFrames() {
+  return(_frames);
+}
+
+uint32_t AFSKReceiver::getErrors() {
+  return(_errors);
+}
+
+void AFSKReceiver::receiveBit(bool bit) {
+  // LSB first
+  _shift = (_shift >> 1) | (bit ? 0x80 : 0x00);
+  if(_shift == RADIOLIB_AX25_FLAG) {
+    // a frame ends at a byte boundary, the flag itself added 7 bits
+    if(_inFrame && (_bitCount == 7) && (_frameLen >= RADIOLIB_AFSK_RX_MIN_FRAME_LEN)) {
+      if(_crc == RADIOLIB_AFSK_RX_CRC_RESIDUE) {
+        _frames++;
+        if(_frameAction != nullptr) {
+          _frameAction(_frame, _frameLen - 2);
+        }
+      } else {
+        _errors++;
+      }
+    }
+
+    // the same flag may start the next frame
+    _inFrame = true;
+    _frameLen = 0;
+    _bitCount = 0;
+    _ones = 0;
+    _crc = 0xFFFF;
+    return;
+  }
+
+  if(!_inFrame) {
+    return;
+  }
+
+  if(bit) {
+    // 7 ones: abort, or the channel is idle
+    if(++_ones >= 7) {
+      _inFrame = false;
+      return;
+    }
+  } else {
+    // the 0 stuffed after 5 ones is not data
+    if(_ones == 5) {
+      _ones = 0;
+      return;
+    }
+    _ones = 0;
+  }
+
+  _byte = (_byte >> 1) | (bit ? 0x80 : 0x00);
+  if(++_bitCount < 8) {
+    return;
+  }
+  _bitCount = 0;
+  if(_frameLen >= RADIOLIB_AFSK_RX_MAX_FRAME_LEN) {
+    _inFrame = false;
+    return;
+  }
+  _frame[_frameLen++] = _byte;
+
+  // CRC-CCITT, reflected, as the bytes come in
+  _crc ^= _byte;
+  for(uint8_t i = 0; i < 8; i++) {
+    _crc = (_crc & 0x0001) ? ((_crc >> 1) ^ 0x8408) : (_crc >> 1);
+  }
+}
+
+#endif
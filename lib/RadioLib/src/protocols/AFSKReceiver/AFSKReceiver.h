@@ -0,0 +1,127 @@
+#if !defined(_RADIOLIB_AFSK_RECEIVER_H)
+#define _RADIOLIB_AFSK_RECEIVER_H
+
+#include "../../TypeDef.h"
+
+#if !defined(RADIOLIB_EXCLUDE_AFSK) && !defined(RADIOLIB_EXCLUDE_AX25)
+
+#include "../AX25/AX25.h"
+
+// AFSK receiver properties
+#define RADIOLIB_AFSK_RX_BAUD                                   1200
+#define RADIOLIB_AFSK_RX_MAX_BIT_LEN                            64          // samples per bit, enough for 76.8 kHz at 1200 baud
+#define RADIOLIB_AFSK_RX_MAX_FRAME_LEN                          332         // 10 addresses, control, PID, 256 bytes info and FCS
+#define RADIOLIB_AFSK_RX_MIN_FRAME_LEN                          17          // 2 addresses, control and FCS
+#define RADIOLIB_AFSK_RX_TABLE_SIZE                             256
+#define RADIOLIB_AFSK_RX_CRC_RESIDUE                            0xF0B8      // CRC-CCITT of a frame followed by its FCS
+
+/*!
+  \class AFSKReceiver
+
+  \brief Demodulates AX.25 frames sent as AFSK (e.g. Bell 202 at 1200 baud, as sent by AX25Client) from 16-bit PCM samples,
+  for example a microphone or the audio output of a receiver.
+  Each tone is detected by a correlator sliding over one bit: the samples are mixed with a quadrature oscillator and
+  the products of the last bit are summed, which costs two multiplications per tone and sample no matter how long a bit is.
+  The bit clock is recovered by a digital PLL locked to the mark/space transitions, then the frames are NRZI decoded,
+  unstuffed and checked against their FCS. Nothing is allocated, frames up to RADIOLIB_AFSK_RX_MAX_FRAME_LEN bytes are received.
+*/
+class AFSKReceiver {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param sampleRate Sample rate of the audio in Hz.
+
+      \param mark Mark (1) frequency in Hz.
+
+      \param space Space (0) frequency in Hz.
+
+      \param baud Bit rate.
+    */
+    AFSKReceiver(uint32_t sampleRate, uint16_t mark = RADIOLIB_AX25_AFSK_MARK, uint16_t space = RADIOLIB_AX25_AFSK_SPACE, uint16_t baud = RADIOLIB_AFSK_RX_BAUD);
+
+    /*!
+      \brief Initialization method, also resets the receiver.
+
+      \returns \ref status_codes
+    */
+    int16_t begin();
+
+    /*!
+      \brief Sets the function called with every frame received with a valid FCS.
+
+      \param func Called with the frame (addresses, control, PID and info field, without FCS) and its length.
+      The frame is only valid during the call.
+    */
+    void setFrameAction(void (*func)(const uint8_t* frame, size_t len));
+
+    /*!
+      \brief Demodulates a block of samples, frames that end in it are passed to the frame action.
+
+      \param samples Mono 16-bit samples.
+
+      \param len Number of samples.
+    */
+    void process(const int16_t* samples, size_t len);
+
+    /*!
+      \brief Gets the number of frames received with a valid FCS.
+
+      \returns Number of frames.
+    */
+    uint32_t getFrames();
+
+    /*!
+      \brief Gets the number of frames dropped because of an FCS error. Noise between frames
+      occasionally looks like a frame as well, so this is not zero on an idle channel.
+
+      \returns Number of frames.
+    */
+    uint32_t getErrors();
+
+#if !defined(RADIOLIB_GODMODE)
+  private:
+#endif
+    uint32_t _sampleRate;
+    uint16_t _mark;
+    uint16_t _space;
+    uint16_t _baud;
+    void (*_frameAction)(const uint8_t* frame, size_t len) = nullptr;
+
+    // correlators, index 0 is mark and 1 is space
+    int16_t _cos[RADIOLIB_AFSK_RX_TABLE_SIZE];
+    uint32_t _oscPhase[2] = {0, 0};
+    uint32_t _oscStep[2] = {0, 0};
+    int32_t _prodI[2][RADIOLIB_AFSK_RX_MAX_BIT_LEN];
+    int32_t _prodQ[2][RADIOLIB_AFSK_RX_MAX_BIT_LEN];
+    int32_t _sumI[2] = {0, 0};
+    int32_t _sumQ[2] = {0, 0};
+    uint8_t _bitLen = 0;
+    uint8_t _pos = 0;
+    int32_t _dc = 0;
+
+    // bit clock
+    uint32_t _pll = 0;
+    uint32_t _pllStep = 0;
+    bool _level = false;
+    bool _lastSample = false;
+
+    // HDLC
+    uint8_t _shift = 0;
+    uint8_t _ones = 0;
+    uint8_t _byte = 0;
+    uint8_t _bitCount = 0;
+    bool _inFrame = false;
+    uint16_t _crc = 0;
+    uint8_t _frame[RADIOLIB_AFSK_RX_MAX_FRAME_LEN];
+    size_t _frameLen = 0;
+
+    uint32_t _frames = 0;
+    uint32_t _errors = 0;
+
+    void receiveBit(bool bit);
+};
+
+#endif
+
+#endif
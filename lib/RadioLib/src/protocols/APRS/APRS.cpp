@@ -19,9 +19,10 @@ int16_t APRSClient::begin(char symbol, bool alt) {
 
 int16_t APRSClient::sendPosition(char* destCallsign, uint8_t destSSID, char* lat, char* lon, char* msg, char* time) {
   #if !defined(RADIOLIB_STATIC_ONLY)
-    size_t len = 1 + strlen(lat) + 1 + strlen(lon);
+    // data type, symbol table, symbol and terminator
+    size_t len = 4 + strlen(lat) + strlen(lon);
     if(msg != NULL) {
-      len += 1 + strlen(msg);
+      len += strlen(msg);
     }
     if(time != NULL) {
       len += strlen(time);
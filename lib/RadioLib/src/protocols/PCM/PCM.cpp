@@ -0,0 +1,215 @@
+#include "PCM.h"
+#if !defined(RADIOLIB_EXCLUDE_PCM) && !defined(RADIOLIB_EXCLUDE_AFSK)
+
+PCMLayer* PCMLayer::_active = nullptr;
+
+PCMLayer::PCMLayer(uint32_t sampleRate, void (*sink)(const int16_t* samples, size_t len)):
+  PhysicalLayer(1, 0),
+  _mod(RADIOLIB_NC, RADIOLIB_NC, RADIOLIB_NC)
+{
+  _sampleRate = sampleRate;
+  _sink = sink;
+  _samplePeriod = 0;
+}
+
+int16_t PCMLayer::begin(int16_t amplitude) {
+  if((_sampleRate < 1000UL) || (_sampleRate > 1000000UL)) {
+    return(RADIOLIB_ERR_INVALID_BIT_RATE);
+  }
+
+  // sample period in 1/65536 us
+  _samplePeriod = (uint32_t)((1000000ULL << 16) / _sampleRate);
+  _clock = 0;
+  _frac = 0;
+  _samples = 0;
+  _phase = 0;
+  _phaseStep = 0;
+  _blockLen = 0;
+
+  for(uint16_t i = 0; i < RADIOLIB_PCM_SINE_TABLE_SIZE; i++) {
+    _sine[i] = (int16_t)(amplitude * sin(2.0 * M_PI * i / RADIOLIB_PCM_SINE_TABLE_SIZE));
+  }
+
+  // the clients wait on these, let them wait on the sample clock
+  _active = this;
+  _mod.setCb_yield(PCMLayer::cbYield);
+  _mod.setCb_delay(PCMLayer::cbDelay);
+  _mod.setCb_delayMicroseconds(PCMLayer::cbDelayMicroseconds);
+  _mod.setCb_millis(PCMLayer::cbMillis);
+  _mod.setCb_micros(PCMLayer::cbMicros);
+  return(RADIOLIB_ERR_NONE);
+}
+
+void PCMLayer::setTone(uint16_t freq) {
+  _phaseStep = (uint32_t)(((uint64_t)freq << 32) / _sampleRate);
+}
+
+void PCMLayer::silence(uint32_t us) {
+  setTone(0);
+  advance(us);
+}
+
+void PCMLayer::flush() {
+  if((_blockLen > 0) && (_sink != nullptr)) {
+    _sink(_block, _blockLen);
+  }
+  _blockLen = 0;
+}
+
+uint32_t PCMLayer::getSamples() {
+  return(_samples);
+}
+
+void PCMLayer::advance(uint32_t us) {
+  _clock += us;
+  while(us > 0) {
+    // in steps, the fraction would overflow on long delays
+    uint32_t step = us > 0x7FFF ? 0x7FFF : us;
+    us -= step;
+    _frac += step << 16;
+    while(_frac >= _samplePeriod) {
+      _frac -= _samplePeriod;
+
+      // silence keeps the phase, the next tone starts where the last one stopped
+      int16_t sample = 0;
+      if(_phaseStep != 0) {
+        sample = _sine[_phase >> 24];
+        _phase += _phaseStep;
+      }
+      _block[_blockLen++] = sample;
+      _samples++;
+      if(_blockLen == RADIOLIB_PCM_BLOCK_SIZE) {
+        flush();
+      }
+    }
+  }
+}
+
+void PCMLayer::cbYield(void) {
+  // nothing to wait for
+}
+
+void PCMLayer::cbDelay(unsigned long ms) {
+  if(_active != nullptr) {
+    _active->advance(ms * 1000UL);
+  }
+}
+
+void PCMLayer::cbDelayMicroseconds(unsigned int us) {
+  if(_active != nullptr) {
+    _active->advance(us);
+  }
+}
+
+unsigned long PCMLayer::cbMillis(void) {
+  // loops polling the clock have to see it move
+  if(_active == nullptr) {
+    return(0);
+  }
+  _active->advance(1);
+  return(_active->_clock / 1000UL);
+}
+
+unsigned long PCMLayer::cbMicros(void) {
+  if(_active == nullptr) {
+    return(0);
+  }
+  _active->advance(1);
+  return(_active->_clock);
+}
+
+int16_t PCMLayer::transmit(uint8_t* data, size_t len, uint8_t addr) {
+  (void)data;
+  (void)len;
+  (void)addr;
+  return(RADIOLIB_ERR_WRONG_MODEM);
+}
+
+int16_t PCMLayer::receive(uint8_t* data, size_t len) {
+  (void)data;
+  (void)len;
+  return(RADIOLIB_ERR_WRONG_MODEM);
+}
+
+int16_t PCMLayer::standby() {
+  setTone(0);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t PCMLayer::startTransmit(uint8_t* data, size_t len, uint8_t addr) {
+  (void)data;
+  (void)len;
+  (void)addr;
+  return(RADIOLIB_ERR_WRONG_MODEM);
+}
+
+int16_t PCMLayer::readData(uint8_t* data, size_t len) {
+  (void)data;
+  (void)len;
+  return(RADIOLIB_ERR_WRONG_MODEM);
+}
+
+int16_t PCMLayer::transmitDirect(uint32_t frf) {
+  (void)frf;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t PCMLayer::receiveDirect() {
+  return(RADIOLIB_ERR_WRONG_MODEM);
+}
+
+int16_t PCMLayer::setFrequencyDeviation(float freqDev) {
+  (void)freqDev;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t PCMLayer::setDataShaping(uint8_t sh) {
+  (void)sh;
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t PCMLayer::setEncoding(uint8_t encoding) {
+  (void)encoding;
+  return(RADIOLIB_ERR_NONE);
+}
+
+size_t PCMLayer::getPacketLength(bool update) {
+  (void)update;
+  return(0);
+}
+
+uint8_t PCMLayer::randomByte() {
+  return((uint8_t)(_clock ^ _phase));
+}
+
+void PCMLayer::setDirectAction(void (*func)(void)) {
+  (void)func;
+}
+
+void PCMLayer::readBit(RADIOLIB_PIN_TYPE pin) {
+  (void)pin;
+}
+
+Module* PCMLayer::getMod() {
+  return(&_mod);
+}
+
+PCMClient::PCMClient(PCMLayer* pcm): AFSKClient(pcm, RADIOLIB_NC) {
+  _pcm = pcm;
+}
+
+int16_t PCMClient::tone(uint16_t freq, bool autoStart) {
+  (void)autoStart;
+  if(freq == 0) {
+    return(RADIOLIB_ERR_INVALID_FREQUENCY);
+  }
+  _pcm->setTone(freq);
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t PCMClient::noTone() {
+  _pcm->setTone(0);
+  return(RADIOLIB_ERR_NONE);
+}
+
+#endif
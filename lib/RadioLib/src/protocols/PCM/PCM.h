@@ -0,0 +1,170 @@
+#if !defined(_RADIOLIB_PCM_H)
+#define _RADIOLIB_PCM_H
+
+#include "../../TypeDef.h"
+
+#if !defined(RADIOLIB_EXCLUDE_PCM) && !defined(RADIOLIB_EXCLUDE_AFSK)
+
+#include "../../Module.h"
+
+#include "../PhysicalLayer/PhysicalLayer.h"
+#include "../AFSK/AFSK.h"
+
+// PCM rendering properties
+#define RADIOLIB_PCM_BLOCK_SIZE                                 256
+#define RADIOLIB_PCM_SINE_TABLE_SIZE                            256
+#define RADIOLIB_PCM_DEFAULT_AMPLITUDE                          16384
+
+/*!
+  \class PCMLayer
+
+  \brief Audio output instead of a radio: renders the tones of the AFSK-based clients (AX.25, APRS, RTTY, Morse,
+  Hellschreiber, SSTV, 4-FSK) into 16-bit PCM samples, e.g. for an I2S amplifier or a WAV file.
+  The clients time their tones with micros() and delay() of the module. This module runs on a sample clock instead:
+  every microsecond the clients wait for advances the clock and produces the samples of that time,
+  so a transmission is rendered much faster than it would be sent. The samples are handed over in blocks.
+  Only one PCMLayer can be in use at a time.
+*/
+class PCMLayer: public PhysicalLayer {
+  public:
+    // introduce PhysicalLayer overloads
+    using PhysicalLayer::transmit;
+    using PhysicalLayer::receive;
+    using PhysicalLayer::startTransmit;
+    using PhysicalLayer::readData;
+
+    /*!
+      \brief Default constructor.
+
+      \param sampleRate Output sample rate in Hz.
+
+      \param sink Function called with each block of RADIOLIB_PCM_BLOCK_SIZE samples (the last one may be shorter).
+    */
+    PCMLayer(uint32_t sampleRate, void (*sink)(const int16_t* samples, size_t len));
+
+    /*!
+      \brief Initialization method, makes this instance the one that renders.
+
+      \param amplitude Peak amplitude of the tones.
+
+      \returns \ref status_codes
+    */
+    int16_t begin(int16_t amplitude = RADIOLIB_PCM_DEFAULT_AMPLITUDE);
+
+    /*!
+      \brief Sets the frequency of the tone rendered from now on. The phase is continuous across changes.
+
+      \param freq Tone frequency in Hz, 0 for silence.
+    */
+    void setTone(uint16_t freq);
+
+    /*!
+      \brief Renders silence.
+
+      \param us Length of the silence in microseconds.
+    */
+    void silence(uint32_t us);
+
+    /*!
+      \brief Hands the samples rendered so far to the sink, call at the end of a transmission.
+    */
+    void flush();
+
+    /*!
+      \brief Gets the number of samples rendered since begin().
+
+      \returns Number of samples.
+    */
+    uint32_t getSamples();
+
+    // direct mode is all there is, the rest does not apply to audio output
+
+    int16_t transmit(uint8_t* data, size_t len, uint8_t addr = 0) override;
+    int16_t receive(uint8_t* data, size_t len) override;
+    int16_t standby() override;
+    int16_t startTransmit(uint8_t* data, size_t len, uint8_t addr = 0) override;
+    int16_t readData(uint8_t* data, size_t len) override;
+    int16_t transmitDirect(uint32_t frf = 0) override;
+    int16_t receiveDirect() override;
+    int16_t setFrequencyDeviation(float freqDev) override;
+    int16_t setDataShaping(uint8_t sh) override;
+    int16_t setEncoding(uint8_t encoding) override;
+    size_t getPacketLength(bool update = true) override;
+    uint8_t randomByte() override;
+    void setDirectAction(void (*func)(void)) override;
+    void readBit(RADIOLIB_PIN_TYPE pin) override;
+    Module* getMod() override;
+
+#if !defined(RADIOLIB_GODMODE)
+  private:
+#endif
+    Module _mod;
+    void (*_sink)(const int16_t* samples, size_t len);
+    uint32_t _sampleRate;
+
+    // sample clock: microseconds, and 1/65536 us since the last sample
+    uint32_t _clock = 0;
+    uint32_t _frac = 0;
+    uint32_t _samplePeriod;
+    uint32_t _samples = 0;
+
+    // phase accumulator oscillator
+    uint32_t _phase = 0;
+    uint32_t _phaseStep = 0;
+    int16_t _sine[RADIOLIB_PCM_SINE_TABLE_SIZE];
+
+    int16_t _block[RADIOLIB_PCM_BLOCK_SIZE];
+    size_t _blockLen = 0;
+
+    void advance(uint32_t us);
+
+    // module callbacks, they drive the instance passed to begin()
+    static PCMLayer* _active;
+    static void cbYield(void);
+    static void cbDelay(unsigned long ms);
+    static void cbDelayMicroseconds(unsigned int us);
+    static unsigned long cbMillis(void);
+    static unsigned long cbMicros(void);
+};
+
+/*!
+  \class PCMClient
+
+  \brief AFSK client that sets the tone of a PCMLayer, pass it to the protocol clients in place of AFSKClient.
+*/
+class PCMClient: public AFSKClient {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param pcm Pointer to the PCMLayer that renders the audio.
+    */
+    explicit PCMClient(PCMLayer* pcm);
+
+    /*!
+      \brief Starts rendering audio tone.
+
+      \param freq Frequency of the tone in Hz.
+
+      \param autoStart Unused, kept for compatibility with AFSKClient.
+
+      \returns \ref status_codes
+    */
+    int16_t tone(uint16_t freq, bool autoStart = true) override;
+
+    /*!
+      \brief Stops rendering audio tone, silence follows.
+
+      \returns \ref status_codes
+    */
+    int16_t noTone() override;
+
+#if !defined(RADIOLIB_GODMODE)
+  private:
+#endif
+    PCMLayer* _pcm;
+};
+
+#endif
+
+#endif
@@ -142,6 +142,79 @@ int16_t PhysicalLayer::receive(String& str, size_t len) {
   return(state);
 }
 
+int16_t PhysicalLayer::transmit(const RadioLibPacket& packet) {
+  return(transmit(packet.data, packet.len, packet.addr));
+}
+
+int16_t PhysicalLayer::transmit(RadioLibPacketQueue& queue) {
+  RadioLibPacket* packet;
+  while((packet = queue.peek()) != NULL) {
+    int16_t state = transmit(*packet);
+    RADIOLIB_ASSERT(state);
+    queue.pop();
+  }
+  return(RADIOLIB_ERR_NONE);
+}
+
+int16_t PhysicalLayer::receive(RadioLibPacket& packet) {
+  packet.len = 0;
+  int16_t state = receive(packet.data, packet.size);
+  if((state == RADIOLIB_ERR_NONE) || (state == RADIOLIB_ERR_CRC_MISMATCH)) {
+    // the module reads up to size bytes
+    packet.len = getPacketLength(false);
+    if(packet.len > packet.size) {
+      // the module has discarded the rest of the packet, status bytes included
+      packet.len = packet.size;
+      packet.rssi = 0;
+      packet.lqi = 0;
+      return(RADIOLIB_ERR_PACKET_TOO_LONG);
+    }
+    getPacketInfo(packet);
+  }
+  return(state);
+}
+
+int16_t PhysicalLayer::startTransmit(const RadioLibPacket& packet) {
+  return(startTransmit(packet.data, packet.len, packet.addr));
+}
+
+int16_t PhysicalLayer::startTransmit(RadioLibPacketQueue& queue) {
+  RadioLibPacket* packet = queue.peek();
+  if(packet == NULL) {
+    return(RADIOLIB_ERR_QUEUE_EMPTY);
+  }
+  int16_t state = startTransmit(*packet);
+  RADIOLIB_ASSERT(state);
+  queue.pop();
+  return(state);
+}
+
+int16_t PhysicalLayer::readData(RadioLibPacket& packet) {
+  // read the number of actually received bytes
+  size_t length = getPacketLength();
+  bool tooLong = length > packet.size;
+  if(tooLong) {
+    // readData() reads the first bytes and discards the rest of the packet, status bytes included
+    // (CC1101 flushes its Rx FIFO for it), so there is no RSSI / LQI and no CRC check
+    length = packet.size;
+  }
+
+  int16_t state = readData(packet.data, length);
+  packet.len = length;
+  if(tooLong) {
+    packet.rssi = 0;
+    packet.lqi = 0;
+    return((state == RADIOLIB_ERR_NONE) ? RADIOLIB_ERR_PACKET_TOO_LONG : state);
+  }
+  getPacketInfo(packet);
+  return(state);
+}
+
+void PhysicalLayer::getPacketInfo(RadioLibPacket& packet) {
+  packet.rssi = 0;
+  packet.lqi = 0;
+}
+
 float PhysicalLayer::getFreqStep() const {
   return(_freqStep);
 }
@@ -246,3 +319,49 @@ void PhysicalLayer::updateDirectBuffer(uint8_t bit) {
     }
   }
 }
+
+RadioLibPacketQueue::RadioLibPacketQueue(RadioLibPacket* slots, size_t numSlots) {
+  _slots = slots;
+  _numSlots = numSlots;
+  _head = 0;
+  _count = 0;
+}
+
+int16_t RadioLibPacketQueue::push(uint8_t* data, size_t len, uint8_t addr) {
+  if(_count >= _numSlots) {
+    return(RADIOLIB_ERR_QUEUE_FULL);
+  }
+  RadioLibPacket* packet = &_slots[(_head + _count) % _numSlots];
+  packet->data = data;
+  packet->size = len;
+  packet->len = len;
+  packet->addr = addr;
+  packet->rssi = 0;
+  packet->lqi = 0;
+  _count++;
+  return(RADIOLIB_ERR_NONE);
+}
+
+RadioLibPacket* RadioLibPacketQueue::peek() {
+  if(_count == 0) {
+    return(NULL);
+  }
+  return(&_slots[_head]);
+}
+
+void RadioLibPacketQueue::pop() {
+  if(_count == 0) {
+    return;
+  }
+  _head = (_head + 1) % _numSlots;
+  _count--;
+}
+
+size_t RadioLibPacketQueue::available() const {
+  return(_count);
+}
+
+void RadioLibPacketQueue::clear() {
+  _head = 0;
+  _count = 0;
+}
@@ -4,6 +4,107 @@
 #include "../../TypeDef.h"
 #include "../../Module.h"
 
+/*!
+  \struct RadioLibPacket
+
+  \brief Packet in a caller provided buffer, together with the metadata of its reception.
+  The packet methods of PhysicalLayer work on these and never allocate memory.
+*/
+struct RadioLibPacket {
+  /*!
+    \brief Payload buffer, owned by the caller.
+  */
+  uint8_t* data;
+
+  /*!
+    \brief Size of the payload buffer in bytes.
+  */
+  size_t size;
+
+  /*!
+    \brief Payload length in bytes.
+  */
+  size_t len;
+
+  /*!
+    \brief Node address. Only used in FSK mode with address filtering.
+  */
+  uint8_t addr;
+
+  /*!
+    \brief RSSI of the received packet in dBm, 0 if the module does not report it.
+  */
+  float rssi;
+
+  /*!
+    \brief Link quality of the received packet (LQI on %CC1101), 0 if the module does not report it.
+  */
+  uint8_t lqi;
+};
+
+/*!
+  \class RadioLibPacketQueue
+
+  \brief First in, first out queue of frames waiting for transmission. Both the slots and the payload buffers
+  are provided by the caller, frames are queued by reference, not copied.
+*/
+class RadioLibPacketQueue {
+  public:
+    /*!
+      \brief Default constructor.
+
+      \param slots Array of packet descriptors used as queue storage.
+
+      \param numSlots Number of elements in slots.
+    */
+    RadioLibPacketQueue(RadioLibPacket* slots, size_t numSlots);
+
+    /*!
+      \brief Queue a frame. The payload must stay valid until the frame was sent.
+
+      \param data Binary data to send.
+
+      \param len Length of binary data (in bytes).
+
+      \param addr Node address to transmit the packet to. Only used in FSK mode.
+
+      \returns \ref status_codes
+    */
+    int16_t push(uint8_t* data, size_t len, uint8_t addr = 0);
+
+    /*!
+      \brief Get the oldest queued frame.
+
+      \returns Pointer to the frame, NULL when the queue is empty.
+    */
+    RadioLibPacket* peek();
+
+    /*!
+      \brief Remove the oldest queued frame.
+    */
+    void pop();
+
+    /*!
+      \brief Get the number of queued frames.
+
+      \returns Number of queued frames.
+    */
+    size_t available() const;
+
+    /*!
+      \brief Drop all queued frames.
+    */
+    void clear();
+
+#if !defined(RADIOLIB_GODMODE)
+  private:
+#endif
+    RadioLibPacket* _slots;
+    size_t _numSlots;
+    size_t _head;
+    size_t _count;
+};
+
 /*!
   \class PhysicalLayer
 
@@ -163,6 +264,73 @@ class PhysicalLayer {
     */
     virtual int16_t readData(uint8_t* data, size_t len) = 0;
 
+    /*!
+      \brief Blocking transmit of a packet descriptor. Does not allocate memory.
+
+      \param packet Packet to send, data, len and addr are used.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(const RadioLibPacket& packet);
+
+    /*!
+      \brief Blocking transmit of all queued frames, in order. Stops at the first failed frame, which stays queued.
+
+      \param queue Frames to send, sent frames are removed.
+
+      \returns \ref status_codes
+    */
+    int16_t transmit(RadioLibPacketQueue& queue);
+
+    /*!
+      \brief Blocking receive into a caller provided buffer. Does not allocate memory.
+
+      \param packet Packet to receive to, data and size must be set. len and the reception metadata are filled in.
+      A packet longer than size is handled as by readData(RadioLibPacket&).
+
+      \returns \ref status_codes
+    */
+    int16_t receive(RadioLibPacket& packet);
+
+    /*!
+      \brief Interrupt-driven transmit of a packet descriptor. Does not allocate memory.
+
+      \param packet Packet to send, data, len and addr are used.
+
+      \returns \ref status_codes
+    */
+    int16_t startTransmit(const RadioLibPacket& packet);
+
+    /*!
+      \brief Interrupt-driven transmit of the oldest queued frame. Call again when the interrupt signals the end
+      of the transmission to send the queue frame by frame.
+
+      \param queue Frames to send, the started frame is removed.
+
+      \returns \ref status_codes, RADIOLIB_ERR_QUEUE_EMPTY when there is nothing to send.
+    */
+    int16_t startTransmit(RadioLibPacketQueue& queue);
+
+    /*!
+      \brief Reads data that was received after calling startReceive method into a caller provided buffer.
+      Does not allocate memory.
+
+      \param packet Packet to read to, data and size must be set. len and the reception metadata are filled in.
+      A packet longer than size is cut to size, its rest is discarded, rssi and lqi are 0 and
+      RADIOLIB_ERR_PACKET_TOO_LONG is returned.
+
+      \returns \ref status_codes
+    */
+    int16_t readData(RadioLibPacket& packet);
+
+    /*!
+      \brief Fill in the metadata of the last received packet (RSSI, link quality).
+      Modules that report them override this, the default sets them to 0.
+
+      \param packet Packet to update.
+    */
+    virtual void getPacketInfo(RadioLibPacket& packet);
+
     /*!
       \brief Enables direct transmission mode on pins DIO1 (clock) and DIO2 (data). Must be implemented in module class.
       While in direct mode, the module will not be able to transmit or receive packets. Can only be activated in FSK mode.
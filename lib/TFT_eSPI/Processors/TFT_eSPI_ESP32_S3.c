@@ -814,9 +814,39 @@ void IRAM_ATTR dc_callback(spi_transaction_t *spi_tx)
 ***************************************************************************************/
 extern "C" void dma_end_callback();
 
+// Optional user notifications, see setDMACallback()
+static void (*dma_user_callback)(void *arg) = nullptr;
+static void (*dma_user_start_callback)(void *arg) = nullptr;
+static void *dma_user_arg = nullptr;
+
 void IRAM_ATTR dma_end_callback(spi_transaction_t *spi_tx)
 {
   WRITE_PERI_REG(SPI_DMA_CONF_REG(spi_host), 0);
+  if (dma_user_callback) dma_user_callback(dma_user_arg);
+}
+
+/***************************************************************************************
+** Function name:           dma_start_callback
+** Description:             Called (from ISR) just before the DMA transfer starts
+***************************************************************************************/
+void IRAM_ATTR dma_start_callback(spi_transaction_t *spi_tx)
+{
+  if (dma_user_start_callback) dma_user_start_callback(dma_user_arg);
+}
+
+/***************************************************************************************
+** Function name:           setDMACallback
+** Description:             Set functions called (from ISR) when a DMA transfer starts/ends
+***************************************************************************************/
+void TFT_eSPI::setDMACallback(void (*cb)(void *arg), void *arg, void (*start_cb)(void *arg))
+{
+  // Make sure a transfer in flight does not see a half updated set
+  dmaWait();
+  dma_user_callback = nullptr;
+  dma_user_start_callback = nullptr;
+  dma_user_arg = arg;
+  dma_user_start_callback = start_cb;
+  dma_user_callback = cb;
 }
 
 /***************************************************************************************
@@ -855,7 +885,7 @@ bool TFT_eSPI::initDMA(bool ctrl_cs)
     .spics_io_num = pin,
     .flags = SPI_DEVICE_NO_DUMMY, //0,
     .queue_size = 1,            // Not using queues
-    .pre_cb = 0, //dc_callback, //Callback to handle D/C line (not used)
+    .pre_cb = dma_start_callback, //dc_callback, //Callback to handle D/C line (not used)
     .post_cb = dma_end_callback //Callback to end transmission
   };
   ret = spi_bus_initialize(spi_host, &buscfg, DMA_CHANNEL);
@@ -793,6 +793,13 @@ class TFT_eSPI : public Print { friend class TFT_eSprite; // Sprite class has ac
   bool     dmaBusy(void); // returns true if DMA is still in progress
   void     dmaWait(void); // wait until DMA is complete
 
+#if defined (CONFIG_IDF_TARGET_ESP32S3)
+           // Register a function called from the SPI interrupt when each DMA pixel transfer ends,
+           // e.g. to hand the buffer back to a graphics library, and optionally one called when
+           // it starts. They must be short, ISR safe and in IRAM. Pass nullptr to remove them.
+  void     setDMACallback(void (*cb)(void *arg), void *arg = nullptr, void (*start_cb)(void *arg) = nullptr);
+#endif
+
   bool     DMA_Enabled = false;   // Flag for DMA enabled state
   uint8_t  spiBusyCheck = 0;      // Number of ESP32 transfer buffers to check
 
@@ -0,0 +1,136 @@
+/*
+  fft_bench.cpp
+
+  Host benchmark of the RealFFT engine of examples/factory against arduinoFFT::Compute, not an
+  Arduino sketch. Both build without Arduino.h when ARDUINO is not defined, arduinoFFT.h then
+  only misses <stdint.h>.
+
+    g++ -O2 -include stdint.h -I../../src -I../../../../examples/factory fft_bench.cpp ../../src/arduinoFFT.cpp \
+      ../../../../examples/factory/RealFFT.cpp -o fft_bench
+
+    ./fft_bench [-l loops]
+
+  For N = 256 .. 4096 the same two-tone signal (the one FFT_Test() draws) goes through
+  arduinoFFT::Compute + magnitude in double, RealFFT::forward + amplitude in float32 and
+  RealFFT::forwardQ15 + amplitudeQ15. Times are CPU microseconds per transform, the amplitude
+  spectrum included. The error columns are the largest difference of a bin from the arduinoFFT
+  amplitude, in percent of the strongest tone. Exits with 1 if float32 is off by more than 0.1 %
+  or Q15 by more than 2 %.
+*/
+#include <stdint.h>
+#include "arduinoFFT.h"
+#include "RealFFT.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const uint16_t MIN_N = 256;
+static const uint16_t MAX_N = 4096;
+static const double RATE = 16000;
+
+static double cpu_us(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+// 1024 @ 1 kHz + 512 @ 3 kHz, 30 degrees, like fn() of MyFFT.h
+static double signal(int i)
+{
+    return 1024 * cos(2 * M_PI * 1000 * i / RATE) + 512 * cos(2 * M_PI * 3000 * i / RATE + M_PI / 6);
+}
+
+int main(int argc, char **argv)
+{
+    int loops = 200;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-l") && i + 1 < argc)
+        {
+            loops = atoi(argv[++i]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-l loops]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    double *vReal = (double *)malloc(MAX_N * sizeof(double));
+    double *vImag = (double *)malloc(MAX_N * sizeof(double));
+    float *fData = (float *)malloc(MAX_N * sizeof(float));
+    int16_t *qData = (int16_t *)malloc(MAX_N * sizeof(int16_t));
+    arduinoFFT ref;
+    RealFFT fft;
+    bool ok = true;
+
+    printf("    N  arduinoFFT us  float32 us  speedup  Q15 us  speedup  float32 err  Q15 err\n");
+    for (uint16_t n = MIN_N; n <= MAX_N; n <<= 1)
+    {
+        if (!fft.begin(n))
+        {
+            fprintf(stderr, "RealFFT.begin(%u) failed\n", n);
+            return 1;
+        }
+        double tRef = 0, tFloat = 0, tQ15 = 0;
+        for (int l = 0; l < loops; l++)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                double v = signal(i);
+                vReal[i] = v;
+                vImag[i] = 0;
+                fData[i] = (float)v;
+                qData[i] = (int16_t)lround(v);
+            }
+
+            double t = cpu_us();
+            ref.Compute(vReal, vImag, n, FFT_FORWARD);
+            for (int i = 0; i < n / 2; i++)
+            {
+                vReal[i] = sqrt(vReal[i] * vReal[i] + vImag[i] * vImag[i]) * (i ? 2.0 : 1.0) / n;
+            }
+            tRef += cpu_us() - t;
+
+            t = cpu_us();
+            fft.forward(fData);
+            fft.amplitude(fData, fData);
+            tFloat += cpu_us() - t;
+
+            t = cpu_us();
+            fft.forwardQ15(qData);
+            fft.amplitudeQ15(qData, (uint16_t *)qData);
+            tQ15 += cpu_us() - t;
+        }
+
+        double errFloat = 0, errQ15 = 0;
+        const uint16_t *amp = (const uint16_t *)qData;
+        for (int i = 0; i < n / 2; i++)
+        {
+            errFloat = fmax(errFloat, fabs(fData[i] - vReal[i]));
+            errQ15 = fmax(errQ15, fabs(amp[i] - vReal[i]));
+        }
+        errFloat = errFloat * 100 / 1024;
+        errQ15 = errQ15 * 100 / 1024;
+        ok = ok && errFloat < 0.1 && errQ15 < 2;
+
+        tRef /= loops;
+        tFloat /= loops;
+        tQ15 /= loops;
+        printf("%5u  %13.1f  %10.1f  %6.1fx  %6.1f  %6.1fx  %10.4f%%  %6.3f%%\n", n, tRef, tFloat,
+               tRef / tFloat, tQ15, tRef / tQ15, errFloat, errQ15);
+    }
+
+    free(vReal);
+    free(vImag);
+    free(fData);
+    free(qData);
+    if (!ok)
+    {
+        printf("amplitude error over the limit\n");
+    }
+    return ok ? 0 : 1;
+}
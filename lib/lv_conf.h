@@ -140,8 +140,8 @@
  *If only the built-in image formats are used there is no real advantage of caching. (I.e. if no new image decoder is added)
  *With complex image decoders (e.g. PNG or JPG) caching can save the continuous open/decode of images.
  *However the opened images might consume additional RAM.
- *0: to disable caching*/
-#define LV_IMG_CACHE_DEF_SIZE 0
+ *0: to disable caching. Keep it at least 1 to be able to resize the cache at run time with `lv_img_cache_set_size()`*/
+#define LV_IMG_CACHE_DEF_SIZE 1
 
 /*Number of stops allowed per gradient. Increase this to allow more stops.
  *This adds (sizeof(lv_color_t) + 1) bytes per additional stop*/
@@ -169,6 +169,11 @@
  *Only used if software rotation is enabled in the display driver.*/
 #define LV_DISP_ROT_MAX_BUF (10*1024)
 
+/*Blend RGB565 with the kernels of lv_draw_sw_blend_rgb565.c: two pixels per 32 bit word and
+ *masks read 4 values at a time. The pixels are the same as with the generic loops.
+ *Requires LV_COLOR_DEPTH 16, LV_COLOR_16_SWAP 0 and LV_COLOR_MIX_ROUND_OFS 0*/
+#define LV_DRAW_SW_BLEND_RGB565 1
+
 /*-------------
  * GPU
  *-----------*/
@@ -316,7 +321,12 @@
 #define LV_ATTRIBUTE_TIMER_HANDLER
 
 /*Define a custom attribute to `lv_disp_flush_ready` function*/
-#define LV_ATTRIBUTE_FLUSH_READY
+#ifdef ESP_PLATFORM
+    #include "esp_attr.h"
+    #define LV_ATTRIBUTE_FLUSH_READY IRAM_ATTR /*May be called from a DMA done interrupt*/
+#else
+    #define LV_ATTRIBUTE_FLUSH_READY
+#endif
 
 /*Required alignment size for buffers*/
 #define LV_ATTRIBUTE_MEM_ALIGN_SIZE 1
@@ -332,7 +342,12 @@
 #define LV_ATTRIBUTE_LARGE_RAM_ARRAY
 
 /*Place performance critical functions into a faster memory (e.g RAM)*/
-#define LV_ATTRIBUTE_FAST_MEM
+#ifdef ESP_PLATFORM
+    #include "esp_attr.h"
+    #define LV_ATTRIBUTE_FAST_MEM IRAM_ATTR /*Blending and masks run from IRAM, no flash cache misses*/
+#else
+    #define LV_ATTRIBUTE_FAST_MEM
+#endif
 
 /*Prefix variables that are used in GPU accelerated operations, often these need to be placed in RAM sections that are DMA accessible*/
 #define LV_ATTRIBUTE_DMA
@@ -0,0 +1,15 @@
+/*Host stand-in of the Arduino API for LV_TICK_CUSTOM of lib/lv_conf.h, see blend_bench.c*/
+#ifndef BLEND_BENCH_ARDUINO_H
+#define BLEND_BENCH_ARDUINO_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint32_t millis(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)(t.tv_sec * 1000 + t.tv_nsec / 1000000);
+}
+
+#endif /*BLEND_BENCH_ARDUINO_H*/
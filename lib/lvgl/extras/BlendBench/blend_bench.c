@@ -0,0 +1,279 @@
+/*
+  blend_bench.c
+
+  Host check and benchmark of the blend kernels of lv_draw_sw_blend_basic(), not part of the library
+  build. LVGL is built with the project's lib/lv_conf.h, Arduino.h and esp32-hal.h of this directory
+  stand in for the ESP32 headers it includes.
+
+    gcc -O2 -DLV_CONF_INCLUDE_SIMPLE -I. -I../../.. blend_bench.c $(find ../../src -name '*.c') -o blend_bench
+
+  ./blend_bench [-n cases] [-s seed]
+    Blends random areas (any offset, width and clipping, random opacity, masks with runs of 0 and
+    255 and anti-aliased edges, destinations with black pixels) with the generic loops and with the
+    RGB565 kernels, and compares the two buffers. Exits with 1 at the first pixel that differs.
+    Then times typical UI blends of a 320x170 screen with both and prints megapixels per CPU second,
+    the best of BENCH_RUNS runs.
+*/
+#include "lvgl/lvgl.h"
+#include "lvgl/src/draw/sw/lv_draw_sw.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SCR_W 320
+#define SCR_H 170
+#define BENCH_RUNS 5    /*timed runs of each case and kernel set*/
+
+typedef struct {
+    const char * name;
+    lv_area_t area;      /*blended area, also the area of the image and the mask*/
+    lv_opa_t opa;
+    bool image;
+    bool image_odd;      /*image rows start a half word off the destination*/
+    uint8_t mask;        /*0: none, 1: glyph like, 2: rounded corners (mostly 255)*/
+} bench_case_t;
+
+static lv_disp_t * disp;
+static lv_draw_ctx_t * draw_ctx;
+static lv_color_t dest_ref[SCR_W * SCR_H];
+static lv_color_t dest_new[SCR_W * SCR_H];
+static lv_color_t src_buf[(SCR_W + 2) * (SCR_H + 2)];
+static lv_opa_t mask_buf[SCR_W * SCR_H + 4];
+static uint32_t rnd_state = 1;
+
+static uint32_t rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static int32_t rnd_range(int32_t min, int32_t max)
+{
+    return min + (int32_t)(rnd() % (uint32_t)(max - min + 1));
+}
+
+static double cpu_seconds(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * color_p)
+{
+    lv_disp_flush_ready(drv);
+}
+
+static void init_disp(void)
+{
+    static lv_disp_draw_buf_t draw_buf;
+    static lv_disp_drv_t disp_drv;
+    static lv_area_t buf_area = {0, 0, SCR_W - 1, SCR_H - 1};
+    static lv_area_t clip_area;
+
+    lv_init();
+    lv_disp_draw_buf_init(&draw_buf, dest_ref, NULL, SCR_W * SCR_H);
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = SCR_W;
+    disp_drv.ver_res = SCR_H;
+    disp_drv.flush_cb = flush_cb;
+    disp_drv.draw_buf = &draw_buf;
+    disp = lv_disp_drv_register(&disp_drv);
+
+    /*As if the screen was being refreshed*/
+    _lv_refr_set_disp_refreshing(disp);
+    draw_ctx = disp->driver->draw_ctx;
+    draw_ctx->buf_area = &buf_area;
+    draw_ctx->clip_area = &clip_area;
+    clip_area = buf_area;
+}
+
+static void fill_dest(lv_color_t * buf, bool black)
+{
+    int32_t i;
+    for(i = 0; i < SCR_W * SCR_H; i++) {
+        buf[i].full = black && (rnd() & 3) == 0 ? 0 : (uint16_t)rnd();
+    }
+    /*Runs of one color, like a background*/
+    for(i = 0; i < 20; i++) {
+        int32_t start = rnd_range(0, SCR_W * SCR_H - 1);
+        int32_t len = rnd_range(1, 600);
+        uint16_t c = rnd() & 1 ? 0 : (uint16_t)rnd();
+        while(len-- && start < SCR_W * SCR_H) buf[start++].full = c;
+    }
+}
+
+static void fill_mask(lv_opa_t * mask, int32_t len, uint8_t kind)
+{
+    int32_t i = 0;
+    while(i < len) {
+        int32_t run = rnd_range(1, kind == 2 ? 200 : 12);
+        uint32_t r = rnd() % 10;
+        lv_opa_t v;
+        if(kind == 2) v = r < 8 ? LV_OPA_COVER : r < 9 ? LV_OPA_TRANSP : (lv_opa_t)rnd();
+        else v = r < 5 ? LV_OPA_TRANSP : r < 7 ? LV_OPA_COVER : (lv_opa_t)rnd();
+        if(r == 9) run = 1; /*anti-aliased edge*/
+        while(run-- && i < len) mask[i++] = v == LV_OPA_COVER || v == LV_OPA_TRANSP ? v : (lv_opa_t)rnd();
+    }
+}
+
+static void blend(lv_color_t * dest, const lv_area_t * area, const lv_area_t * clip, lv_color_t color,
+                  const lv_color_t * src, lv_opa_t opa, lv_opa_t * mask)
+{
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = area;
+    dsc.src_buf = src;
+    dsc.color = color;
+    dsc.opa = opa;
+    dsc.mask_buf = mask;
+    dsc.mask_area = area;
+    dsc.mask_res = mask ? LV_DRAW_MASK_RES_CHANGED : LV_DRAW_MASK_RES_FULL_COVER;
+    dsc.blend_mode = LV_BLEND_MODE_NORMAL;
+
+    draw_ctx->buf = dest;
+    *(lv_area_t *)draw_ctx->clip_area = *clip;
+    lv_draw_sw_blend(draw_ctx, &dsc);
+}
+
+static int check(int32_t cases)
+{
+    const lv_draw_sw_blend_kernels_t * kernels = lv_draw_sw_blend_get_kernels();
+    int32_t i;
+    for(i = 0; i < cases; i++) {
+        /*Areas partly out of the clip area shift the image and the mask by odd amounts too*/
+        lv_area_t area;
+        area.x1 = rnd_range(-8, SCR_W - 1);
+        area.y1 = rnd_range(-8, SCR_H - 1);
+        area.x2 = area.x1 + rnd_range(0, i % 4 == 0 ? SCR_W : 40);
+        area.y2 = area.y1 + rnd_range(0, i % 4 == 0 ? SCR_H : 12);
+        if(lv_area_get_size(&area) > SCR_W * SCR_H) area.y2 = area.y1 + SCR_W * SCR_H / lv_area_get_width(&area) - 1;
+        lv_area_t clip = {rnd_range(0, 4), rnd_range(0, 4), SCR_W - 1 - rnd_range(0, 4), SCR_H - 1 - rnd_range(0, 4)};
+
+        lv_opa_t opa;
+        uint32_t r = rnd() % 4;
+        opa = r == 0 ? LV_OPA_COVER : r == 1 ? (lv_opa_t)rnd_range(LV_OPA_MAX - 4, 255) : (lv_opa_t)rnd();
+        bool image = rnd() & 1;
+        uint8_t mask_kind = rnd() % 3;
+        lv_color_t color;
+        color.full = (uint16_t)rnd();
+        const lv_color_t * src = image ? src_buf + (rnd() & 1) : NULL;
+        int32_t mask_ofs = rnd() % 4;
+        lv_opa_t * mask = mask_kind ? mask_buf + mask_ofs : NULL;
+
+        int32_t j;
+        for(j = 0; j < (SCR_W + 2) * (SCR_H + 2); j++) src_buf[j].full = rnd() & 7 ? (uint16_t)rnd() : 0;
+        if(mask) fill_mask(mask, lv_area_get_size(&area), mask_kind);
+        fill_dest(dest_ref, rnd() & 1);
+        lv_memcpy(dest_new, dest_ref, sizeof(dest_ref));
+
+        lv_draw_sw_blend_set_kernels(NULL);
+        blend(dest_ref, &area, &clip, color, src, opa, mask);
+        lv_draw_sw_blend_set_kernels(kernels);
+        blend(dest_new, &area, &clip, color, src, opa, mask);
+
+        for(j = 0; j < SCR_W * SCR_H; j++) {
+            if(dest_ref[j].full != dest_new[j].full) {
+                printf("case %d: %s, area %d,%d %dx%d, opa %u, mask %u (+%d): pixel %d,%d is %04x instead of %04x\n",
+                       (int)i, src ? (src == src_buf ? "image" : "image +1") : "fill",
+                       (int)area.x1, (int)area.y1, (int)lv_area_get_width(&area), (int)lv_area_get_height(&area),
+                       opa, mask_kind, (int)mask_ofs, (int)(j % SCR_W), (int)(j / SCR_W),
+                       dest_new[j].full, dest_ref[j].full);
+                return 1;
+            }
+        }
+    }
+    printf("%d random blends: the kernels give the same pixels as the generic loops\n", (int)cases);
+    return 0;
+}
+
+/*Megapixels per CPU second of one case with the current kernels*/
+static double run_case(const bench_case_t * c)
+{
+    lv_area_t clip = {0, 0, SCR_W - 1, SCR_H - 1};
+    lv_color_t color = lv_color_make(0x20, 0x80, 0xc0);
+    const lv_color_t * src = c->image ? src_buf + (c->image_odd ? 1 : 0) : NULL;
+    lv_opa_t * mask = c->mask ? mask_buf : NULL;
+    uint32_t px = lv_area_get_size(&c->area);
+    uint32_t n = 0;
+    double start = cpu_seconds();
+    double t;
+    do {
+        uint32_t k;
+        for(k = 0; k < 16; k++) blend(dest_new, &c->area, &clip, color, src, c->opa, mask);
+        n += 16;
+        t = cpu_seconds() - start;
+    } while(t < 0.2);
+    return (double)n * px / t / 1e6;
+}
+
+static void bench(void)
+{
+    static const bench_case_t cases[] = {
+        {"fill, screen",             {0, 0, 319, 169}, LV_OPA_COVER, false, false, 0},
+        {"fill, opa 50%",            {11, 20, 210, 119}, LV_OPA_50, false, false, 0},
+        {"fill, glyph mask",         {11, 20, 210, 59}, LV_OPA_COVER, false, false, 1},
+        {"fill, rounded mask",       {11, 20, 210, 119}, LV_OPA_COVER, false, false, 2},
+        {"fill, glyph mask, opa",    {11, 20, 210, 59}, LV_OPA_70, false, false, 1},
+        {"image",                    {10, 20, 137, 147}, LV_OPA_COVER, true, false, 0},
+        {"image, odd offset",        {11, 20, 138, 147}, LV_OPA_COVER, true, true, 0},
+        {"image, opa 50%",           {10, 20, 137, 147}, LV_OPA_50, true, false, 0},
+        {"image, rounded mask",      {10, 20, 137, 147}, LV_OPA_COVER, true, false, 2},
+        {"image, glyph mask, opa",   {10, 20, 137, 147}, LV_OPA_70, true, false, 1},
+    };
+    const lv_draw_sw_blend_kernels_t * kernels = lv_draw_sw_blend_get_kernels();
+    uint32_t i;
+
+    for(i = 0; i < (SCR_W + 2) * (SCR_H + 2); i++) src_buf[i].full = (uint16_t)rnd();
+    fill_mask(mask_buf, SCR_W * SCR_H, 1);
+    lv_opa_t * rounded = lv_mem_alloc(SCR_W * SCR_H);
+    fill_mask(rounded, SCR_W * SCR_H, 2);
+    /*A gradient under the blends, not one color all over*/
+    for(i = 0; i < SCR_W * SCR_H; i++) dest_new[i] = lv_color_make(i % SCR_W * 255 / SCR_W, 0x40, i / SCR_W);
+
+    printf("%-26s %10s %10s %8s\n", "Mpx/s", "generic", "kernels", "speedup");
+    for(i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const bench_case_t * c = &cases[i];
+        if(c->mask == 2) lv_memcpy(mask_buf, rounded, SCR_W * SCR_H);
+        else if(c->mask == 1) fill_mask(mask_buf, SCR_W * SCR_H, 1);
+
+        /*Best of alternating runs, single runs of the same code differ by 30 %*/
+        double ref = 0;
+        double fast = 0;
+        uint32_t k;
+        for(k = 0; k < BENCH_RUNS; k++) {
+            lv_draw_sw_blend_set_kernels(NULL);
+            ref = LV_MAX(ref, run_case(c));
+            lv_draw_sw_blend_set_kernels(kernels);
+            fast = LV_MAX(fast, run_case(c));
+        }
+        printf("%-26s %10.1f %10.1f %7.2fx\n", c->name, ref, fast, fast / ref);
+    }
+    lv_mem_free(rounded);
+}
+
+int main(int argc, char ** argv)
+{
+    int32_t cases = 20000;
+    int i;
+    for(i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) cases = atoi(argv[++i]);
+        else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) rnd_state = (uint32_t)strtoul(argv[++i], NULL, 0) | 1;
+        else {
+            printf("usage: %s [-n cases] [-s seed]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    init_disp();
+    if(lv_draw_sw_blend_get_kernels() == NULL) {
+        printf("LV_DRAW_SW_BLEND_RGB565 is disabled in lv_conf.h\n");
+        return 1;
+    }
+    if(check(cases)) return 1;
+    bench();
+    return 0;
+}
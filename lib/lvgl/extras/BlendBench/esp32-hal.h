@@ -0,0 +1,10 @@
+/*Host stand-in of the PSRAM allocator for LV_MEM_CUSTOM of lib/lv_conf.h, see blend_bench.c*/
+#ifndef BLEND_BENCH_ESP32_HAL_H
+#define BLEND_BENCH_ESP32_HAL_H
+
+#include <stdlib.h>
+
+#define ps_malloc  malloc
+#define ps_realloc realloc
+
+#endif /*BLEND_BENCH_ESP32_HAL_H*/
@@ -0,0 +1,85 @@
+/*Host stand-in of the Arduino, ESP-IDF and FreeRTOS calls of LVGL and gif_cache.cpp, see gif_bench.cpp*/
+#ifndef GIF_BENCH_ARDUINO_H
+#define GIF_BENCH_ARDUINO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*Simulated clock of LV_TICK_CUSTOM, advanced by the bench*/
+uint32_t millis(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#define MALLOC_CAP_SPIRAM 0
+
+static inline void * heap_caps_malloc(size_t size, uint32_t caps) { return malloc(size); }
+static inline void * heap_caps_calloc(size_t n, size_t size, uint32_t caps) { return calloc(n, size); }
+static inline void heap_caps_free(void * p) { free(p); }
+
+/*CPU time of the calling thread, the time gif_cache measures is the work it does on that task*/
+static inline int64_t esp_timer_get_time(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return t.tv_sec * 1000000LL + t.tv_nsec / 1000;
+}
+
+/*A task is a thread, it ends when its function returns after vTaskDelete(NULL)*/
+typedef void * TaskHandle_t;
+#define pdPASS        1
+#define portMAX_DELAY 0xFFFFFFFFu
+
+static inline int xTaskCreatePinnedToCore(void (*fn)(void *), const char * name, uint32_t stack, void * arg,
+                                          uint32_t prio, TaskHandle_t * task, int core)
+{
+    std::thread(fn, arg).detach();
+    return pdPASS;
+}
+static inline void vTaskDelete(TaskHandle_t task) {}
+
+struct HostSemaphore {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool given = false;
+};
+typedef HostSemaphore * SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinary(void) { return new HostSemaphore(); }
+static inline void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
+static inline int xSemaphoreGive(SemaphoreHandle_t s)
+{
+    std::lock_guard<std::mutex> lock(s->mutex);
+    s->given = true;
+    s->cv.notify_one();
+    return 1;
+}
+/*Waits forever whatever the timeout, gif_cache only waits with portMAX_DELAY*/
+static inline int xSemaphoreTake(SemaphoreHandle_t s, uint32_t wait)
+{
+    std::unique_lock<std::mutex> lock(s->mutex);
+    s->cv.wait(lock, [s] { return s->given; });
+    s->given = false;
+    return 1;
+}
+
+struct HostSerial {
+    template <typename... Args> void printf(const char * fmt, Args... args) { ::printf(fmt, args...); }
+    void println(void) { ::printf("\n"); }
+};
+static HostSerial Serial;
+
+#endif /*__cplusplus*/
+
+#endif /*GIF_BENCH_ARDUINO_H*/
@@ -0,0 +1,208 @@
+/*
+  gif_bench.cpp
+
+  Host check and benchmark of the GIF player of the factory example (examples/factory/gif_cache.cpp),
+  not part of the library build. LVGL is built with the project's lib/lv_conf.h, Arduino.h and
+  esp32-hal.h of this directory stand in for the ESP32 headers. LVGL is C, so it is built first:
+
+    gcc -O2 -DLV_CONF_INCLUDE_SIMPLE -I. -I../.. -I../../.. -c $(find ../../src -name '*.c') \
+      ../../../../examples/factory/src/lilygo2_gif.c
+    g++ -O2 -DLV_CONF_INCLUDE_SIMPLE -I. -I../.. -I../../.. gif_bench.cpp *.o -o gif_bench && ./gif_bench
+
+  Plays lilygo2_gif (the boot animation) for PLAY_LOOPS loops on a simulated clock, stepped 1 ms at a
+  time. The recorder task is a thread; the clock stands still while the UI would wait for it, as if
+  it kept ahead. After each frame the canvas has to match gifdec decoding the same file, and the
+  screen redrawn over the area the player invalidated has to match a redraw of the whole screen.
+  Every loop has to have the same number of frames, gif_cache_loops() has to count them, no frame
+  may be decoded on the UI, and the first loop may not cost the UI more than gifdec. At the end a
+  player is deleted while its recorder runs.
+
+  Prints per loop the CPU time of the frame updates on the UI: the player against gifdec decoding
+  each frame, which is what lv_gif does, and the redraw of the invalidated area against that of the
+  whole image (lv_gif invalidates it all). Then the CPU time of the recorder, off the UI. Exits with
+  1 when a check fails.
+*/
+#include "lvgl.h"
+#include "../../../../examples/factory/gif_cache.cpp"
+#include "../../../../examples/factory/lz4_block.cpp"
+
+#define SCR_W      320
+#define SCR_H      170
+#define PLAY_LOOPS 3
+
+extern "C" const lv_img_dsc_t lilygo2_gif;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t decoded;    /*on the UI*/
+    uint32_t player_us;  /*gif_cache on the UI: unpack, or decode*/
+    uint32_t gifdec_us;  /*gifdec: decode every frame*/
+    uint64_t px;         /*redrawn by the player*/
+    uint32_t redraw_us;
+    uint32_t full_us;    /*redraw of the whole screen*/
+    uint32_t end_ms;     /*simulated time when the next loop started*/
+} loop_stat_t;
+
+static uint32_t sim_ms = 0;
+static lv_color_t fb[SCR_W * SCR_H];
+static lv_color_t fb_part[SCR_W * SCR_H];
+static lv_color_t draw_buf[SCR_W * 40];
+static uint64_t flushed_px = 0;
+static loop_stat_t loops[PLAY_LOOPS + 1];
+
+uint32_t millis(void)
+{
+    return sim_ms;
+}
+
+static uint32_t cpu_us(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+
+static void flush_cb(lv_disp_drv_t * drv, const lv_area_t * area, lv_color_t * px)
+{
+    int32_t w = lv_area_get_width(area);
+    for(int32_t y = area->y1; y <= area->y2; y++) {
+        memcpy(&fb[y * SCR_W + area->x1], &px[(y - area->y1) * w], w * sizeof(lv_color_t));
+    }
+    flushed_px += lv_area_get_size(area);
+    lv_disp_flush_ready(drv);
+}
+
+static void print_loop(const char * name, const loop_stat_t * l)
+{
+    printf("  %-6s %3u frames, %3u decoded: update %5u us/frame (gifdec %5u us, %4.1fx), "
+           "redraw %5.1f%% of the screen %5u us/frame (whole %5u us, %4.1fx)\n",
+           name, l->frames, l->decoded, l->player_us / l->frames, l->gifdec_us / l->frames,
+           (double)l->gifdec_us / l->player_us, l->px * 100.0 / ((uint64_t)l->frames * SCR_W * SCR_H),
+           l->redraw_us / l->frames, l->full_us / l->frames, (double)l->full_us / l->redraw_us);
+}
+
+int main(void)
+{
+    lv_init();
+    static lv_disp_draw_buf_t disp_buf;
+    lv_disp_draw_buf_init(&disp_buf, draw_buf, NULL, SCR_W * 40);
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = SCR_W;
+    disp_drv.ver_res = SCR_H;
+    disp_drv.flush_cb = flush_cb;
+    disp_drv.draw_buf = &disp_buf;
+    lv_disp_t * disp = lv_disp_drv_register(&disp_drv);
+    lv_timer_set_period(disp->refr_timer, UINT32_MAX); /*the bench redraws, after each frame*/
+    lv_refr_now(NULL);
+
+    gd_GIF * ref = gd_open_gif_data(lilygo2_gif.data);
+    lv_obj_t * obj = gif_cache_create(lv_scr_act(), &lilygo2_gif);
+    lv_obj_center(obj);
+    const gif_player_t * p = (const gif_player_t *)lv_obj_get_user_data(obj);
+    const uint8_t * canvas = (const uint8_t *)((const lv_img_dsc_t *)lv_img_get_src(obj))->data;
+    uint32_t canvas_size = ref->width * ref->height * PX;
+
+    uint32_t shown = 0, bad = 0, decoded = 0, player_us = 0;
+    int32_t loop = 0;
+    while(loop >= 0 && loop < PLAY_LOOPS && sim_ms < 60000) {
+        if(shown == stat.shown + stat.decoded) {
+            if(p->mode == GIF_FOLLOW && p->seq == p->ready.load() && p->state.load() == REC_RUNNING) {
+                std::this_thread::yield();
+                continue;
+            }
+            sim_ms++;
+            lv_timer_handler();
+            continue;
+        }
+        /*one frame per step, the frames last 10 ms or more*/
+        shown++;
+        int32_t played = gif_cache_loops(obj);
+        if(played != loop && played >= 0) loops[loop].end_ms = sim_ms;
+        loop = played;
+        loop_stat_t * l = &loops[loop < 0 ? PLAY_LOOPS : loop];
+        l->frames++;
+        l->decoded += stat.decoded - decoded;
+        decoded = stat.decoded;
+        uint32_t us = stat.show_us + stat.decode_us;
+        l->player_us += us - player_us;
+        player_us = us;
+
+        uint32_t start = cpu_us();
+        if(gd_get_frame(ref) <= 0) {
+            printf("frame %u: gifdec ended\n", shown);
+            bad++;
+        }
+        gd_render_frame(ref, ref->canvas);
+        l->gifdec_us += cpu_us() - start;
+        if(memcmp(canvas, ref->canvas, canvas_size) != 0) {
+            if(bad < 5) printf("frame %u: canvas differs from gifdec\n", shown);
+            bad++;
+        }
+
+        uint64_t px = flushed_px;
+        start = cpu_us();
+        lv_refr_now(NULL);
+        l->redraw_us += cpu_us() - start;
+        l->px += flushed_px - px;
+        memcpy(fb_part, fb, sizeof(fb));
+        lv_obj_invalidate(lv_scr_act());
+        start = cpu_us();
+        lv_refr_now(NULL);
+        l->full_us += cpu_us() - start;
+        if(memcmp(fb_part, fb, sizeof(fb)) != 0) {
+            if(bad < 5) printf("frame %u: redraw of the invalidated area differs\n", shown);
+            bad++;
+        }
+    }
+
+    /*the first frame of the loop after the last one is shown already*/
+    printf("lilygo2_gif %ux%u, %u loops of %u frames\n", ref->width, ref->height, PLAY_LOOPS, loops[0].frames);
+    loop_stat_t all = {0};
+    for(int32_t i = 0; i < PLAY_LOOPS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "loop %d", (int)i + 1);
+        print_loop(name, &loops[i]);
+        printf("         ends at %.2f s\n", loops[i].end_ms / 1000.0);
+        if(loops[i].frames != loops[0].frames) {
+            printf("loop %d: %u frames, the first one had %u\n", (int)i + 1, loops[i].frames, loops[0].frames);
+            bad++;
+        }
+        all.frames += loops[i].frames;
+        all.decoded += loops[i].decoded;
+        all.player_us += loops[i].player_us;
+        all.gifdec_us += loops[i].gifdec_us;
+        all.px += loops[i].px;
+        all.redraw_us += loops[i].redraw_us;
+        all.full_us += loops[i].full_us;
+    }
+    print_loop("all", &all);
+    printf("  recorder %u frames, %u us/frame off the UI, the UI waited %u times\n", stat.recorded,
+           stat.record_us / LV_MAX(stat.recorded, 1), stat.waits);
+    if(all.decoded) {
+        printf("%u frames decoded on the UI\n", all.decoded);
+        bad++;
+    }
+    if(loops[0].player_us > loops[0].gifdec_us) {
+        printf("loop 1 costs the UI more than gifdec\n");
+        bad++;
+    }
+    if(stat.recorded >= 2 * loops[0].frames) {
+        printf("the recorder did not stop after the second loop\n");
+        bad++;
+    }
+    if(loop != PLAY_LOOPS) {
+        printf("gif_cache_loops() is %d after %u frames\n", (int)loop, shown);
+        bad++;
+    }
+    gif_cache_report();
+    lv_obj_del(obj);
+
+    /*deleted while recording: waits for the frame the recorder is on*/
+    uint32_t recorded = stat.recorded;
+    obj = gif_cache_create(lv_scr_act(), &lilygo2_gif);
+    while(stat.recorded < recorded + 3) std::this_thread::yield();
+    lv_obj_del(obj);
+    printf("deleted after %u frames recorded\n", stat.recorded - recorded);
+    gd_close_gif(ref);
+    printf("%s\n", bad ? "FAILED" : "ok");
+    return bad ? 1 : 0;
+}
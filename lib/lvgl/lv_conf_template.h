@@ -172,6 +172,11 @@
  *Only used if software rotation is enabled in the display driver.*/
 #define LV_DISP_ROT_MAX_BUF (10*1024)
 
+/*Blend RGB565 with the kernels of lv_draw_sw_blend_rgb565.c: two pixels per 32 bit word and
+ *masks read 4 values at a time. The pixels are the same as with the generic loops.
+ *Requires LV_COLOR_DEPTH 16, LV_COLOR_16_SWAP 0 and LV_COLOR_MIX_ROUND_OFS 0*/
+#define LV_DRAW_SW_BLEND_RGB565 0
+
 /*-------------
  * GPU
  *-----------*/
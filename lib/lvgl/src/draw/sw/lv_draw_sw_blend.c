@@ -14,6 +14,14 @@
 /*********************
  *      DEFINES
  *********************/
+#if LV_DRAW_SW_BLEND_RGB565
+    #if LV_COLOR_DEPTH != 16 || LV_COLOR_16_SWAP != 0 || LV_COLOR_MIX_ROUND_OFS != 0 || LV_BIG_ENDIAN_SYSTEM != 0
+        #error "LV_DRAW_SW_BLEND_RGB565 requires LV_COLOR_DEPTH 16, LV_COLOR_16_SWAP 0, LV_COLOR_MIX_ROUND_OFS 0 and a little endian system"
+    #endif
+    #define BLEND_KERNELS_DEF (&lv_draw_sw_blend_kernels_rgb565)
+#else
+    #define BLEND_KERNELS_DEF NULL
+#endif
 
 /**********************
  *      TYPEDEFS
@@ -26,6 +34,9 @@
 static void fill_set_px(lv_color_t * dest_buf, const lv_area_t * blend_area, lv_coord_t dest_stride,
                         lv_color_t color, lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stide);
 
+static bool fill_kernel(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_coord_t dest_stride,
+                        lv_color_t color, lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stride);
+
 static void /* LV_ATTRIBUTE_FAST_MEM */ fill_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
                                                     lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa,
                                                     const lv_opa_t * mask, lv_coord_t mask_stride);
@@ -46,6 +57,10 @@ static void map_set_px(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_co
                        const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
                        const lv_opa_t * mask, lv_coord_t mask_stride);
 
+static bool map_kernel(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_coord_t dest_stride,
+                       const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
+                       const lv_opa_t * mask, lv_coord_t mask_stride);
+
 static void /* LV_ATTRIBUTE_FAST_MEM */ map_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
                                                    lv_coord_t dest_stride, const lv_color_t * src_buf,
                                                    lv_coord_t src_stride, lv_opa_t opa, const lv_opa_t * mask,
@@ -72,6 +87,7 @@ static inline lv_color_t color_blend_true_color_multiply(lv_color_t fg, lv_color
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const lv_draw_sw_blend_kernels_t * kernels = BLEND_KERNELS_DEF;
 
 /**********************
  *      MACROS
@@ -94,6 +110,16 @@ static inline lv_color_t color_blend_true_color_multiply(lv_color_t fg, lv_color
  *   GLOBAL FUNCTIONS
  **********************/
 
+void lv_draw_sw_blend_set_kernels(const lv_draw_sw_blend_kernels_t * k)
+{
+    kernels = k;
+}
+
+const lv_draw_sw_blend_kernels_t * lv_draw_sw_blend_get_kernels(void)
+{
+    return kernels;
+}
+
 void lv_draw_sw_blend(lv_draw_ctx_t * draw_ctx, const lv_draw_sw_blend_dsc_t * dsc)
 {
     /*Do not draw transparent things*/
@@ -188,10 +214,14 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_blend_basic(lv_draw_ctx_t * draw_ctx,
 #endif
     else if(dsc->blend_mode == LV_BLEND_MODE_NORMAL) {
         if(dsc->src_buf == NULL) {
-            fill_normal(dest_buf, &blend_area, dest_stride, dsc->color, dsc->opa, mask, mask_stride);
+            if(!fill_kernel(dest_buf, &blend_area, dest_stride, dsc->color, dsc->opa, mask, mask_stride)) {
+                fill_normal(dest_buf, &blend_area, dest_stride, dsc->color, dsc->opa, mask, mask_stride);
+            }
         }
         else {
-            map_normal(dest_buf, &blend_area, dest_stride, src_buf, src_stride, dsc->opa, mask, mask_stride);
+            if(!map_kernel(dest_buf, &blend_area, dest_stride, src_buf, src_stride, dsc->opa, mask, mask_stride)) {
+                map_normal(dest_buf, &blend_area, dest_stride, src_buf, src_stride, dsc->opa, mask, mask_stride);
+            }
         }
     }
     else {
@@ -244,6 +274,32 @@ static void fill_set_px(lv_color_t * dest_buf, const lv_area_t * blend_area, lv_
     }
 }
 
+/**
+ * Run the matching kernel of the current set
+ * @return false if there is no such kernel
+ */
+static bool fill_kernel(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_coord_t dest_stride,
+                        lv_color_t color, lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stride)
+{
+    if(kernels == NULL) return false;
+
+    int32_t w = lv_area_get_width(dest_area);
+    int32_t h = lv_area_get_height(dest_area);
+    if(mask) {
+        if(kernels->fill_mask == NULL) return false;
+        kernels->fill_mask(dest_buf, dest_stride, w, h, color, opa, mask, mask_stride);
+    }
+    else if(opa >= LV_OPA_MAX) {
+        if(kernels->fill == NULL) return false;
+        kernels->fill(dest_buf, dest_stride, w, h, color);
+    }
+    else {
+        if(kernels->fill_opa == NULL) return false;
+        kernels->fill_opa(dest_buf, dest_stride, w, h, color, opa);
+    }
+    return true;
+}
+
 static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
                                               lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa,
                                               const lv_opa_t * mask, lv_coord_t mask_stride)
@@ -643,6 +699,29 @@ static void map_set_px(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_co
     }
 }
 
+/**
+ * Run the matching kernel of the current set
+ * @return false if there is no such kernel
+ */
+static bool map_kernel(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_coord_t dest_stride,
+                       const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
+                       const lv_opa_t * mask, lv_coord_t mask_stride)
+{
+    if(kernels == NULL) return false;
+
+    int32_t w = lv_area_get_width(dest_area);
+    int32_t h = lv_area_get_height(dest_area);
+    if(mask) {
+        if(kernels->map_mask == NULL) return false;
+        kernels->map_mask(dest_buf, dest_stride, w, h, src_buf, src_stride, opa, mask, mask_stride);
+    }
+    else {
+        if(kernels->map == NULL) return false;
+        kernels->map(dest_buf, dest_stride, w, h, src_buf, src_stride, opa);
+    }
+    return true;
+}
+
 static void LV_ATTRIBUTE_FAST_MEM map_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
                                              lv_coord_t dest_stride, const lv_color_t * src_buf,
                                              lv_coord_t src_stride, lv_opa_t opa, const lv_opa_t * mask,
@@ -38,6 +38,34 @@ typedef struct {
     lv_blend_mode_t blend_mode;     /**< E.g. LV_BLEND_MODE_ADDITIVE*/
 } lv_draw_sw_blend_dsc_t;
 
+/**
+ * Optional kernels for the common cases of `lv_draw_sw_blend_basic()`: normal blend mode into a
+ * plain `lv_color_t` buffer (no `set_px_cb`, no `screen_transp`).
+ * `dest_buf`, `src_buf` and `mask` point to the first pixel of the `w` x `h` area, strides are in pixels.
+ * A kernel has to give exactly the same pixels as the generic loops. A NULL member uses the generic loop.
+ */
+typedef struct {
+    /** Fill with `opa >= LV_OPA_MAX`, no mask*/
+    void (*fill)(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h, lv_color_t color);
+
+    /** Fill with `opa < LV_OPA_MAX`, no mask*/
+    void (*fill_opa)(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h, lv_color_t color,
+                     lv_opa_t opa);
+
+    /** Fill through a mask, any `opa`*/
+    void (*fill_mask)(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h, lv_color_t color,
+                      lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stride);
+
+    /** Copy an image, any `opa`, no mask*/
+    void (*map)(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa);
+
+    /** Copy an image through a mask, any `opa`*/
+    void (*map_mask)(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                     const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
+                     const lv_opa_t * mask, lv_coord_t mask_stride);
+} lv_draw_sw_blend_kernels_t;
+
 struct _lv_draw_ctx_t;
 
 /**********************
@@ -59,6 +87,26 @@ void lv_draw_sw_blend(struct _lv_draw_ctx_t * draw_ctx, const lv_draw_sw_blend_d
 void /* LV_ATTRIBUTE_FAST_MEM */ lv_draw_sw_blend_basic(struct _lv_draw_ctx_t * draw_ctx,
                                                         const lv_draw_sw_blend_dsc_t * dsc);
 
+/**
+ * Select the kernels of `lv_draw_sw_blend_basic()`.
+ * @param kernels       pointer to a static kernel set, or NULL to use only the generic loops
+ */
+void lv_draw_sw_blend_set_kernels(const lv_draw_sw_blend_kernels_t * kernels);
+
+/**
+ * Get the kernels of `lv_draw_sw_blend_basic()`.
+ * @return              the current kernel set, NULL if only the generic loops are used
+ */
+const lv_draw_sw_blend_kernels_t * lv_draw_sw_blend_get_kernels(void);
+
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0 && LV_COLOR_MIX_ROUND_OFS == 0 && LV_BIG_ENDIAN_SYSTEM == 0
+/**
+ * RGB565 kernels working on two pixels per 32 bit word (lv_draw_sw_blend_rgb565.c).
+ * The default with `LV_DRAW_SW_BLEND_RGB565`.
+ */
+extern const lv_draw_sw_blend_kernels_t lv_draw_sw_blend_kernels_rgb565;
+#endif
+
 /**********************
  *      MACROS
  **********************/
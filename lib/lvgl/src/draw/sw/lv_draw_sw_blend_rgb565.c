@@ -0,0 +1,339 @@
+/**
+ * @file lv_draw_sw_blend_rgb565.c
+ *
+ * RGB565 kernels of lv_draw_sw_blend_basic().
+ * Pixels are read and written in pairs as 32 bit words where the buffers allow it, masks are
+ * scanned 4 values at a time and the colors are mixed with the same arithmetic as lv_color_mix(),
+ * so the result is the same as the generic loops of lv_draw_sw_blend.c, pixel by pixel.
+ * Plain and masked fills are left to the generic loops, which store two pixels at a time already:
+ * kernels for them measured slower (extras/BlendBench).
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_draw_sw.h"
+
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0 && LV_COLOR_MIX_ROUND_OFS == 0 && LV_BIG_ENDIAN_SYSTEM == 0
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Green, red and blue of a pixel spread in a word with room for a 5 bit multiplier, see lv_color_mix()*/
+#define SPREAD_MASK 0x07E0F81F
+
+/*Smaller opacity fills mix pixel by pixel instead of building the look up tables*/
+#define FILL_OPA_LUT_MIN_PX 64
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/*Result of an opacity fill for each value of the channels of the destination*/
+typedef struct {
+    uint16_t r[32];
+    uint16_t g[64];
+    uint16_t b[32];
+} fill_opa_lut_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void fill_opa(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h, lv_color_t color,
+                     lv_opa_t opa);
+static void map(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa);
+static void map_mask(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                     const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
+                     const lv_opa_t * mask, lv_coord_t mask_stride);
+
+/**********************
+ *  GLOBAL VARIABLES
+ **********************/
+const lv_draw_sw_blend_kernels_t lv_draw_sw_blend_kernels_rgb565 = {
+    .fill = NULL,
+    .fill_opa = fill_opa,
+    .fill_mask = NULL,
+    .map = map,
+    .map_mask = map_mask,
+};
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static inline uint32_t spread(uint16_t c)
+{
+    return ((uint32_t)c | ((uint32_t)c << 16)) & SPREAD_MASK;
+}
+
+/*The 5 bit mix ratio of lv_color_mix()*/
+static inline uint32_t mix5(lv_opa_t mix)
+{
+    return ((uint32_t)mix + 4) >> 3;
+}
+
+/*lv_color_mix() with a spread foreground, `mix` is 1..31*/
+static inline uint16_t mix_spread(uint32_t fg, uint16_t bg, uint32_t mix)
+{
+    uint32_t b = spread(bg);
+    uint32_t res = ((((fg - b) * mix) >> 5) + b) & SPREAD_MASK;
+    return (uint16_t)((res >> 16) | res);
+}
+
+/*One pixel of a masked copy: `mix` 0 keeps the destination, 32 is the source*/
+static inline void map_px(uint16_t * d, uint16_t s, uint32_t mix)
+{
+    if(mix == 32) *d = s;
+    else if(mix) *d = mix_spread(spread(s), *d, mix);
+}
+
+/*Pixels from `x` covered by whole words of 0xFF in an aligned mask, at least the word at `x`*/
+static inline int32_t cover_run(const lv_opa_t * mask, int32_t x, int32_t w)
+{
+    const uint32_t * m32 = (const uint32_t *)(mask + x) + 1;
+    int32_t run = 4;
+    while(x + run <= w - 4 && *m32 == 0xFFFFFFFF) {
+        run += 4;
+        m32++;
+    }
+    return run;
+}
+
+static inline void LV_ATTRIBUTE_FAST_MEM copy_row(uint16_t * d, const uint16_t * s, int32_t n)
+{
+    if(((lv_uintptr_t)d & 0x2) && n > 0) {
+        *d++ = *s++;
+        n--;
+    }
+
+    uint32_t * d32 = (uint32_t *)d;
+    if(((lv_uintptr_t)s & 0x2) == 0) {
+        const uint32_t * s32 = (const uint32_t *)s;
+        for(; n >= 8; n -= 8) {
+            d32[0] = s32[0];
+            d32[1] = s32[1];
+            d32[2] = s32[2];
+            d32[3] = s32[3];
+            d32 += 4;
+            s32 += 4;
+        }
+        for(; n >= 2; n -= 2) {
+            *d32++ = *s32++;
+        }
+        s = (const uint16_t *)s32;
+    }
+    else if(n >= 2) {
+        /*The source is a half word off: aligned loads, each output word is made of two of them.
+         *The first and the last load only touch the words holding the first and the last pixel.*/
+        const uint32_t * s32 = (const uint32_t *)(s - 1);
+        uint32_t prev = *s32++;
+        for(; n >= 2; n -= 2) {
+            uint32_t next = *s32++;
+            *d32++ = (prev >> 16) | (next << 16);
+            prev = next;
+            s += 2;
+        }
+    }
+    if(n) *(uint16_t *)d32 = *s;
+}
+
+static inline uint16_t lut_px(const fill_opa_lut_t * lut, uint16_t c)
+{
+    return lut->r[c >> 11] | lut->g[(c >> 5) & 0x3F] | lut->b[c & 0x1F];
+}
+
+static inline uint16_t premult_px(const uint16_t * premult, uint16_t c, lv_opa_t opa_inv)
+{
+    lv_color_t bg;
+    bg.full = c;
+    return lv_color_mix_premult((uint16_t *)premult, bg, opa_inv).full;
+}
+
+/*fill_normal() starts with the result of lv_color_mix() for black and keeps it until it meets
+ *another color, from there on black is mixed like the others. `black` holds the current one.*/
+static inline uint16_t fill_opa_px(const fill_opa_lut_t * lut, uint16_t c, uint16_t * black)
+{
+    if(c == 0) return *black;
+    *black = lut->r[0] | lut->g[0] | lut->b[0];
+    return lut_px(lut, c);
+}
+
+static void LV_ATTRIBUTE_FAST_MEM fill_opa(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                                           lv_color_t color, lv_opa_t opa)
+{
+    uint16_t black = lv_color_mix(color, lv_color_black(), opa).full;
+
+    /*The same rounding (and overflow at 252) of opa as fill_normal()*/
+    opa = (uint32_t)((uint32_t)opa + 4) >> 3;
+    opa = opa << 3;
+
+    uint16_t premult[3];
+    lv_color_premult(color, opa, premult);
+    lv_opa_t opa_inv = 255 - opa;
+
+    uint16_t * d = (uint16_t *)dest_buf;
+    int32_t x;
+    int32_t y;
+
+    if(w * h < FILL_OPA_LUT_MIN_PX) {
+        uint16_t last_dest = 0;
+        uint16_t last_res = black;
+        for(y = 0; y < h; y++) {
+            for(x = 0; x < w; x++) {
+                if(d[x] != last_dest) {
+                    last_dest = d[x];
+                    last_res = premult_px(premult, d[x], opa_inv);
+                }
+                d[x] = last_res;
+            }
+            d += dest_stride;
+        }
+        return;
+    }
+
+    /*The channels are mixed independently: 128 entries give the result of any pixel*/
+    fill_opa_lut_t lut;
+    uint32_t i;
+    for(i = 0; i < 32; i++) {
+        lut.r[i] = LV_UDIV255(premult[0] + i * opa_inv) << 11;
+        lut.b[i] = LV_UDIV255(premult[2] + i * opa_inv);
+    }
+    for(i = 0; i < 64; i++) {
+        lut.g[i] = LV_UDIV255(premult[1] + i * opa_inv) << 5;
+    }
+
+    /*The word cache starts with two blacks, it is refreshed when a single pixel changed `black`*/
+    uint32_t last_dest32 = 0;
+    uint32_t last_res32 = (uint32_t)black | ((uint32_t)black << 16);
+    for(y = 0; y < h; y++) {
+        uint16_t * row = d;
+        int32_t n = w;
+        if(((lv_uintptr_t)row & 0x2) && n > 0) {
+            *row = fill_opa_px(&lut, *row, &black);
+            if(last_dest32 == 0) last_res32 = (uint32_t)black | ((uint32_t)black << 16);
+            row++;
+            n--;
+        }
+
+        uint32_t * d32 = (uint32_t *)row;
+        for(; n >= 2; n -= 2) {
+            uint32_t v = *d32;
+            if(v != last_dest32) {
+                last_dest32 = v;
+                uint32_t lo = fill_opa_px(&lut, (uint16_t)v, &black);
+                uint32_t hi = fill_opa_px(&lut, (uint16_t)(v >> 16), &black);
+                last_res32 = lo | (hi << 16);
+            }
+            *d32++ = last_res32;
+        }
+        if(n) {
+            row = (uint16_t *)d32;
+            *row = fill_opa_px(&lut, *row, &black);
+            if(last_dest32 == 0) last_res32 = (uint32_t)black | ((uint32_t)black << 16);
+        }
+        d += dest_stride;
+    }
+}
+
+static void LV_ATTRIBUTE_FAST_MEM map(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                                      const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa)
+{
+    uint16_t * d = (uint16_t *)dest_buf;
+    const uint16_t * s = (const uint16_t *)src_buf;
+    uint32_t mix = mix5(opa);
+    int32_t x;
+    int32_t y;
+
+    /*Mixing with 32 gives the source exactly, with 0 the destination*/
+    if(opa >= LV_OPA_MAX || mix == 32) {
+        for(y = 0; y < h; y++) {
+            copy_row(d, s, w);
+            d += dest_stride;
+            s += src_stride;
+        }
+        return;
+    }
+    if(mix == 0) return;
+
+    for(y = 0; y < h; y++) {
+        x = 0;
+        if((((lv_uintptr_t)d ^ (lv_uintptr_t)s) & 0x2) == 0) {
+            if(((lv_uintptr_t)d & 0x2) && w > 0) {
+                d[0] = mix_spread(spread(s[0]), d[0], mix);
+                x = 1;
+            }
+            for(; x <= w - 2; x += 2) {
+                uint32_t dv = *(uint32_t *)&d[x];
+                uint32_t sv = *(const uint32_t *)&s[x];
+                if(dv == sv) continue;
+                uint32_t lo = mix_spread(spread((uint16_t)sv), (uint16_t)dv, mix);
+                uint32_t hi = mix_spread(spread((uint16_t)(sv >> 16)), (uint16_t)(dv >> 16), mix);
+                *(uint32_t *)&d[x] = lo | (hi << 16);
+            }
+        }
+        for(; x < w; x++) {
+            d[x] = mix_spread(spread(s[x]), d[x], mix);
+        }
+        d += dest_stride;
+        s += src_stride;
+    }
+}
+
+static void LV_ATTRIBUTE_FAST_MEM map_mask(lv_color_t * dest_buf, lv_coord_t dest_stride, int32_t w, int32_t h,
+                                           const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
+                                           const lv_opa_t * mask, lv_coord_t mask_stride)
+{
+    uint16_t * d = (uint16_t *)dest_buf;
+    const uint16_t * s = (const uint16_t *)src_buf;
+    int32_t x;
+    int32_t y;
+
+    /*Only the mask matters*/
+    if(opa > LV_OPA_MAX) {
+        for(y = 0; y < h; y++) {
+            for(x = 0; x < w && ((lv_uintptr_t)(mask + x) & 0x3); x++) {
+                map_px(&d[x], s[x], mix5(mask[x]));
+            }
+
+            while(x <= w - 4) {
+                uint32_t mask32 = *(const uint32_t *)(mask + x);
+                if(mask32 == 0xFFFFFFFF) {
+                    int32_t run = cover_run(mask, x, w);
+                    copy_row(&d[x], &s[x], run);
+                    x += run;
+                    continue;
+                }
+                if(mask32) {
+                    map_px(&d[x], s[x], mix5(mask[x]));
+                    map_px(&d[x + 1], s[x + 1], mix5(mask[x + 1]));
+                    map_px(&d[x + 2], s[x + 2], mix5(mask[x + 2]));
+                    map_px(&d[x + 3], s[x + 3], mix5(mask[x + 3]));
+                }
+                x += 4;
+            }
+
+            for(; x < w; x++) {
+                map_px(&d[x], s[x], mix5(mask[x]));
+            }
+            d += dest_stride;
+            s += src_stride;
+            mask += mask_stride;
+        }
+    }
+    /*Handle opa and mask values too*/
+    else {
+        for(y = 0; y < h; y++) {
+            for(x = 0; x < w; x++) {
+                if(mask[x]) {
+                    lv_opa_t opa_tmp = mask[x] >= LV_OPA_MAX ? opa : ((opa * mask[x]) >> 8);
+                    map_px(&d[x], s[x], mix5(opa_tmp));
+                }
+            }
+            d += dest_stride;
+            s += src_stride;
+            mask += mask_stride;
+        }
+    }
+}
+
+#endif /*LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0 && LV_COLOR_MIX_ROUND_OFS == 0 && LV_BIG_ENDIAN_SYSTEM == 0*/
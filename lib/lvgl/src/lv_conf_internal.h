@@ -412,6 +412,17 @@
     #endif
 #endif
 
+/*Blend RGB565 with the kernels of lv_draw_sw_blend_rgb565.c: two pixels per 32 bit word and
+ *masks read 4 values at a time. The pixels are the same as with the generic loops.
+ *Requires LV_COLOR_DEPTH 16, LV_COLOR_16_SWAP 0 and LV_COLOR_MIX_ROUND_OFS 0*/
+#ifndef LV_DRAW_SW_BLEND_RGB565
+    #ifdef CONFIG_LV_DRAW_SW_BLEND_RGB565
+        #define LV_DRAW_SW_BLEND_RGB565 CONFIG_LV_DRAW_SW_BLEND_RGB565
+    #else
+        #define LV_DRAW_SW_BLEND_RGB565 0
+    #endif
+#endif
+
 /*-------------
  * GPU
  *-----------*/